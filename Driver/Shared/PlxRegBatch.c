@@ -0,0 +1,262 @@
+/*******************************************************************************
+ * Copyright 2013-2019 Broadcom Inc
+ * Copyright (c) 2009 to 2012 PLX Technology Inc.  All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directorY of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ * File Name:
+ *
+ *      PlxRegBatch.c
+ *
+ * Description:
+ *
+ *      Register batch support shared by all drivers
+ *
+ * Revision History:
+ *
+ *      03-01-19 : PCI/PCIe SDK v8.00
+ *
+ ******************************************************************************/
+
+
+#include <linux/delay.h>    // For msleep_interruptible() & udelay()
+#include <linux/sched.h>    // For signal_pending()
+#include <linux/uaccess.h>  // For copy_to/from_user()
+#include "PlxRegBatch.h"
+
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,11,0))
+    #include <linux/sched/signal.h>
+#endif
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchExecute
+ *
+ * Description:  Executes a sequence of register accesses from a user array,
+ *               returning read values in the array
+ *
+ * Note       :  Processing stops at the first failed entry. Batches are
+ *               serialized with pMutex so that a sequence is not interleaved
+ *               with another batch.  Partial writes to PLX registers use the
+ *               RegModify accessor, if provided, so that bits also updated by
+ *               the ISR, e.g. in the interrupt control register, are not lost.
+ *               The total delay of a batch is limited & a pending signal
+ *               stops the batch, so other batch callers aren't held off.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxRegBatchExecute(
+    const PLX_REG_BATCH_OPS *pOps,
+    VOID                    *pContext,
+    struct semaphore        *pMutex,
+    PLX_REG_BATCH_ENTRY     *pUserEntries,
+    U32                      Count,
+    U32                     *pCountDone
+    )
+{
+    U32                  i;
+    U32                  Chunk;
+    U32                  RegValue;
+    U32                  DelayTotal_us;
+    BOOLEAN              bPartial;
+    PLX_STATUS           status;
+    PLX_REG_BATCH_ENTRY *pEntry;
+    PLX_REG_BATCH_ENTRY  Entries[PLX_REG_BATCH_ENTRIES_PER_COPY];
+
+
+    *pCountDone = 0;
+
+    if (Count > PLX_REG_BATCH_MAX_ENTRIES)
+    {
+        DebugPrintf(("ERROR - Batch of %d entries exceeds max (%d)\n", Count, PLX_REG_BATCH_MAX_ENTRIES));
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    if (down_interruptible( pMutex ) < 0)
+    {
+        return PLX_STATUS_CANCELED;
+    }
+
+    status        = PLX_STATUS_OK;
+    DelayTotal_us = 0;
+
+    while ((*pCountDone < Count) && (status == PLX_STATUS_OK))
+    {
+        Chunk = min_t( U32, Count - *pCountDone, PLX_REG_BATCH_ENTRIES_PER_COPY );
+
+        // Stage entries to avoid a user access per register
+        if (copy_from_user(
+                Entries,
+                pUserEntries + *pCountDone,
+                Chunk * sizeof(PLX_REG_BATCH_ENTRY)
+                ) != 0)
+        {
+            status = PLX_STATUS_INVALID_ADDR;
+            break;
+        }
+
+        for (i = 0; i < Chunk; i++)
+        {
+            pEntry = &Entries[i];
+
+            if ((pEntry->Op > PLX_REG_BATCH_DELAY) ||
+                (pEntry->Space > PLX_REG_BATCH_SPACE_MAPPED))
+            {
+                status = PLX_STATUS_INVALID_DATA;
+                break;
+            }
+
+            // Limit the total delay of the batch
+            if (pEntry->Delay_us > (PLX_REG_BATCH_MAX_DELAY_US - DelayTotal_us))
+            {
+                DebugPrintf(("ERROR - Total batch delay exceeds max (%dus)\n", PLX_REG_BATCH_MAX_DELAY_US));
+                status = PLX_STATUS_INVALID_SIZE;
+                break;
+            }
+
+            DelayTotal_us += pEntry->Delay_us;
+
+            // Stop if the caller was interrupted, e.g. during a delay
+            if (signal_pending( current ))
+            {
+                status = PLX_STATUS_CANCELED;
+                break;
+            }
+
+            RegValue = 0;
+
+            bPartial =
+                (pEntry->Op == PLX_REG_BATCH_WRITE) &&
+                (pEntry->mask != 0) && (pEntry->mask != (U32)-1);
+
+            if (bPartial && (pEntry->Space != PLX_REG_BATCH_SPACE_PCI) &&
+                (pOps->RegModify != NULL))
+            {
+                // Read-modify-write must not race the ISR
+                status =
+                    pOps->RegModify(
+                        pContext,
+                        pEntry->Space,
+                        pEntry->offset,
+                        pEntry->value & pEntry->mask,
+                        ~pEntry->value & pEntry->mask
+                        );
+            }
+            else
+            {
+                // Get current value for reads & writes to only some bits
+                if ((pEntry->Op == PLX_REG_BATCH_READ) || bPartial)
+                {
+                    status =
+                        pOps->RegRead(
+                            pContext,
+                            pEntry->Space,
+                            pEntry->offset,
+                            &RegValue
+                            );
+                }
+
+                if (status != PLX_STATUS_OK)
+                {
+                    break;
+                }
+
+                if (pEntry->Op == PLX_REG_BATCH_READ)
+                {
+                    if (pEntry->mask != 0)
+                    {
+                        RegValue &= pEntry->mask;
+                    }
+
+                    pEntry->value = RegValue;
+                }
+                else if (pEntry->Op == PLX_REG_BATCH_WRITE)
+                {
+                    if (pEntry->mask != 0)
+                    {
+                        RegValue = (RegValue & ~pEntry->mask) | (pEntry->value & pEntry->mask);
+                    }
+                    else
+                    {
+                        RegValue = pEntry->value;
+                    }
+
+                    status =
+                        pOps->RegWrite(
+                            pContext,
+                            pEntry->Space,
+                            pEntry->offset,
+                            RegValue
+                            );
+                }
+            }
+
+            if (status != PLX_STATUS_OK)
+            {
+                break;
+            }
+
+            // Delay if requested, e.g. to let a reset complete
+            if (pEntry->Delay_us >= 1000)
+            {
+                msleep_interruptible( pEntry->Delay_us / 1000 );
+            }
+
+            if ((pEntry->Delay_us % 1000) != 0)
+            {
+                udelay( pEntry->Delay_us % 1000 );
+            }
+        }
+
+        // Return read values of completed entries
+        if (copy_to_user(
+                pUserEntries + *pCountDone,
+                Entries,
+                i * sizeof(PLX_REG_BATCH_ENTRY)
+                ) != 0)
+        {
+            status = PLX_STATUS_INVALID_ADDR;
+            break;
+        }
+
+        *pCountDone += i;
+    }
+
+    up( pMutex );
+
+    DebugPrintf(("Completed %d of %d batch entries\n", *pCountDone, Count));
+
+    return status;
+}
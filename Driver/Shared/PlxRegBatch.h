@@ -0,0 +1,96 @@
+#ifndef __PLX_REG_BATCH_H
+#define __PLX_REG_BATCH_H
+
+/*******************************************************************************
+ * Copyright 2013-2019 Broadcom Inc
+ * Copyright (c) 2009 to 2012 PLX Technology Inc.  All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directorY of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ * File Name:
+ *
+ *      PlxRegBatch.h
+ *
+ * Description:
+ *
+ *      Header for the register batch support shared by all drivers
+ *
+ * Revision History:
+ *
+ *      03-01-19 : PCI/PCIe SDK v8.00
+ *
+ ******************************************************************************/
+
+
+#include "DrvDefs.h"
+
+
+
+
+/**********************************************
+ *               Definitions
+ *********************************************/
+#define PLX_REG_BATCH_ENTRIES_PER_COPY      16            // Register batch entries staged per user copy
+
+
+// Driver-specific register accessors used by a batch
+typedef struct _PLX_REG_BATCH_OPS
+{
+    // Reads a register in the requested space
+    PLX_STATUS (*RegRead)(VOID *pContext, U8 Space, U32 offset, U32 *pValue);
+
+    // Writes a register in the requested space
+    PLX_STATUS (*RegWrite)(VOID *pContext, U8 Space, U32 offset, U32 value);
+
+    // Modifies bits of a PLX register synchronized with the ISR (optional)
+    PLX_STATUS (*RegModify)(VOID *pContext, U8 Space, U32 offset, U32 BitsToSet, U32 BitsToClear);
+} PLX_REG_BATCH_OPS;
+
+
+
+
+/**********************************************
+ *               Functions
+ *********************************************/
+PLX_STATUS
+PlxRegBatchExecute(
+    const PLX_REG_BATCH_OPS *pOps,
+    VOID                    *pContext,
+    struct semaphore        *pMutex,
+    PLX_REG_BATCH_ENTRY     *pUserEntries,
+    U32                      Count,
+    U32                     *pCountDone
+    );
+
+
+
+#endif
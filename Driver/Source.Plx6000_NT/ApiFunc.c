@@ -48,12 +48,14 @@
  ******************************************************************************/
 
 
+#include <linux/delay.h>    // For udelay()
 #include <linux/uaccess.h>  // For copy_to/from_user()
 #include <linux/sched.h>    // For MAX_SCHED_TIMEOUT & TASK_UNINTERRUPTIBLE
 #include "ApiFunc.h"
 #include "Eep_6000.h"
 #include "PciFunc.h"
 #include "PlxInterrupt.h"
+#include "PlxRegBatch.h"
 #include "SuppFunc.h"
 
 
@@ -339,6 +341,126 @@ PlxRegisterWrite(
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchRead
+ *
+ * Description:  Register batch accessor to read a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchRead(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32  *pValue
+    )
+{
+    PLX_STATUS        status;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterRead_UseOS( pdx->pPciDevice, (U16)offset, pValue );
+    }
+
+    *pValue =
+        PlxRegisterRead(
+            pdx,
+            offset,
+            &status,
+            (Space == PLX_REG_BATCH_SPACE_PLX)
+            );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchWrite
+ *
+ * Description:  Register batch accessor to write a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchWrite(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   value
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterWrite_UseOS( pdx->pPciDevice, (U16)offset, value );
+    }
+
+    return PlxRegisterWrite(
+        pdx,
+        offset,
+        value,
+        (Space == PLX_REG_BATCH_SPACE_PLX)
+        );
+}
+
+
+
+
+// Register accessors for batch operations
+static const PLX_REG_BATCH_OPS PlxRegBatchOps =
+{
+    .RegRead   = PlxRegBatchRead,
+    .RegWrite  = PlxRegBatchWrite,
+    .RegModify = NULL,              // No PLX-specific registers
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegisterBatch
+ *
+ * Description:  Executes a sequence of register accesses from a user array,
+ *               returning read values in the array
+ *
+ * Note       :  Processing stops at the first failed entry. Batches are
+ *               serialized so that a sequence is not interleaved with
+ *               another batch.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    )
+{
+    return PlxRegBatchExecute(
+        &PlxRegBatchOps,
+        pdx,
+        &(pdx->Mutex_RegBatch),
+        pUserEntries,
+        Count,
+        pCountDone
+        );
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  PlxPciBarProperties
@@ -107,6 +107,14 @@ PlxRegisterWrite(
     BOOLEAN           bAdjustForPort
     );
 
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    );
+
 PLX_STATUS
 PlxPciBarProperties(
     DEVICE_EXTENSION *pdx,
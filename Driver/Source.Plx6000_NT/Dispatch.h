@@ -54,6 +54,10 @@
 #include <linux/fs.h>
 #include "Plx_sysdep.h"
 
+#if defined(PLX_IO_URING)
+    #include <linux/io_uring/cmd.h>
+#endif
+
 
 
 
@@ -85,6 +89,14 @@ Dispatch_IoControl(
     unsigned long  args
     );
 
+#if defined(PLX_IO_URING)
+int
+Dispatch_uring_cmd(
+    struct io_uring_cmd *ioucmd,
+    unsigned int         issue_flags
+    );
+#endif
+
 
 
 
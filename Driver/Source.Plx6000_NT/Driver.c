@@ -97,6 +97,11 @@ static struct pci_device_id PlxPciIdTable[] =
 };
 MODULE_DEVICE_TABLE(pci, PlxPciIdTable);
 
+// CPU to service device interrupts & run the IRQ thread (-1 = any CPU)
+static int PlxIrqCpu = -1;
+module_param(PlxIrqCpu, int, S_IRUGO);
+MODULE_PARM_DESC(PlxIrqCpu, "CPU to service device interrupts (-1 = any)");
+
 // Driver registration functions
 static struct pci_driver PlxPciDriver =
 {
@@ -170,6 +175,11 @@ Plx_init_module(
     pGbl_DriverObject->DispatchTable.unlocked_ioctl = Dispatch_IoControl;
     pGbl_DriverObject->DispatchTable.compat_ioctl   = Dispatch_IoControl;
 
+#if defined(PLX_IO_URING)
+    // Accept messages submitted through io_uring
+    pGbl_DriverObject->DispatchTable.uring_cmd = Dispatch_uring_cmd;
+#endif
+
     // Initialize spin locks
     spin_lock_init(
         &(pGbl_DriverObject->Lock_DeviceList)
@@ -573,6 +583,9 @@ AddDevice(
     INIT_LIST_HEAD( &(pdx->List_WaitObjects) );
     spin_lock_init( &(pdx->Lock_WaitObjectsList) );
 
+    // Initialize register batch mutex
+    Plx_sema_init( &(pdx->Mutex_RegBatch), 1 );
+
     // Initialize physical memories list
     INIT_LIST_HEAD( &(pdx->List_PhysicalMem) );
     spin_lock_init( &(pdx->Lock_PhysicalMemList) );
@@ -925,6 +938,17 @@ StartDevice(
         }
 
         // Install the ISR
+#if defined(PLX_THREADED_IRQ)
+        rc =
+            request_threaded_irq(
+                pdx->pPciDevice->irq,    // The device IRQ
+                OnInterrupt,             // Interrupt handler
+                OnInterruptThread,       // IRQ thread to run the DPC
+                IRQF_SHARED,             // Flags, support interrupt sharing
+                PLX_DRIVER_NAME,         // The driver name
+                pdx                      // Parameter to the ISR
+                );
+#else
         rc =
             request_irq(
                 pdx->pPciDevice->irq,    // The device IRQ
@@ -933,6 +957,7 @@ StartDevice(
                 PLX_DRIVER_NAME,         // The driver name
                 pdx                      // Parameter to the ISR
                 );
+#endif
 
         if (rc != 0)
         {
@@ -947,6 +972,24 @@ StartDevice(
         {
             DebugPrintf(("Installed ISR for interrupt\n"));
 
+            // Pin interrupt & its IRQ thread to a CPU if requested
+            if (PlxIrqCpu >= 0)
+            {
+                if (((unsigned int)PlxIrqCpu < nr_cpu_ids) && cpu_online(PlxIrqCpu))
+                {
+                    DebugPrintf(("Set interrupt affinity to CPU %d\n", PlxIrqCpu));
+
+                    Plx_irq_set_affinity_hint(
+                        pdx->pPciDevice->irq,
+                        cpumask_of(PlxIrqCpu)
+                        );
+                }
+                else
+                {
+                    ErrorPrintf(("WARNING - CPU %d not available for interrupt affinity\n", PlxIrqCpu));
+                }
+            }
+
             // Enable interrupts on success
             PlxChipInterruptsEnable( pdx );
         }
@@ -1029,6 +1072,9 @@ StopDevice(
             "Remove ISR (IRQ = %02d [%02Xh])\n",
             pdx->pPciDevice->irq, pdx->pPciDevice->irq
             ));
+        // Affinity hint must be removed before the IRQ is released
+        Plx_irq_set_affinity_hint( pdx->pPciDevice->irq, NULL );
+
         free_irq( pdx->pPciDevice->irq, pdx );
 
         if (pdx->IrqType == PLX_IRQ_TYPE_MSI)
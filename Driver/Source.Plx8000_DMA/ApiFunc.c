@@ -48,6 +48,7 @@
  ******************************************************************************/
 
 
+#include <linux/delay.h>    // For udelay()
 #include <linux/uaccess.h>  // For copy_to/from_user()
 #include <linux/sched.h>    // For MAX_SCHED_TIMEOUT & TASK_UNINTERRUPTIBLE
 #include "ApiFunc.h"
@@ -55,6 +56,8 @@
 #include "PciRegs.h"
 #include "PlxChipFn.h"
 #include "PlxInterrupt.h"
+#include "PlxRegBatch.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -463,6 +466,169 @@ PlxRegisterWrite(
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchRead
+ *
+ * Description:  Register batch accessor to read a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchRead(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32  *pValue
+    )
+{
+    PLX_STATUS        status;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterRead_UseOS( pdx->pPciDevice, (U16)offset, pValue );
+    }
+
+    *pValue =
+        PlxRegisterRead(
+            pdx,
+            offset,
+            &status,
+            (Space == PLX_REG_BATCH_SPACE_PLX)
+            );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchWrite
+ *
+ * Description:  Register batch accessor to write a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchWrite(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   value
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterWrite_UseOS( pdx->pPciDevice, (U16)offset, value );
+    }
+
+    return PlxRegisterWrite(
+        pdx,
+        offset,
+        value,
+        (Space == PLX_REG_BATCH_SPACE_PLX)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchModify
+ *
+ * Description:  Register batch accessor to modify bits of a PLX register
+ *               synchronized with the ISR
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchModify(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   BitsToSet,
+    U32   BitsToClear
+    )
+{
+    PLX_REG_DATA      RegData;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    // Verify offset
+    if ((offset & 0x3) || (offset >= pdx->PciBar[0].Properties.Size))
+    {
+        DebugPrintf(("ERROR - Invalid register offset (%X)\n", offset));
+        return PLX_STATUS_INVALID_OFFSET;
+    }
+
+    RegData.pdx         = pdx;
+    RegData.offset      = offset;
+    RegData.BitsToSet   = BitsToSet;
+    RegData.BitsToClear = BitsToClear;
+
+    PlxSynchronizedRegisterModify( &RegData );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+// Register accessors for batch operations
+static const PLX_REG_BATCH_OPS PlxRegBatchOps =
+{
+    .RegRead   = PlxRegBatchRead,
+    .RegWrite  = PlxRegBatchWrite,
+    .RegModify = PlxRegBatchModify,
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegisterBatch
+ *
+ * Description:  Executes a sequence of register accesses from a user array,
+ *               returning read values in the array
+ *
+ * Note       :  Processing stops at the first failed entry. Batches are
+ *               serialized so that a sequence is not interleaved with
+ *               another batch.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    )
+{
+    return PlxRegBatchExecute(
+        &PlxRegBatchOps,
+        pdx,
+        &(pdx->Mutex_RegBatch),
+        pUserEntries,
+        Count,
+        pCountDone
+        );
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  PlxPciBarProperties
@@ -2491,6 +2657,9 @@ PlxDmaTransferBlock(
         &(pdx->Lock_Dma[channel])
         );
 
+    // Store transfer size for completion reporting
+    pdx->DmaInfo[channel].BlockByteCount = pParams->ByteCount;
+
     // Write Source Address
     PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x0, PLX_64_LOW_32(pParams->AddrSource) );
     PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x4, PLX_64_HIGH_32(pParams->AddrSource) );
@@ -2536,6 +2705,20 @@ PlxDmaTransferBlock(
 
     DebugPrintf(("Start DMA transfer...\n"));
 
+    trace_plx_dma_start(
+        pdx,
+        channel,
+        pParams->ByteCount,
+        0,
+        pParams->Direction
+        );
+
+    PlxDmaStatsStart(
+        pdx,
+        channel,
+        pParams->ByteCount
+        );
+
     // Start DMA ([3])
     PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x38, RegValue | (1 << 3) );
 
@@ -2560,8 +2743,6 @@ PlxDmaTransferUserBuffer(
     VOID             *pOwner
     )
 {
-    U16        OffsetDmaBase;
-    U32        RegValue;
     U32        NumDescriptors;
     U64        SglPciAddress;
     PLX_STATUS status;
@@ -2617,89 +2798,36 @@ PlxDmaTransferUserBuffer(
         return status;
     }
 
-    // Make sure DMA descriptors are set to external ([2] = 0)
-    if (pdx->Key.PlxFamily == PLX_FAMILY_SIRIUS)
-    {
-        RegValue = PLX_DMA_REG_READ( pdx, 0x1FC );
-        PLX_DMA_REG_WRITE( pdx, 0x1FC, RegValue & ~(1 << 2) );
-    }
-
-    // Set the channel's base register offset (200h, 300h, etc)
-    OffsetDmaBase = 0x200 + (channel * 0x100);
+    trace_plx_dma_start(
+        pdx,
+        channel,
+        pParams->ByteCount,
+        NumDescriptors,
+        pParams->Direction
+        );
 
-    // Verify DMA prefetch doesn't exceed descriptor count & is a multiple of 4
-    if (NumDescriptors < 4)
-    {
-        RegValue = 1;
-    }
-    else if (NumDescriptors >= 256)
-    {
-        RegValue = 0;
-    }
-    else
-    {
-        RegValue = (NumDescriptors & (U8)~0x3);
-    }
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x34, RegValue );
+    PlxDmaStatsStart(
+        pdx,
+        channel,
+        pParams->ByteCount
+        );
 
     spin_lock(
         &(pdx->Lock_Dma[channel])
         );
 
-    // Clear all DMA registers
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x00, 0 );
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x04, 0 );
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x08, 0 );
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x0C, 0 );
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x10, 0 );
-
-    // Descriptor ring address
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x14, PLX_64_LOW_32(SglPciAddress) );
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x18, PLX_64_HIGH_32(SglPciAddress) );
-
-    // Current descriptor address
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x1C, PLX_64_LOW_32(SglPciAddress) );
-
-    // Descriptor ring size
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x20, NumDescriptors );
-
-    // Current descriptor transfer size
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x28, 0 );
-
-    // Disable invalid descriptor interrupt (x3C[1])
-    RegValue = PLX_DMA_REG_READ( pdx, OffsetDmaBase + 0x3C );
-    RegValue &= ~(1 << 1);
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x3C, RegValue );
-
-    // Get DMA control/status
-    RegValue = PLX_DMA_REG_READ( pdx, OffsetDmaBase + 0x38 );
-
-    // Make sure descriptor write-back ([2]) is disabled
-    RegValue &= ~(1 << 2);
-
-    // Clear any active status bits ([31,12:8])
-    RegValue |= ((1 << 31) | (0x1F << 8));
-
-    // Enable SGL off-chip mode & descriptor fetch stops at end
-    if (pdx->Key.PlxFamily == PLX_FAMILY_SIRIUS)
-    {
-        RegValue |= (1 << 5) | (1 << 4);        // SGL mode (4) & descriptor halt mode (5)
-    }
-    else
-    {
-        RegValue &= ~(3 << 5);
-        RegValue |= (2 << 5) | (1 << 4);        // SGL mode ([6:5]) & descriptor halt mode (4)
-    }
+    // Program the channel with the SGL & start DMA
+    PlxDmaSglStart(
+        pdx,
+        channel,
+        SglPciAddress,
+        NumDescriptors
+        );
 
     spin_unlock(
         &(pdx->Lock_Dma[channel])
         );
 
-    DebugPrintf(("Start DMA transfer...\n"));
-
-    // Start DMA (x38[3])
-    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x38, RegValue | (1 << 3) );
-
     return PLX_STATUS_OK;
 }
 
@@ -2751,6 +2879,12 @@ PlxDmaChannelClose(
 
         DebugPrintf(("DMA in progress, aborting...\n"));
 
+        // Prevent queued transfers from starting once DMA is aborted
+        PlxDmaQueueFlush(
+            pdx,
+            channel
+            );
+
         // Force DMA abort, which may generate a DMA done interrupt
         PlxDmaControl(
             pdx,
@@ -2786,15 +2920,548 @@ PlxDmaChannelClose(
             );
     }
 
+    // Unlock any queued transfers & release their SGL memory
+    PlxDmaQueueReleaseAll(
+        pdx,
+        channel
+        );
+
     // Release memory previously used for SGL descriptors
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa != NULL)
+    if (pdx->DmaInfo[channel].Sgl.SglBuffer.pKernelVa != NULL)
     {
         DebugPrintf(("Releasing memory used for SGL descriptors...\n"));
 
         Plx_dma_buffer_free(
             pdx,
-            &pdx->DmaInfo[channel].SglBuffer
+            &pdx->DmaInfo[channel].Sgl.SglBuffer
+            );
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxDmaTransferQueue
+ *
+ * Description:  Submits a user buffer SGL transfer to the channel queue. The
+ *               transfer starts immediately if the channel is idle, otherwise
+ *               it is started by the DPC once prior transfers complete.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferQueue(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    VOID             *pOwner
+    )
+{
+    U8                   i;
+    U64                  Start_ns;
+    PLX_STATUS           status;
+    PLX_DMA_QUEUE_ENTRY *pEntry;
+
+
+    // Verify DMA channel
+    if (channel >= pdx->NumDmaChannels)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if ((pParams->UserVa == 0) || (pParams->ByteCount == 0))
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    pEntry = NULL;
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        DebugPrintf(("ERROR - DMA channel not opened by caller\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Find a free entry
+    for (i = 0; i < DMA_MAX_QUEUE_ENTRIES; i++)
+    {
+        if (pdx->DmaInfo[channel].Queue[i].bInUse == FALSE)
+        {
+            pEntry         = &pdx->DmaInfo[channel].Queue[i];
+            pEntry->bInUse = TRUE;
+            break;
+        }
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (pEntry == NULL)
+    {
+        DebugPrintf(("ERROR - DMA queue full (%d entries)\n", DMA_MAX_QUEUE_ENTRIES));
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    Start_ns = ktime_to_ns( ktime_get() );
+
+    // Page-lock user buffer & build SGL
+    status =
+        PlxSglBuild(
+            pdx,
+            pParams,
+            &pEntry->Sgl,
+            &pEntry->SglAddress
+            );
+
+    PlxDmaStatsSetup(
+        pdx,
+        channel,
+        Start_ns,
+        &pEntry->Sgl,
+        status
+        );
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (status != PLX_STATUS_OK)
+    {
+        DebugPrintf(("ERROR - Unable to lock buffer and build SGL list\n"));
+        pEntry->bInUse = FALSE;
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return status;
+    }
+
+    if (pdx->DmaInfo[channel].bSglPending == FALSE)
+    {
+        // A block transfer may still be using the channel
+        if (PlxDmaStatus(
+                pdx,
+                channel,
+                pOwner
+                ) != PLX_STATUS_COMPLETE)
+        {
+            DebugPrintf(("ERROR - DMA unavailable or in-progress\n"));
+            spin_unlock( &(pdx->Lock_Dma[channel]) );
+
+            PlxSglRelease(
+                pdx,
+                &pEntry->Sgl
+                );
+
+            pEntry->bInUse = FALSE;
+            return PLX_STATUS_IN_PROGRESS;
+        }
+
+        // Channel is idle, so start the transfer now
+        pdx->DmaInfo[channel].bSglPending    = TRUE;
+        pdx->DmaInfo[channel].pQueueActive   = pEntry;
+        pdx->DmaInfo[channel].NumDescriptors = pEntry->Sgl.NumDescriptors;
+
+        PlxDmaStatsStart(
+            pdx,
+            channel,
+            pEntry->Sgl.BufferSize
+            );
+
+        PlxDmaSglStart(
+            pdx,
+            channel,
+            pEntry->SglAddress,
+            pEntry->Sgl.NumDescriptors
+            );
+    }
+    else
+    {
+        DebugPrintf((
+            "Queue DMA transfer behind %d pending\n",
+            pdx->DmaInfo[channel].QueueCount + 1
+            ));
+
+        // Add to end of FIFO for DPC to start
+        pdx->DmaInfo[channel].pQueueFifo[
+            (pdx->DmaInfo[channel].QueueHead + pdx->DmaInfo[channel].QueueCount) %
+            DMA_MAX_QUEUE_ENTRIES] = pEntry;
+
+        pdx->DmaInfo[channel].QueueCount++;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxDmaQueueStatus
+ *
+ * Description:  Returns the number of outstanding & completed queued transfers
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaQueueStatus(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32              *pNumPending,
+    U32              *pNumCompleted,
+    VOID             *pOwner
+    )
+{
+    // Verify DMA channel
+    if (channel >= pdx->NumDmaChannels)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Include the queued transfer in progress
+    *pNumPending = pdx->DmaInfo[channel].QueueCount;
+
+    if (pdx->DmaInfo[channel].pQueueActive != NULL)
+    {
+        (*pNumPending)++;
+    }
+
+    *pNumCompleted = pdx->DmaInfo[channel].QueueCompleted;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxDmaTransferWait
+ *
+ * Description:  Starts a block or user buffer DMA transfer & waits for it to
+ *               complete, avoiding a separate notification object & wait
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    BOOLEAN           bUserBuffer,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    )
+{
+    U32        DoneCount;
+    PLX_STATUS status;
+
+
+    // Verify DMA channel
+    if (channel >= pdx->NumDmaChannels)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Note completion count before start so an early completion is not missed
+    DoneCount = pdx->DmaInfo[channel].DoneCount;
+
+    if (bUserBuffer)
+    {
+        status =
+            PlxDmaTransferUserBuffer(
+                pdx,
+                channel,
+                pParams,
+                pOwner
+                );
+    }
+    else
+    {
+        // DMA done interrupt is required to wake the caller
+        pParams->bIgnoreBlockInt = FALSE;
+
+        status =
+            PlxDmaTransferBlock(
+                pdx,
+                channel,
+                pParams,
+                pOwner
+                );
+    }
+
+    if (status != PLX_STATUS_OK)
+    {
+        return status;
+    }
+
+    return PlxDmaCompletionWait(
+        pdx,
+        channel,
+        DoneCount,
+        Timeout_ms
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingCreate
+ *
+ * Description:  Allocate a DMA completion ring for the caller, which is filled
+ *               by the driver as DMA transfers on its channels complete
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaCompletionRingCreate(
+    DEVICE_EXTENSION *pdx,
+    U64              *pCpuPhysical,
+    VOID             *pOwner
+    )
+{
+    struct list_head        *pEntry;
+    PLX_PHYS_MEM_OBJECT     *pMemObject;
+    PLX_DMA_COMPLETION_RING *pRing;
+
+
+    // Default to no ring
+    *pCpuPhysical = 0;
+
+    // Allocate memory for new list object
+    pMemObject =
+        kmalloc(
+            sizeof(PLX_PHYS_MEM_OBJECT),
+            GFP_KERNEL
             );
+
+    if (pMemObject == NULL)
+    {
+        DebugPrintf(("ERROR - Memory allocation for list object failed\n"));
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    // Initialize object
+    RtlZeroMemory( pMemObject, sizeof(PLX_PHYS_MEM_OBJECT) );
+
+    // Ring is mapped to user space, so allocate whole pages
+    pMemObject->Size = PAGE_ALIGN( sizeof(PLX_DMA_COMPLETION_RING) );
+
+    if (Plx_dma_buffer_alloc(
+            pdx,
+            pMemObject
+            ) == NULL)
+    {
+        DebugPrintf(("ERROR - Unable to allocate DMA completion ring\n"));
+        kfree( pMemObject );
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    pRing = (PLX_DMA_COMPLETION_RING*)pMemObject->pKernelVa;
+
+    pRing->NumEntries = PLX_DMA_COMPLETION_RING_SIZE;
+
+    // Record the owner
+    pMemObject->pOwner = pOwner;
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Only a single ring is supported per owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        if (list_entry(pEntry, PLX_PHYS_MEM_OBJECT, ListEntry)->pOwner == pOwner)
+        {
+            spin_unlock( &(pdx->Lock_CompletionRingList) );
+
+            DebugPrintf(("ERROR - DMA completion ring already exists\n"));
+
+            Plx_dma_buffer_free(
+                pdx,
+                pMemObject
+                );
+
+            kfree( pMemObject );
+            return PLX_STATUS_IN_USE;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    // Add ring to list
+    list_add_tail(
+        &(pMemObject->ListEntry),
+        &(pdx->List_CompletionRings)
+        );
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    // Return ring address for mapping to user space
+    *pCpuPhysical = pMemObject->CpuPhysical;
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingDestroy
+ *
+ * Description:  Release the DMA completion ring of the caller
+ *
+ * Note       :  The ring must be unmapped from user space beforehand
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaCompletionRingDestroy(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    )
+{
+    struct list_head    *pEntry;
+    PLX_PHYS_MEM_OBJECT *pMemObject;
+
+
+    pMemObject = NULL;
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Find the ring of the owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        if (list_entry(pEntry, PLX_PHYS_MEM_OBJECT, ListEntry)->pOwner == pOwner)
+        {
+            pMemObject =
+                list_entry(
+                    pEntry,
+                    PLX_PHYS_MEM_OBJECT,
+                    ListEntry
+                    );
+
+            // Remove ring from list so the DPC no longer fills it
+            list_del(
+                pEntry
+                );
+            break;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    if (pMemObject == NULL)
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    DebugPrintf(("Release DMA completion ring\n"));
+
+    Plx_dma_buffer_free(
+        pdx,
+        pMemObject
+        );
+
+    kfree( pMemObject );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaGetStatistics
+ *
+ * Description:  Copy the counters & latency histograms of a DMA channel to a
+ *               user buffer, optionally clearing them
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaGetStatistics(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    VOID             *pUserStats,
+    BOOLEAN           bReset
+    )
+{
+    PLX_DMA_STATS Stats;
+
+
+    // Verify DMA channel
+    if (channel >= pdx->NumDmaChannels)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    PlxDmaStatsGet(
+        pdx,
+        channel,
+        &Stats,
+        bReset
+        );
+
+    // Caller may only request a reset
+    if (pUserStats == NULL)
+    {
+        return PLX_STATUS_OK;
+    }
+
+    if (copy_to_user(
+            pUserStats,
+            &Stats,
+            sizeof(PLX_DMA_STATS)
+            ) != 0)
+    {
+        return PLX_STATUS_INVALID_ADDR;
     }
 
     return PLX_STATUS_OK;
@@ -107,6 +107,14 @@ PlxRegisterWrite(
     BOOLEAN           bAdjustForPort
     );
 
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    );
+
 PLX_STATUS
 PlxPciBarProperties(
     DEVICE_EXTENSION *pdx,
@@ -334,6 +342,54 @@ PlxDmaChannelClose(
     VOID             *pOwner
     );
 
+PLX_STATUS
+PlxDmaTransferQueue(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaQueueStatus(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32              *pNumPending,
+    U32              *pNumCompleted,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaTransferWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    BOOLEAN           bUserBuffer,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaCompletionRingCreate(
+    DEVICE_EXTENSION *pdx,
+    U64              *pCpuPhysical,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaCompletionRingDestroy(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaGetStatistics(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    VOID             *pUserStats,
+    BOOLEAN           bReset
+    );
+
 
 
 #endif
@@ -605,6 +605,18 @@ Dispatch_IoControl(
                 ));
             break;
 
+        case PLX_IOCTL_REGISTER_BATCH:
+            DebugPrintf_Cont(("PLX_IOCTL_REGISTER_BATCH\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxRegisterBatch(
+                    pdx,
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (U32)pIoBuffer->value[0],
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[1]) )
+                    );
+            break;
+
 
         /******************************************
          * PCI Mapping Functions
@@ -997,6 +1009,13 @@ Dispatch_IoControl(
                     (U8)pIoBuffer->value[0],
                     NULL              // Ignore channel ownership
                     );
+
+            // Return number of descriptors in last SGL built for the channel
+            if (pIoBuffer->value[0] < MAX_DMA_CHANNELS)
+            {
+                pIoBuffer->value[1] =
+                    pdx->DmaInfo[pIoBuffer->value[0]].NumDescriptors;
+            }
             break;
 
         case PLX_IOCTL_DMA_TRANSFER_BLOCK:
@@ -1035,6 +1054,78 @@ Dispatch_IoControl(
                     );
             break;
 
+        case PLX_IOCTL_DMA_TRANSFER_QUEUE:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_QUEUE\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaTransferQueue(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    &(pIoBuffer->u.TxParams),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_QUEUE_STATUS:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_QUEUE_STATUS\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaQueueStatus(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[1]) ),
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[2]) ),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_TRANSFER_WAIT:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_WAIT\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaTransferWait(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    &(pIoBuffer->u.TxParams),
+                    (BOOLEAN)pIoBuffer->value[2],
+                    (PLX_UINT_PTR)pIoBuffer->value[1],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_COMPLETION_RING_CREATE:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_COMPLETION_RING_CREATE\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaCompletionRingCreate(
+                    pdx,
+                    &(pIoBuffer->value[0]),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_COMPLETION_RING_DESTROY:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_COMPLETION_RING_DESTROY\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaCompletionRingDestroy(
+                    pdx,
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_GET_STATISTICS:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_GET_STATISTICS\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaGetStatistics(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (BOOLEAN)pIoBuffer->value[1]
+                    );
+            break;
+
 
         /******************************************
          * Unsupported Messages
@@ -1060,3 +1151,57 @@ Dispatch_IoControl(
 
     return status;
 }
+
+
+
+
+#if defined(PLX_IO_URING)
+/*******************************************************************************
+ *
+ * Function   :  Dispatch_uring_cmd
+ *
+ * Description:  Handle a PLX message submitted through io_uring
+ *
+ * Note       :  The SQE command opcode is the IOCTL code & the command area
+ *               holds the user address of the PLX_PARAMS message.  Messages
+ *               that may sleep are refused in non-blocking context, so
+ *               io_uring re-issues them from a worker thread & a batch of
+ *               waits completes independently of the submitter.
+ *
+ ******************************************************************************/
+int
+Dispatch_uring_cmd(
+    struct io_uring_cmd *ioucmd,
+    unsigned int         issue_flags
+    )
+{
+    const PLX_URING_CMD *pCmd;
+
+
+    pCmd = io_uring_sqe_cmd( ioucmd->sqe );
+
+    // Only register accesses are processed in the submitter's context
+    if (issue_flags & IO_URING_F_NONBLOCK)
+    {
+        switch (ioucmd->cmd_op)
+        {
+            case PLX_IOCTL_PCI_REGISTER_READ:
+            case PLX_IOCTL_PCI_REGISTER_WRITE:
+            case PLX_IOCTL_REGISTER_READ:
+            case PLX_IOCTL_REGISTER_WRITE:
+            case PLX_IOCTL_MAPPED_REGISTER_READ:
+            case PLX_IOCTL_MAPPED_REGISTER_WRITE:
+                break;
+
+            default:
+                return (-EAGAIN);
+        }
+    }
+
+    return Dispatch_IoControl(
+        ioucmd->file,
+        ioucmd->cmd_op,
+        (unsigned long)READ_ONCE(pCmd->pIoBuffer)
+        );
+}
+#endif
@@ -48,6 +48,7 @@
  *****************************************************************************/
 
 
+#include <linux/debugfs.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/sched.h>
@@ -76,6 +77,10 @@
 #include "Plx_sysdep.h"
 #include "SuppFunc.h"
 
+// Instantiate the driver trace events in this file only
+#define CREATE_TRACE_POINTS
+#include "PlxTrace.h"
+
 
 
 
@@ -94,6 +99,21 @@ static struct pci_device_id PlxPciIdTable[] =
 };
 MODULE_DEVICE_TABLE(pci, PlxPciIdTable);
 
+// CPU to service device interrupts & run the IRQ thread (-1 = any CPU)
+static int PlxIrqCpu = -1;
+module_param(PlxIrqCpu, int, S_IRUGO);
+MODULE_PARM_DESC(PlxIrqCpu, "CPU to service device interrupts (-1 = any)");
+
+// Use a standard & error MSI vector per DMA channel where the chip supports it
+static int PlxMsiPerChannel = 1;
+module_param(PlxMsiPerChannel, int, S_IRUGO);
+MODULE_PARM_DESC(PlxMsiPerChannel, "Use per-channel MSI vectors on 8600 DMA (0 = single vector)");
+
+// CPU to service each DMA channel's MSI vectors (-1 = use PlxIrqCpu)
+static int PlxDmaIrqCpu[MAX_DMA_CHANNELS] = { [0 ... (MAX_DMA_CHANNELS - 1)] = -1 };
+module_param_array(PlxDmaIrqCpu, int, NULL, S_IRUGO);
+MODULE_PARM_DESC(PlxDmaIrqCpu, "CPU per DMA channel for per-channel MSI vectors (-1 = PlxIrqCpu)");
+
 // Driver registration functions
 static struct pci_driver PlxPciDriver =
 {
@@ -107,6 +127,41 @@ static struct pci_driver PlxPciDriver =
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxIrqAffinitySet
+ *
+ * Description:  Pins an interrupt & its IRQ thread to a CPU, if requested
+ *
+ ******************************************************************************/
+static VOID
+PlxIrqAffinitySet(
+    unsigned int irq,
+    int          cpu
+    )
+{
+    // Negative CPU leaves affinity to the system
+    if (cpu < 0)
+        return;
+
+    if (((unsigned int)cpu < nr_cpu_ids) && cpu_online(cpu))
+    {
+        DebugPrintf(("Set IRQ %02d affinity to CPU %d\n", irq, cpu));
+
+        Plx_irq_set_affinity_hint(
+            irq,
+            cpumask_of(cpu)
+            );
+    }
+    else
+    {
+        ErrorPrintf(("WARNING - CPU %d not available for interrupt affinity\n", cpu));
+    }
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  Plx_init_module
@@ -167,11 +222,25 @@ Plx_init_module(
     pGbl_DriverObject->DispatchTable.unlocked_ioctl = Dispatch_IoControl;
     pGbl_DriverObject->DispatchTable.compat_ioctl   = Dispatch_IoControl;
 
+#if defined(PLX_IO_URING)
+    // Accept messages submitted through io_uring
+    pGbl_DriverObject->DispatchTable.uring_cmd = Dispatch_uring_cmd;
+#endif
+
     // Initialize spin locks
     spin_lock_init(
         &(pGbl_DriverObject->Lock_DeviceList)
         );
 
+#if defined(PLX_DEBUGFS)
+    // Create debugfs directory for device statistics
+    pGbl_DriverObject->pDebugFsRoot =
+        debugfs_create_dir(
+            PLX_DRIVER_NAME,
+            NULL
+            );
+#endif
+
     /*********************************************************
      * Register the driver with the OS
      *
@@ -299,6 +368,11 @@ Plx_cleanup_module(
         PLX_DRIVER_NAME
         );
 
+#if defined(PLX_DEBUGFS)
+    // Remove debugfs directory
+    debugfs_remove_recursive( pGbl_DriverObject->pDebugFsRoot );
+#endif
+
     DebugPrintf((
         "Release global driver object (%p)\n",
         pGbl_DriverObject
@@ -567,6 +641,9 @@ AddDevice(
     INIT_LIST_HEAD( &(pdx->List_WaitObjects) );
     spin_lock_init( &(pdx->Lock_WaitObjectsList) );
 
+    // Initialize register batch mutex
+    Plx_sema_init( &(pdx->Mutex_RegBatch), 1 );
+
     // Initialize physical memories list
     INIT_LIST_HEAD( &(pdx->List_PhysicalMem) );
     spin_lock_init( &(pdx->Lock_PhysicalMemList) );
@@ -588,10 +665,27 @@ AddDevice(
         ErrorPrintf(("WARNING - Set DMA coherent mask failed\n"));
     }
 
-    // Initialize DMA spinlocks
+    // Initialize DMA completion rings list
+    INIT_LIST_HEAD( &(pdx->List_CompletionRings) );
+    spin_lock_init( &(pdx->Lock_CompletionRingList) );
+
+    // Initialize DMA statistics spinlock
+    spin_lock_init( &(pdx->Lock_DmaStats) );
+
+#if defined(PLX_DEBUGFS)
+    // Export DMA statistics in debugfs
+    PlxDmaStatsDebugFsCreate(
+        pdx,
+        pDriverObject->pDebugFsRoot
+        );
+#endif
+
+    // Initialize DMA spinlocks & completion wait queues
     for (channel = 0; channel < MAX_DMA_CHANNELS; channel++)
     {
         spin_lock_init( &(pdx->Lock_Dma[channel]) );
+        spin_lock_init( &(pdx->DmaInfo[channel].Lock_Isr) );
+        init_waitqueue_head( &(pdx->DmaInfo[channel].WaitDone) );
     }
 
     //
@@ -714,6 +808,11 @@ RemoveDevice(
     // Release Device List lock
     spin_unlock( &(fdo->DriverObject->Lock_DeviceList) );
 
+#if defined(PLX_DEBUGFS)
+    // Remove DMA statistics from debugfs
+    PlxDmaStatsDebugFsRemove( pdx );
+#endif
+
     // Disable the device
     DebugPrintf(("Disable device\n"));
     pci_disable_device( pdx->pPciDevice );
@@ -928,9 +1027,10 @@ StartDevice(
         /**************************************************************
          * DMA MSI vector mapping
          *
-         * Although the PLX driver does not currently use the
-         * multiple MSI vector feature, the following is provided
-         * to document chip behavior if multi-MSI vectors are used.
+         * On 8600-series DMA, the driver requests 8 vectors so each
+         * channel is serviced by its own vectors, ISR lock & IRQ
+         * thread.  Otherwise, or if 8 vectors are not granted, a
+         * single vector or INTx is used for all interrupts.
          *
          * The DMA endpoint's multiple MSI capable field in the chip's
          * MSI capability can be set to request 1, 2, 4, or 8 vectors.
@@ -997,6 +1097,15 @@ StartDevice(
          *
          *************************************************************/
 
+        // Attempt per-channel MSI vectors first
+        rc = PlxIrqVectorsInstall( pdx );
+        if (rc == 0)
+        {
+            // Enable interrupts on success
+            PlxChipInterruptsEnable( pdx );
+            goto _Exit_StartDevice;
+        }
+
         // Attempt to enable MSI interrupt
         rc = Plx_pci_enable_msi( pdx->pPciDevice );
         if (rc == 0)
@@ -1035,6 +1144,17 @@ StartDevice(
         }
 
         // Install the ISR
+#if defined(PLX_THREADED_IRQ)
+        rc =
+            request_threaded_irq(
+                pdx->pPciDevice->irq,    // The device IRQ
+                OnInterrupt,             // Interrupt handler
+                OnInterruptThread,       // IRQ thread to run the DPC
+                IRQF_SHARED,             // Flags, support interrupt sharing
+                PLX_DRIVER_NAME,         // The driver name
+                pdx                      // Parameter to the ISR
+                );
+#else
         rc =
             request_irq(
                 pdx->pPciDevice->irq,    // The device IRQ
@@ -1043,6 +1163,7 @@ StartDevice(
                 PLX_DRIVER_NAME,         // The driver name
                 pdx                      // Parameter to the ISR
                 );
+#endif
 
         if (rc != 0)
         {
@@ -1057,11 +1178,19 @@ StartDevice(
         {
             DebugPrintf(("Installed ISR for interrupt\n"));
 
+            // Pin interrupt & its IRQ thread to a CPU if requested
+            PlxIrqAffinitySet(
+                pdx->pPciDevice->irq,
+                PlxIrqCpu
+                );
+
             // Enable interrupts on success
             PlxChipInterruptsEnable( pdx );
         }
     }
 
+_Exit_StartDevice:
+
     // Update device state
     pdx->State = PLX_STATE_STARTED;
 
@@ -1132,6 +1261,12 @@ StopDevice(
         schedule_timeout( Plx_ms_to_jiffies( 100 ) );
     }
 
+    // Release per-channel MSI vectors, if used
+    if (pdx->NumIrqVectors != 0)
+    {
+        PlxIrqVectorsRemove( pdx );
+    }
+
     // Release interrupt resources
     if (pdx->IrqType != PLX_IRQ_TYPE_NONE)
     {
@@ -1139,6 +1274,9 @@ StopDevice(
             "Remove ISR (IRQ = %02d [%02Xh])\n",
             pdx->pPciDevice->irq, pdx->pPciDevice->irq
             ));
+        // Affinity hint must be removed before the IRQ is released
+        Plx_irq_set_affinity_hint( pdx->pPciDevice->irq, NULL );
+
         free_irq( pdx->pPciDevice->irq, pdx );
 
         if (pdx->IrqType == PLX_IRQ_TYPE_MSI)
@@ -1161,3 +1299,162 @@ StopDevice(
     // Update device state
     pdx->State = PLX_STATE_STOPPED;
 }
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxIrqVectorsInstall
+ *
+ * Description:  Allocates a standard & error MSI vector for each DMA channel
+ *               and installs a per-channel ISR & IRQ thread on each
+ *
+ * Note       :  Only 8600-series DMA routes each channel to its own vectors.
+ *               The DMA endpoint exposes an MSI capability only (no MSI-X),
+ *               so a multiple-message MSI block of 8 vectors is requested.
+ *
+ ******************************************************************************/
+int
+PlxIrqVectorsInstall(
+    DEVICE_EXTENSION *pdx
+    )
+{
+#if defined(PLX_MULTI_MSI) && defined(PLX_THREADED_IRQ)
+    U8              i;
+    int             rc;
+    int             cpu;
+    PLX_DMA_VECTOR *pVector;
+
+
+    // Verify per-channel vector routing is available & desired
+    if (((pdx->Key.PlxChip & 0xFF00) != 0x8600) || (PlxMsiPerChannel == 0))
+    {
+        return -ENODEV;
+    }
+
+    // Request the full block, since fewer vectors group several channels
+    rc =
+        Plx_pci_enable_msi_block(
+            pdx->pPciDevice,
+            DMA_MAX_MSI_VECTORS
+            );
+
+    if (rc != 0)
+    {
+        DebugPrintf(("%d MSI vectors not available (code=%d)\n", DMA_MAX_MSI_VECTORS, rc));
+        return rc;
+    }
+
+    pdx->IrqType       = PLX_IRQ_TYPE_MSI;
+    pdx->NumIrqVectors = DMA_MAX_MSI_VECTORS;
+
+    DebugPrintf(("Enabled %d MSI vectors, one pair per DMA channel\n", pdx->NumIrqVectors));
+
+    for (i = 0; i < pdx->NumIrqVectors; i++)
+    {
+        pVector = &(pdx->IrqVector[i]);
+
+        // Vectors 0-3 carry standard ints & 4-7 error ints of channels 0-3
+        pVector->pdx        = pdx;
+        pVector->channel    = i % MAX_DMA_CHANNELS;
+        pVector->irq        = Plx_pci_irq_vector( pdx->pPciDevice, i );
+        pVector->bInstalled = FALSE;
+
+        snprintf(
+            pVector->Name,
+            sizeof(pVector->Name),
+            "%s-ch%d%s",
+            pdx->LinkName,
+            pVector->channel,
+            (i < MAX_DMA_CHANNELS) ? "" : "-err"
+            );
+
+        // Vectors are never shared, so each has its own context
+        rc =
+            request_threaded_irq(
+                pVector->irq,              // The vector IRQ
+                OnInterruptChannel,        // Interrupt handler
+                OnInterruptChannelThread,  // IRQ thread to run the channel DPC
+                0,                         // Flags, MSI vectors are not shared
+                pVector->Name,             // The vector name
+                pVector                    // Parameter to the ISR
+                );
+
+        if (rc != 0)
+        {
+            ErrorPrintf(("ERROR - Unable to install ISR for MSI vector %d\n", i));
+            PlxIrqVectorsRemove( pdx );
+            return rc;
+        }
+
+        pVector->bInstalled = TRUE;
+
+        DebugPrintf((
+            "     IRQ      : %02d [%02Xh] (%s)\n",
+            pVector->irq, pVector->irq, pVector->Name
+            ));
+
+        // Pin vector & its IRQ thread to the channel CPU, else device CPU
+        cpu = PlxDmaIrqCpu[pVector->channel];
+        if (cpu < 0)
+            cpu = PlxIrqCpu;
+
+        PlxIrqAffinitySet(
+            pVector->irq,
+            cpu
+            );
+    }
+
+    return 0;
+#else
+    return -EINVAL;
+#endif
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxIrqVectorsRemove
+ *
+ * Description:  Removes per-channel ISRs & releases the MSI vector block
+ *
+ ******************************************************************************/
+VOID
+PlxIrqVectorsRemove(
+    DEVICE_EXTENSION *pdx
+    )
+{
+#if defined(PLX_MULTI_MSI) && defined(PLX_THREADED_IRQ)
+    U8              i;
+    PLX_DMA_VECTOR *pVector;
+
+
+    for (i = 0; i < pdx->NumIrqVectors; i++)
+    {
+        pVector = &(pdx->IrqVector[i]);
+
+        if (pVector->bInstalled)
+        {
+            DebugPrintf(("Remove ISR (IRQ = %02d [%02Xh])\n", pVector->irq, pVector->irq));
+
+            // Affinity hint must be removed before the IRQ is released
+            Plx_irq_set_affinity_hint( pVector->irq, NULL );
+
+            // Waits for the vector's IRQ thread to complete
+            free_irq( pVector->irq, pVector );
+
+            pVector->bInstalled = FALSE;
+        }
+    }
+
+    DebugPrintf(("Disable MSI vectors\n"));
+    Plx_pci_disable_msi( pdx->pPciDevice );
+
+    // Mark the interrupt resources released
+    pdx->NumIrqVectors = 0;
+    pdx->IrqType       = PLX_IRQ_TYPE_NONE;
+#endif
+}
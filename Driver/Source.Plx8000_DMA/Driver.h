@@ -102,6 +102,16 @@ StopDevice(
     DEVICE_OBJECT *fdo
     );
 
+int
+PlxIrqVectorsInstall(
+    DEVICE_EXTENSION *pdx
+    );
+
+VOID
+PlxIrqVectorsRemove(
+    DEVICE_EXTENSION *pdx
+    );
+
 
 
 
@@ -73,6 +73,9 @@
 #define PLX_MAX_NAME_LENGTH                 0x20          // Max length of registered device name
 #define DEFAULT_SIZE_COMMON_BUFFER          (64 * 1024)   // Default size of Common Buffer
 #define MAX_DMA_CHANNELS                    4             // Total number of DMA Channels
+#define DMA_MAX_BYTE_COUNT                  0x07FFFFFF    // Max byte count per SGL descriptor ([26:0])
+#define DMA_MAX_QUEUE_ENTRIES               16            // Max queued SGL transfers per DMA channel
+#define DMA_MAX_MSI_VECTORS                 (MAX_DMA_CHANNELS * 2)  // Standard & error vector per channel (8600 multi-MSI)
 #define MIN_WORKING_POWER_STATE	            PowerDeviceD2 // Minimum state required for local register access
 
 
@@ -213,21 +216,64 @@ typedef struct _PLX_PCI_BAR_INFO
 } PLX_PCI_BAR_INFO;
 
 
-// DMA channel information 
-typedef struct _PLX_DMA_INFO
+// Page-locked user buffer & the SGL describing it
+typedef struct _PLX_DMA_SGL
 {
-    VOID                 *pOwner;               // Object that requested to open the channel
-    BOOLEAN               bOpen;                // Flag to note if DMA channel is open
-    BOOLEAN               bSglPending;          // Flag to note if an SGL DMA is pending
     U32                   NumPages;             // Number of pages mapped for user buffer
+    U32                   NumDescriptors;       // Number of SGL descriptors after merging contiguous pages
     U32                   InitialOffset;        // Initial offset of user buffer
     U32                   BufferSize;           // Total size of the user buffer
     int                   direction;            // The direction of the transfer
     struct page         **PageList;             // List of locked user pages
-    PLX_PHYS_MEM_OBJECT   SglBuffer;            // Current SGL descriptor list buffer
+    PLX_PHYS_MEM_OBJECT   SglBuffer;            // SGL descriptor list buffer
+} PLX_DMA_SGL;
+
+
+// User buffer transfer submitted to a DMA channel queue
+typedef struct _PLX_DMA_QUEUE_ENTRY
+{
+    BOOLEAN               bInUse;               // Flag whether entry is allocated
+    U64                   SglAddress;           // Bus address of first SGL descriptor
+    PLX_DMA_SGL           Sgl;                  // Locked buffer & its SGL
+} PLX_DMA_QUEUE_ENTRY;
+
+
+// DMA channel information 
+typedef struct _PLX_DMA_INFO
+{
+    VOID                 *pOwner;               // Object that requested to open the channel
+    BOOLEAN               bOpen;                // Flag to note if DMA channel is open
+    BOOLEAN               bSglPending;          // Flag to note if an SGL DMA is pending
+    U32                   NumDescriptors;       // Number of descriptors in last SGL started
+    PLX_DMA_SGL           Sgl;                  // SGL of current user buffer transfer
+    PLX_DMA_QUEUE_ENTRY   Queue[DMA_MAX_QUEUE_ENTRIES];       // Queued user buffer transfers
+    PLX_DMA_QUEUE_ENTRY  *pQueueFifo[DMA_MAX_QUEUE_ENTRIES];  // Queued transfers in order of submission
+    U8                    QueueHead;            // Index of next transfer to start in FIFO
+    U8                    QueueCount;           // Number of transfers waiting in FIFO
+    PLX_DMA_QUEUE_ENTRY  *pQueueActive;         // Queued transfer currently in progress
+    U32                   QueueCompleted;       // Number of queued transfers completed
+    wait_queue_head_t     WaitDone;             // Threads waiting for DMA completion
+    U32                   DoneCount;            // Number of DMA completions serviced
+    U32                   BlockByteCount;       // Size of block transfer in progress
+    spinlock_t            Lock_Isr;             // Spinlock to sync with channel's own MSI vectors
+    U32                   Source_Ints;          // Interrupts detected by channel's vector ISR
+    PLX_DMA_STATS         Stats;                // Transfer counters & latency histograms
+    U64                   StartTime_ns;         // Time the last transfer was started
+    U64                   DoneTime_ns;          // Time of the last DMA done interrupt
 } PLX_DMA_INFO;
 
 
+// Per-channel MSI vector
+typedef struct _PLX_DMA_VECTOR
+{
+    struct _DEVICE_EXTENSION *pdx;
+    U8                        channel;          // DMA channel serviced by vector
+    unsigned int              irq;              // OS IRQ assigned to vector
+    BOOLEAN                   bInstalled;       // Flag whether handler is installed
+    char                      Name[PLX_MAX_NAME_LENGTH];  // Name shown in /proc/interrupts
+} PLX_DMA_VECTOR;
+
+
 // Argument for ISR synchronized register access
 typedef struct _PLX_REG_DATA
 {
@@ -258,16 +304,28 @@ typedef struct _DEVICE_EXTENSION
     U32                    Source_Ints;                   // Interrupts detected by ISR
     U8                    *pRegVa;                        // Virtual address to registers
     U8                     NumDmaChannels;                // Number of DMA channels supported
+    U8                     NumIrqVectors;                 // Number of MSI vectors allocated (0/1 = single shared ISR)
+    PLX_DMA_VECTOR         IrqVector[DMA_MAX_MSI_VECTORS];  // Per-channel MSI vectors
 
     struct list_head       List_WaitObjects;              // List of registered notification objects
     spinlock_t             Lock_WaitObjectsList;          // Spinlock for notification objects list
 
+    struct semaphore       Mutex_RegBatch;                // Serializes register batch sequences
+
     struct list_head       List_PhysicalMem;              // List of user-allocated physical memory
     spinlock_t             Lock_PhysicalMemList;          // Spinlock for physical memory list
 
     PLX_DMA_INFO           DmaInfo[MAX_DMA_CHANNELS];     // DMA channel information
     spinlock_t             Lock_Dma[MAX_DMA_CHANNELS];    // Spinlock for DMA channel access
 
+    struct list_head       List_CompletionRings;          // List of DMA completion rings shared with user space
+    spinlock_t             Lock_CompletionRingList;       // Spinlock for completion ring list
+    spinlock_t             Lock_DmaStats;                 // Spinlock for DMA channel statistics
+
+#if defined(PLX_DEBUGFS)
+    struct dentry         *pDebugFsDir;                   // Device directory in debugfs
+#endif
+
 } DEVICE_EXTENSION; 
 
 
@@ -280,6 +338,9 @@ typedef struct _DRIVER_OBJECT
     U8                      DeviceCount;      // Number of devices in list
     U8                      bPciDriverReg;    // Flag whether the driver was registered as PCI
     PLX_PHYS_MEM_OBJECT     CommonBuffer;     // Contiguous memory to be shared by all processes
+#if defined(PLX_DEBUGFS)
+    struct dentry          *pDebugFsRoot;     // Driver directory in debugfs
+#endif
     struct file_operations  DispatchTable;    // Driver dispatch table
 } DRIVER_OBJECT;
 
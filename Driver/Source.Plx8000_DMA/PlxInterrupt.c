@@ -51,11 +51,150 @@
 #include "DrvDefs.h"
 #include "PciFunc.h"
 #include "PlxInterrupt.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxChannelInterruptAck
+ *
+ * Description:  Reads & clears active interrupts of a DMA channel
+ *
+ * Note       :  Called at interrupt level with the ISR lock of the channel
+ *               held, either the device lock or the channel's own lock
+ *
+ ******************************************************************************/
+static U32
+PlxChannelInterruptAck(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U16 OffsetStatus;
+    U32 RegStatus;
+    U32 IntSource;
+
+
+    // Determine DMA status register offset
+    OffsetStatus = 0x23C + (channel * 0x100);
+
+    // Read interrupt status register for channel
+    RegStatus = PLX_DMA_REG_READ( pdx, OffsetStatus );
+
+    // Clear the interrupt type flag
+    IntSource = INTR_TYPE_NONE;
+
+    // Check if error interrupt is active ([16]) and enabled([0])
+    if ((RegStatus & (1 << 16)) && (RegStatus & (1 << 0)))
+        IntSource |= INTR_TYPE_DMA_ERROR;
+    else
+        RegStatus &= ~(1 << 16);
+
+    // Check if invalid descriptor interrupt is active ([17]) and enabled([1])
+    if ((RegStatus & (1 << 17)) && (RegStatus & (1 << 1)))
+        IntSource |= INTR_TYPE_DESCR_INVALID;
+    else
+        RegStatus &= ~(1 << 17);
+
+    // Check if abort done interrupt is active ([19]) and enabled([3])
+    if ((RegStatus & (1 << 19)) && (RegStatus & (1 << 3)))
+        IntSource |= INTR_TYPE_ABORT_DONE;
+    else
+        RegStatus &= ~(1 << 19);
+
+    // Check if pause done interrupt is active ([20]) and enabled([4])
+    if ((RegStatus & (1 << 20)) && (RegStatus & (1 << 4)))
+        IntSource |= INTR_TYPE_PAUSE_DONE;
+    else
+        RegStatus &= ~(1 << 20);
+
+    // Check if immediate stop interrupt is active ([21]) and enabled([5])
+    if ((RegStatus & (1 << 21)) && (RegStatus & (1 << 5)))
+        IntSource |= INTR_TYPE_IMMED_STOP_DONE;
+    else
+        RegStatus &= ~(1 << 21);
+
+    // Check if descriptor/DMA done interrupt is active ([18])
+    if (RegStatus & (1 << 18))
+        IntSource |= INTR_TYPE_DESCR_DMA_DONE;
+
+    if (IntSource == INTR_TYPE_NONE)
+        return INTR_TYPE_NONE;
+
+    // Write register back to itself to clear active interrupts
+    PLX_DMA_REG_WRITE( pdx, OffsetStatus, RegStatus );
+
+    // Complete block DMA here, since only SGL requires DPC cleanup
+    if ((IntSource & INTR_TYPE_DESCR_DMA_DONE) &&
+        (pdx->DmaInfo[channel].bSglPending == FALSE))
+    {
+        // Wake threads waiting for DMA completion without DPC latency
+        PlxDmaCompletionSignal(
+            pdx,
+            channel
+            );
+
+        IntSource |= INTR_TYPE_DMA_DONE_ISR;
+    }
+
+    return IntSource;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxChannelInterruptComplete
+ *
+ * Description:  Performs DPC-level cleanup for interrupts of a DMA channel
+ *
+ ******************************************************************************/
+static VOID
+PlxChannelInterruptComplete(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               IntStatus
+    )
+{
+    // Check if DMA completed for a driver SGL transfer & cleanup
+    if ((IntStatus & INTR_TYPE_DESCR_DMA_DONE) &&
+        ((IntStatus & INTR_TYPE_DMA_DONE_ISR) == 0) &&
+        (pdx->DmaInfo[channel].bSglPending))
+    {
+        PlxSglDmaTransferComplete(
+            pdx,
+            channel
+            );
+    }
+    else if (IntStatus & INTR_TYPE_DESCR_DMA_DONE)
+    {
+        // Record block DMA completion
+        PlxDmaCompletionPost(
+            pdx,
+            channel,
+            pdx->DmaInfo[channel].BlockByteCount,
+            PLX_STATUS_OK
+            );
+    }
+
+    // Wake any threads waiting for DMA completion if ISR did not
+    if ((IntStatus & INTR_TYPE_DESCR_DMA_DONE) &&
+        ((IntStatus & INTR_TYPE_DMA_DONE_ISR) == 0))
+    {
+        PlxDmaCompletionSignal(
+            pdx,
+            channel
+            );
+    }
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  OnInterrupt
@@ -73,8 +212,6 @@ OnInterrupt(
     )
 {
     U8                channel;
-    U16               OffsetStatus;
-    U32               RegStatus;
     U32               IntSource;
     BOOLEAN           bIntActive;
     DEVICE_EXTENSION *pdx;
@@ -83,6 +220,8 @@ OnInterrupt(
     // Get the device extension
     pdx = (DEVICE_EXTENSION *)dev_id;
 
+    trace_plx_isr_entry( pdx, irq );
+
     // Disable interrupts and acquire lock 
     spin_lock( &(pdx->Lock_Isr) ); 
 
@@ -92,55 +231,15 @@ OnInterrupt(
     // Check each channel for active interrupt
     for (channel = 0; channel < pdx->NumDmaChannels; channel++)
     {
-        // Determine DMA status register offset
-        OffsetStatus = 0x23C + (channel * 0x100);
-
-        // Read interrupt status register for channel
-        RegStatus = PLX_DMA_REG_READ( pdx, OffsetStatus );
-
-        // Clear the interrupt type flag
-        IntSource = INTR_TYPE_NONE;
-
-        // Check if error interrupt is active ([16]) and enabled([0])
-        if ((RegStatus & (1 << 16)) && (RegStatus & (1 << 0)))
-            IntSource |= INTR_TYPE_DMA_ERROR;
-        else
-            RegStatus &= ~(1 << 16);
-
-        // Check if invalid descriptor interrupt is active ([17]) and enabled([1])
-        if ((RegStatus & (1 << 17)) && (RegStatus & (1 << 1)))
-            IntSource |= INTR_TYPE_DESCR_INVALID;
-        else
-            RegStatus &= ~(1 << 17);
-
-        // Check if abort done interrupt is active ([19]) and enabled([3])
-        if ((RegStatus & (1 << 19)) && (RegStatus & (1 << 3)))
-            IntSource |= INTR_TYPE_ABORT_DONE;
-        else
-            RegStatus &= ~(1 << 19);
-
-        // Check if pause done interrupt is active ([20]) and enabled([4])
-        if ((RegStatus & (1 << 20)) && (RegStatus & (1 << 4)))
-            IntSource |= INTR_TYPE_PAUSE_DONE;
-        else
-            RegStatus &= ~(1 << 20);
-
-        // Check if immediate stop interrupt is active ([21]) and enabled([5])
-        if ((RegStatus & (1 << 21)) && (RegStatus & (1 << 5)))
-            IntSource |= INTR_TYPE_IMMED_STOP_DONE;
-        else
-            RegStatus &= ~(1 << 21);
-
-        // Check if descriptor/DMA done interrupt is active ([18])
-        if (RegStatus & (1 << 18))
-            IntSource |= INTR_TYPE_DESCR_DMA_DONE;
-
-        // Clear interrupt
+        // Read & clear active interrupts for channel
+        IntSource =
+            PlxChannelInterruptAck(
+                pdx,
+                channel
+                );
+
         if (IntSource != INTR_TYPE_NONE)
         {
-            // Write register back to itself to clear active interrupts
-            PLX_DMA_REG_WRITE( pdx, OffsetStatus, RegStatus );
-
             // Flag an interrupt was detected
             bIntActive = TRUE;
 
@@ -149,6 +248,8 @@ OnInterrupt(
         }
     }
 
+    trace_plx_isr_exit( pdx, pdx->Source_Ints );
+
     // Re-enable interrupts and release lock 
     spin_unlock( &(pdx->Lock_Isr) ); 
 
@@ -164,6 +265,13 @@ OnInterrupt(
     if (pdx->State != PLX_STATE_STARTED)
         return IRQ_RETVAL(IRQ_HANDLED);
 
+#if defined(PLX_THREADED_IRQ)
+    // Flag a DPC is pending
+    pdx->bDpcPending = TRUE;
+
+    // Wake the IRQ thread to run the DPC
+    return IRQ_WAKE_THREAD;
+#else
     // Add task to system work queue
     schedule_work(
         &(pdx->Task_DpcForIsr)
@@ -173,11 +281,172 @@ OnInterrupt(
     pdx->bDpcPending = TRUE;
 
     return IRQ_RETVAL(IRQ_HANDLED);
+#endif
 }
 
 
 
 
+#if defined(PLX_THREADED_IRQ)
+/*******************************************************************************
+ *
+ * Function   :  OnInterruptThread
+ *
+ * Description:  IRQ thread handler, which runs the DPC at real-time priority
+ *               instead of deferring it to the shared system work queue
+ *
+ ******************************************************************************/
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    // Get the device extension
+    pdx = (DEVICE_EXTENSION *)dev_id;
+
+    // DPC locates the device extension from its work item
+    DpcForIsr(
+        &(pdx->Task_DpcForIsr)
+        );
+
+    return IRQ_RETVAL(IRQ_HANDLED);
+}
+#endif
+
+
+
+
+#if defined(PLX_THREADED_IRQ)
+/*******************************************************************************
+ *
+ * Function   :  OnInterruptChannel
+ *
+ * Description:  Interrupt Service Routine for a per-channel MSI vector
+ *
+ * Note       :  Only the channel owning the vector is serviced & only its own
+ *               lock is taken, so channels on different CPUs do not contend
+ *
+ ******************************************************************************/
+irqreturn_t
+OnInterruptChannel(
+    int   irq,
+    void *dev_id
+    )
+{
+    U8                channel;
+    U32               IntSource;
+    PLX_DMA_VECTOR   *pVector;
+    DEVICE_EXTENSION *pdx;
+
+
+    // Get the vector & its owner
+    pVector = (PLX_DMA_VECTOR *)dev_id;
+    pdx     = pVector->pdx;
+    channel = pVector->channel;
+
+    trace_plx_isr_entry( pdx, irq );
+
+    // Standard & error vectors of the channel share its lock
+    spin_lock( &(pdx->DmaInfo[channel].Lock_Isr) );
+
+    // Read & clear active interrupts for channel
+    IntSource =
+        PlxChannelInterruptAck(
+            pdx,
+            channel
+            );
+
+    // Store pending interrupts
+    pdx->DmaInfo[channel].Source_Ints |= IntSource;
+
+    spin_unlock( &(pdx->DmaInfo[channel].Lock_Isr) );
+
+    trace_plx_isr_exit( pdx, IntSource << (channel * 8) );
+
+    // MSI is not shared, but the other vector of the channel may have acked it
+    if (IntSource == INTR_TYPE_NONE)
+        return IRQ_RETVAL(IRQ_HANDLED);
+
+    // If device is no longer started, do not run the DPC
+    if (pdx->State != PLX_STATE_STARTED)
+        return IRQ_RETVAL(IRQ_HANDLED);
+
+    // Wake the IRQ thread of the vector to complete the channel
+    return IRQ_WAKE_THREAD;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  OnInterruptChannelThread
+ *
+ * Description:  IRQ thread of a per-channel MSI vector, runs the DPC work
+ *               for the channel only
+ *
+ ******************************************************************************/
+irqreturn_t
+OnInterruptChannelThread(
+    int   irq,
+    void *dev_id
+    )
+{
+    U8                  channel;
+    U32                 IntStatus;
+    unsigned long       flags;
+    PLX_DMA_VECTOR     *pVector;
+    DEVICE_EXTENSION   *pdx;
+    PLX_INTERRUPT_DATA  IntData;
+
+
+    // Get the vector & its owner
+    pVector = (PLX_DMA_VECTOR *)dev_id;
+    pdx     = pVector->pdx;
+    channel = pVector->channel;
+
+    // Abort if device is being stopped and resources released
+    if ((pdx->State != PLX_STATE_STARTED) || (pdx->pRegVa == NULL))
+        return IRQ_RETVAL(IRQ_HANDLED);
+
+    // Get & clear pending interrupt sources of the channel
+    spin_lock_irqsave( &(pdx->DmaInfo[channel].Lock_Isr), flags );
+    IntStatus = pdx->DmaInfo[channel].Source_Ints;
+    pdx->DmaInfo[channel].Source_Ints = INTR_TYPE_NONE;
+    spin_unlock_irqrestore( &(pdx->DmaInfo[channel].Lock_Isr), flags );
+
+    // Nothing to do if other vector of the channel already completed it
+    if (IntStatus == INTR_TYPE_NONE)
+        return IRQ_RETVAL(IRQ_HANDLED);
+
+    trace_plx_dpc( pdx, IntStatus << (channel * 8) );
+
+    PlxChannelInterruptComplete(
+        pdx,
+        channel,
+        IntStatus
+        );
+
+    // Signal any objects waiting for notification, in device source format
+    IntData.pdx         = pdx;
+    IntData.Source_Ints = IntStatus << (channel * 8);
+
+    PlxSignalNotifications(
+        pdx,
+        &IntData
+        );
+
+    return IRQ_RETVAL(IRQ_HANDLED);
+}
+#endif
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  DpcForIsr
@@ -220,21 +489,19 @@ DpcForIsr(
         &IntData
         );
 
+    trace_plx_dpc( pdx, IntData.Source_Ints );
+
     // Cleanup after SGL DMA
     for (channel = 0; channel < pdx->NumDmaChannels; channel++)
     {
         // Get active interrupts for channel
         IntStatus = (IntData.Source_Ints >> (channel * 8)) & 0xFF;
 
-        // Check if DMA completed for a driver SGL transfer & cleanup
-        if ((IntStatus & INTR_TYPE_DESCR_DMA_DONE) &&
-            (pdx->DmaInfo[channel].bSglPending))
-        {
-            PlxSglDmaTransferComplete(
-                pdx,
-                channel
-                );
-        }
+        PlxChannelInterruptComplete(
+            pdx,
+            channel,
+            IntStatus
+            );
     }
 
     // Signal any objects waiting for notification
@@ -67,6 +67,7 @@
 #define INTR_TYPE_IMMED_STOP_DONE       (1 << 4)
 #define INTR_TYPE_DESCR_INVALID         (1 << 5)
 #define INTR_TYPE_DMA_ERROR             (1 << 6)
+#define INTR_TYPE_DMA_DONE_ISR          (1 << 7)       // Block DMA completion signaled by ISR (driver internal)
 
 
 
@@ -85,6 +86,26 @@ OnInterrupt(
   #endif
     );
 
+#if defined(PLX_THREADED_IRQ)
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    );
+
+irqreturn_t
+OnInterruptChannel(
+    int   irq,
+    void *dev_id
+    );
+
+irqreturn_t
+OnInterruptChannelThread(
+    int   irq,
+    void *dev_id
+    );
+#endif
+
 VOID
 DpcForIsr(
     PLX_DPC_PARAM *pArg1
@@ -0,0 +1,254 @@
+
+/*******************************************************************************
+ * Copyright 2013-2016 Avago Technologies
+ * Copyright (c) 2009 to 2012 PLX Technology Inc.  All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directorY of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ * File Name:
+ *
+ *      PlxTrace.h
+ *
+ * Description:
+ *
+ *      Static tracepoints for the interrupt & DMA paths.  Events are
+ *      registered under the "plx8000_dma" trace system and cost only a
+ *      patched-out branch unless enabled through ftrace/perf.
+ *
+ * Note:
+ *
+ *      This header is read multiple times by the kernel trace macros.
+ *      Exactly one driver file defines CREATE_TRACE_POINTS before
+ *      including it.
+ *
+ * Revision History:
+ *
+ *      12-01-16 : PLX SDK v7.25
+ *
+ ******************************************************************************/
+
+
+#include "Plx_sysdep.h"
+
+
+#if !defined(PLX_TRACEPOINTS)
+
+#if !defined(__PLX_TRACE_H)
+#define __PLX_TRACE_H
+
+// Tracepoints not available, compile out trace calls
+#define trace_plx_isr_entry(pdx, irq)                               do { } while (0)
+#define trace_plx_isr_exit(pdx, source)                             do { } while (0)
+#define trace_plx_dpc(pdx, source)                                  do { } while (0)
+#define trace_plx_dma_start(pdx, channel, bytes, descriptors, dir)  do { } while (0)
+#define trace_plx_dma_sgl_build(pdx, bytes, pages, descriptors)     do { } while (0)
+#define trace_plx_dma_sgl_complete(pdx, channel, bytes)             do { } while (0)
+
+#endif
+
+#else
+
+#undef  TRACE_SYSTEM
+#define TRACE_SYSTEM                        plx8000_dma
+
+#if !defined(__PLX_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define __PLX_TRACE_H
+
+#include <linux/tracepoint.h>
+#include "DrvDefs.h"
+
+
+
+
+/**********************************************
+ *               Trace Events
+ *********************************************/
+// ISR entered, before the device interrupt status is read
+TRACE_EVENT(plx_isr_entry,
+    TP_PROTO(DEVICE_EXTENSION *pdx, int irq),
+    TP_ARGS(pdx, irq),
+    TP_STRUCT__entry(
+        __field( u8,  bus )
+        __field( u8,  slot )
+        __field( u8,  function )
+        __field( int, irq )
+        ),
+    TP_fast_assign(
+        __entry->bus      = pdx->Key.bus;
+        __entry->slot     = pdx->Key.slot;
+        __entry->function = pdx->Key.function;
+        __entry->irq      = irq;
+        ),
+    TP_printk(
+        "%02x:%02x.%x irq=%d",
+        __entry->bus, __entry->slot, __entry->function, __entry->irq
+        )
+);
+
+// ISR verified & cleared an interrupt, source holds 8 bits per channel
+TRACE_EVENT(plx_isr_exit,
+    TP_PROTO(DEVICE_EXTENSION *pdx, u32 source),
+    TP_ARGS(pdx, source),
+    TP_STRUCT__entry(
+        __field( u8,  bus )
+        __field( u8,  slot )
+        __field( u8,  function )
+        __field( u32, source )
+        ),
+    TP_fast_assign(
+        __entry->bus      = pdx->Key.bus;
+        __entry->slot     = pdx->Key.slot;
+        __entry->function = pdx->Key.function;
+        __entry->source   = source;
+        ),
+    TP_printk(
+        "%02x:%02x.%x source=%08x",
+        __entry->bus, __entry->slot, __entry->function, __entry->source
+        )
+);
+
+// DPC services pending interrupts
+TRACE_EVENT(plx_dpc,
+    TP_PROTO(DEVICE_EXTENSION *pdx, u32 source),
+    TP_ARGS(pdx, source),
+    TP_STRUCT__entry(
+        __field( u8,  bus )
+        __field( u8,  slot )
+        __field( u8,  function )
+        __field( u32, source )
+        ),
+    TP_fast_assign(
+        __entry->bus      = pdx->Key.bus;
+        __entry->slot     = pdx->Key.slot;
+        __entry->function = pdx->Key.function;
+        __entry->source   = source;
+        ),
+    TP_printk(
+        "%02x:%02x.%x source=%08x",
+        __entry->bus, __entry->slot, __entry->function, __entry->source
+        )
+);
+
+// DMA channel started, descriptors is 0 for block mode
+TRACE_EVENT(plx_dma_start,
+    TP_PROTO(DEVICE_EXTENSION *pdx, u8 channel, u32 bytes, u32 descriptors, u8 dir),
+    TP_ARGS(pdx, channel, bytes, descriptors, dir),
+    TP_STRUCT__entry(
+        __field( u8,  bus )
+        __field( u8,  slot )
+        __field( u8,  function )
+        __field( u8,  channel )
+        __field( u32, bytes )
+        __field( u32, descriptors )
+        __field( u8,  dir )
+        ),
+    TP_fast_assign(
+        __entry->bus         = pdx->Key.bus;
+        __entry->slot        = pdx->Key.slot;
+        __entry->function    = pdx->Key.function;
+        __entry->channel     = channel;
+        __entry->bytes       = bytes;
+        __entry->descriptors = descriptors;
+        __entry->dir         = dir;
+        ),
+    TP_printk(
+        "%02x:%02x.%x ch=%d bytes=%u descriptors=%u dir=%s",
+        __entry->bus, __entry->slot, __entry->function,
+        __entry->channel, __entry->bytes, __entry->descriptors,
+        (__entry->dir == PLX_DMA_LOC_TO_PCI) ? "L->P" : "P->L"
+        )
+);
+
+// User buffer page-locked & SGL descriptors built
+TRACE_EVENT(plx_dma_sgl_build,
+    TP_PROTO(DEVICE_EXTENSION *pdx, u32 bytes, u32 pages, u32 descriptors),
+    TP_ARGS(pdx, bytes, pages, descriptors),
+    TP_STRUCT__entry(
+        __field( u8,  bus )
+        __field( u8,  slot )
+        __field( u8,  function )
+        __field( u32, bytes )
+        __field( u32, pages )
+        __field( u32, descriptors )
+        ),
+    TP_fast_assign(
+        __entry->bus         = pdx->Key.bus;
+        __entry->slot        = pdx->Key.slot;
+        __entry->function    = pdx->Key.function;
+        __entry->bytes       = bytes;
+        __entry->pages       = pages;
+        __entry->descriptors = descriptors;
+        ),
+    TP_printk(
+        "%02x:%02x.%x bytes=%u pages=%u descriptors=%u",
+        __entry->bus, __entry->slot, __entry->function,
+        __entry->bytes, __entry->pages, __entry->descriptors
+        )
+);
+
+// SGL DMA transfer completed & cleaned up by the DPC
+TRACE_EVENT(plx_dma_sgl_complete,
+    TP_PROTO(DEVICE_EXTENSION *pdx, u8 channel, u32 bytes),
+    TP_ARGS(pdx, channel, bytes),
+    TP_STRUCT__entry(
+        __field( u8,  bus )
+        __field( u8,  slot )
+        __field( u8,  function )
+        __field( u8,  channel )
+        __field( u32, bytes )
+        ),
+    TP_fast_assign(
+        __entry->bus      = pdx->Key.bus;
+        __entry->slot     = pdx->Key.slot;
+        __entry->function = pdx->Key.function;
+        __entry->channel  = channel;
+        __entry->bytes    = bytes;
+        ),
+    TP_printk(
+        "%02x:%02x.%x ch=%d bytes=%u",
+        __entry->bus, __entry->slot, __entry->function,
+        __entry->channel, __entry->bytes
+        )
+);
+
+#endif // __PLX_TRACE_H
+
+
+// Trace header is in the driver folder, which is in the include path
+#undef  TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH                  .
+#undef  TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE                  PlxTrace
+
+#include <trace/define_trace.h>
+
+#endif // PLX_TRACEPOINTS
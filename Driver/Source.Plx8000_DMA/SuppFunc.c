@@ -49,12 +49,15 @@
 
 
 #include <linux/uaccess.h>   // For user page access
+#include <linux/debugfs.h>
 #include <linux/delay.h>     // For mdelay()
 #include <linux/sched.h>     // For TASK_xxx
+#include <linux/seq_file.h>
 #include "ApiFunc.h"
 #include "PciFunc.h"
 #include "PciRegs.h"
 #include "PlxInterrupt.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -790,6 +793,12 @@ PlxDmaChannelCleanup(
                 );
         }
     }
+
+    // Release any DMA completion ring of the owner
+    PlxDmaCompletionRingDestroy(
+        pdx,
+        pOwner
+        );
 }
 
 
@@ -808,11 +817,7 @@ PlxSglDmaTransferComplete(
     U8                channel
     )
 {
-    U8           Index_PciAddr;
-    U32          i;
-    U32          BusAddr;
-    U32          BlockSize;
-    PLX_UINT_PTR VaSgl;
+    PLX_DMA_QUEUE_ENTRY *pEntry;
 
 
     if (pdx->DmaInfo[channel].bSglPending == FALSE)
@@ -821,63 +826,226 @@ PlxSglDmaTransferComplete(
         return;
     }
 
+    pEntry = pdx->DmaInfo[channel].pQueueActive;
+
+    trace_plx_dma_sgl_complete(
+        pdx,
+        channel,
+        (pEntry != NULL) ? pEntry->Sgl.BufferSize :
+                           pdx->DmaInfo[channel].Sgl.BufferSize
+        );
+
+    // Record completion of the transfer
+    PlxDmaCompletionPost(
+        pdx,
+        channel,
+        (pEntry != NULL) ? pEntry->Sgl.BufferSize :
+                           pdx->DmaInfo[channel].Sgl.BufferSize,
+        PLX_STATUS_OK
+        );
+
     DebugPrintf(("Unlock user-mode buffer used for SGL DMA transfer...\n"));
 
+    // Unmap and unlock user buffer pages
+    if (pEntry != NULL)
+    {
+        PlxSglRelease(
+            pdx,
+            &pEntry->Sgl
+            );
+    }
+    else
+    {
+        PlxSglRelease(
+            pdx,
+            &pdx->DmaInfo[channel].Sgl
+            );
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Return queue entry to the free pool
+    if (pEntry != NULL)
+    {
+        pEntry->bInUse = FALSE;
+        pdx->DmaInfo[channel].pQueueActive = NULL;
+        pdx->DmaInfo[channel].QueueCompleted++;
+    }
+
+    // Chain the next queued transfer to keep the channel busy
+    if ((pdx->DmaInfo[channel].QueueCount != 0) && pdx->DmaInfo[channel].bOpen)
+    {
+        pEntry =
+            pdx->DmaInfo[channel].pQueueFifo[pdx->DmaInfo[channel].QueueHead];
+
+        pdx->DmaInfo[channel].QueueHead =
+            (pdx->DmaInfo[channel].QueueHead + 1) % DMA_MAX_QUEUE_ENTRIES;
+
+        pdx->DmaInfo[channel].QueueCount--;
+
+        DebugPrintf((
+            "Start next queued DMA transfer (%d remain)\n",
+            pdx->DmaInfo[channel].QueueCount
+            ));
+
+        pdx->DmaInfo[channel].pQueueActive   = pEntry;
+        pdx->DmaInfo[channel].NumDescriptors = pEntry->Sgl.NumDescriptors;
+
+        trace_plx_dma_start(
+            pdx,
+            channel,
+            pEntry->Sgl.BufferSize,
+            pEntry->Sgl.NumDescriptors,
+            (pEntry->Sgl.direction == DMA_FROM_DEVICE) ? PLX_DMA_LOC_TO_PCI : PLX_DMA_PCI_TO_LOC
+            );
+
+        PlxDmaStatsStart(
+            pdx,
+            channel,
+            pEntry->Sgl.BufferSize
+            );
+
+        PlxDmaSglStart(
+            pdx,
+            channel,
+            pEntry->SglAddress,
+            pEntry->Sgl.NumDescriptors
+            );
+    }
+    else
+    {
+        // Clear the DMA pending flag
+        pdx->DmaInfo[channel].bSglPending = FALSE;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglRelease
+ *
+ * Description:  Unmap & unlock the user buffer pages described by an SGL
+ *
+ ******************************************************************************/
+VOID
+PlxSglRelease(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_SGL      *pSgl
+    )
+{
+    U8           Index_PciAddr;
+    U8           ShiftHigh;
+    U32          i;
+    U32          page;
+    U32          offset;
+    U32          BlockSize;
+    U32          BytesRemaining;
+    U64          BusAddr;
+    PLX_UINT_PTR VaSgl;
+
+
+    if (pSgl->PageList == NULL)
+    {
+        return;
+    }
+
     // Get pointer to SGL list
-    VaSgl = (PLX_UINT_PTR)pdx->DmaInfo[channel].SglBuffer.pKernelVa;
+    VaSgl = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
 
-    // Jump to next 16-byte aligned boundary
-    VaSgl = (VaSgl + 0xF) & ~(0xF);
+    // Jump to next 64-byte aligned boundary
+    VaSgl = (VaSgl + (64 - 1)) & ~((PLX_UINT_PTR)64 - 1);
 
-    // Detemine which descriptor field contains mapped PCI address
-    if (pdx->DmaInfo[channel].direction == DMA_FROM_DEVICE)
+    // Detemine which descriptor fields contain mapped user buffer address
+    if (pSgl->direction == DMA_FROM_DEVICE)
     {
-        Index_PciAddr = 0x4;
+        Index_PciAddr = 0x8;    // Destination
+        ShiftHigh     = 0;
     }
     else
     {
-        Index_PciAddr = 0x8;
+        Index_PciAddr = 0xC;    // Source
+        ShiftHigh     = 16;
     }
 
-    // Unmap and unlock user buffer pages
-    for (i = 0; i < pdx->DmaInfo[channel].NumPages; i++)
+    // Set offset of first page
+    offset = pSgl->InitialOffset;
+
+    page = 0;
+
+    /*************************************************************
+     * Unmap and unlock user buffer pages
+     *
+     * A descriptor may cover several pages which were merged
+     * because they were contiguous on the bus. Each page was
+     * mapped individually, so the descriptor is split back
+     * into its page-sized pieces for unmapping.
+     ************************************************************/
+    for (i = 0; i < pSgl->NumDescriptors; i++)
     {
-        // Get PCI bus address from descriptor
-        BusAddr = PLX_LE_DATA_32( *(U32*)(VaSgl + Index_PciAddr) );
+        // Get bus address of user buffer from descriptor
+        BusAddr =
+            ((U64)((PLX_LE_DATA_32( *(U32*)(VaSgl + 0x4) ) >> ShiftHigh) & 0xFFFF) << 32) |
+            PLX_LE_DATA_32( *(U32*)(VaSgl + Index_PciAddr) );
 
         // Get byte count from descriptor
-        BlockSize = PLX_LE_DATA_32( *(U32*)(VaSgl + 0) );
+        BytesRemaining = PLX_LE_DATA_32( *(U32*)(VaSgl + 0) ) & DMA_MAX_BYTE_COUNT;
 
         // Adjust virtual address to next descriptor
         VaSgl += (4 * sizeof(U32));
 
-        // Unmap the page
-        dma_unmap_page(
-            &(pdx->pPciDevice->dev),
-            BusAddr,
-            BlockSize,
-            pdx->DmaInfo[channel].direction
-            );
-
-        // Mark page as dirty if PCI->User buffer DMA (user app read)
-        if (pdx->DmaInfo[channel].direction == DMA_FROM_DEVICE)
+        while ((BytesRemaining != 0) && (page < pSgl->NumPages))
         {
-            // Mark page as dirty if necessary
-            if (!PageReserved(pdx->DmaInfo[channel].PageList[i]))
+            // Calculate size of the piece in current page
+            if (BytesRemaining > (PAGE_SIZE - offset))
             {
-                SetPageDirty( pdx->DmaInfo[channel].PageList[i] );
+                BlockSize = PAGE_SIZE - offset;
             }
-        }
+            else
+            {
+                BlockSize = BytesRemaining;
+            }
+
+            // Unmap the page
+            dma_unmap_page(
+                &(pdx->pPciDevice->dev),
+                BusAddr,
+                BlockSize,
+                pSgl->direction
+                );
 
-        // Unlock the page
-        put_page( pdx->DmaInfo[channel].PageList[i] );
+            // Mark page as dirty if PCI->User buffer DMA (user app read)
+            if (pSgl->direction == DMA_FROM_DEVICE)
+            {
+                // Mark page as dirty if necessary
+                if (!PageReserved(pSgl->PageList[page]))
+                {
+                    SetPageDirty( pSgl->PageList[page] );
+                }
+            }
+
+            // Unlock the page
+            put_page( pSgl->PageList[page] );
+
+            // Adjust for next page
+            BusAddr        += BlockSize;
+            BytesRemaining -= BlockSize;
+            offset          = 0;
+            page++;
+        }
     }
 
     // Release page-list memory
-    kfree( pdx->DmaInfo[channel].PageList );
+    kfree( pSgl->PageList );
 
-    // Clear the DMA pending flag
-    pdx->DmaInfo[channel].bSglPending = FALSE;
+    pSgl->PageList = NULL;
 }
 
 
@@ -898,6 +1066,60 @@ PlxLockBufferAndBuildSgl(
     U64              *pSglAddress,
     U32              *pNumDescr
     )
+{
+    U64        Start_ns;
+    PLX_STATUS status;
+
+
+    Start_ns = ktime_to_ns( ktime_get() );
+
+    // Page-lock user buffer & build a new SGL
+    status =
+        PlxSglBuild(
+            pdx,
+            pDma,
+            &pdx->DmaInfo[channel].Sgl,
+            pSglAddress
+            );
+
+    if (status == PLX_STATUS_OK)
+    {
+        // Store final descriptor count
+        pdx->DmaInfo[channel].NumDescriptors =
+                           pdx->DmaInfo[channel].Sgl.NumDescriptors;
+
+        // Return number of descriptors created
+        *pNumDescr = pdx->DmaInfo[channel].Sgl.NumDescriptors;
+    }
+
+    PlxDmaStatsSetup(
+        pdx,
+        channel,
+        Start_ns,
+        &pdx->DmaInfo[channel].Sgl,
+        status
+        );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglBuild
+ *
+ * Description:  Page-lock & map a user buffer and build the SGL describing it
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxSglBuild(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_PARAMS   *pDma,
+    PLX_DMA_SGL      *pSgl,
+    U64              *pSglAddress
+    )
 {
     int          rc;
     U32          i;
@@ -905,11 +1127,14 @@ PlxLockBufferAndBuildSgl(
     U32          SglSize;
     U32          TmpValue;
     U32          BlockSize;
+    U32          NumDescr;
+    U32          DescrSize;
     U32          TotalDescr;
     U32          BytesRemaining;
     U64          BusSgl;
     U64          BusAddr;
     U64          PciAddr;
+    U64          DescrBusAddr;
     U64          AddrSrc;
     U64          AddrDest;
     BOOLEAN      bDirPciToUser;
@@ -930,9 +1155,9 @@ PlxLockBufferAndBuildSgl(
     *pSglAddress = 0;
 
     // Store buffer page offset
-    pdx->DmaInfo[channel].InitialOffset = (U32)(pDma->UserVa & ~PAGE_MASK);
+    pSgl->InitialOffset = (U32)(pDma->UserVa & ~PAGE_MASK);
 
-    offset         = pdx->DmaInfo[channel].InitialOffset;
+    offset         = pSgl->InitialOffset;
     UserVa         = pDma->UserVa;
     BytesRemaining = pDma->ByteCount;
     TotalDescr     = 0;
@@ -963,31 +1188,31 @@ PlxLockBufferAndBuildSgl(
         ));
 
     // Allocate memory to store page list
-    pdx->DmaInfo[channel].PageList =
+    pSgl->PageList =
         kmalloc(
             TotalDescr * sizeof(struct page *),
             GFP_KERNEL
             );
 
-    if (pdx->DmaInfo[channel].PageList == NULL)
+    if (pSgl->PageList == NULL)
     {
         DebugPrintf(("ERROR - Unable to allocate memory for list of pages\n"));
         return PLX_STATUS_PAGE_GET_ERROR;
     }
 
     // Store number of pages
-    pdx->DmaInfo[channel].NumPages = TotalDescr;
+    pSgl->NumPages = TotalDescr;
 
     // Determine & store DMA transfer direction
     if (pDma->Direction == PLX_DMA_PCI_TO_USER)
     {
-        bDirPciToUser                   = TRUE;
-        pdx->DmaInfo[channel].direction = DMA_FROM_DEVICE;
+        bDirPciToUser   = TRUE;
+        pSgl->direction = DMA_FROM_DEVICE;
     }
     else
     {
-        bDirPciToUser                   = FALSE;
-        pdx->DmaInfo[channel].direction = DMA_TO_DEVICE;
+        bDirPciToUser   = FALSE;
+        pSgl->direction = DMA_TO_DEVICE;
     }
 
     // Obtain the mmap reader/writer semaphore
@@ -999,7 +1224,7 @@ PlxLockBufferAndBuildSgl(
             UserVa & PAGE_MASK,               // Page-aligned user buffer start address
             TotalDescr,                       // Length of the buffer in pages
             (bDirPciToUser ? FOLL_WRITE : 0), // Flags
-            pdx->DmaInfo[channel].PageList,   // List of page pointers describing buffer
+            pSgl->PageList,   // List of page pointers describing buffer
             NULL                              // List of associated VMAs
             );
 
@@ -1019,7 +1244,8 @@ PlxLockBufferAndBuildSgl(
                 rc, TotalDescr
                 ));
         }
-        kfree( pdx->DmaInfo[channel].PageList );
+        kfree( pSgl->PageList );
+        pSgl->PageList = NULL;
         return PLX_STATUS_PAGE_LOCK_ERROR;
     }
 
@@ -1032,9 +1258,10 @@ PlxLockBufferAndBuildSgl(
      * Build SGL descriptors
      *
      * The following code will build the SGL descriptors
-     * in PCI memory.  There will be one descriptor for
-     * each page of memory since the pages are scattered
-     * throughout physical memory.
+     * in PCI memory.  Pages are mapped individually, but
+     * pages which end up contiguous on the bus are merged
+     * into a single descriptor, up to the maximum byte count
+     * supported by the DMA engine per descriptor.
      ************************************************************/
 
     /*************************************************************
@@ -1050,9 +1277,9 @@ PlxLockBufferAndBuildSgl(
     SglSize = (TotalDescr * (4 * sizeof(U32))) + 64;
 
     // Check if a previously allocated buffer can be re-used
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa != NULL)
+    if (pSgl->SglBuffer.pKernelVa != NULL)
     {
-        if (pdx->DmaInfo[channel].SglBuffer.Size >= SglSize)
+        if (pSgl->SglBuffer.Size >= SglSize)
         {
             // Buffer can be re-used, do nothing
             DebugPrintf(("Re-use previously allocated SGL descriptor buffer\n"));
@@ -1064,48 +1291,49 @@ PlxLockBufferAndBuildSgl(
             // Release memory used for SGL descriptors
             Plx_dma_buffer_free(
                 pdx,
-                &pdx->DmaInfo[channel].SglBuffer
+                &pSgl->SglBuffer
                 );
 
-            pdx->DmaInfo[channel].SglBuffer.pKernelVa = NULL;
+            pSgl->SglBuffer.pKernelVa = NULL;
         }
     }
 
     // Allocate memory for SGL descriptors if necessary
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa == NULL)
+    if (pSgl->SglBuffer.pKernelVa == NULL)
     {
         DebugPrintf(("Allocate PCI memory for SGL descriptor buffer...\n"));
 
         // Setup for transfer
-        pdx->DmaInfo[channel].SglBuffer.Size = SglSize;
+        pSgl->SglBuffer.Size = SglSize;
 
         VaSgl =
             (PLX_UINT_PTR)Plx_dma_buffer_alloc(
                 pdx,
-                &pdx->DmaInfo[channel].SglBuffer
+                &pSgl->SglBuffer
                 );
 
         if (VaSgl == 0)
         {
             DebugPrintf((
                 "ERROR - Unable to allocate %d bytes for %d SGL descriptors\n",
-                pdx->DmaInfo[channel].SglBuffer.Size,
+                pSgl->SglBuffer.Size,
                 TotalDescr
                 ));
-            kfree( pdx->DmaInfo[channel].PageList );
+            kfree( pSgl->PageList );
+            pSgl->PageList = NULL;
             return PLX_STATUS_INSUFFICIENT_RES;
         }
     }
     else
     {
-        VaSgl = (PLX_UINT_PTR)pdx->DmaInfo[channel].SglBuffer.pKernelVa;
+        VaSgl = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
     }
 
     // Prepare for build of SGL
     PciAddr = pDma->PciAddr;
 
     // Get bus physical address of SGL descriptors
-    BusSgl = (U32)pdx->DmaInfo[channel].SglBuffer.BusPhysical;
+    BusSgl = (U32)pSgl->SglBuffer.BusPhysical;
 
     // Make sure addresses are aligned on next descriptor boundary
     VaSgl  = (VaSgl + (64 - 1)) & ~((PLX_UINT_PTR)64 - 1);
@@ -1117,14 +1345,19 @@ PlxLockBufferAndBuildSgl(
         ));
 
     // Store total buffer size
-    pdx->DmaInfo[channel].BufferSize = pDma->ByteCount;
+    pSgl->BufferSize = pDma->ByteCount;
 
     // Set offset of first page
-    offset = pdx->DmaInfo[channel].InitialOffset;
+    offset = pSgl->InitialOffset;
 
     // Initialize bytes remaining
     BytesRemaining = pDma->ByteCount;
 
+    // Initialize descriptor tracking
+    NumDescr     = 0;
+    DescrSize    = 0;
+    DescrBusAddr = 0;
+
     // Build the SGL list
     for (i = 0; i < TotalDescr; i++)
     {
@@ -1142,63 +1375,90 @@ PlxLockBufferAndBuildSgl(
         BusAddr =
             dma_map_page(
                 &(pdx->pPciDevice->dev),
-                pdx->DmaInfo[channel].PageList[i],
+                pSgl->PageList[i],
                 offset,
                 BlockSize,
-                pdx->DmaInfo[channel].direction
+                pSgl->direction
                 );
 
+        // Merge into current descriptor if contiguous & within byte count limit
+        if ((DescrSize != 0) &&
+            (BusAddr == (DescrBusAddr + DescrSize)) &&
+            ((DescrSize + BlockSize) <= DMA_MAX_BYTE_COUNT))
+        {
+            DescrSize += BlockSize;
+        }
+        else
+        {
+            // Adjust virtual address to next descriptor
+            if (DescrSize != 0)
+            {
+                VaSgl += (4 * sizeof(U32));
+            }
+
+            // Start a new descriptor
+            NumDescr++;
+            DescrBusAddr = BusAddr;
+            DescrSize    = BlockSize;
+
+            // Set source destination addresses
+            if (pDma->Direction == PLX_DMA_USER_TO_PCI)
+            {
+                AddrSrc  = BusAddr;
+                AddrDest = PciAddr;
+            }
+            else
+            {
+                AddrSrc  = PciAddr;
+                AddrDest = BusAddr;
+            }
+
+            // Descriptor upper bits of addresses ([47:32])
+            TmpValue  = (PLX_64_HIGH_32( AddrSrc ) & 0x0000FFFF) << 16;
+            TmpValue |= (PLX_64_HIGH_32( AddrDest ) & 0x0000FFFF) <<  0;
+
+            *(U32*)(VaSgl + 0x4) = PLX_LE_DATA_32( TmpValue );
+
+            // Descriptor lower bits of destination address ([31:0])
+            TmpValue = PLX_64_LOW_32( AddrDest );
+            *(U32*)(VaSgl + 0x8) = PLX_LE_DATA_32( TmpValue );
+
+            // Descriptor lower bits of source address ([31:0])
+            TmpValue = PLX_64_LOW_32( AddrSrc );
+            *(U32*)(VaSgl + 0xC) = PLX_LE_DATA_32( TmpValue );
+        }
+
         // Enable the following to display the parameters of each SGL descriptor
         if (PLX_DEBUG_DISPLAY_SGL_DESCR)
         {
             DebugPrintf((
                 "SGL Desc %02d: User=%08lX  PCI=%08lX  Size=%X (%d) bytes\n",
-                i, (PLX_UINT_PTR)BusAddr, (PLX_UINT_PTR)PciAddr, BlockSize, BlockSize
+                NumDescr - 1, (PLX_UINT_PTR)DescrBusAddr, (PLX_UINT_PTR)PciAddr, DescrSize, DescrSize
                 ));
         }
 
-        // Set source destination addresses & increment to next PCI address
+        // Increment to next PCI address unless should remain constant
         if (pDma->Direction == PLX_DMA_USER_TO_PCI)
         {
-            AddrSrc  = BusAddr;
-            AddrDest = PciAddr;
-
-            // Increment destination PCI address unless should remain constant
             if (pDma->bConstAddrDest == FALSE)
+            {
                 PciAddr += BlockSize;
+            }
         }
         else
         {
-            AddrSrc  = PciAddr;
-            AddrDest = BusAddr;
-
-            // Increment source PCI address unless should remain constant
             if (pDma->bConstAddrSrc == FALSE)
             {
                 PciAddr += BlockSize;
             }
         }
 
-        // Descriptor upper bits of addresses ([47:32])
-        TmpValue  = (PLX_64_HIGH_32( AddrSrc ) & 0x0000FFFF) << 16;
-        TmpValue |= (PLX_64_HIGH_32( AddrDest ) & 0x0000FFFF) <<  0;
-
-        *(U32*)(VaSgl + 0x4) = PLX_LE_DATA_32( TmpValue );
-
-        // Descriptor lower bits of destination address ([31:0])
-        TmpValue = PLX_64_LOW_32( AddrDest );
-        *(U32*)(VaSgl + 0x8) = PLX_LE_DATA_32( TmpValue );
-
-        // Descriptor lower bits of source address ([31:0])
-        TmpValue = PLX_64_LOW_32( AddrSrc );
-        *(U32*)(VaSgl + 0xC) = PLX_LE_DATA_32( TmpValue );
-
         // Adjust byte count
         BytesRemaining -= BlockSize;
 
         // Descriptor transfer count
         TmpValue = PLX_LE_U32_BIT( 31 ) |       // Descriptor valid
-                   PLX_LE_DATA_32( BlockSize ); // Transfer count
+                   PLX_LE_DATA_32( DescrSize ); // Transfer count
 
         if (pDma->bConstAddrSrc)
         {
@@ -1217,25 +1477,860 @@ PlxLockBufferAndBuildSgl(
 
         *(U32*)(VaSgl + 0x0) = TmpValue;
 
-        // Adjust virtual address to next descriptor
-        VaSgl += (4 * sizeof(U32));
-
         // Clear offset
         offset = 0;
     }
 
+    // Store final descriptor count
+    pSgl->NumDescriptors = NumDescr;
+
+    DebugPrintf((
+        "Merged %d pages into %d SGL descriptors\n",
+        TotalDescr, NumDescr
+        ));
+
+    trace_plx_dma_sgl_build(
+        pdx,
+        pDma->ByteCount,
+        TotalDescr,
+        NumDescr
+        );
+
     // Return the physical address of the SGL
     *pSglAddress = BusSgl;
 
-    // Return number of descriptors created
-    *pNumDescr = TotalDescr;
-
     return PLX_STATUS_OK;
 }
 
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaSglStart
+ *
+ * Description:  Programs a DMA channel with an SGL & starts the transfer
+ *
+ * Note       :  The caller must hold the DMA channel lock
+ *
+ ******************************************************************************/
+VOID
+PlxDmaSglStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               SglPciAddress,
+    U32               NumDescriptors
+    )
+{
+    U16 OffsetDmaBase;
+    U32 RegValue;
+
+
+    // Make sure DMA descriptors are set to external ([2] = 0)
+    if (pdx->Key.PlxFamily == PLX_FAMILY_SIRIUS)
+    {
+        RegValue = PLX_DMA_REG_READ( pdx, 0x1FC );
+        PLX_DMA_REG_WRITE( pdx, 0x1FC, RegValue & ~(1 << 2) );
+    }
+
+    // Set the channel's base register offset (200h, 300h, etc)
+    OffsetDmaBase = 0x200 + (channel * 0x100);
+
+    // Verify DMA prefetch doesn't exceed descriptor count & is a multiple of 4
+    if (NumDescriptors < 4)
+    {
+        RegValue = 1;
+    }
+    else if (NumDescriptors >= 256)
+    {
+        RegValue = 0;
+    }
+    else
+    {
+        RegValue = (NumDescriptors & (U8)~0x3);
+    }
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x34, RegValue );
+
+    // Clear all DMA registers
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x00, 0 );
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x04, 0 );
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x08, 0 );
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x0C, 0 );
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x10, 0 );
+
+    // Descriptor ring address
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x14, PLX_64_LOW_32(SglPciAddress) );
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x18, PLX_64_HIGH_32(SglPciAddress) );
+
+    // Current descriptor address
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x1C, PLX_64_LOW_32(SglPciAddress) );
+
+    // Descriptor ring size
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x20, NumDescriptors );
+
+    // Current descriptor transfer size
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x28, 0 );
+
+    // Disable invalid descriptor interrupt (x3C[1])
+    RegValue = PLX_DMA_REG_READ( pdx, OffsetDmaBase + 0x3C );
+    RegValue &= ~(1 << 1);
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x3C, RegValue );
+
+    // Get DMA control/status
+    RegValue = PLX_DMA_REG_READ( pdx, OffsetDmaBase + 0x38 );
+
+    // Make sure descriptor write-back ([2]) is disabled
+    RegValue &= ~(1 << 2);
+
+    // Clear any active status bits ([31,12:8])
+    RegValue |= ((1 << 31) | (0x1F << 8));
+
+    // Enable SGL off-chip mode & descriptor fetch stops at end
+    if (pdx->Key.PlxFamily == PLX_FAMILY_SIRIUS)
+    {
+        RegValue |= (1 << 5) | (1 << 4);        // SGL mode (4) & descriptor halt mode (5)
+    }
+    else
+    {
+        RegValue &= ~(3 << 5);
+        RegValue |= (2 << 5) | (1 << 4);        // SGL mode ([6:5]) & descriptor halt mode (4)
+    }
+
+    DebugPrintf(("Start DMA transfer...\n"));
+
+    // Start DMA (x38[3])
+    PLX_DMA_REG_WRITE( pdx, OffsetDmaBase + 0x38, RegValue | (1 << 3) );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionSignal
+ *
+ * Description:  Wake any threads waiting for a DMA channel to complete
+ *
+ ******************************************************************************/
+VOID
+PlxDmaCompletionSignal(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U64           Time_ns;
+    unsigned long flags;
+
+
+    Time_ns = ktime_to_ns( ktime_get() );
+
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+    // Record hardware time of the transfer
+    PlxDmaStatsHistAdd(
+        pdx->DmaInfo[channel].Stats.Hist_Hardware,
+        pdx->DmaInfo[channel].StartTime_ns,
+        Time_ns
+        );
+
+    pdx->DmaInfo[channel].StartTime_ns = 0;
+    pdx->DmaInfo[channel].DoneTime_ns  = Time_ns;
+
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+
+    pdx->DmaInfo[channel].DoneCount++;
+
+    wake_up_interruptible(
+        &(pdx->DmaInfo[channel].WaitDone)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionPost
+ *
+ * Description:  Append a record to the completion ring of the DMA channel owner
+ *
+ ******************************************************************************/
+VOID
+PlxDmaCompletionPost(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount,
+    PLX_STATUS        status
+    )
+{
+    unsigned long            flags;
+    struct list_head        *pEntry;
+    PLX_DMA_COMPLETION      *pRecord;
+    PLX_PHYS_MEM_OBJECT     *pMemObject;
+    PLX_DMA_COMPLETION_RING *pRing;
+
+
+    if (status != PLX_STATUS_OK)
+    {
+        spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+        pdx->DmaInfo[channel].Stats.Errors++;
+        spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+    }
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Find the ring of the channel owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        pMemObject =
+            list_entry(
+                pEntry,
+                PLX_PHYS_MEM_OBJECT,
+                ListEntry
+                );
+
+        if (pMemObject->pOwner == pdx->DmaInfo[channel].pOwner)
+        {
+            pRing = (PLX_DMA_COMPLETION_RING*)pMemObject->pKernelVa;
+
+            // Drop record if application has not drained the ring
+            if ((pRing->Head - pRing->Tail) >= PLX_DMA_COMPLETION_RING_SIZE)
+            {
+                pRing->DropCount++;
+            }
+            else
+            {
+                pRecord =
+                    &pRing->Entry[pRing->Head & (PLX_DMA_COMPLETION_RING_SIZE - 1)];
+
+                pRecord->Timestamp_ns = ktime_to_ns( ktime_get() );
+                pRecord->ByteCount    = ByteCount;
+                pRecord->Status       = status;
+                pRecord->Channel      = channel;
+
+                // Ensure record is visible before it is published
+                wmb();
+
+                pRing->Head++;
+            }
+            break;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionWait
+ *
+ * Description:  Wait until the DMA completion count of a channel moves past
+ *               the provided value or the timeout expires
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaCompletionWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               DoneCount,
+    PLX_UINT_PTR      Timeout_ms
+    )
+{
+    U64           Time_ns;
+    long          Wait_rc;
+    unsigned long flags;
+
+
+    // Convert to jiffies in 2 steps to minimize overflow
+    if (Timeout_ms != PLX_TIMEOUT_INFINITE)
+    {
+        Timeout_ms = ((Timeout_ms / 1000) * HZ) + Plx_ms_to_jiffies( Timeout_ms % 1000 );
+    }
+
+    // Timeout parameter is signed and can't be negative
+    if ((signed long)Timeout_ms < 0)
+    {
+        Timeout_ms = Timeout_ms >> 1;
+    }
+
+    do
+    {
+        Wait_rc =
+            wait_event_interruptible_timeout(
+                pdx->DmaInfo[channel].WaitDone,
+                (pdx->DmaInfo[channel].DoneCount != DoneCount),
+                Timeout_ms
+                );
+    }
+    while ((Wait_rc == 0) && (Timeout_ms == PLX_TIMEOUT_INFINITE));
+
+    if (Wait_rc > 0)
+    {
+        Time_ns = ktime_to_ns( ktime_get() );
+
+        spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+        // Record delay from DMA done interrupt until the waiter runs
+        PlxDmaStatsHistAdd(
+            pdx->DmaInfo[channel].Stats.Hist_Wakeup,
+            pdx->DmaInfo[channel].DoneTime_ns,
+            Time_ns
+            );
+
+        spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+
+        return PLX_STATUS_OK;
+    }
+
+    if (Wait_rc == 0)
+    {
+        DebugPrintf(("Timeout waiting for DMA completion\n"));
+
+        spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+        pdx->DmaInfo[channel].Stats.Timeouts++;
+        spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+
+        return PLX_STATUS_TIMEOUT;
+    }
+
+    DebugPrintf(("DMA completion wait interrupted by signal\n"));
+    return PLX_STATUS_CANCELED;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaQueueFlush
+ *
+ * Description:  Remove all transfers waiting in a DMA channel queue & unlock
+ *               their buffers. A transfer already in progress is not affected.
+ *
+ ******************************************************************************/
+VOID
+PlxDmaQueueFlush(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U8                   i;
+    U8                   count;
+    PLX_DMA_QUEUE_ENTRY *pFlush[DMA_MAX_QUEUE_ENTRIES];
+
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Detach waiting entries so the DPC can no longer start them
+    count = pdx->DmaInfo[channel].QueueCount;
+
+    for (i = 0; i < count; i++)
+    {
+        pFlush[i] =
+            pdx->DmaInfo[channel].pQueueFifo[
+                (pdx->DmaInfo[channel].QueueHead + i) % DMA_MAX_QUEUE_ENTRIES];
+    }
+
+    pdx->DmaInfo[channel].QueueHead  = 0;
+    pdx->DmaInfo[channel].QueueCount = 0;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (count != 0)
+    {
+        DebugPrintf(("Flush %d queued DMA transfers\n", count));
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        PlxSglRelease(
+            pdx,
+            &pFlush[i]->Sgl
+            );
+
+        pFlush[i]->bInUse = FALSE;
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaQueueReleaseAll
+ *
+ * Description:  Flush a DMA channel queue & release its SGL descriptor memory
+ *
+ ******************************************************************************/
+VOID
+PlxDmaQueueReleaseAll(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U8 i;
+
+
+    PlxDmaQueueFlush(
+        pdx,
+        channel
+        );
+
+    for (i = 0; i < DMA_MAX_QUEUE_ENTRIES; i++)
+    {
+        if (pdx->DmaInfo[channel].Queue[i].Sgl.SglBuffer.pKernelVa != NULL)
+        {
+            Plx_dma_buffer_free(
+                pdx,
+                &pdx->DmaInfo[channel].Queue[i].Sgl.SglBuffer
+                );
+        }
+
+        RtlZeroMemory(
+            &pdx->DmaInfo[channel].Queue[i],
+            sizeof(PLX_DMA_QUEUE_ENTRY)
+            );
+    }
+
+    pdx->DmaInfo[channel].pQueueActive   = NULL;
+    pdx->DmaInfo[channel].QueueCompleted = 0;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsHistAdd
+ *
+ * Description:  Add a latency sample to a log2 histogram
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsHistAdd(
+    U32 *pHist,
+    U64  Start_ns,
+    U64  End_ns
+    )
+{
+    U32 bucket;
+
+
+    // Ignore samples without a valid start time
+    if ((Start_ns == 0) || (End_ns < Start_ns))
+    {
+        return;
+    }
+
+    // Bucket N holds samples in the range [2^(N-1), 2^N) ns
+    bucket = fls64( End_ns - Start_ns );
+
+    // Last bucket also collects any larger samples
+    if (bucket >= PLX_DMA_STATS_HIST_BUCKETS)
+    {
+        bucket = PLX_DMA_STATS_HIST_BUCKETS - 1;
+    }
+
+    pHist[bucket]++;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsStart
+ *
+ * Description:  Account for a DMA transfer started on a channel
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount
+    )
+{
+    U64           Time_ns;
+    unsigned long flags;
+
+
+    Time_ns = ktime_to_ns( ktime_get() );
+
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+    pdx->DmaInfo[channel].Stats.Transfers++;
+    pdx->DmaInfo[channel].Stats.Bytes  += ByteCount;
+    pdx->DmaInfo[channel].StartTime_ns  = Time_ns;
+    pdx->DmaInfo[channel].DoneTime_ns   = 0;
+
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsSetup
+ *
+ * Description:  Account for the result of locking a user buffer & building
+ *               its SGL
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsSetup(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Start_ns,
+    PLX_DMA_SGL      *pSgl,
+    PLX_STATUS        status
+    )
+{
+    U64           Time_ns;
+    unsigned long flags;
+
+
+    Time_ns = ktime_to_ns( ktime_get() );
+
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+    if (status != PLX_STATUS_OK)
+    {
+        pdx->DmaInfo[channel].Stats.Errors++;
+    }
+    else
+    {
+        // Registered buffers re-use an existing SGL
+        if (pSgl != NULL)
+        {
+            pdx->DmaInfo[channel].Stats.PagesPinned += pSgl->NumPages;
+            pdx->DmaInfo[channel].Stats.Descriptors += pSgl->NumDescriptors;
+        }
+
+        PlxDmaStatsHistAdd(
+            pdx->DmaInfo[channel].Stats.Hist_Setup,
+            Start_ns,
+            Time_ns
+            );
+    }
+
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsGet
+ *
+ * Description:  Return a snapshot of the statistics of a DMA channel
+ *
+ * Note       :  Either parameter may be NULL/FALSE to only read or only reset
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsGet(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_STATS    *pStats,
+    BOOLEAN           bReset
+    )
+{
+    unsigned long flags;
+
+
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+    if (pStats != NULL)
+    {
+        *pStats = pdx->DmaInfo[channel].Stats;
+    }
+
+    if (bReset)
+    {
+        RtlZeroMemory(
+            &(pdx->DmaInfo[channel].Stats),
+            sizeof(PLX_DMA_STATS)
+            );
+    }
+
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+}
+
+
+
+#if defined(PLX_DEBUGFS)
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsShow
+ *
+ * Description:  Print the statistics of all DMA channels to a debugfs file
+ *
+ ******************************************************************************/
+static int
+PlxDmaStatsDebugFsShow(
+    struct seq_file *pSeq,
+    void            *pData
+    )
+{
+    U8                channel;
+    U32               bucket;
+    PLX_DMA_STATS     Stats;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = pSeq->private;
+
+    for (channel = 0; channel < pdx->NumDmaChannels; channel++)
+    {
+        PlxDmaStatsGet(
+            pdx,
+            channel,
+            &Stats,
+            FALSE
+            );
+
+        seq_printf(pSeq, "Channel %d\n", channel);
+        seq_printf(pSeq, "  Transfers  : %llu\n", (unsigned long long)Stats.Transfers);
+        seq_printf(pSeq, "  Bytes      : %llu\n", (unsigned long long)Stats.Bytes);
+        seq_printf(pSeq, "  Pages      : %llu\n", (unsigned long long)Stats.PagesPinned);
+        seq_printf(pSeq, "  Descriptors: %llu\n", (unsigned long long)Stats.Descriptors);
+        seq_printf(pSeq, "  Errors     : %llu\n", (unsigned long long)Stats.Errors);
+        seq_printf(pSeq, "  Timeouts   : %llu\n", (unsigned long long)Stats.Timeouts);
+        seq_printf(pSeq, "  Latency (ns)      Setup   Hardware     Wakeup\n");
+
+        // Only list buckets holding samples
+        for (bucket = 0; bucket < PLX_DMA_STATS_HIST_BUCKETS; bucket++)
+        {
+            if ((Stats.Hist_Setup[bucket] == 0) &&
+                (Stats.Hist_Hardware[bucket] == 0) &&
+                (Stats.Hist_Wakeup[bucket] == 0))
+            {
+                continue;
+            }
+
+            seq_printf(
+                pSeq,
+                "  %s %10llu %10u %10u %10u\n",
+                (bucket == (PLX_DMA_STATS_HIST_BUCKETS - 1)) ? ">=" : "< ",
+                (unsigned long long)1 <<
+                    ((bucket == (PLX_DMA_STATS_HIST_BUCKETS - 1)) ? (bucket - 1) : bucket),
+                Stats.Hist_Setup[bucket],
+                Stats.Hist_Hardware[bucket],
+                Stats.Hist_Wakeup[bucket]
+                );
+        }
+    }
+
+    return 0;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsOpen
+ *
+ * Description:  Open the debugfs statistics file
+ *
+ ******************************************************************************/
+static int
+PlxDmaStatsDebugFsOpen(
+    struct inode *inode,
+    struct file  *filp
+    )
+{
+    return single_open(
+        filp,
+        PlxDmaStatsDebugFsShow,
+        inode->i_private
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsResetOpen
+ *
+ * Description:  Open the debugfs statistics reset file
+ *
+ ******************************************************************************/
+static int
+PlxDmaStatsDebugFsResetOpen(
+    struct inode *inode,
+    struct file  *filp
+    )
+{
+    filp->private_data = inode->i_private;
+
+    return 0;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsReset
+ *
+ * Description:  Clear the statistics of all DMA channels on any write
+ *
+ ******************************************************************************/
+static ssize_t
+PlxDmaStatsDebugFsReset(
+    struct file       *filp,
+    const char __user *pBuffer,
+    size_t             count,
+    loff_t            *pOffset
+    )
+{
+    U8                channel;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = filp->private_data;
+
+    for (channel = 0; channel < pdx->NumDmaChannels; channel++)
+    {
+        PlxDmaStatsGet(
+            pdx,
+            channel,
+            NULL,
+            TRUE
+            );
+    }
+
+    return count;
+}
+
+
+static const struct file_operations PlxDmaStatsFops =
+{
+    .owner   = THIS_MODULE,
+    .open    = PlxDmaStatsDebugFsOpen,
+    .read    = seq_read,
+    .llseek  = seq_lseek,
+    .release = single_release,
+};
+
+
+static const struct file_operations PlxDmaStatsResetFops =
+{
+    .owner   = THIS_MODULE,
+    .open    = PlxDmaStatsDebugFsResetOpen,
+    .write   = PlxDmaStatsDebugFsReset,
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsCreate
+ *
+ * Description:  Create the debugfs directory & statistics files of a device
+ *
+ * Note       :  Failure is not fatal, the device just has no debugfs entries
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsDebugFsCreate(
+    DEVICE_EXTENSION *pdx,
+    struct dentry    *pRoot
+    )
+{
+    struct dentry *pDir;
+
+
+    pdx->pDebugFsDir = NULL;
+
+    if ((pRoot == NULL) || IS_ERR(pRoot))
+    {
+        return;
+    }
+
+    // Name directory after the PCI location of the device
+    pDir =
+        debugfs_create_dir(
+            pci_name( pdx->pPciDevice ),
+            pRoot
+            );
+
+    if ((pDir == NULL) || IS_ERR(pDir))
+    {
+        DebugPrintf(("ERROR - Unable to create debugfs directory\n"));
+        return;
+    }
+
+    debugfs_create_file(
+        "dma_stats",
+        S_IRUGO,
+        pDir,
+        pdx,
+        &PlxDmaStatsFops
+        );
+
+    debugfs_create_file(
+        "dma_stats_reset",
+        S_IWUSR,
+        pDir,
+        pdx,
+        &PlxDmaStatsResetFops
+        );
+
+    pdx->pDebugFsDir = pDir;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsRemove
+ *
+ * Description:  Remove the debugfs directory of a device
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsDebugFsRemove(
+    DEVICE_EXTENSION *pdx
+    )
+{
+    if (pdx->pDebugFsDir != NULL)
+    {
+        debugfs_remove_recursive( pdx->pDebugFsDir );
+        pdx->pDebugFsDir = NULL;
+    }
+}
+
+#endif  // PLX_DEBUGFS
+
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  Plx_dev_mem_to_user_8
@@ -138,6 +138,106 @@ PlxLockBufferAndBuildSgl(
     U32              *pNumDescr
     );
 
+PLX_STATUS
+PlxSglBuild(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_PARAMS   *pDma,
+    PLX_DMA_SGL      *pSgl,
+    U64              *pSglAddress
+    );
+
+VOID
+PlxSglRelease(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_SGL      *pSgl
+    );
+
+VOID
+PlxDmaSglStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               SglPciAddress,
+    U32               NumDescriptors
+    );
+
+VOID
+PlxDmaQueueFlush(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaQueueReleaseAll(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaCompletionSignal(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaCompletionPost(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount,
+    PLX_STATUS        status
+    );
+
+PLX_STATUS
+PlxDmaCompletionWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               DoneCount,
+    PLX_UINT_PTR      Timeout_ms
+    );
+
+VOID
+PlxDmaStatsHistAdd(
+    U32 *pHist,
+    U64  Start_ns,
+    U64  End_ns
+    );
+
+VOID
+PlxDmaStatsStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount
+    );
+
+VOID
+PlxDmaStatsSetup(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Start_ns,
+    PLX_DMA_SGL      *pSgl,
+    PLX_STATUS        status
+    );
+
+VOID
+PlxDmaStatsGet(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_STATS    *pStats,
+    BOOLEAN           bReset
+    );
+
+#if defined(PLX_DEBUGFS)
+VOID
+PlxDmaStatsDebugFsCreate(
+    DEVICE_EXTENSION *pdx,
+    struct dentry    *pRoot
+    );
+
+VOID
+PlxDmaStatsDebugFsRemove(
+    DEVICE_EXTENSION *pdx
+    );
+#endif
+
 void
 Plx_dev_mem_to_user_8(
     U8            *VaUser,
@@ -48,6 +48,7 @@
  ******************************************************************************/
 
 
+#include <linux/delay.h>    // For udelay()
 #include <linux/uaccess.h>  // For copy_to/from_user()
 #include <linux/sched.h>    // For MAX_SCHED_TIMEOUT & TASK_UNINTERRUPTIBLE
 #include "ApiFunc.h"
@@ -55,6 +56,7 @@
 #include "PciFunc.h"
 #include "PciRegs.h"
 #include "PlxInterrupt.h"
+#include "PlxRegBatch.h"
 #include "SuppFunc.h"
 
 
@@ -495,6 +497,185 @@ PlxRegisterWrite(
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchRead
+ *
+ * Description:  Register batch accessor to read a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchRead(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32  *pValue
+    )
+{
+    PLX_STATUS        status;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterRead_UseOS( pdx->pPciDevice, (U16)offset, pValue );
+    }
+
+    *pValue =
+        PlxRegisterRead(
+            pdx,
+            offset,
+            &status,
+            (Space == PLX_REG_BATCH_SPACE_PLX)
+            );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchWrite
+ *
+ * Description:  Register batch accessor to write a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchWrite(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   value
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterWrite_UseOS( pdx->pPciDevice, (U16)offset, value );
+    }
+
+    return PlxRegisterWrite(
+        pdx,
+        offset,
+        value,
+        (Space == PLX_REG_BATCH_SPACE_PLX)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchModify
+ *
+ * Description:  Register batch accessor to modify bits of a PLX register
+ *               synchronized with the ISR
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchModify(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   BitsToSet,
+    U32   BitsToClear
+    )
+{
+    PLX_REG_DATA      RegData;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    // Adjust the offset for correct port
+    if (Space == PLX_REG_BATCH_SPACE_PLX)
+    {
+        offset += pdx->Offset_RegBase;
+    }
+
+    // Verify offset
+    if ((offset & 0x3) || (offset >= pdx->PciBar[0].Properties.Size))
+    {
+        DebugPrintf(("ERROR - Invalid register offset (%X)\n", offset));
+        return PLX_STATUS_INVALID_OFFSET;
+    }
+
+    // For Draco 1, some register cause problems if accessed
+    if (pdx->Key.PlxFamily == PLX_FAMILY_DRACO_1)
+    {
+        if ((offset == 0x856C)  || (offset == 0x8570) ||
+            (offset == 0x1056C) || (offset == 0x10570))
+        {
+            return PLX_STATUS_OK;
+        }
+    }
+
+    RegData.pdx         = pdx;
+    RegData.offset      = offset;
+    RegData.BitsToSet   = BitsToSet;
+    RegData.BitsToClear = BitsToClear;
+
+    PlxSynchronizedRegisterModify( &RegData );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+// Register accessors for batch operations
+static const PLX_REG_BATCH_OPS PlxRegBatchOps =
+{
+    .RegRead   = PlxRegBatchRead,
+    .RegWrite  = PlxRegBatchWrite,
+    .RegModify = PlxRegBatchModify,
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegisterBatch
+ *
+ * Description:  Executes a sequence of register accesses from a user array,
+ *               returning read values in the array
+ *
+ * Note       :  Processing stops at the first failed entry. Batches are
+ *               serialized so that a sequence is not interleaved with
+ *               another batch.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    )
+{
+    return PlxRegBatchExecute(
+        &PlxRegBatchOps,
+        pdx,
+        &(pdx->Mutex_RegBatch),
+        pUserEntries,
+        Count,
+        pCountDone
+        );
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  PlxMailboxRead
@@ -260,6 +260,8 @@ typedef struct _DEVICE_EXTENSION
     struct list_head       List_WaitObjects;              // List of registered notification objects
     spinlock_t             Lock_WaitObjectsList;          // Spinlock for notification objects list
 
+    struct semaphore       Mutex_RegBatch;                // Serializes register batch sequences
+
     struct list_head       List_PhysicalMem;              // List of user-allocated physical memory
     spinlock_t             Lock_PhysicalMemList;          // Spinlock for physical memory list
 
@@ -200,6 +200,13 @@ OnInterrupt(
     if (pdx->State != PLX_STATE_STARTED)
         return IRQ_RETVAL(IRQ_HANDLED);
 
+#if defined(PLX_THREADED_IRQ)
+    // Flag a DPC is pending
+    pdx->bDpcPending = TRUE;
+
+    // Wake the IRQ thread to run the DPC
+    return IRQ_WAKE_THREAD;
+#else
     // Add task to system work queue
     schedule_work(
         &(pdx->Task_DpcForIsr)
@@ -208,8 +215,42 @@ OnInterrupt(
     // Flag a DPC is pending
     pdx->bDpcPending = TRUE;
 
+    return IRQ_RETVAL(IRQ_HANDLED);
+#endif
+}
+
+
+
+
+#if defined(PLX_THREADED_IRQ)
+/*******************************************************************************
+ *
+ * Function   :  OnInterruptThread
+ *
+ * Description:  IRQ thread handler, which runs the DPC at real-time priority
+ *               instead of deferring it to the shared system work queue
+ *
+ ******************************************************************************/
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    // Get the device extension
+    pdx = (DEVICE_EXTENSION *)dev_id;
+
+    // DPC locates the device extension from its work item
+    DpcForIsr(
+        &(pdx->Task_DpcForIsr)
+        );
+
     return IRQ_RETVAL(IRQ_HANDLED);
 }
+#endif
 
 
 
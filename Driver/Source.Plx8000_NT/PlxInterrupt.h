@@ -83,6 +83,14 @@ OnInterrupt(
   #endif
     );
 
+#if defined(PLX_THREADED_IRQ)
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    );
+#endif
+
 VOID
 DpcForIsr(
     PLX_DPC_PARAM *pArg1
@@ -48,6 +48,7 @@
  ******************************************************************************/
 
 
+#include <linux/delay.h>    // For udelay()
 #include <linux/uaccess.h>  // For copy_to/from_user()
 #include <linux/sched.h>    // For MAX_SCHED_TIMEOUT & TASK_UNINTERRUPTIBLE
 #include "ApiFunc.h"
@@ -57,6 +58,7 @@
 #include "PlxChipApi.h"
 #include "PlxChipFn.h"
 #include "PlxInterrupt.h"
+#include "PlxRegBatch.h"
 #include "SuppFunc.h"
 
 
@@ -290,10 +292,19 @@ PlxPciDeviceReset(
     DEVICE_EXTENSION *pdx
     )
 {
+    PLX_STATUS status;
+
+
     // Call chip-specific function
-    return PlxChip_BoardReset(
-        pdx
-        );
+    status =
+        PlxChip_BoardReset(
+            pdx
+            );
+
+    // Reset reloads remap registers, so refresh cached windows
+    atomic_inc( &(pdx->RemapGeneration) );
+
+    return status;
 }
 
 
@@ -351,6 +362,9 @@ PlxRegisterWrite(
     BOOLEAN           bAdjustForPort
     )
 {
+    unsigned long flags;
+
+
     // Verify offset
     if ((offset & 0x3) || (offset >= pdx->PciBar[0].Properties.Size))
     {
@@ -358,14 +372,198 @@ PlxRegisterWrite(
         return PLX_STATUS_INVALID_OFFSET;
     }
 
+    /*************************************************
+     * Applications with direct register access send
+     * writes to registers also modified by the ISR
+     * here, so synchronize the write with the ISR.
+     ************************************************/
+    spin_lock_irqsave( &(pdx->Lock_Isr), flags );
+
     PLX_9000_REG_WRITE( pdx, offset, value );
 
+    spin_unlock_irqrestore( &(pdx->Lock_Isr), flags );
+
+    // Cached remap windows must be refreshed if a space may have moved
+    if (PLX_REG_AFFECTS_REMAP(offset))
+    {
+        atomic_inc( &(pdx->RemapGeneration) );
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchRead
+ *
+ * Description:  Register batch accessor to read a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchRead(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32  *pValue
+    )
+{
+    PLX_STATUS        status;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterRead_UseOS( pdx->pPciDevice, (U16)offset, pValue );
+    }
+
+    *pValue =
+        PlxRegisterRead(
+            pdx,
+            offset,
+            &status,
+            (Space == PLX_REG_BATCH_SPACE_PLX)
+            );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchWrite
+ *
+ * Description:  Register batch accessor to write a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchWrite(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   value
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterWrite_UseOS( pdx->pPciDevice, (U16)offset, value );
+    }
+
+    return PlxRegisterWrite(
+        pdx,
+        offset,
+        value,
+        (Space == PLX_REG_BATCH_SPACE_PLX)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchModify
+ *
+ * Description:  Register batch accessor to modify bits of a PLX register
+ *               synchronized with the ISR
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchModify(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   BitsToSet,
+    U32   BitsToClear
+    )
+{
+    PLX_REG_DATA      RegData;
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx = (DEVICE_EXTENSION*)pContext;
+
+    // Verify offset
+    if ((offset & 0x3) || (offset >= pdx->PciBar[0].Properties.Size))
+    {
+        DebugPrintf(("ERROR - Invalid register offset (%X)\n", offset));
+        return PLX_STATUS_INVALID_OFFSET;
+    }
+
+    RegData.pdx         = pdx;
+    RegData.offset      = offset;
+    RegData.BitsToSet   = BitsToSet;
+    RegData.BitsToClear = BitsToClear;
+
+    PlxSynchronizedRegisterModify( &RegData );
+
+    // Cached remap windows must be refreshed if a space may have moved
+    if (PLX_REG_AFFECTS_REMAP(offset))
+    {
+        atomic_inc( &(pdx->RemapGeneration) );
+    }
+
     return PLX_STATUS_OK;
 }
 
 
 
 
+// Register accessors for batch operations
+static const PLX_REG_BATCH_OPS PlxRegBatchOps =
+{
+    .RegRead   = PlxRegBatchRead,
+    .RegWrite  = PlxRegBatchWrite,
+    .RegModify = PlxRegBatchModify,
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegisterBatch
+ *
+ * Description:  Executes a sequence of register accesses from a user array,
+ *               returning read values in the array
+ *
+ * Note       :  Processing stops at the first failed entry. Batches are
+ *               serialized so that a sequence is not interleaved with
+ *               another batch.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    )
+{
+    return PlxRegBatchExecute(
+        &PlxRegBatchOps,
+        pdx,
+        &(pdx->Mutex_RegBatch),
+        pUserEntries,
+        Count,
+        pCountDone
+        );
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  PlxPciBarProperties
@@ -1248,6 +1446,61 @@ PlxInterruptDisable(
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxInterruptCoalesceSet
+ *
+ * Description:  Configures moderation of DMA done & doorbell notifications
+ *
+ * Note       :  Notifications are batched until MaxEvents interrupts occur or
+ *               MaxDelay_us elapses after the first one, whichever is first.
+ *               A MaxEvents of 0 or 1 disables moderation.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxInterruptCoalesceSet(
+    DEVICE_EXTENSION *pdx,
+    U32               MaxEvents,
+    U32               MaxDelay_us
+    )
+{
+    unsigned long flags;
+
+
+    // A delay limit is required so a batch is never held indefinitely
+    if ((MaxEvents > 1) &&
+        ((MaxDelay_us == 0) || (MaxDelay_us > PLX_COALESCE_MAX_DELAY_US)))
+    {
+        DebugPrintf(("ERROR - Invalid interrupt moderation delay (%dus)\n", MaxDelay_us));
+        return PLX_STATUS_INVALID_DATA;
+    }
+
+    spin_lock_irqsave( &(pdx->Lock_Coalesce), flags );
+
+    pdx->Coalesce_MaxEvents   = MaxEvents;
+    pdx->Coalesce_MaxDelay_us = MaxDelay_us;
+
+    spin_unlock_irqrestore( &(pdx->Lock_Coalesce), flags );
+
+    DebugPrintf((
+        "Interrupt moderation %s (events=%d delay=%dus)\n",
+        (MaxEvents > 1) ? "enabled" : "disabled",
+        MaxEvents, MaxDelay_us
+        ));
+
+    // Release any batch collected under the previous settings
+    hrtimer_cancel( &(pdx->Timer_Coalesce) );
+
+    PlxCoalesceFlush(
+        pdx
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  PlxNotificationRegisterFor
@@ -1263,14 +1516,15 @@ PlxNotificationRegisterFor(
     VOID              *pOwner
     )
 {
+    int              Handle;
     unsigned long    flags;
     PLX_WAIT_OBJECT *pWaitObject;
 
 
     // Allocate a new wait object
     pWaitObject =
-        kmalloc(
-            sizeof(PLX_WAIT_OBJECT),
+        kmem_cache_alloc(
+            pGbl_DriverObject->pCache_WaitObject,
             GFP_KERNEL
             );
 
@@ -1280,15 +1534,18 @@ PlxNotificationRegisterFor(
         return PLX_STATUS_INSUFFICIENT_RES;
     }
 
-    // Provide the wait object to the user app
-    *pUserWaitObject = pWaitObject;
-
     // Record the owner
     pWaitObject->pOwner = pOwner;
 
     // Mark the object as waiting
     pWaitObject->state = PLX_STATE_WAITING;
 
+    // No eventfd bound by default
+    pWaitObject->pEventFd = NULL;
+
+    // Object not yet signaled by any DPC pass
+    pWaitObject->SignalSeq = 0;
+
     // Clear number of sleeping threads
     atomic_set( &pWaitObject->SleepCount, 0 );
 
@@ -1305,15 +1562,50 @@ PlxNotificationRegisterFor(
         pWaitObject
         );
 
-    // Add to list of waiting objects
+    // Reserve memory for handle allocation, which is done under spinlock
+    Plx_idr_preload(
+        &(pdx->Idr_WaitObjects),
+        GFP_KERNEL
+        );
+
     spin_lock_irqsave(
         &(pdx->Lock_WaitObjectsList),
         flags
         );
 
-    list_add_tail(
-        &(pWaitObject->ListEntry),
-        &(pdx->List_WaitObjects)
+    // Assign a handle, starting at 1 since 0 is never a valid object
+    Handle =
+        Plx_idr_alloc(
+            &(pdx->Idr_WaitObjects),
+            pWaitObject,
+            1
+            );
+
+    if (Handle < 0)
+    {
+        spin_unlock_irqrestore(
+            &(pdx->Lock_WaitObjectsList),
+            flags
+            );
+
+        Plx_idr_preload_end();
+
+        DebugPrintf(("ERROR - Unable to assign handle for interrupt wait object\n"));
+
+        kmem_cache_free(
+            pGbl_DriverObject->pCache_WaitObject,
+            pWaitObject
+            );
+
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    pWaitObject->Handle = Handle;
+
+    // Add to list of waiting objects & to each interrupt source list
+    PlxWaitObjectLink(
+        pdx,
+        pWaitObject
         );
 
     spin_unlock_irqrestore(
@@ -1321,9 +1613,14 @@ PlxNotificationRegisterFor(
         flags
         );
 
+    Plx_idr_preload_end();
+
+    // Provide the wait object handle to the user app
+    *pUserWaitObject = (VOID*)(PLX_UINT_PTR)Handle;
+
     DebugPrintf((
-        "Registered interrupt wait object (%p)\n",
-        pWaitObject
+        "Registered interrupt wait object (%p) as handle %d\n",
+        pWaitObject, Handle
         ));
 
     return PLX_STATUS_OK;
@@ -1350,149 +1647,135 @@ PlxNotificationWait(
     PLX_STATUS        rc;
     PLX_UINT_PTR      Timeout_sec;
     unsigned long     flags;
-    struct list_head *pEntry;
     PLX_WAIT_OBJECT  *pWaitObject;
 
 
-    // Find the wait object in the list
     spin_lock_irqsave(
         &(pdx->Lock_WaitObjectsList),
         flags
         );
 
-    pEntry = pdx->List_WaitObjects.next;
+    // Find the wait object
+    pWaitObject =
+        PlxWaitObjectFind(
+            pdx,
+            pUserWaitObject
+            );
 
-    // Find the wait object and wait for wake-up event
-    while (pEntry != &(pdx->List_WaitObjects))
+    if (pWaitObject == NULL)
     {
-        // Get the wait object
-        pWaitObject =
-            list_entry(
-                pEntry,
-                PLX_WAIT_OBJECT,
-                ListEntry
-                );
-
-        // Check if the object address matches the Tag
-        if (pWaitObject == pUserWaitObject)
-        {
-            spin_unlock_irqrestore(
-                &(pdx->Lock_WaitObjectsList),
-                flags
-                );
+        spin_unlock_irqrestore(
+            &(pdx->Lock_WaitObjectsList),
+            flags
+            );
 
-            DebugPrintf((
-                "Waiting for Interrupt wait object (%p) to wake-up\n",
-                pWaitObject
-                ));
-
-            /*********************************************************
-             * Convert milliseconds to jiffies.  The following
-             * formula is used:
-             *
-             *                      ms * HZ
-             *           jiffies = ---------
-             *                       1,000
-             *
-             *
-             *  where:  HZ      = System-defined clock ticks per second
-             *          ms      = Timeout in milliseconds
-             *          jiffies = Number of HZ's per second
-             *
-             *  Note: Since the timeout is stored as a "long" integer,
-             *        the conversion to jiffies is split into two operations.
-             *        The first is on number of seconds and the second on
-             *        the remaining millisecond precision.  This mimimizes
-             *        overflow when the specified timeout is large and also
-             *        keeps millisecond precision.
-             ********************************************************/
-
-            // Perform conversion if not infinite wait
-            if (Timeout_ms != PLX_TIMEOUT_INFINITE)
-            {
-                // Get number of seconds
-                Timeout_sec = Timeout_ms / 1000;
+        DebugPrintf((
+            "Interrupt wait object (%p) not found or previously canceled\n",
+            pUserWaitObject
+            ));
 
-                // Store milliseconds precision
-                Timeout_ms = Timeout_ms - (Timeout_sec * 1000);
+        return PLX_STATUS_FAILED;
+    }
 
-                // Convert to jiffies
-                Timeout_sec = Timeout_sec * HZ;
-                Timeout_ms  = (Timeout_ms * HZ) / 1000;
+    // Count sleeping thread before releasing lock so object isn't freed
+    atomic_inc( &pWaitObject->SleepCount );
 
-                // Compute total jiffies
-                Timeout_ms = Timeout_sec + Timeout_ms;
-            }
+    spin_unlock_irqrestore(
+        &(pdx->Lock_WaitObjectsList),
+        flags
+        );
 
-            // Timeout parameter is signed and can't be negative
-            if ((signed long)Timeout_ms < 0)
-            {
-                // Shift out negative bit
-                Timeout_ms = Timeout_ms >> 1;
-            }
+    DebugPrintf((
+        "Waiting for Interrupt wait object (%p) to wake-up\n",
+        pWaitObject
+        ));
 
-            // Increment number of sleeping threads
-            atomic_inc( &pWaitObject->SleepCount );
+    /*********************************************************
+     * Convert milliseconds to jiffies.  The following
+     * formula is used:
+     *
+     *                      ms * HZ
+     *           jiffies = ---------
+     *                       1,000
+     *
+     *
+     *  where:  HZ      = System-defined clock ticks per second
+     *          ms      = Timeout in milliseconds
+     *          jiffies = Number of HZ's per second
+     *
+     *  Note: Since the timeout is stored as a "long" integer,
+     *        the conversion to jiffies is split into two operations.
+     *        The first is on number of seconds and the second on
+     *        the remaining millisecond precision.  This mimimizes
+     *        overflow when the specified timeout is large and also
+     *        keeps millisecond precision.
+     ********************************************************/
+
+    // Perform conversion if not infinite wait
+    if (Timeout_ms != PLX_TIMEOUT_INFINITE)
+    {
+        // Get number of seconds
+        Timeout_sec = Timeout_ms / 1000;
 
-            do
-            {
-                // Wait for interrupt event
-                Wait_rc =
-                    wait_event_interruptible_timeout(
-                        pWaitObject->WaitQueue,
-                        (pWaitObject->state != PLX_STATE_WAITING),
-                        Timeout_ms
-                        );
-            }
-            while ((Wait_rc == 0) && (Timeout_ms == PLX_TIMEOUT_INFINITE));
+        // Store milliseconds precision
+        Timeout_ms = Timeout_ms - (Timeout_sec * 1000);
 
-            if (Wait_rc > 0)
-            {
-                // Condition met or interrupt occurred
-                DebugPrintf(("Interrupt wait object awakened\n"));
-                rc = PLX_STATUS_OK;
-            }
-            else if (Wait_rc == 0)
-            {
-                // Timeout reached
-                DebugPrintf(("Timeout waiting for interrupt\n"));
-                rc = PLX_STATUS_TIMEOUT;
-            }
-            else
-            {
-                // Interrupted by a signal
-                DebugPrintf(("Interrupt wait object interrupted by signal or error\n"));
-                rc = PLX_STATUS_CANCELED;
-            }
+        // Convert to jiffies
+        Timeout_sec = Timeout_sec * HZ;
+        Timeout_ms  = (Timeout_ms * HZ) / 1000;
 
-            // If object is in triggered state, rest to waiting state
-            if (pWaitObject->state == PLX_STATE_TRIGGERED)
-            {
-                pWaitObject->state = PLX_STATE_WAITING;
-            }
+        // Compute total jiffies
+        Timeout_ms = Timeout_sec + Timeout_ms;
+    }
 
-            // Decrement number of sleeping threads
-            atomic_dec( &pWaitObject->SleepCount );
+    // Timeout parameter is signed and can't be negative
+    if ((signed long)Timeout_ms < 0)
+    {
+        // Shift out negative bit
+        Timeout_ms = Timeout_ms >> 1;
+    }
 
-            return rc;
-        }
+    do
+    {
+        // Wait for interrupt event
+        Wait_rc =
+            wait_event_interruptible_timeout(
+                pWaitObject->WaitQueue,
+                (pWaitObject->state != PLX_STATE_WAITING),
+                Timeout_ms
+                );
+    }
+    while ((Wait_rc == 0) && (Timeout_ms == PLX_TIMEOUT_INFINITE));
 
-        // Jump to next item in the list
-        pEntry = pEntry->next;
+    if (Wait_rc > 0)
+    {
+        // Condition met or interrupt occurred
+        DebugPrintf(("Interrupt wait object awakened\n"));
+        rc = PLX_STATUS_OK;
+    }
+    else if (Wait_rc == 0)
+    {
+        // Timeout reached
+        DebugPrintf(("Timeout waiting for interrupt\n"));
+        rc = PLX_STATUS_TIMEOUT;
+    }
+    else
+    {
+        // Interrupted by a signal
+        DebugPrintf(("Interrupt wait object interrupted by signal or error\n"));
+        rc = PLX_STATUS_CANCELED;
     }
 
-    spin_unlock_irqrestore(
-        &(pdx->Lock_WaitObjectsList),
-        flags
-        );
+    // If object is in triggered state, rest to waiting state
+    if (pWaitObject->state == PLX_STATE_TRIGGERED)
+    {
+        pWaitObject->state = PLX_STATE_WAITING;
+    }
 
-    DebugPrintf((
-        "Interrupt wait object (%p) not found or previously canceled\n",
-        pUserWaitObject
-        ));
+    // Decrement number of sleeping threads
+    atomic_dec( &pWaitObject->SleepCount );
 
-    // Object not found at this point
-    return PLX_STATUS_FAILED;
+    return rc;
 }
 
 
@@ -1513,7 +1796,6 @@ PlxNotificationStatus(
     )
 {
     unsigned long       flags;
-    struct list_head   *pEntry;
     PLX_WAIT_OBJECT    *pWaitObject;
     PLX_INTERRUPT_DATA  IntData;
 
@@ -1523,59 +1805,48 @@ PlxNotificationStatus(
         flags
         );
 
-    pEntry = pdx->List_WaitObjects.next;
+    // Find the wait object
+    pWaitObject =
+        PlxWaitObjectFind(
+            pdx,
+            pUserWaitObject
+            );
 
-    // Traverse list to find the desired list object
-    while (pEntry != &(pdx->List_WaitObjects))
+    if (pWaitObject == NULL)
     {
-        // Get the object
-        pWaitObject =
-            list_entry(
-                pEntry,
-                PLX_WAIT_OBJECT,
-                ListEntry
-                );
+        spin_unlock_irqrestore(
+            &(pdx->Lock_WaitObjectsList),
+            flags
+            );
 
-        // Check if desired object
-        if (pWaitObject == pUserWaitObject)
-        {
-            // Copy the interrupt sources
-            IntData.Source_Ints     = pWaitObject->Source_Ints;
-            IntData.Source_Doorbell = pWaitObject->Source_Doorbell;
+        return PLX_STATUS_FAILED;
+    }
 
-            // Reset interrupt sources
-            pWaitObject->Source_Ints     = INTR_TYPE_NONE;
-            pWaitObject->Source_Doorbell = 0;
+    // Copy the interrupt sources
+    IntData.Source_Ints     = pWaitObject->Source_Ints;
+    IntData.Source_Doorbell = pWaitObject->Source_Doorbell;
 
-            spin_unlock_irqrestore(
-                &(pdx->Lock_WaitObjectsList),
-                flags
-                );
-
-            DebugPrintf((
-                "Returning status for interrupt wait object (%p)...\n",
-                pWaitObject
-                ));
-
-            // Set triggered interrupts
-            PlxChipSetInterruptStatusFlags(
-                &IntData,
-                pPlxIntr
-                );
-
-            return PLX_STATUS_OK;
-        }
-
-        // Jump to next item in the list
-        pEntry = pEntry->next;
-    }
+    // Reset interrupt sources
+    pWaitObject->Source_Ints     = INTR_TYPE_NONE;
+    pWaitObject->Source_Doorbell = 0;
 
     spin_unlock_irqrestore(
         &(pdx->Lock_WaitObjectsList),
         flags
         );
 
-    return PLX_STATUS_FAILED;
+    DebugPrintf((
+        "Returning status for interrupt wait object (%p)...\n",
+        pWaitObject
+        ));
+
+    // Set triggered interrupts
+    PlxChipSetInterruptStatusFlags(
+        &IntData,
+        pPlxIntr
+        );
+
+    return PLX_STATUS_OK;
 }
 
 
@@ -1595,8 +1866,6 @@ PlxNotificationCancel(
     VOID             *pOwner
     )
 {
-    U32               LoopCount;
-    BOOLEAN           bRemove;
     unsigned long     flags;
     struct list_head *pEntry;
     PLX_WAIT_OBJECT  *pWaitObject;
@@ -1607,9 +1876,46 @@ PlxNotificationCancel(
         flags
         );
 
+    // Remove a specific object
+    if (pUserWaitObject != NULL)
+    {
+        pWaitObject =
+            PlxWaitObjectFind(
+                pdx,
+                pUserWaitObject
+                );
+
+        if ((pWaitObject == NULL) || (pWaitObject->pOwner != pOwner))
+        {
+            spin_unlock_irqrestore(
+                &(pdx->Lock_WaitObjectsList),
+                flags
+                );
+
+            return PLX_STATUS_FAILED;
+        }
+
+        // Remove the object from all lists
+        PlxWaitObjectUnlink(
+            pdx,
+            pWaitObject
+            );
+
+        spin_unlock_irqrestore(
+            &(pdx->Lock_WaitObjectsList),
+            flags
+            );
+
+        PlxWaitObjectRelease(
+            pWaitObject
+            );
+
+        return PLX_STATUS_OK;
+    }
+
     pEntry = pdx->List_WaitObjects.next;
 
-    // Find the object and remove it
+    // Remove all objects owned by the caller
     while (pEntry != &(pdx->List_WaitObjects))
     {
         // Get the object
@@ -1620,100 +1926,133 @@ PlxNotificationCancel(
                 ListEntry
                 );
 
-        // Default to not remove
-        bRemove = FALSE;
-
-        // Determine if object should be removed
-        if (pOwner == pWaitObject->pOwner)
-        {
-            if (pUserWaitObject == NULL)
-            {
-                bRemove = TRUE;
-            }
-            else if (pWaitObject == pUserWaitObject)
-            {
-                bRemove = TRUE;
-            }
-        }
-
-        // Remove object
-        if (bRemove)
+        if (pWaitObject->pOwner == pOwner)
         {
-            DebugPrintf((
-                "Remove interrupt wait object (%p)...\n",
+            // Remove the object from all lists
+            PlxWaitObjectUnlink(
+                pdx,
                 pWaitObject
-                ));
-
-            // Remove the object from the list
-            list_del( pEntry );
+                );
 
             spin_unlock_irqrestore(
                 &(pdx->Lock_WaitObjectsList),
                 flags
                 );
 
-            // Set loop count
-            LoopCount = 20;
+            PlxWaitObjectRelease(
+                pWaitObject
+                );
+
+            // Reset to beginning of list
+            spin_lock_irqsave(
+                &(pdx->Lock_WaitObjectsList),
+                flags
+                );
+
+            pEntry = pdx->List_WaitObjects.next;
+        }
+        else
+        {
+            // Jump to next item in the list
+            pEntry = pEntry->next;
+        }
+    }
 
-            // Wake-up processes if wait object is pending
-            if (atomic_read(&pWaitObject->SleepCount) != 0)
-            {
-                DebugPrintf(("Wait object is pending in another thread, forcing wake up\n"));
+    spin_unlock_irqrestore(
+        &(pdx->Lock_WaitObjectsList),
+        flags
+        );
 
-                // Mark object for deletion
-                pWaitObject->state = PLX_STATE_MARKED_FOR_DELETE;
+    return PLX_STATUS_FAILED;
+}
 
-                // Wake-up any process waiting on the object
-                wake_up_interruptible(
-                    &(pWaitObject->WaitQueue)
-                    );
 
-                do
-                {
-                    // Set current task as uninterruptible
-                    set_current_state(TASK_UNINTERRUPTIBLE);
 
-                    // Relieve timeslice to allow pending thread to wake up
-                    schedule_timeout( Plx_ms_to_jiffies( 10 ) );
 
-                    // Decrement counter
-                    LoopCount--;
-                }
-                while (LoopCount && (atomic_read(&pWaitObject->SleepCount) != 0));
-            }
+/*******************************************************************************
+ *
+ * Function   :  PlxNotificationEventFdBind
+ *
+ * Description:  Binds a user eventfd to a registered notification object
+ *
+ * Note       :  The eventfd is signaled each time the object is triggered, in
+ *               addition to waking threads waiting on the object.  A negative
+ *               descriptor removes any existing binding.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxNotificationEventFdBind(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pUserWaitObject,
+    int               EventFd,
+    VOID             *pOwner
+    )
+{
+#if defined(PLX_EVENTFD_SUPPORT)
+    unsigned long       flags;
+    PLX_WAIT_OBJECT    *pWaitObject;
+    struct eventfd_ctx *pEventFd;
+    struct eventfd_ctx *pEventFdOld;
 
 
-            if (LoopCount == 0)
-            {
-                DebugPrintf(("ERROR: Timeout waiting for pending thread, unable to free wait object\n"));
-            }
-            else
-            {
-                // Release the list object
-                kfree(
-                    pWaitObject
-                    );
-            }
+    // Get a reference to the eventfd
+    pEventFd = NULL;
+
+    if (EventFd >= 0)
+    {
+        pEventFd = eventfd_ctx_fdget( EventFd );
+
+        if (IS_ERR(pEventFd))
+        {
+            DebugPrintf(("ERROR - Descriptor (%d) is not a valid eventfd\n", EventFd));
+            return PLX_STATUS_INVALID_DATA;
+        }
+    }
+
+    spin_lock_irqsave(
+        &(pdx->Lock_WaitObjectsList),
+        flags
+        );
+
+    // Find the wait object
+    pWaitObject =
+        PlxWaitObjectFind(
+            pdx,
+            pUserWaitObject
+            );
+
+    if ((pWaitObject != NULL) && (pWaitObject->pOwner == pOwner))
+    {
+        // Replace any previous binding
+        pEventFdOld           = pWaitObject->pEventFd;
+        pWaitObject->pEventFd = pEventFd;
 
-            // Return if removing only a specific object
-            if (pUserWaitObject != NULL)
+        // Signal immediately if notifications are already pending
+        if (pEventFd != NULL)
+        {
+            if (pWaitObject->Source_Ints || pWaitObject->Source_Doorbell)
             {
-                return PLX_STATUS_OK;
+                Plx_eventfd_signal( pEventFd );
             }
+        }
 
-            // Reset to beginning of list
-            spin_lock_irqsave(
-                &(pdx->Lock_WaitObjectsList),
-                flags
-                );
+        spin_unlock_irqrestore(
+            &(pdx->Lock_WaitObjectsList),
+            flags
+            );
 
-            pEntry = pdx->List_WaitObjects.next;
-        }
-        else
+        DebugPrintf((
+            "%s eventfd for interrupt wait object (%p)\n",
+            (pEventFd == NULL) ? "Removed" : "Bound",
+            pWaitObject
+            ));
+
+        if (pEventFdOld != NULL)
         {
-            // Jump to next item in the list
-            pEntry = pEntry->next;
+            eventfd_ctx_put( pEventFdOld );
         }
+
+        return PLX_STATUS_OK;
     }
 
     spin_unlock_irqrestore(
@@ -1721,7 +2060,20 @@ PlxNotificationCancel(
         flags
         );
 
+    DebugPrintf((
+        "Interrupt wait object (%p) not found or previously canceled\n",
+        pUserWaitObject
+        ));
+
+    if (pEventFd != NULL)
+    {
+        eventfd_ctx_put( pEventFd );
+    }
+
     return PLX_STATUS_FAILED;
+#else
+    return PLX_STATUS_UNSUPPORTED;
+#endif
 }
 
 
@@ -1733,6 +2085,13 @@ PlxNotificationCancel(
  *
  * Description:  Accesses a PCI BAR space
  *
+ * Note       :  For local address transfers, the remap register is only
+ *               written when the target is outside the current window and is
+ *               left at the last window used.  The home window is restored
+ *               for offset transfers & whenever the BAR is mapped to user
+ *               space.  Transfers may not move a window locked with
+ *               PlxPciBarWindowLock.
+ *
  ******************************************************************************/
 PLX_STATUS
 PlxPciBarSpaceTransfer(
@@ -1746,13 +2105,14 @@ PlxPciBarSpaceTransfer(
     BOOLEAN           bReadOperation
     )
 {
-    U8  *pVaSpace;
-    U16  Offset_RegRemap;
-    U32  RegValue;
-    U32  SpaceRange;
-    U32  SpaceOffset;
-    U32  RemapOriginal;
-    U32  BytesToTransfer;
+    U8               *pVaSpace;
+    BOOLEAN           bBurst;
+    PLX_STATUS        status;
+    U32               RegValue;
+    U32               SpaceRange;
+    U32               SpaceOffset;
+    U32               BytesToTransfer;
+    PLX_REMAP_WINDOW *pWindow;
 
 
     DebugPrintf((
@@ -1764,9 +2124,6 @@ PlxPciBarSpaceTransfer(
         ByteCount
         ));
 
-    // Added to prevent compiler warnings
-    RemapOriginal = 0;
-
     // Verify data alignment
     switch (AccessType)
     {
@@ -1801,28 +2158,57 @@ PlxPciBarSpaceTransfer(
             }
             break;
 
+        case BitSize64:
+#if !defined(PLX_MMIO_64)
+            // Platform can't perform 64-bit accesses to I/O memory
+            DebugPrintf(("ERROR - 64-bit accesses not supported\n"));
+            return PLX_STATUS_INVALID_ACCESS;
+#else
+            if (offset & 0x7)
+            {
+                DebugPrintf(("ERROR - Local address not aligned\n"));
+                return PLX_STATUS_INVALID_ADDR;
+            }
+
+            if (ByteCount & 0x7)
+            {
+                DebugPrintf(("ERROR - Byte count not aligned\n"));
+                return PLX_STATUS_INVALID_SIZE;
+            }
+            break;
+#endif
+
         default:
             DebugPrintf(("ERROR - Invalid access type\n"));
             return PLX_STATUS_INVALID_ACCESS;
     }
 
-    // Get offset of remap register
-    PlxChipGetRemapOffset(
-        pdx,
-        BarIndex,
-        &Offset_RegRemap
-        );
-
-    if (Offset_RegRemap == (U16)-1)
+    if (BarIndex >= PCI_NUM_BARS_TYPE_00)
     {
         return PLX_STATUS_INVALID_ACCESS;
     }
 
+    // Transfers share the bounce page & the remap window state
+    if (down_interruptible( &(pdx->Mutex_BarSpace) ) < 0)
+    {
+        return PLX_STATUS_CANCELED;
+    }
+
+    // Get remap window state, which also verifies the BAR is a local space
+    pWindow = PlxRemapWindowGet( pdx, BarIndex );
+
+    if (pWindow == NULL)
+    {
+        status = PLX_STATUS_INVALID_ACCESS;
+        goto _Exit_PlxPciBarSpaceTransfer;
+    }
+
     // Only memory spaces are supported by this function
     if (pdx->PciBar[BarIndex].Properties.Flags & PLX_BAR_FLAG_IO)
     {
         DebugPrintf(("ERROR - I/O spaces not supported by this function\n"));
-        return PLX_STATUS_INVALID_ACCESS;
+        status = PLX_STATUS_INVALID_ACCESS;
+        goto _Exit_PlxPciBarSpaceTransfer;
     }
 
     // Get kernel virtual address for the space
@@ -1831,26 +2217,70 @@ PlxPciBarSpaceTransfer(
     if (pVaSpace == NULL)
     {
         DebugPrintf(("ERROR - Invalid kernel VA (%p) for PCI BAR\n", pVaSpace));
-        return PLX_STATUS_INVALID_ADDR;
+        status = PLX_STATUS_INVALID_ADDR;
+        goto _Exit_PlxPciBarSpaceTransfer;
+    }
+
+    // Make sure requested area doesn't exceed our local space window boundary
+    if ((bRemap == FALSE) &&
+        ((offset + ByteCount) > (U32)pdx->PciBar[BarIndex].Properties.Size))
+    {
+        DebugPrintf(("ERROR - requested area exceeds space range\n"));
+        status = PLX_STATUS_INVALID_SIZE;
+        goto _Exit_PlxPciBarSpaceTransfer;
+    }
+
+    // Get the range of the space
+    SpaceRange = ~((U32)pdx->PciBar[BarIndex].Properties.Size - 1);
+
+    // Offsets are relative to the home window
+    if ((bRemap == FALSE) && (pWindow->RegValue != pWindow->RegHome))
+    {
+        PLX_9000_REG_WRITE(
+            pdx,
+            pWindow->Offset_RegRemap,
+            pWindow->RegHome
+            );
+
+        pWindow->RegValue = pWindow->RegHome;
+    }
+
+    // A locked window may not be moved
+    if (bRemap && (pWindow->pOwnerLock != NULL) && (ByteCount != 0))
+    {
+        if (((offset & SpaceRange) != (pWindow->RegValue & SpaceRange)) ||
+            (((offset + ByteCount - 1) & SpaceRange) != (pWindow->RegValue & SpaceRange)))
+        {
+            DebugPrintf(("ERROR - Local address outside of locked window\n"));
+            status = PLX_STATUS_IN_USE;
+            goto _Exit_PlxPciBarSpaceTransfer;
+        }
     }
 
-    // Save the remap register
-    if (bRemap)
+    // Prefetchable spaces allow the CPU to combine accesses into bursts
+    if (pdx->PciBar[BarIndex].Properties.Flags & PLX_BAR_FLAG_PREFETCHABLE)
     {
-        RemapOriginal = PLX_9000_REG_READ( pdx, Offset_RegRemap );
+        bBurst = TRUE;
     }
     else
     {
-        // Make sure requested area doesn't exceed our local space window boundary
-        if ((offset + ByteCount) > (U32)pdx->PciBar[BarIndex].Properties.Size)
+        bBurst = FALSE;
+    }
+
+    // Allocate bounce page on first use
+    if (pdx->pBarBounce == NULL)
+    {
+        pdx->pBarBounce = (U8*)__get_free_page( GFP_KERNEL );
+
+        if (pdx->pBarBounce == NULL)
         {
-            DebugPrintf(("ERROR - requested area exceeds space range\n"));
-            return PLX_STATUS_INVALID_SIZE;
+            ErrorPrintf(("ERROR - Unable to allocate BAR transfer bounce page\n"));
+            status = PLX_STATUS_INSUFFICIENT_RES;
+            goto _Exit_PlxPciBarSpaceTransfer;
         }
     }
 
-    // Get the range of the space
-    SpaceRange = ~((U32)pdx->PciBar[BarIndex].Properties.Size - 1);
+    status = PLX_STATUS_OK;
 
     // Transfer data in blocks
     while (ByteCount != 0)
@@ -1859,16 +2289,22 @@ PlxPciBarSpaceTransfer(
         if (bRemap)
         {
             // Clear upper bits of remap
-            RegValue = RemapOriginal & ~SpaceRange;
+            RegValue = pWindow->RegValue & ~SpaceRange;
 
             // Adjust window to local address
             RegValue |= offset & SpaceRange;
 
-            PLX_9000_REG_WRITE(
-                pdx,
-                Offset_RegRemap,
-                RegValue
-                );
+            // Skip the update if already in the window
+            if (RegValue != pWindow->RegValue)
+            {
+                PLX_9000_REG_WRITE(
+                    pdx,
+                    pWindow->Offset_RegRemap,
+                    RegValue
+                    );
+
+                pWindow->RegValue = RegValue;
+            }
         }
 
         // Get current offset into space
@@ -1895,7 +2331,8 @@ PlxPciBarSpaceTransfer(
                     ) == FALSE)
             {
                 DebugPrintf(("ERROR - User buffer not accessible\n"));
-                return PLX_STATUS_INSUFFICIENT_RES;
+                status = PLX_STATUS_INSUFFICIENT_RES;
+                goto _Exit_PlxPciBarSpaceTransfer;
             }
         }
         else
@@ -1908,77 +2345,41 @@ PlxPciBarSpaceTransfer(
                     ) == FALSE)
             {
                 DebugPrintf(("ERROR - User buffer not accessible\n"));
-                return PLX_STATUS_INSUFFICIENT_RES;
+                status = PLX_STATUS_INSUFFICIENT_RES;
+                goto _Exit_PlxPciBarSpaceTransfer;
             }
         }
 
         if (bReadOperation)
         {
             // Copy block to user buffer
-            switch (AccessType)
-            {
-                case BitSize8:
-                    DEV_MEM_TO_USER_8(
-                        pBuffer,
-                        (pVaSpace + SpaceOffset),
-                        BytesToTransfer
-                        );
-                    break;
-
-                case BitSize16:
-                    DEV_MEM_TO_USER_16(
-                        pBuffer,
-                        (pVaSpace + SpaceOffset),
-                        BytesToTransfer
-                        );
-                    break;
-
-                case BitSize32:
-                    DEV_MEM_TO_USER_32(
-                        pBuffer,
-                        (pVaSpace + SpaceOffset),
-                        BytesToTransfer
-                        );
-                    break;
-
-                case BitSize64:
-                    // 64-bit not implemented yet
-                    break;
-            }
+            status =
+                Plx_dev_mem_to_user(
+                    pBuffer,
+                    (pVaSpace + SpaceOffset),
+                    BytesToTransfer,
+                    AccessType,
+                    bBurst,
+                    pdx->pBarBounce
+                    );
         }
         else
         {
             // Copy user buffer to device memory
-            switch (AccessType)
-            {
-                case BitSize8:
-                    USER_TO_DEV_MEM_8(
-                        (pVaSpace + SpaceOffset),
-                        pBuffer,
-                        BytesToTransfer
-                        );
-                    break;
-
-                case BitSize16:
-                    USER_TO_DEV_MEM_16(
-                        (pVaSpace + SpaceOffset),
-                        pBuffer,
-                        BytesToTransfer
-                        );
-                    break;
-
-                case BitSize32:
-                    USER_TO_DEV_MEM_32(
-                        (pVaSpace + SpaceOffset),
-                        pBuffer,
-                        BytesToTransfer
-                        );
-                    break;
+            status =
+                Plx_user_to_dev_mem(
+                    (pVaSpace + SpaceOffset),
+                    pBuffer,
+                    BytesToTransfer,
+                    AccessType,
+                    bBurst,
+                    pdx->pBarBounce
+                    );
+        }
 
-                case BitSize64:
-                    // 64-bit not implemented yet
-                    break;
-            }
+        if (status != PLX_STATUS_OK)
+        {
+            goto _Exit_PlxPciBarSpaceTransfer;
         }
 
         // Adjust for next block access
@@ -1987,17 +2388,12 @@ PlxPciBarSpaceTransfer(
         ByteCount -= BytesToTransfer;
     }
 
-    // Restore the remap register
-    if (bRemap)
-    {
-        PLX_9000_REG_WRITE(
-            pdx,
-            Offset_RegRemap,
-            RemapOriginal
-            );
-    }
+_Exit_PlxPciBarSpaceTransfer:
 
-    return PLX_STATUS_OK;
+    // Restores home window of mapped spaces
+    PlxBarSpaceRelease( pdx );
+
+    return status;
 }
 
 
@@ -2005,17 +2401,154 @@ PlxPciBarSpaceTransfer(
 
 /*******************************************************************************
  *
- * Function   :  PlxPciVpdRead
+ * Function   :  PlxPciBarWindowLock
  *
- * Description:  Read the Vital Product Data
+ * Description:  Moves a local space window to a local address & locks it
+ *
+ * Note       :  While locked, local address transfers outside the window fail
+ *               instead of moving it, so a sequence of accesses, including
+ *               those through a user mapping of the BAR, stays in the window.
+ *               The owner may lock again to move the window.
  *
  ******************************************************************************/
 PLX_STATUS
-PlxPciVpdRead(
+PlxPciBarWindowLock(
     DEVICE_EXTENSION *pdx,
-    U16               offset,
-    U32              *pValue
-    )
+    U8                BarIndex,
+    U32               LocalAddress,
+    VOID             *pOwner
+    )
+{
+    U32               RegValue;
+    U32               SpaceRange;
+    PLX_STATUS        status;
+    PLX_REMAP_WINDOW *pWindow;
+
+
+    if (BarIndex >= PCI_NUM_BARS_TYPE_00)
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if (down_interruptible( &(pdx->Mutex_BarSpace) ) < 0)
+    {
+        return PLX_STATUS_CANCELED;
+    }
+
+    status = PLX_STATUS_OK;
+
+    pWindow = PlxRemapWindowGet( pdx, BarIndex );
+
+    if ((pWindow == NULL) ||
+        (pdx->PciBar[BarIndex].Properties.Flags & PLX_BAR_FLAG_IO) ||
+        (pdx->PciBar[BarIndex].Properties.Size == 0))
+    {
+        status = PLX_STATUS_INVALID_ACCESS;
+        goto _Exit_PlxPciBarWindowLock;
+    }
+
+    if ((pWindow->pOwnerLock != NULL) && (pWindow->pOwnerLock != pOwner))
+    {
+        DebugPrintf(("ERROR - BAR %d window locked by another owner\n", BarIndex));
+        status = PLX_STATUS_IN_USE;
+        goto _Exit_PlxPciBarWindowLock;
+    }
+
+    // Get the range of the space
+    SpaceRange = ~((U32)pdx->PciBar[BarIndex].Properties.Size - 1);
+
+    // Move window to local address
+    RegValue = (pWindow->RegValue & ~SpaceRange) | (LocalAddress & SpaceRange);
+
+    if (RegValue != pWindow->RegValue)
+    {
+        PLX_9000_REG_WRITE(
+            pdx,
+            pWindow->Offset_RegRemap,
+            RegValue
+            );
+
+        pWindow->RegValue = RegValue;
+    }
+
+    // BAR mappings & offset transfers now use the locked window
+    pWindow->RegHome    = RegValue;
+    pWindow->pOwnerLock = pOwner;
+
+    DebugPrintf((
+        "Locked BAR %d window at local %08X\n",
+        BarIndex, (RegValue & SpaceRange)
+        ));
+
+_Exit_PlxPciBarWindowLock:
+
+    PlxBarSpaceRelease( pdx );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarWindowUnlock
+ *
+ * Description:  Releases a local space window locked by the owner
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPciBarWindowUnlock(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex,
+    VOID             *pOwner
+    )
+{
+    PLX_STATUS status;
+
+
+    if (BarIndex >= PCI_NUM_BARS_TYPE_00)
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if (down_interruptible( &(pdx->Mutex_BarSpace) ) < 0)
+    {
+        return PLX_STATUS_CANCELED;
+    }
+
+    if (pdx->RemapWindow[BarIndex].pOwnerLock == pOwner)
+    {
+        pdx->RemapWindow[BarIndex].pOwnerLock = NULL;
+        status = PLX_STATUS_OK;
+    }
+    else
+    {
+        DebugPrintf(("ERROR - BAR %d window not locked by caller\n", BarIndex));
+        status = PLX_STATUS_INVALID_STATE;
+    }
+
+    PlxBarSpaceRelease( pdx );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciVpdRead
+ *
+ * Description:  Read the Vital Product Data
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPciVpdRead(
+    DEVICE_EXTENSION *pdx,
+    U16               offset,
+    U32              *pValue
+    )
 {
     S16 VpdRetries;
     S16 VpdPollCount;
@@ -2237,3 +2770,1686 @@ PlxPciVpdWrite(
 
     return PLX_STATUS_TIMEOUT;
 }
+
+
+
+
+#if defined(PLX_DMA_SUPPORT)
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaBufferRegister
+ *
+ * Description:  Page-lock a user buffer & build its SGL once so that it can
+ *               be re-used for multiple SGL DMA transfers
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaBufferRegister(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    U64              *pHandle,
+    VOID             *pOwner
+    )
+{
+    U8                  i;
+    U32                 SglPciAddress;
+    BOOLEAN             bBits64;
+    PLX_STATUS          status;
+    PLX_DMA_PROP        DmaProp;
+    PLX_DMA_REG_BUFFER *pRegBuffer;
+
+
+    // Default to invalid handle
+    *pHandle = 0;
+
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if ((pParams->UserVa == 0) || (pParams->ByteCount == 0))
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    pRegBuffer = NULL;
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        DebugPrintf(("ERROR - DMA channel not opened by caller\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Find a free entry
+    for (i = 0; i < DMA_MAX_REG_BUFFERS; i++)
+    {
+        if (pdx->DmaInfo[channel].RegBuffer[i].bInUse == FALSE)
+        {
+            pRegBuffer         = &pdx->DmaInfo[channel].RegBuffer[i];
+            pRegBuffer->bInUse = TRUE;
+            break;
+        }
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (pRegBuffer == NULL)
+    {
+        DebugPrintf(("ERROR - Max registered DMA buffers (%d) reached\n", DMA_MAX_REG_BUFFERS));
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    // Get current local address mode of the channel
+    PlxChip_DmaGetProperties(
+        pdx,
+        channel,
+        &DmaProp
+        );
+
+    // Page-lock user buffer & build SGL
+    status =
+        PlxSglBuild(
+            pdx,
+            pParams,
+            (BOOLEAN)DmaProp.ConstAddrLocal,
+            0,
+            &pRegBuffer->Sgl,
+            &SglPciAddress,
+            &bBits64
+            );
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (status == PLX_STATUS_OK)
+    {
+        // Buffer is now available for transfers
+        pRegBuffer->bReady = TRUE;
+    }
+    else
+    {
+        // Free the entry
+        RtlZeroMemory( pRegBuffer, sizeof(PLX_DMA_REG_BUFFER) );
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (status != PLX_STATUS_OK)
+    {
+        DebugPrintf(("ERROR - Unable to lock buffer and build SGL list\n"));
+        return status;
+    }
+
+    // Handle is 1-based entry index
+    *pHandle = i + 1;
+
+    DebugPrintf((
+        "Registered buffer %d (%d pages, %d descriptors)\n",
+        i + 1, pRegBuffer->Sgl.NumPages, pRegBuffer->Sgl.NumDescriptors
+        ));
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaBufferUnregister
+ *
+ * Description:  Unlock a previously registered user buffer
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaBufferUnregister(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Handle,
+    VOID             *pOwner
+    )
+{
+    PLX_DMA_REG_BUFFER *pRegBuffer;
+
+
+    // Verify DMA channel & handle
+    if ((channel >= NUM_DMA_CHANNELS) ||
+        (Handle == 0) || (Handle > DMA_MAX_REG_BUFFERS))
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    pRegBuffer = &pdx->DmaInfo[channel].RegBuffer[Handle - 1];
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if ((pdx->DmaInfo[channel].pOwner != pOwner) ||
+        (pRegBuffer->bReady == FALSE))
+    {
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Buffer may not be released while DMA is using it
+    if ((pRegBuffer->bBusy) ||
+        (pdx->DmaInfo[channel].pRegBufferActive == pRegBuffer))
+    {
+        DebugPrintf(("ERROR - Registered buffer in use by pending DMA\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_IN_PROGRESS;
+    }
+
+    // Prevent further use of the buffer
+    pRegBuffer->bReady = FALSE;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    DebugPrintf(("Unregister buffer %d\n", (U32)Handle));
+
+    PlxDmaRegBufferRelease(
+        pdx,
+        channel,
+        pRegBuffer
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaTransferRegBuffer
+ *
+ * Description:  Transfers part or all of a registered user buffer using SGL DMA
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferRegBuffer(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Handle,
+    U32               offset,
+    U32               ByteCount,
+    VOID             *pOwner
+    )
+{
+    PLX_STATUS          status;
+    PLX_DMA_SGL        *pSgl;
+    PLX_DMA_PARAMS      DmaParams;
+    PLX_DMA_REG_BUFFER *pRegBuffer;
+
+
+    // Verify DMA channel & handle
+    if ((channel >= NUM_DMA_CHANNELS) ||
+        (Handle == 0) || (Handle > DMA_MAX_REG_BUFFERS))
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    pRegBuffer = &pdx->DmaInfo[channel].RegBuffer[Handle - 1];
+    pSgl       = &pRegBuffer->Sgl;
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller & buffer is registered
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner) ||
+        (pRegBuffer->bReady == FALSE))
+    {
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if (pRegBuffer->bBusy)
+    {
+        DebugPrintf(("ERROR - Registered buffer transfer already being started\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_IN_PROGRESS;
+    }
+
+    // Transfer entire buffer if no size provided
+    if (ByteCount == 0)
+    {
+        ByteCount = pSgl->BufferSize - offset;
+    }
+
+    if ((offset >= pSgl->BufferSize) || (ByteCount > (pSgl->BufferSize - offset)))
+    {
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    RtlZeroMemory( &DmaParams, sizeof(PLX_DMA_PARAMS) );
+
+    // Describe the range using the registered buffer properties
+    DmaParams.UserVa    = pSgl->UserVa + offset;
+    DmaParams.ByteCount = ByteCount;
+
+    if (pSgl->bConstAddrLocal)
+    {
+        DmaParams.LocalAddr = pSgl->LocalAddr;
+    }
+    else
+    {
+        DmaParams.LocalAddr = pSgl->LocalAddr + offset;
+    }
+
+    if (pSgl->direction == DMA_FROM_DEVICE)
+    {
+        DmaParams.Direction = PLX_DMA_LOC_TO_PCI;
+    }
+    else
+    {
+        DmaParams.Direction = PLX_DMA_PCI_TO_LOC;
+    }
+
+    // Prevent the buffer from being unregistered until the transfer owns it
+    pRegBuffer->bBusy = TRUE;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Start the transfer, which will locate & re-use the registered SGL
+    status =
+        PlxChip_DmaTransferUserBuffer(
+            pdx,
+            channel,
+            &DmaParams,
+            pOwner
+            );
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    pRegBuffer->bBusy = FALSE;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaTransferQueue
+ *
+ * Description:  Submits a user buffer SGL transfer to the channel queue. The
+ *               transfer starts immediately if the channel is idle, otherwise
+ *               it is started by the DPC once prior transfers complete.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferQueue(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    VOID             *pOwner
+    )
+{
+    U8                   i;
+    U64                  Start_ns;
+    PLX_STATUS           status;
+    PLX_DMA_PROP         DmaProp;
+    PLX_DMA_QUEUE_ENTRY *pEntry;
+
+
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if ((pParams->UserVa == 0) || (pParams->ByteCount == 0))
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    pEntry = NULL;
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        DebugPrintf(("ERROR - DMA channel not opened by caller\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Find a free entry
+    for (i = 0; i < DMA_MAX_QUEUE_ENTRIES; i++)
+    {
+        if (pdx->DmaInfo[channel].Queue[i].bInUse == FALSE)
+        {
+            pEntry         = &pdx->DmaInfo[channel].Queue[i];
+            pEntry->bInUse = TRUE;
+            break;
+        }
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (pEntry == NULL)
+    {
+        DebugPrintf(("ERROR - DMA queue full (%d entries)\n", DMA_MAX_QUEUE_ENTRIES));
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    // Get current local address mode of the channel
+    PlxChip_DmaGetProperties(
+        pdx,
+        channel,
+        &DmaProp
+        );
+
+    Start_ns = ktime_to_ns( ktime_get() );
+
+    // Page-lock user buffer & build SGL
+    status =
+        PlxSglBuild(
+            pdx,
+            pParams,
+            (BOOLEAN)DmaProp.ConstAddrLocal,
+            0,
+            &pEntry->Sgl,
+            &pEntry->SglAddress,
+            &pEntry->bBits64
+            );
+
+    PlxDmaStatsSetup(
+        pdx,
+        channel,
+        Start_ns,
+        &pEntry->Sgl,
+        status
+        );
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (status != PLX_STATUS_OK)
+    {
+        DebugPrintf(("ERROR - Unable to lock buffer and build SGL list\n"));
+        pEntry->bInUse = FALSE;
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return status;
+    }
+
+    if (pdx->DmaInfo[channel].bSglPending == FALSE)
+    {
+        // A non-SGL transfer may still be using the channel
+        if (PlxChip_DmaStatus(
+                pdx,
+                channel,
+                pOwner
+                ) != PLX_STATUS_COMPLETE)
+        {
+            DebugPrintf(("ERROR - DMA channel is currently active\n"));
+            spin_unlock( &(pdx->Lock_Dma[channel]) );
+
+            PlxSglRelease(
+                pdx,
+                &pEntry->Sgl
+                );
+
+            pEntry->bInUse = FALSE;
+            return PLX_STATUS_IN_PROGRESS;
+        }
+
+        // Channel is idle, so start the transfer now
+        pdx->DmaInfo[channel].bSglPending    = TRUE;
+        pdx->DmaInfo[channel].pQueueActive   = pEntry;
+        pdx->DmaInfo[channel].NumDescriptors = pEntry->Sgl.NumDescriptors;
+
+        PlxDmaStatsStart(
+            pdx,
+            channel,
+            pEntry->Sgl.BufferSize
+            );
+
+        PlxChipDmaSglStart(
+            pdx,
+            channel,
+            pEntry->SglAddress,
+            pEntry->bBits64
+            );
+    }
+    else
+    {
+        DebugPrintf((
+            "Queue DMA transfer behind %d pending\n",
+            pdx->DmaInfo[channel].QueueCount + 1
+            ));
+
+        // Add to end of FIFO for DPC to start
+        pdx->DmaInfo[channel].pQueueFifo[
+            (pdx->DmaInfo[channel].QueueHead + pdx->DmaInfo[channel].QueueCount) %
+            DMA_MAX_QUEUE_ENTRIES] = pEntry;
+
+        pdx->DmaInfo[channel].QueueCount++;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaQueueStatus
+ *
+ * Description:  Returns the number of outstanding & completed queued transfers
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaQueueStatus(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32              *pNumPending,
+    U32              *pNumCompleted,
+    VOID             *pOwner
+    )
+{
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Include the queued transfer in progress
+    *pNumPending = pdx->DmaInfo[channel].QueueCount;
+
+    if (pdx->DmaInfo[channel].pQueueActive != NULL)
+    {
+        (*pNumPending)++;
+    }
+
+    *pNumCompleted = pdx->DmaInfo[channel].QueueCompleted;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaTransferWait
+ *
+ * Description:  Starts a block or user buffer DMA transfer & waits for it to
+ *               complete, avoiding a separate notification object & wait
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    BOOLEAN           bUserBuffer,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    )
+{
+    U32        DoneSeq;
+    PLX_STATUS status;
+
+
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Note completion sequence before start so an early completion is not missed
+    DoneSeq = PLX_DMA_NEXT_DONE_SEQ( pdx, channel );
+
+    // Striped transfers span both channels & wait for each
+    if (bUserBuffer && pParams->bStriped)
+    {
+        return PlxDmaTransferStriped(
+            pdx,
+            pParams,
+            Timeout_ms,
+            pOwner
+            );
+    }
+
+    if (bUserBuffer)
+    {
+        status =
+            PlxChip_DmaTransferUserBuffer(
+                pdx,
+                channel,
+                pParams,
+                pOwner
+                );
+    }
+    else
+    {
+        // DMA done interrupt is required to wake the caller
+        pParams->bIgnoreBlockInt = FALSE;
+
+        status =
+            PlxChip_DmaTransferBlock(
+                pdx,
+                channel,
+                pParams,
+                pOwner
+                );
+    }
+
+    if (status != PLX_STATUS_OK)
+    {
+        return status;
+    }
+
+    return PlxDmaCompletionWait(
+        pdx,
+        channel,
+        DoneSeq,
+        Timeout_ms
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaWaitDone
+ *
+ * Description:  Waits for the DMA transfer with the provided completion
+ *               sequence number to complete
+ *
+ * Note       :  Used by the API to fall back to the DMA done interrupt after
+ *               polling the channel status for a bounded time
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaWaitDone(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               DoneSeq,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    )
+{
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        DebugPrintf(("ERROR - DMA channel not opened by caller\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    return PlxDmaCompletionWait(
+        pdx,
+        channel,
+        DoneSeq,
+        Timeout_ms
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaTransferStriped
+ *
+ * Description:  Splits a user buffer transfer into two halves, each started
+ *               on its own DMA channel, to run both channels concurrently
+ *
+ * Note       :  Both channels must be opened by the caller.  If a timeout is
+ *               provided, waits until both halves complete.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferStriped(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_PARAMS   *pParams,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    )
+{
+    U8             channel;
+    U32            FirstSize;
+    U32            DoneSeq[2];
+    PLX_STATUS     status;
+    PLX_DMA_PROP   DmaProp;
+    PLX_DMA_PARAMS Stripe[2];
+
+
+    if ((pParams->UserVa == 0) || (pParams->ByteCount == 0))
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    for (channel = 0; channel < 2; channel++)
+    {
+        // Verify DMA channel was opened by the caller
+        if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+            (pdx->DmaInfo[channel].pOwner != pOwner))
+        {
+            DebugPrintf(("ERROR - Both DMA channels must be opened for striping\n"));
+            return PLX_STATUS_INVALID_ACCESS;
+        }
+
+        PlxChip_DmaGetProperties(
+            pdx,
+            channel,
+            &DmaProp
+            );
+
+        // Halves of a FIFO transfer would be interleaved out of order
+        if (DmaProp.ConstAddrLocal)
+        {
+            DebugPrintf(("ERROR - Striping not supported with constant local address\n"));
+            return PLX_STATUS_UNSUPPORTED;
+        }
+    }
+
+    // Split on a page boundary near the middle to keep descriptors whole
+    FirstSize =
+        (U32)((((PLX_UINT_PTR)pParams->UserVa + (pParams->ByteCount / 2) +
+                (PAGE_SIZE - 1)) & PAGE_MASK) - (PLX_UINT_PTR)pParams->UserVa);
+
+    if (FirstSize >= pParams->ByteCount)
+    {
+        FirstSize = (pParams->ByteCount / 2) & ~(U32)0x7;
+    }
+
+    // Buffer is too small to split
+    if (FirstSize == 0)
+    {
+        DebugPrintf(("Buffer too small to stripe, use channel 0 only\n"));
+        FirstSize = pParams->ByteCount;
+    }
+
+    Stripe[0]           = *pParams;
+    Stripe[0].ByteCount = FirstSize;
+    Stripe[0].bStriped  = 0;
+
+    Stripe[1]           = Stripe[0];
+    Stripe[1].UserVa    = pParams->UserVa + FirstSize;
+    Stripe[1].LocalAddr = pParams->LocalAddr + FirstSize;
+    Stripe[1].ByteCount = pParams->ByteCount - FirstSize;
+
+    DebugPrintf((
+        "Stripe %dB transfer as %dB on DMA 0 & %dB on DMA 1\n",
+        pParams->ByteCount, Stripe[0].ByteCount, Stripe[1].ByteCount
+        ));
+
+    // Note completion sequences before start so an early completion is not missed
+    DoneSeq[0] = PLX_DMA_NEXT_DONE_SEQ( pdx, 0 );
+    DoneSeq[1] = PLX_DMA_NEXT_DONE_SEQ( pdx, 1 );
+
+    // Mark both halves before either can complete
+    pdx->DmaInfo[0].bStriped        = (Stripe[1].ByteCount != 0);
+    pdx->DmaInfo[1].bStriped        = (Stripe[1].ByteCount != 0);
+    pdx->DmaInfo[0].StripeByteCount = pParams->ByteCount;
+    pdx->DmaInfo[1].StripeByteCount = pParams->ByteCount;
+
+    status =
+        PlxChip_DmaTransferUserBuffer(
+            pdx,
+            0,
+            &Stripe[0],
+            pOwner
+            );
+
+    if (status != PLX_STATUS_OK)
+    {
+        pdx->DmaInfo[0].bStriped = FALSE;
+        pdx->DmaInfo[1].bStriped = FALSE;
+        return status;
+    }
+
+    if (Stripe[1].ByteCount != 0)
+    {
+        status =
+            PlxChip_DmaTransferUserBuffer(
+                pdx,
+                1,
+                &Stripe[1],
+                pOwner
+                );
+
+        if (status != PLX_STATUS_OK)
+        {
+            DebugPrintf(("ERROR - Unable to start DMA 1, first half continues alone\n"));
+
+            // Let channel 0 report only its own half
+            pdx->DmaInfo[0].StripeByteCount = Stripe[0].ByteCount;
+            pdx->DmaInfo[1].bStriped        = FALSE;
+            return status;
+        }
+    }
+
+    if (Timeout_ms == 0)
+    {
+        return PLX_STATUS_OK;
+    }
+
+    status =
+        PlxDmaCompletionWait(
+            pdx,
+            0,
+            DoneSeq[0],
+            Timeout_ms
+            );
+
+    if ((status != PLX_STATUS_OK) || (Stripe[1].ByteCount == 0))
+    {
+        return status;
+    }
+
+    return PlxDmaCompletionWait(
+        pdx,
+        1,
+        DoneSeq[1],
+        Timeout_ms
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaTransferVector
+ *
+ * Description:  Page-locks an array of user buffers & chains their SGLs into a
+ *               single descriptor list, which completes as one DMA transfer
+ *
+ * Note       :  If a timeout is provided, waits for the transfer to complete
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaTransferVector(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_UINT_PTR      UserParams,
+    U32               count,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    )
+{
+    U8                   SizeDescr;
+    U32                  i;
+    U32                  offset;
+    U32                  DoneSeq;
+    U32                  ByteCount;
+    U32                  TotalPages;
+    U64                  Start_ns;
+    U32                  SglAddress;
+    U32                  ElemAddress;
+    U32                 *pLastDescr;
+    BOOLEAN              bBits64;
+    PLX_STATUS           status;
+    PLX_DMA_SGL         *pVector;
+    PLX_DMA_PROP         DmaProp;
+    PLX_DMA_PARAMS      *pParams;
+    PLX_PHYS_MEM_OBJECT  SglBuffer;
+
+
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if ((count == 0) || (count > DMA_MAX_VECTOR_ENTRIES))
+    {
+        DebugPrintf((
+            "ERROR - Vector must contain 1-%d buffers\n",
+            DMA_MAX_VECTOR_ENTRIES
+            ));
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        DebugPrintf(("ERROR - DMA channel not opened by caller\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    pVector = NULL;
+
+    RtlZeroMemory(
+        &SglBuffer,
+        sizeof(PLX_PHYS_MEM_OBJECT)
+        );
+
+    // Get a copy of the buffer descriptions
+    pParams =
+        kmalloc(
+            count * sizeof(PLX_DMA_PARAMS),
+            GFP_KERNEL
+            );
+
+    if (pParams == NULL)
+    {
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    if (copy_from_user(
+            pParams,
+            PLX_INT_TO_PTR(UserParams),
+            count * sizeof(PLX_DMA_PARAMS)
+            ) != 0)
+    {
+        status = PLX_STATUS_INVALID_ADDR;
+        goto _Exit_PlxDmaTransferVector;
+    }
+
+    // Determine worst-case number of descriptors, one per page
+    TotalPages = 0;
+    ByteCount  = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((pParams[i].UserVa == 0) || (pParams[i].ByteCount == 0))
+        {
+            DebugPrintf(("ERROR - Invalid buffer at vector index %d\n", i));
+            status = PLX_STATUS_INVALID_ADDR;
+            goto _Exit_PlxDmaTransferVector;
+        }
+
+        TotalPages +=
+            (U32)((((PLX_UINT_PTR)pParams[i].UserVa & ~PAGE_MASK) +
+                   pParams[i].ByteCount + (PAGE_SIZE - 1)) >> PAGE_SHIFT);
+
+        ByteCount += pParams[i].ByteCount;
+    }
+
+    pVector =
+        kmalloc(
+            count * sizeof(PLX_DMA_SGL),
+            GFP_KERNEL
+            );
+
+    if (pVector == NULL)
+    {
+        status = PLX_STATUS_INSUFFICIENT_RES;
+        goto _Exit_PlxDmaTransferVector;
+    }
+
+    RtlZeroMemory(
+        pVector,
+        count * sizeof(PLX_DMA_SGL)
+        );
+
+    // Descriptor size must match that chosen by the SGL builder
+    if (pdx->bDmaAddr64)
+    {
+        SizeDescr = 8 * sizeof(U32);
+    }
+    else
+    {
+        SizeDescr = 4 * sizeof(U32);
+    }
+
+    // Allocate a single descriptor buffer for the entire chain
+    SglBuffer.Size = (TotalPages * SizeDescr) + SizeDescr;
+
+    if (Plx_dma_buffer_alloc(
+            pdx,
+            &SglBuffer
+            ) == NULL)
+    {
+        DebugPrintf((
+            "ERROR - Unable to allocate %d bytes for %d SGL descriptors\n",
+            SglBuffer.Size, TotalPages
+            ));
+        status = PLX_STATUS_INSUFFICIENT_RES;
+        goto _Exit_PlxDmaTransferVector;
+    }
+
+    // Get current local address mode of the channel
+    PlxChip_DmaGetProperties(
+        pdx,
+        channel,
+        &DmaProp
+        );
+
+    DebugPrintf((
+        "Build vectored SGL for %d buffers (%dB total)...\n",
+        count, ByteCount
+        ));
+
+    offset     = 0;
+    SglAddress = 0;
+    pLastDescr = NULL;
+
+    for (i = 0; i < count; i++)
+    {
+        // Build each SGL in the unused part of the shared descriptor buffer
+        pVector[i].SglBuffer.pKernelVa   = (U8*)SglBuffer.pKernelVa + offset;
+        pVector[i].SglBuffer.BusPhysical = SglBuffer.BusPhysical + offset;
+        pVector[i].SglBuffer.Size        = SglBuffer.Size - offset;
+
+        Start_ns = ktime_to_ns( ktime_get() );
+
+        status =
+            PlxSglBuild(
+                pdx,
+                &pParams[i],
+                (BOOLEAN)DmaProp.ConstAddrLocal,
+                0,
+                &pVector[i],
+                &ElemAddress,
+                &bBits64
+                );
+
+        PlxDmaStatsSetup(
+            pdx,
+            channel,
+            Start_ns,
+            &pVector[i],
+            status
+            );
+
+        if (status != PLX_STATUS_OK)
+        {
+            DebugPrintf(("ERROR - Unable to lock buffer %d and build SGL list\n", i));
+            goto _Exit_PlxDmaTransferVector;
+        }
+
+        if (pLastDescr == NULL)
+        {
+            SglAddress = ElemAddress;
+        }
+        else
+        {
+            // Replace end-of-chain on previous buffer with link to this one
+            pLastDescr[SGL_DESC_IDX_NEXT_DESC] =
+                PLX_LE_DATA_32(
+                    ElemAddress |
+                    (PLX_LE_DATA_32(pLastDescr[SGL_DESC_IDX_NEXT_DESC]) & (1 << 3)) |
+                    (1 << 0)
+                    );
+        }
+
+        // Advance past descriptors used by this buffer
+        offset += pVector[i].NumDescriptors * SizeDescr;
+
+        pLastDescr = (U32*)((U8*)SglBuffer.pKernelVa + offset - SizeDescr);
+    }
+
+    // Flush descriptor updates before the DMA engine reads them
+    wmb();
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify the channel is idle
+    if ((pdx->DmaInfo[channel].bSglPending) ||
+        (PlxChip_DmaStatus(
+             pdx,
+             channel,
+             pOwner
+             ) != PLX_STATUS_COMPLETE))
+    {
+        DebugPrintf(("ERROR - DMA channel is currently active\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        status = PLX_STATUS_IN_PROGRESS;
+        goto _Exit_PlxDmaTransferVector;
+    }
+
+    // Hand over the SGLs for release by the DPC
+    pdx->DmaInfo[channel].bSglPending     = TRUE;
+    pdx->DmaInfo[channel].pVector         = pVector;
+    pdx->DmaInfo[channel].VectorCount     = count;
+    pdx->DmaInfo[channel].VectorByteCount = ByteCount;
+    pdx->DmaInfo[channel].VectorSglBuffer = SglBuffer;
+    pdx->DmaInfo[channel].NumDescriptors  = offset / SizeDescr;
+
+    // Note completion sequence before start so an early completion is not missed
+    DoneSeq = PLX_DMA_NEXT_DONE_SEQ( pdx, channel );
+
+    PlxDmaStatsStart(
+        pdx,
+        channel,
+        ByteCount
+        );
+
+    PlxChipDmaSglStart(
+        pdx,
+        channel,
+        SglAddress,
+        bBits64
+        );
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    kfree( pParams );
+
+    if (Timeout_ms == 0)
+    {
+        return PLX_STATUS_OK;
+    }
+
+    return PlxDmaCompletionWait(
+        pdx,
+        channel,
+        DoneSeq,
+        Timeout_ms
+        );
+
+_Exit_PlxDmaTransferVector:
+
+    if (pVector != NULL)
+    {
+        PlxSglVectorRelease(
+            pdx,
+            pVector,
+            count,
+            &SglBuffer
+            );
+    }
+
+    kfree( pParams );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaRingStart
+ *
+ * Description:  Starts continuous Local-to-PCI DMA into a user ring buffer
+ *               using a circular SGL, with an interrupt after each segment
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaRingStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    U32               SegmentSize,
+    U64              *pCtrlPhysical,
+    VOID             *pOwner
+    )
+{
+    U32                SglPciAddress;
+    BOOLEAN            bBits64;
+    PLX_STATUS         status;
+    PLX_DMA_PROP       DmaProp;
+    PLX_DMA_RING      *pRing;
+    PLX_DMA_RING_CTRL *pCtrl;
+
+
+    // Default to no control page
+    *pCtrlPhysical = 0;
+
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if ((pParams->UserVa == 0) || (pParams->ByteCount == 0))
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    // Only streaming from the local bus is supported
+    if (pParams->Direction != PLX_DMA_LOC_TO_PCI)
+    {
+        DebugPrintf(("ERROR - DMA ring only supports Local-to-PCI direction\n"));
+        return PLX_STATUS_UNSUPPORTED;
+    }
+
+    // Ring must be page-aligned & contain at least 2 whole segments of full pages
+    if ((pParams->UserVa & ~PAGE_MASK) ||
+        (SegmentSize == 0) || (SegmentSize & ~PAGE_MASK) ||
+        (pParams->ByteCount % SegmentSize) ||
+        ((pParams->ByteCount / SegmentSize) < 2))
+    {
+        DebugPrintf(("ERROR - Ring buffer or segment size not page-aligned\n"));
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    pRing = &pdx->DmaInfo[channel].Ring;
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner))
+    {
+        DebugPrintf(("ERROR - DMA channel not opened by caller\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Verify channel is idle
+    if ((pdx->DmaInfo[channel].bSglPending) ||
+        (PlxChip_DmaStatus(
+             pdx,
+             channel,
+             pOwner
+             ) != PLX_STATUS_COMPLETE))
+    {
+        DebugPrintf(("ERROR - DMA channel is currently active\n"));
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_IN_PROGRESS;
+    }
+
+    // Reserve the channel while the ring is built
+    pdx->DmaInfo[channel].bSglPending = TRUE;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Get current local address mode of the channel
+    PlxChip_DmaGetProperties(
+        pdx,
+        channel,
+        &DmaProp
+        );
+
+    // Page-lock ring buffer & build SGL with descriptors split at segments
+    status =
+        PlxSglBuild(
+            pdx,
+            pParams,
+            (BOOLEAN)DmaProp.ConstAddrLocal,
+            SegmentSize,
+            &pRing->Sgl,
+            &SglPciAddress,
+            &bBits64
+            );
+
+    if (status != PLX_STATUS_OK)
+    {
+        DebugPrintf(("ERROR - Unable to lock buffer and build SGL list\n"));
+        goto _Exit_PlxDmaRingStart;
+    }
+
+    // Allocate table to map descriptors to segments
+    pRing->pDescrSegment =
+        kmalloc(
+            pRing->Sgl.NumDescriptors * sizeof(U32),
+            GFP_KERNEL
+            );
+
+    // Allocate control page to share ring indices with user space
+    pRing->CtrlPage.Size = PAGE_SIZE;
+
+    if ((pRing->pDescrSegment == NULL) ||
+        (Plx_dma_buffer_alloc(
+             pdx,
+             &pRing->CtrlPage
+             ) == NULL))
+    {
+        DebugPrintf(("ERROR - Unable to allocate DMA ring resources\n"));
+        status = PLX_STATUS_INSUFFICIENT_RES;
+        goto _Exit_PlxDmaRingStart;
+    }
+
+    // Link last descriptor back to the first
+    PlxSglRingLink(
+        &pRing->Sgl,
+        SglPciAddress,
+        SegmentSize,
+        pRing->pDescrSegment
+        );
+
+    pRing->SglAddress    = SglPciAddress;
+    pRing->SegmentSize   = SegmentSize;
+    pRing->NumSegments   = pParams->ByteCount / SegmentSize;
+    pRing->SegmentActive = 0;
+
+    pCtrl = (PLX_DMA_RING_CTRL*)pRing->CtrlPage.pKernelVa;
+
+    pCtrl->NumSegments = pRing->NumSegments;
+    pCtrl->SegmentSize = SegmentSize;
+
+    DebugPrintf((
+        "Start DMA ring (%d segments of %dB, %d descriptors)\n",
+        pRing->NumSegments, SegmentSize, pRing->Sgl.NumDescriptors
+        ));
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    pRing->bActive = TRUE;
+
+    pdx->DmaInfo[channel].NumDescriptors = pRing->Sgl.NumDescriptors;
+
+    PlxChipDmaSglStart(
+        pdx,
+        channel,
+        SglPciAddress,
+        bBits64
+        );
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Return control page address for mapping to user space
+    *pCtrlPhysical = pRing->CtrlPage.CpuPhysical;
+
+    return PLX_STATUS_OK;
+
+_Exit_PlxDmaRingStart:
+    // Release any partially built ring
+    PlxDmaRingRelease(
+        pdx,
+        channel
+        );
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    pdx->DmaInfo[channel].bSglPending = FALSE;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaRingStop
+ *
+ * Description:  Stops continuous DMA & releases the ring buffer
+ *
+ * Note       :  The control page must be unmapped from user space beforehand
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaRingStop(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    VOID             *pOwner
+    )
+{
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Verify DMA channel was opened by the caller & ring is active
+    if ((pdx->DmaInfo[channel].bOpen == FALSE) ||
+        (pdx->DmaInfo[channel].pOwner != pOwner) ||
+        (pdx->DmaInfo[channel].Ring.bActive == FALSE))
+    {
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    DebugPrintf(("Stop DMA ring on channel %d...\n", channel));
+
+    // Force DMA abort, which may generate a DMA done interrupt
+    PlxChip_DmaControl(
+        pdx,
+        channel,
+        DmaAbort,
+        pOwner
+        );
+
+    // Small delay to let DPC service any final interrupt
+    Plx_sleep( 100 );
+
+    PlxDmaRingRelease(
+        pdx,
+        channel
+        );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingCreate
+ *
+ * Description:  Allocate a DMA completion ring for the caller, which is filled
+ *               by the driver as DMA transfers on its channels complete
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaCompletionRingCreate(
+    DEVICE_EXTENSION *pdx,
+    U64              *pCpuPhysical,
+    VOID             *pOwner
+    )
+{
+    struct list_head        *pEntry;
+    PLX_PHYS_MEM_OBJECT     *pMemObject;
+    PLX_DMA_COMPLETION_RING *pRing;
+
+
+    // Default to no ring
+    *pCpuPhysical = 0;
+
+    // Allocate memory for new list object
+    pMemObject =
+        kmalloc(
+            sizeof(PLX_PHYS_MEM_OBJECT),
+            GFP_KERNEL
+            );
+
+    if (pMemObject == NULL)
+    {
+        DebugPrintf(("ERROR - Memory allocation for list object failed\n"));
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    // Initialize object
+    RtlZeroMemory( pMemObject, sizeof(PLX_PHYS_MEM_OBJECT) );
+
+    // Ring is mapped to user space, so allocate whole pages
+    pMemObject->Size = PAGE_ALIGN( sizeof(PLX_DMA_COMPLETION_RING) );
+
+    if (Plx_dma_buffer_alloc(
+            pdx,
+            pMemObject
+            ) == NULL)
+    {
+        DebugPrintf(("ERROR - Unable to allocate DMA completion ring\n"));
+        kfree( pMemObject );
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    pRing = (PLX_DMA_COMPLETION_RING*)pMemObject->pKernelVa;
+
+    pRing->NumEntries = PLX_DMA_COMPLETION_RING_SIZE;
+
+    // Record the owner
+    pMemObject->pOwner = pOwner;
+
+    // Ring is not mapped yet
+    atomic_set( &(pMemObject->MapCount), 0 );
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Only a single ring is supported per owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        if (list_entry(pEntry, PLX_PHYS_MEM_OBJECT, ListEntry)->pOwner == pOwner)
+        {
+            spin_unlock( &(pdx->Lock_CompletionRingList) );
+
+            DebugPrintf(("ERROR - DMA completion ring already exists\n"));
+
+            Plx_dma_buffer_free(
+                pdx,
+                pMemObject
+                );
+
+            kfree( pMemObject );
+            return PLX_STATUS_IN_USE;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    // Add ring to list
+    list_add_tail(
+        &(pMemObject->ListEntry),
+        &(pdx->List_CompletionRings)
+        );
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    // Return ring address for mapping to user space
+    *pCpuPhysical = pMemObject->CpuPhysical;
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingDestroy
+ *
+ * Description:  Release the DMA completion ring of the caller
+ *
+ * Note       :  The ring must be unmapped from user space beforehand, so
+ *               the request fails while any user mapping of it remains
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaCompletionRingDestroy(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    )
+{
+    BOOLEAN              bMapped;
+    struct list_head    *pEntry;
+    PLX_PHYS_MEM_OBJECT *pMemObject;
+
+
+    bMapped    = FALSE;
+    pMemObject = NULL;
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Find the ring of the owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        if (list_entry(pEntry, PLX_PHYS_MEM_OBJECT, ListEntry)->pOwner == pOwner)
+        {
+            pMemObject =
+                list_entry(
+                    pEntry,
+                    PLX_PHYS_MEM_OBJECT,
+                    ListEntry
+                    );
+
+            // Pages may not be released while still mapped
+            if (atomic_read( &(pMemObject->MapCount) ) != 0)
+            {
+                bMapped = TRUE;
+                break;
+            }
+
+            // Remove ring from list so the DPC no longer fills it
+            list_del(
+                pEntry
+                );
+            break;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    if (pMemObject == NULL)
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if (bMapped)
+    {
+        DebugPrintf(("ERROR - DMA completion ring still mapped to user space\n"));
+        return PLX_STATUS_IN_USE;
+    }
+
+    DebugPrintf(("Release DMA completion ring\n"));
+
+    Plx_dma_buffer_free(
+        pdx,
+        pMemObject
+        );
+
+    kfree( pMemObject );
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaGetStatistics
+ *
+ * Description:  Copy the counters & latency histograms of a DMA channel to a
+ *               user buffer, optionally clearing them
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaGetStatistics(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    VOID             *pUserStats,
+    BOOLEAN           bReset
+    )
+{
+    PLX_DMA_STATS Stats;
+
+
+    // Verify DMA channel
+    if (channel >= NUM_DMA_CHANNELS)
+    {
+        DebugPrintf(("ERROR - Invalid DMA channel\n"));
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    PlxDmaStatsGet(
+        pdx,
+        channel,
+        &Stats,
+        bReset
+        );
+
+    // Caller may only request a reset
+    if (pUserStats == NULL)
+    {
+        return PLX_STATUS_OK;
+    }
+
+    if (copy_to_user(
+            pUserStats,
+            &Stats,
+            sizeof(PLX_DMA_STATS)
+            ) != 0)
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+#endif  // PLX_DMA_SUPPORT
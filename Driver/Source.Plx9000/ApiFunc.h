@@ -107,6 +107,14 @@ PlxRegisterWrite(
     BOOLEAN           bAdjustForPort
     );
 
+PLX_STATUS
+PlxRegisterBatch(
+    DEVICE_EXTENSION    *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    );
+
 PLX_STATUS
 PlxPciBarProperties(
     DEVICE_EXTENSION *pdx,
@@ -232,6 +240,13 @@ PlxInterruptDisable(
     PLX_INTERRUPT    *pPlxIntr
     );
 
+PLX_STATUS
+PlxInterruptCoalesceSet(
+    DEVICE_EXTENSION *pdx,
+    U32               MaxEvents,
+    U32               MaxDelay_us
+    );
+
 PLX_STATUS
 PlxNotificationRegisterFor(
     DEVICE_EXTENSION  *pdx,
@@ -261,6 +276,14 @@ PlxNotificationCancel(
     VOID             *pOwner
     );
 
+PLX_STATUS
+PlxNotificationEventFdBind(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pUserWaitObject,
+    int               EventFd,
+    VOID             *pOwner
+    );
+
 PLX_STATUS
 PlxPciBarSpaceTransfer(
     DEVICE_EXTENSION *pdx,
@@ -273,6 +296,21 @@ PlxPciBarSpaceTransfer(
     BOOLEAN           bReadOperation
     );
 
+PLX_STATUS
+PlxPciBarWindowLock(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex,
+    U32               LocalAddress,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxPciBarWindowUnlock(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex,
+    VOID             *pOwner
+    );
+
 PLX_STATUS
 PlxPciVpdRead(
     DEVICE_EXTENSION *pdx,
@@ -287,6 +325,127 @@ PlxPciVpdWrite(
     U32               VpdData
     );
 
+#if defined(PLX_DMA_SUPPORT)
+PLX_STATUS
+PlxDmaBufferRegister(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    U64              *pHandle,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaBufferUnregister(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Handle,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaTransferRegBuffer(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Handle,
+    U32               offset,
+    U32               ByteCount,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaTransferQueue(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaQueueStatus(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32              *pNumPending,
+    U32              *pNumCompleted,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaTransferWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    BOOLEAN           bUserBuffer,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaWaitDone(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               DoneSeq,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaTransferStriped(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_PARAMS   *pParams,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaTransferVector(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_UINT_PTR      UserParams,
+    U32               count,
+    PLX_UINT_PTR      Timeout_ms,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaRingStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pParams,
+    U32               SegmentSize,
+    U64              *pCtrlPhysical,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaRingStop(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaCompletionRingCreate(
+    DEVICE_EXTENSION *pdx,
+    U64              *pCpuPhysical,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaCompletionRingDestroy(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    );
+
+PLX_STATUS
+PlxDmaGetStatistics(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    VOID             *pUserStats,
+    BOOLEAN           bReset
+    );
+#endif
+
 
 
 
@@ -50,6 +50,7 @@
 
 #include "PlxChipFn.h"
 #include "PlxInterrupt.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -79,6 +80,8 @@ OnInterrupt(
     // Get the device extension
     pdx = (DEVICE_EXTENSION *)dev_id;
 
+    trace_plx_isr_entry( pdx, irq );
+
     // Disable interrupts and acquire lock 
     spin_lock( &(pdx->Lock_Isr) ); 
 
@@ -100,6 +103,7 @@ OnInterrupt(
     if (RegPciInt == 0xFFFFFFFF)
     {
         spin_unlock( &(pdx->Lock_Isr) );
+        trace_plx_isr_exit( pdx, INTR_TYPE_NONE, 0 );
         return IRQ_RETVAL(IRQ_NONE);
     }
 
@@ -107,6 +111,7 @@ OnInterrupt(
     if ((RegPciInt & (1 << 6)) == 0)
     {
         spin_unlock( &(pdx->Lock_Isr) );
+        trace_plx_isr_exit( pdx, INTR_TYPE_NONE, 0 );
         return IRQ_RETVAL(IRQ_NONE);
     }
 
@@ -137,6 +142,7 @@ OnInterrupt(
     if (InterruptSource == INTR_TYPE_NONE)
     {
         spin_unlock( &(pdx->Lock_Isr) );
+        trace_plx_isr_exit( pdx, INTR_TYPE_NONE, 0 );
         return IRQ_RETVAL(IRQ_NONE);
     }
 
@@ -156,13 +162,26 @@ OnInterrupt(
     // Schedule deferred procedure (DPC) to complete interrupt processing
     //
 
-    // Provide interrupt source to DPC
-    pdx->Source_Ints = InterruptSource;
+    trace_plx_isr_exit( pdx, InterruptSource, 0 );
+
+    // Queue interrupt event for the DPC
+    PlxIntEventPush(
+        pdx,
+        InterruptSource,
+        0
+        );
 
     // If device is no longer started, do not schedule a DPC
     if (pdx->State != PLX_STATE_STARTED)
         return IRQ_RETVAL(IRQ_HANDLED);
 
+#if defined(PLX_THREADED_IRQ)
+    // Flag a DPC is pending
+    pdx->bDpcPending = TRUE;
+
+    // Wake the IRQ thread to run the DPC
+    return IRQ_WAKE_THREAD;
+#else
     // Add task to system work queue
     schedule_work(
         &(pdx->Task_DpcForIsr)
@@ -171,8 +190,42 @@ OnInterrupt(
     // Flag a DPC is pending
     pdx->bDpcPending = TRUE;
 
+    return IRQ_RETVAL(IRQ_HANDLED);
+#endif
+}
+
+
+
+
+#if defined(PLX_THREADED_IRQ)
+/*******************************************************************************
+ *
+ * Function   :  OnInterruptThread
+ *
+ * Description:  IRQ thread handler, which runs the DPC at real-time priority
+ *               instead of deferring it to the shared system work queue
+ *
+ ******************************************************************************/
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    // Get the device extension
+    pdx = (DEVICE_EXTENSION *)dev_id;
+
+    // DPC locates the device extension from its work item
+    DpcForIsr(
+        &(pdx->Task_DpcForIsr)
+        );
+
     return IRQ_RETVAL(IRQ_HANDLED);
 }
+#endif
 
 
 
@@ -215,89 +268,96 @@ DpcForIsr(
         return;
     }
 
-    // Get interrupt source
-    IntData.Source_Ints     = pdx->Source_Ints;
-    IntData.Source_Doorbell = 0;
-
-    // Synchronize access to Interrupt Control/Status Register
-    RegData.BitsToSet   = 0;
-    RegData.BitsToClear = 0;
-
-    // Get current interrupt status
-    RegValue =
-        PLX_9000_REG_READ(
+    // Process each interrupt event queued by the ISR, in arrival order
+    while (PlxIntEventPop( pdx, &IntData ))
+    {
+        trace_plx_dpc(
             pdx,
-            PCI9030_INT_CTRL_STAT
+            IntData.Source_Ints,
+            IntData.Source_Doorbell,
+            IntData.Timestamp_ns
             );
 
-    // Local Interrupt 1
-    if (IntData.Source_Ints & INTR_TYPE_LOCAL_1)
-    {
-        // Check if this is an edge-triggered interrupt
-        if ((RegValue & (1 << 1)) && (RegValue & (1 << 8)))
+        // Synchronize access to Interrupt Control/Status Register
+        RegData.BitsToSet   = 0;
+        RegData.BitsToClear = 0;
+
+        // Get current interrupt status
+        RegValue =
+            PLX_9000_REG_READ(
+                pdx,
+                PCI9030_INT_CTRL_STAT
+                );
+
+        // Local Interrupt 1
+        if (IntData.Source_Ints & INTR_TYPE_LOCAL_1)
         {
-            // Clear edge-triggered interrupt
-            RegData.BitsToSet |= (1 << 10);
+            // Check if this is an edge-triggered interrupt
+            if ((RegValue & (1 << 1)) && (RegValue & (1 << 8)))
+            {
+                // Clear edge-triggered interrupt
+                RegData.BitsToSet |= (1 << 10);
+            }
+            else
+            {
+                // Mask Local Interrupt 1
+                RegData.BitsToClear |= (1 << 0);
+            }
         }
-        else
+
+        // Local Interrupt 2
+        if (IntData.Source_Ints & INTR_TYPE_LOCAL_2)
         {
-            // Mask Local Interrupt 1
-            RegData.BitsToClear |= (1 << 0);
+            // Check if this is an edge-triggered interrupt
+            if ((RegValue & (1 << 4)) && (RegValue & (1 << 9)))
+            {
+                // Clear edge-triggered interrupt
+                RegData.BitsToSet |= (1 << 11);
+            }
+            else
+            {
+                // Mask Local Interrupt 2
+                RegData.BitsToClear |= (1 << 3);
+            }
         }
-    }
 
-    // Local Interrupt 2
-    if (IntData.Source_Ints & INTR_TYPE_LOCAL_2)
-    {
-        // Check if this is an edge-triggered interrupt
-        if ((RegValue & (1 << 4)) && (RegValue & (1 << 9)))
+        // Software Interrupt
+        if (IntData.Source_Ints & INTR_TYPE_SOFTWARE)
         {
-            // Clear edge-triggered interrupt
-            RegData.BitsToSet |= (1 << 11);
+            // Clear the software interrupt
+            RegData.BitsToClear |= (1 << 7);
         }
-        else
+
+        // Clear any active interrupts
+        if (RegData.BitsToSet || RegData.BitsToClear)
         {
-            // Mask Local Interrupt 2
-            RegData.BitsToClear |= (1 << 3);
-        }
-    }
+            spin_lock_irqsave( &(pdx->Lock_Isr), flags );
 
-    // Software Interrupt
-    if (IntData.Source_Ints & INTR_TYPE_SOFTWARE)
-    {
-        // Clear the software interrupt
-        RegData.BitsToClear |= (1 << 7);
-    }
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9030_INT_CTRL_STAT
+                    );
 
-    // Clear any active interrupts
-    if (RegData.BitsToSet || RegData.BitsToClear)
-    {
-        spin_lock_irqsave( &(pdx->Lock_Isr), flags );
+            RegValue |= RegData.BitsToSet;
+            RegValue &= ~(RegData.BitsToClear);
 
-        RegValue =
-            PLX_9000_REG_READ(
+            PLX_9000_REG_WRITE(
                 pdx,
-                PCI9030_INT_CTRL_STAT
+                PCI9030_INT_CTRL_STAT,
+                RegValue
                 );
 
-        RegValue |= RegData.BitsToSet;
-        RegValue &= ~(RegData.BitsToClear);
+            spin_unlock_irqrestore( &(pdx->Lock_Isr), flags );
+        }
 
-        PLX_9000_REG_WRITE(
+        // Signal any objects waiting for notification
+        PlxSignalNotifications(
             pdx,
-            PCI9030_INT_CTRL_STAT,
-            RegValue
+            &IntData
             );
-
-        spin_unlock_irqrestore( &(pdx->Lock_Isr), flags );
     }
 
-    // Signal any objects waiting for notification
-    PlxSignalNotifications(
-        pdx,
-        &IntData
-        );
-
     // Re-enable interrupts
     PlxChipInterruptsEnable(
         pdx
@@ -48,11 +48,14 @@
  ******************************************************************************/
 
 
+#include <linux/uaccess.h>  // For copy_to/from_user()
 #include "ApiFunc.h"
 #include "Eep_9000.h"
 #include "PciFunc.h"
 #include "PciRegs.h"
 #include "PlxChipApi.h"
+#include "PlxChipFn.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -1373,6 +1376,9 @@ PlxChip_DmaTransferBlock(
         return PLX_STATUS_INVALID_ACCESS;
     }
 
+    // Store transfer size for completion reporting
+    pdx->DmaInfo[channel].BlockByteCount = pParams->ByteCount;
+
     // Get DMA mode
     RegValue =
         PLX_9000_REG_READ(
@@ -1457,6 +1463,20 @@ PlxChip_DmaTransferBlock(
 
     DebugPrintf(("Starting DMA transfer...\n"));
 
+    trace_plx_dma_start(
+        pdx,
+        channel,
+        pParams->ByteCount,
+        0,
+        pParams->Direction
+        );
+
+    PlxDmaStatsStart(
+        pdx,
+        channel,
+        pParams->ByteCount
+        );
+
     // Start DMA
     PLX_9000_REG_WRITE(
         pdx,
@@ -1582,65 +1602,36 @@ PlxChip_DmaTransferUserBuffer(
         return rc;
     }
 
-    spin_lock(
-        &(pdx->Lock_Dma[channel])
-        );
-
-    // Enable DMA chaining, interrupt, & route interrupt to PCI
-    RegValue |= (1 << 9) | (1 << 10) | (1 << 17);
-
-    // Enable dual-addressing DMA if 64-bit DMA is required
-    if (bBits64)
-        RegValue |= (1 << 18);
-    else
-        RegValue &= ~(1 << 18);
-
-    PLX_9000_REG_WRITE(
+    trace_plx_dma_start(
         pdx,
-        OffsetMode,
-        RegValue
+        channel,
+        pParams->ByteCount,
+        pdx->DmaInfo[channel].NumDescriptors,
+        pParams->Direction
         );
 
-    // Clear DAC upper 32-bit PCI address in case it contains non-zero value
-    PLX_9000_REG_WRITE(
+    PlxDmaStatsStart(
         pdx,
-        PCI9054_DMA0_PCI_DAC + (channel * sizeof(U32)),
-        0
+        channel,
+        pParams->ByteCount
         );
 
-    // Write SGL physical address & set descriptors in PCI space
-    PLX_9000_REG_WRITE(
-        pdx,
-        OffsetMode + 0x10,
-        SglPciAddress | (1 << 0)
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
         );
 
-    // Enable DMA channel
-    RegValue =
-        PLX_9000_REG_READ(
-            pdx,
-            PCI9054_DMA_COMMAND_STAT
-            );
-
-    PLX_9000_REG_WRITE(
+    // Program the channel with the SGL & start DMA
+    PlxChipDmaSglStart(
         pdx,
-        PCI9054_DMA_COMMAND_STAT,
-        RegValue | ((1 << 0) << shift)
+        channel,
+        SglPciAddress,
+        bBits64
         );
 
     spin_unlock(
         &(pdx->Lock_Dma[channel])
         );
 
-    DebugPrintf(("Starting DMA transfer...\n"));
-
-    // Start DMA
-    PLX_9000_REG_WRITE(
-        pdx,
-        PCI9054_DMA_COMMAND_STAT,
-        RegValue | (((1 << 0) | (1 << 1)) << shift)
-        );
-
     return PLX_STATUS_OK;
 }
 
@@ -1710,6 +1701,12 @@ PlxChip_DmaChannelClose(
 
         DebugPrintf(("DMA in progress, aborting...\n"));
 
+        // Prevent queued transfers from starting once DMA is aborted
+        PlxDmaQueueFlush(
+            pdx,
+            channel
+            );
+
         // Force DMA abort, which may generate a DMA done interrupt
         PlxChip_DmaControl(
             pdx,
@@ -1736,6 +1733,12 @@ PlxChip_DmaChannelClose(
         &(pdx->Lock_Dma[channel])
         );
 
+    // Release any streaming ring, which never completes on its own
+    PlxDmaRingRelease(
+        pdx,
+        channel
+        );
+
     // If DMA is hung, an SGL transfer could be pending, so release user buffer
     if (pdx->DmaInfo[channel].bSglPending)
     {
@@ -1745,16 +1748,337 @@ PlxChip_DmaChannelClose(
             );
     }
 
+    // Unlock any buffers registered for the channel
+    PlxDmaRegBufferReleaseAll(
+        pdx,
+        channel
+        );
+
+    // Unlock any queued transfers & release their SGL memory
+    PlxDmaQueueReleaseAll(
+        pdx,
+        channel
+        );
+
     // Release memory previously used for SGL descriptors
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa != NULL)
+    if (pdx->DmaInfo[channel].Sgl.SglBuffer.pKernelVa != NULL)
     {
         DebugPrintf(("Releasing memory used for SGL descriptors...\n"));
 
         Plx_dma_buffer_free(
             pdx,
-            &pdx->DmaInfo[channel].SglBuffer
+            &pdx->DmaInfo[channel].Sgl.SglBuffer
+            );
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxChip_MuQueueInit
+ *
+ * Description:  Sets up the I2O messaging unit circular queues in local memory
+ *
+ * Note       :  The four queues (inbound free, inbound post, outbound post,
+ *               outbound free) are placed consecutively from LocalQueueBase,
+ *               which must be 1MB-aligned.  Enabling I2O decode replaces
+ *               mailbox 0 & 1 with the inbound & outbound queue ports, which
+ *               remain readable through their shadow registers at 78h/7Ch.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxChip_MuQueueInit(
+    DEVICE_EXTENSION *pdx,
+    U32               LocalQueueBase,
+    U32               EntriesPerQueue
+    )
+{
+    U32 RegValue;
+    U32 QueueSize;
+
+
+    // Verify queue size, encoded in MQCR[5:1] as a multiple of 4K entries
+    switch (EntriesPerQueue)
+    {
+        case (4 * 1024):
+        case (8 * 1024):
+        case (16 * 1024):
+        case (32 * 1024):
+        case (64 * 1024):
+            break;
+
+        default:
+            return PLX_STATUS_INVALID_SIZE;
+    }
+
+    // Verify queue base is 1MB-aligned
+    if (LocalQueueBase & 0x000FFFFF)
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    // Size of each queue in bytes
+    QueueSize = EntriesPerQueue * sizeof(U32);
+
+    spin_lock(
+        &(pdx->Lock_Mu)
+        );
+
+    // Disable queues while pointers are reset
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_MU_QUEUE_CONFIG,
+        0
+        );
+
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_MU_QUEUE_BASE,
+        LocalQueueBase
+        );
+
+    // Start all queues empty
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_IN_FREE_HEAD , LocalQueueBase );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_IN_FREE_TAIL , LocalQueueBase );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_IN_POST_HEAD , LocalQueueBase + QueueSize );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_IN_POST_TAIL , LocalQueueBase + QueueSize );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_OUT_POST_HEAD, LocalQueueBase + (2 * QueueSize) );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_OUT_POST_TAIL, LocalQueueBase + (2 * QueueSize) );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_OUT_FREE_HEAD, LocalQueueBase + (3 * QueueSize) );
+    PLX_9000_REG_WRITE( pdx, PCI9054_MU_OUT_FREE_TAIL, LocalQueueBase + (3 * QueueSize) );
+
+    // Set queue size & enable queues
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_MU_QUEUE_CONFIG,
+        ((EntriesPerQueue / (4 * 1024)) << 1) | (1 << 0)
+        );
+
+    // Enable I2O decode to map the queue ports
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            PCI9054_FIFO_CTRL_STAT
+            );
+
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_FIFO_CTRL_STAT,
+        RegValue | (1 << 0)
+        );
+
+    spin_unlock(
+        &(pdx->Lock_Mu)
+        );
+
+    DebugPrintf((
+        "MU queues enabled at local %08X (%d entries each)\n",
+        LocalQueueBase, EntriesPerQueue
+        ));
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxChip_MuInboundPost
+ *
+ * Description:  Posts 32-bit message frames to the MU inbound post queue
+ *
+ * Note       :  Posting stops when the queue is full.  The number of frames
+ *               actually posted is returned, so the caller may retry the rest.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxChip_MuInboundPost(
+    DEVICE_EXTENSION *pdx,
+    U32              *pUserFrames,
+    U32               Count,
+    U32              *pCountPosted
+    )
+{
+    U32 i;
+    U32 Head;
+    U32 Tail;
+    U32 Chunk;
+    U32 Posted;
+    U32 RegValue;
+    U32 QueueSize;
+    U32 FreeCount;
+    U32 Frames[PLX_MU_FRAMES_PER_COPY];
+
+
+    *pCountPosted = 0;
+
+    // Verify queues are enabled & get their size
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            PCI9054_MU_QUEUE_CONFIG
+            );
+
+    if ((RegValue & (1 << 0)) == 0)
+    {
+        return PLX_STATUS_DISABLED;
+    }
+
+    QueueSize = ((RegValue >> 1) & 0x1F) * (4 * 1024) * sizeof(U32);
+
+    while (*pCountPosted < Count)
+    {
+        Chunk = min_t( U32, Count - *pCountPosted, PLX_MU_FRAMES_PER_COPY );
+
+        // Stage frames, since user memory may not be touched under spinlock
+        if (copy_from_user(
+                Frames,
+                pUserFrames + *pCountPosted,
+                Chunk * sizeof(U32)
+                ) != 0)
+        {
+            return PLX_STATUS_INVALID_ADDR;
+        }
+
+        spin_lock(
+            &(pdx->Lock_Mu)
+            );
+
+        // Local side consumes from tail, hardware advances head on each post
+        Head = PLX_9000_REG_READ( pdx, PCI9054_MU_IN_POST_HEAD );
+        Tail = PLX_9000_REG_READ( pdx, PCI9054_MU_IN_POST_TAIL );
+
+        // One entry is kept unused to tell a full queue from an empty one
+        FreeCount =
+            ((QueueSize - ((Head - Tail) & (QueueSize - 1))) / sizeof(U32)) - 1;
+
+        Posted = min_t( U32, Chunk, FreeCount );
+
+        for (i = 0; i < Posted; i++)
+        {
+            PLX_9000_REG_WRITE(
+                pdx,
+                PCI9054_MU_INBOUND_PORT,
+                Frames[i]
+                );
+        }
+
+        spin_unlock(
+            &(pdx->Lock_Mu)
+            );
+
+        *pCountPosted += Posted;
+
+        // Stop if queue is full
+        if (Posted < Chunk)
+        {
+            break;
+        }
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxChip_MuOutboundDrain
+ *
+ * Description:  Reaps 32-bit message frames from the MU outbound post queue
+ *
+ * Note       :  Draining stops when the queue is empty, which the queue port
+ *               reports as FFFF_FFFFh.  The outbound post interrupt is masked
+ *               by the DPC & must be re-enabled after draining to be notified
+ *               of further frames.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxChip_MuOutboundDrain(
+    DEVICE_EXTENSION *pdx,
+    U32              *pUserFrames,
+    U32               MaxCount,
+    U32              *pCountDrained
+    )
+{
+    U32 Chunk;
+    U32 Drained;
+    U32 RegValue;
+    U32 Frames[PLX_MU_FRAMES_PER_COPY];
+
+
+    *pCountDrained = 0;
+
+    // Verify queues are enabled
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            PCI9054_MU_QUEUE_CONFIG
+            );
+
+    if ((RegValue & (1 << 0)) == 0)
+    {
+        return PLX_STATUS_DISABLED;
+    }
+
+    while (*pCountDrained < MaxCount)
+    {
+        Chunk = min_t( U32, MaxCount - *pCountDrained, PLX_MU_FRAMES_PER_COPY );
+
+        spin_lock(
+            &(pdx->Lock_Mu)
             );
+
+        // Each port read pops one frame
+        for (Drained = 0; Drained < Chunk; Drained++)
+        {
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9054_MU_OUTBOUND_PORT
+                    );
+
+            if (RegValue == 0xFFFFFFFF)
+            {
+                break;
+            }
+
+            Frames[Drained] = RegValue;
+        }
+
+        spin_unlock(
+            &(pdx->Lock_Mu)
+            );
+
+        if (Drained != 0)
+        {
+            // Frames are already popped, so report a failed copy as an error
+            if (copy_to_user(
+                    pUserFrames + *pCountDrained,
+                    Frames,
+                    Drained * sizeof(U32)
+                    ) != 0)
+            {
+                ErrorPrintf(("ERROR - Unable to copy %d MU frames to user buffer\n", Drained));
+                return PLX_STATUS_INVALID_ADDR;
+            }
+        }
+
+        *pCountDrained += Drained;
+
+        // Stop if queue is empty
+        if (Drained < Chunk)
+        {
+            break;
+        }
     }
 
     return PLX_STATUS_OK;
 }
+
@@ -355,3 +355,134 @@ PlxChipGetRemapOffset(
     // BAR not supported
     *pOffset_RegRemap = (U16)-1;
 }
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxChipDmaSglStart
+ *
+ * Description:  Programs a DMA channel with an SGL & starts the transfer
+ *
+ * Note       :  The caller must hold the DMA channel lock
+ *
+ *****************************************************************************/
+VOID
+PlxChipDmaSglStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               SglPciAddress,
+    BOOLEAN           bBits64
+    )
+{
+    U8  shift;
+    U16 OffsetMode;
+    U32 RegValue;
+
+
+    // Setup register offsets
+    if (channel == 0)
+        OffsetMode = PCI9054_DMA0_MODE;
+    else
+        OffsetMode = PCI9054_DMA1_MODE;
+
+    // Set shift for status register
+    shift = (channel * 8);
+
+    // Get DMA mode
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            OffsetMode
+            );
+
+    // Enable DMA chaining, interrupt, & route interrupt to PCI
+    RegValue |= (1 << 9) | (1 << 10) | (1 << 17);
+
+    // Enable dual-addressing DMA if 64-bit DMA is required
+    if (bBits64)
+        RegValue |= (1 << 18);
+    else
+        RegValue &= ~(1 << 18);
+
+    PLX_9000_REG_WRITE(
+        pdx,
+        OffsetMode,
+        RegValue
+        );
+
+    // Clear DAC upper 32-bit PCI address in case it contains non-zero value
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_DMA0_PCI_DAC + (channel * sizeof(U32)),
+        0
+        );
+
+    // Write SGL physical address & set descriptors in PCI space
+    PLX_9000_REG_WRITE(
+        pdx,
+        OffsetMode + 0x10,
+        SglPciAddress | (1 << 0)
+        );
+
+    // Enable DMA channel
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            PCI9054_DMA_COMMAND_STAT
+            );
+
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_DMA_COMMAND_STAT,
+        RegValue | ((1 << 0) << shift)
+        );
+
+    DebugPrintf(("Starting DMA transfer...\n"));
+
+    // Start DMA
+    PLX_9000_REG_WRITE(
+        pdx,
+        PCI9054_DMA_COMMAND_STAT,
+        RegValue | (((1 << 0) | (1 << 1)) << shift)
+        );
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxChipDmaSglNextDescriptor
+ *
+ * Description:  Returns the bus address of the next SGL descriptor the DMA
+ *               channel will fetch
+ *
+ *****************************************************************************/
+U32
+PlxChipDmaSglNextDescriptor(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U16 OffsetMode;
+    U32 RegValue;
+
+
+    // Setup register offsets
+    if (channel == 0)
+        OffsetMode = PCI9054_DMA0_MODE;
+    else
+        OffsetMode = PCI9054_DMA1_MODE;
+
+    // Get DMA descriptor pointer
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            OffsetMode + 0x10
+            );
+
+    // Remove descriptor control bits
+    return (RegValue & ~0xF);
+}
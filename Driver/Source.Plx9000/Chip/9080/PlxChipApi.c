@@ -51,6 +51,8 @@
 #include "Eep_9000.h"
 #include "PciFunc.h"
 #include "PlxChipApi.h"
+#include "PlxChipFn.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -1098,6 +1100,9 @@ PlxChip_DmaTransferBlock(
         return PLX_STATUS_INVALID_ACCESS;
     }
 
+    // Store transfer size for completion reporting
+    pdx->DmaInfo[channel].BlockByteCount = pParams->ByteCount;
+
     // Get DMA mode
     RegValue =
         PLX_9000_REG_READ(
@@ -1175,6 +1180,20 @@ PlxChip_DmaTransferBlock(
 
     DebugPrintf(("Starting DMA transfer...\n"));
 
+    trace_plx_dma_start(
+        pdx,
+        channel,
+        pParams->ByteCount,
+        0,
+        pParams->Direction
+        );
+
+    PlxDmaStatsStart(
+        pdx,
+        channel,
+        pParams->ByteCount
+        );
+
     // Start DMA
     PLX_9000_REG_WRITE(
         pdx,
@@ -1307,52 +1326,36 @@ PlxChip_DmaTransferUserBuffer(
         return rc;
     }
 
-    spin_lock(
-        &(pdx->Lock_Dma[channel])
-        );
-
-    // Enable DMA chaining, interrupt, & route interrupt to PCI
-    RegValue |= (1 << 9) | (1 << 10) | (1 << 17);
-
-    PLX_9000_REG_WRITE(
+    trace_plx_dma_start(
         pdx,
-        OffsetMode,
-        RegValue
+        channel,
+        pParams->ByteCount,
+        pdx->DmaInfo[channel].NumDescriptors,
+        pParams->Direction
         );
 
-    // Write SGL physical address & set descriptors in PCI space
-    PLX_9000_REG_WRITE(
+    PlxDmaStatsStart(
         pdx,
-        OffsetMode + 0x10,
-        SglPciAddress | (1 << 0)
+        channel,
+        pParams->ByteCount
         );
 
-    // Enable DMA channel
-    RegValue =
-        PLX_9000_REG_READ(
-            pdx,
-            PCI9080_DMA_COMMAND_STAT
-            );
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
 
-    PLX_9000_REG_WRITE(
+    // Program the channel with the SGL & start DMA
+    PlxChipDmaSglStart(
         pdx,
-        PCI9080_DMA_COMMAND_STAT,
-        RegValue | ((1 << 0) << shift)
+        channel,
+        SglPciAddress,
+        bBits64
         );
 
     spin_unlock(
         &(pdx->Lock_Dma[channel])
         );
 
-    DebugPrintf(("Starting DMA transfer...\n"));
-
-    // Start DMA
-    PLX_9000_REG_WRITE(
-        pdx,
-        PCI9080_DMA_COMMAND_STAT,
-        RegValue | (((1 << 0) | (1 << 1)) << shift)
-        );
-
     return PLX_STATUS_OK;
 }
 
@@ -1422,6 +1425,12 @@ PlxChip_DmaChannelClose(
 
         DebugPrintf(("DMA in progress, aborting...\n"));
 
+        // Prevent queued transfers from starting once DMA is aborted
+        PlxDmaQueueFlush(
+            pdx,
+            channel
+            );
+
         // Force DMA abort, which may generate a DMA done interrupt
         PlxChip_DmaControl(
             pdx,
@@ -1448,6 +1457,12 @@ PlxChip_DmaChannelClose(
         &(pdx->Lock_Dma[channel])
         );
 
+    // Release any streaming ring, which never completes on its own
+    PlxDmaRingRelease(
+        pdx,
+        channel
+        );
+
     // If DMA is hung, an SGL transfer could be pending, so release user buffer
     if (pdx->DmaInfo[channel].bSglPending)
     {
@@ -1457,14 +1472,26 @@ PlxChip_DmaChannelClose(
             );
     }
 
+    // Unlock any buffers registered for the channel
+    PlxDmaRegBufferReleaseAll(
+        pdx,
+        channel
+        );
+
+    // Unlock any queued transfers & release their SGL memory
+    PlxDmaQueueReleaseAll(
+        pdx,
+        channel
+        );
+
     // Release memory previously used for SGL descriptors
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa != NULL)
+    if (pdx->DmaInfo[channel].Sgl.SglBuffer.pKernelVa != NULL)
     {
         DebugPrintf(("Releasing memory used for SGL descriptors...\n"));
 
         Plx_dma_buffer_free(
             pdx,
-            &pdx->DmaInfo[channel].SglBuffer
+            &pdx->DmaInfo[channel].Sgl.SglBuffer
             );
     }
 
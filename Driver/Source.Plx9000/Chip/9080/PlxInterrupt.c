@@ -51,6 +51,7 @@
 #include "PciFunc.h"
 #include "PlxChipFn.h"
 #include "PlxInterrupt.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -75,12 +76,15 @@ OnInterrupt(
     U32               RegValue;
     U32               RegPciInt;
     U32               InterruptSource;
+    U32               Doorbell;
     DEVICE_EXTENSION *pdx;
 
 
     // Get the device extension
     pdx = (DEVICE_EXTENSION *)dev_id;
 
+    trace_plx_isr_entry( pdx, irq );
+
     // Disable interrupts and acquire lock 
     spin_lock( &(pdx->Lock_Isr) ); 
 
@@ -95,6 +99,7 @@ OnInterrupt(
     if ((RegPciInt & (1 << 8)) == 0)
     {
         spin_unlock( &(pdx->Lock_Isr) );
+        trace_plx_isr_exit( pdx, INTR_TYPE_NONE, 0 );
         return IRQ_RETVAL(IRQ_NONE);
     }
 
@@ -102,11 +107,25 @@ OnInterrupt(
 
     // Clear the interrupt type flag
     InterruptSource = INTR_TYPE_NONE;
+    Doorbell        = 0;
 
     // Check if PCI Doorbell Interrupt is active and not masked
     if ((RegPciInt & (1 << 13)) && (RegPciInt & (1 << 9)))
     {
         InterruptSource |= INTR_TYPE_DOORBELL;
+
+        // Get & clear doorbells here so each interrupt event keeps its own value
+        Doorbell =
+            PLX_9000_REG_READ(
+                pdx,
+                PCI9080_PCI_DOORBELL
+                );
+
+        PLX_9000_REG_WRITE(
+            pdx,
+            PCI9080_PCI_DOORBELL,
+            Doorbell
+            );
     }
 
     // Check if PCI Abort Interrupt is active and not masked
@@ -179,17 +198,89 @@ OnInterrupt(
     if (InterruptSource == INTR_TYPE_NONE)
     {
         spin_unlock( &(pdx->Lock_Isr) );
+        trace_plx_isr_exit( pdx, INTR_TYPE_NONE, 0 );
         return IRQ_RETVAL(IRQ_NONE);
     }
 
+    // Complete block DMA channel 0 here, since only SGL requires DPC cleanup
+    if (InterruptSource & INTR_TYPE_DMA_0)
+    {
+        RegValue =
+            PLX_9000_REG_READ(
+                pdx,
+                PCI9080_DMA0_MODE
+                );
+
+        if ((RegValue & (1 << 9)) == 0)
+        {
+            // Clear DMA interrupt
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_DMA_COMMAND_STAT
+                    );
+
+            PLX_9000_REG_WRITE(
+                pdx,
+                PCI9080_DMA_COMMAND_STAT,
+                RegValue | (1 << 3)
+                );
+
+            // Wake threads waiting for DMA completion without DPC latency
+            PlxDmaCompletionSignal(
+                pdx,
+                0
+                );
+
+            InterruptSource |= INTR_TYPE_DMA_0_DONE_ISR;
+        }
+    }
+
+    // Complete block DMA channel 1 here, since only SGL requires DPC cleanup
+    if (InterruptSource & INTR_TYPE_DMA_1)
+    {
+        RegValue =
+            PLX_9000_REG_READ(
+                pdx,
+                PCI9080_DMA1_MODE
+                );
+
+        if ((RegValue & (1 << 9)) == 0)
+        {
+            // Clear DMA interrupt
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_DMA_COMMAND_STAT
+                    );
+
+            PLX_9000_REG_WRITE(
+                pdx,
+                PCI9080_DMA_COMMAND_STAT,
+                RegValue | (1 << 11)
+                );
+
+            // Wake threads waiting for DMA completion without DPC latency
+            PlxDmaCompletionSignal(
+                pdx,
+                1
+                );
+
+            InterruptSource |= INTR_TYPE_DMA_1_DONE_ISR;
+        }
+    }
+
     // At this point, the device interrupt is verified
 
-    // Mask the PCI Interrupt
-    PLX_9000_REG_WRITE(
-        pdx,
-        PCI9080_INT_CTRL_STAT,
-        RegPciInt & ~(1 << 8)
-        );
+    // Mask the PCI Interrupt, unless only doorbells (already cleared) are active
+    if (InterruptSource != INTR_TYPE_DOORBELL)
+    {
+        PLX_9000_REG_WRITE(
+            pdx,
+            PCI9080_INT_CTRL_STAT,
+            RegPciInt & ~(1 << 8)
+            );
+    }
 
     // Re-enable interrupts and release lock 
     spin_unlock( &(pdx->Lock_Isr) ); 
@@ -198,13 +289,26 @@ OnInterrupt(
     // Schedule deferred procedure (DPC) to complete interrupt processing
     //
 
-    // Provide interrupt source to DPC
-    pdx->Source_Ints = InterruptSource;
+    trace_plx_isr_exit( pdx, InterruptSource, Doorbell );
+
+    // Queue interrupt event for the DPC
+    PlxIntEventPush(
+        pdx,
+        InterruptSource,
+        Doorbell
+        );
 
     // If device is no longer started, do not schedule a DPC
     if (pdx->State != PLX_STATE_STARTED)
         return IRQ_RETVAL(IRQ_HANDLED);
 
+#if defined(PLX_THREADED_IRQ)
+    // Flag a DPC is pending
+    pdx->bDpcPending = TRUE;
+
+    // Wake the IRQ thread to run the DPC
+    return IRQ_WAKE_THREAD;
+#else
     // Add task to system work queue
     schedule_work(
         &(pdx->Task_DpcForIsr)
@@ -214,11 +318,45 @@ OnInterrupt(
     pdx->bDpcPending = TRUE;
 
     return IRQ_RETVAL(IRQ_HANDLED);
+#endif
 }
 
 
 
 
+#if defined(PLX_THREADED_IRQ)
+/*******************************************************************************
+ *
+ * Function   :  OnInterruptThread
+ *
+ * Description:  IRQ thread handler, which runs the DPC at real-time priority
+ *               instead of deferring it to the shared system work queue
+ *
+ ******************************************************************************/
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    // Get the device extension
+    pdx = (DEVICE_EXTENSION *)dev_id;
+
+    // DPC locates the device extension from its work item
+    DpcForIsr(
+        &(pdx->Task_DpcForIsr)
+        );
+
+    return IRQ_RETVAL(IRQ_HANDLED);
+}
+#endif
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  DpcForIsr
@@ -256,156 +394,194 @@ DpcForIsr(
         return;
     }
 
-    // Get interrupt source
-    IntData.Source_Ints     = pdx->Source_Ints;
-    IntData.Source_Doorbell = 0;
-
-    // Local Interrupt 1
-    if (IntData.Source_Ints & INTR_TYPE_LOCAL_1)
+    // Process each interrupt event queued by the ISR, in arrival order
+    while (PlxIntEventPop( pdx, &IntData ))
     {
-        // Synchronize access to Interrupt Control/Status Register
-        spin_lock_irqsave( &(pdx->Lock_Isr), flags );
-
-        // Mask local interrupt 1 since true source is unknown
-        RegValue =
-            PLX_9000_REG_READ(
-                pdx,
-                PCI9080_INT_CTRL_STAT
-                );
-
-        RegValue &= ~(1 << 11);
-
-        PLX_9000_REG_WRITE(
+        trace_plx_dpc(
             pdx,
-            PCI9080_INT_CTRL_STAT,
-            RegValue
+            IntData.Source_Ints,
+            IntData.Source_Doorbell,
+            IntData.Timestamp_ns
             );
 
-        spin_unlock_irqrestore( &(pdx->Lock_Isr), flags );
-    }
-
-    // Doorbell Interrupt
-    if (IntData.Source_Ints & INTR_TYPE_DOORBELL)
-    {
-        // Get Doorbell register
-        RegValue =
-            PLX_9000_REG_READ(
-                pdx,
-                PCI9080_PCI_DOORBELL
-                );
+        // Local Interrupt 1
+        if (IntData.Source_Ints & INTR_TYPE_LOCAL_1)
+        {
+            // Synchronize access to Interrupt Control/Status Register
+            spin_lock_irqsave( &(pdx->Lock_Isr), flags );
 
-        // Clear Doorbell interrupt
-        PLX_9000_REG_WRITE(
-            pdx,
-            PCI9080_PCI_DOORBELL,
-            RegValue
-            );
+            // Mask local interrupt 1 since true source is unknown
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_INT_CTRL_STAT
+                    );
 
-        // Save the doorbell value
-        IntData.Source_Doorbell = RegValue;
-    }
+            RegValue &= ~(1 << 11);
 
-    // PCI Abort interrupt
-    if (IntData.Source_Ints & INTR_TYPE_PCI_ABORT)
-    {
-        // Get the PCI Command register
-        PLX_PCI_REG_READ(
-            pdx,
-            0x04,
-            &RegValue
-            );
+            PLX_9000_REG_WRITE(
+                pdx,
+                PCI9080_INT_CTRL_STAT,
+                RegValue
+                );
 
-        // Write to back to clear PCI Abort
-        PLX_PCI_REG_WRITE(
-            pdx,
-            0x04,
-            RegValue
-            );
-    }
+            spin_unlock_irqrestore( &(pdx->Lock_Isr), flags );
+        }
 
-    // DMA Channel 0 interrupt
-    if (IntData.Source_Ints & INTR_TYPE_DMA_0)
-    {
-        // Get DMA Control/Status
-        RegValue =
-            PLX_9000_REG_READ(
+        // PCI Abort interrupt
+        if (IntData.Source_Ints & INTR_TYPE_PCI_ABORT)
+        {
+            // Get the PCI Command register
+            PLX_PCI_REG_READ(
                 pdx,
-                PCI9080_DMA_COMMAND_STAT
+                0x04,
+                &RegValue
                 );
 
-        // Clear DMA interrupt
-        PLX_9000_REG_WRITE(
-            pdx,
-            PCI9080_DMA_COMMAND_STAT,
-            RegValue | (1 << 3)
-            );
-
-        RegValue =
-            PLX_9000_REG_READ(
+            // Write to back to clear PCI Abort
+            PLX_PCI_REG_WRITE(
                 pdx,
-                PCI9080_DMA0_MODE
+                0x04,
+                RegValue
                 );
+        }
 
-        // Check if SGL is enabled & cleanup
-        if (RegValue & (1 << 9))
+        // DMA Channel 0 interrupt
+        if (IntData.Source_Ints & INTR_TYPE_DMA_0_DONE_ISR)
         {
-            PlxSglDmaTransferComplete(
+            // Block DMA already cleared & signaled by ISR, only record completion
+            PlxDmaCompletionPost(
                 pdx,
-                0
+                0,
+                pdx->DmaInfo[0].BlockByteCount,
+                PLX_STATUS_OK
                 );
         }
-    }
+        else if (IntData.Source_Ints & INTR_TYPE_DMA_0)
+        {
+            // Get DMA Control/Status
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_DMA_COMMAND_STAT
+                    );
+
+            // Clear DMA interrupt
+            PLX_9000_REG_WRITE(
+                pdx,
+                PCI9080_DMA_COMMAND_STAT,
+                RegValue | (1 << 3)
+                );
 
-    // DMA Channel 1 interrupt
-    if (IntData.Source_Ints & INTR_TYPE_DMA_1)
-    {
-        // Get DMA Control/Status
-        RegValue =
-            PLX_9000_REG_READ(
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_DMA0_MODE
+                    );
+
+            // Check if SGL is enabled & cleanup
+            if (RegValue & (1 << 9))
+            {
+                PlxSglDmaTransferComplete(
+                    pdx,
+                    0
+                    );
+            }
+            else
+            {
+                // Record block DMA completion
+                PlxDmaCompletionPost(
+                    pdx,
+                    0,
+                    pdx->DmaInfo[0].BlockByteCount,
+                    PLX_STATUS_OK
+                    );
+            }
+
+            // Wake any threads waiting for DMA completion
+            PlxDmaCompletionSignal(
                 pdx,
-                PCI9080_DMA_COMMAND_STAT
+                0
                 );
+        }
 
-        // Clear DMA interrupt
-        PLX_9000_REG_WRITE(
-            pdx,
-            PCI9080_DMA_COMMAND_STAT,
-            RegValue | (1 << 11)
-            );
+        // DMA Channel 1 interrupt
+        if (IntData.Source_Ints & INTR_TYPE_DMA_1_DONE_ISR)
+        {
+            // Block DMA already cleared & signaled by ISR, only record completion
+            PlxDmaCompletionPost(
+                pdx,
+                1,
+                pdx->DmaInfo[1].BlockByteCount,
+                PLX_STATUS_OK
+                );
+        }
+        else if (IntData.Source_Ints & INTR_TYPE_DMA_1)
+        {
+            // Get DMA Control/Status
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_DMA_COMMAND_STAT
+                    );
+
+            // Clear DMA interrupt
+            PLX_9000_REG_WRITE(
+                pdx,
+                PCI9080_DMA_COMMAND_STAT,
+                RegValue | (1 << 11)
+                );
 
-        RegValue =
-            PLX_9000_REG_READ(
+            RegValue =
+                PLX_9000_REG_READ(
+                    pdx,
+                    PCI9080_DMA1_MODE
+                    );
+
+            // Check if SGL is enabled & cleanup
+            if (RegValue & (1 << 9))
+            {
+                PlxSglDmaTransferComplete(
+                    pdx,
+                    1
+                    );
+            }
+            else
+            {
+                // Record block DMA completion
+                PlxDmaCompletionPost(
+                    pdx,
+                    1,
+                    pdx->DmaInfo[1].BlockByteCount,
+                    PLX_STATUS_OK
+                    );
+            }
+
+            // Wake any threads waiting for DMA completion
+            PlxDmaCompletionSignal(
                 pdx,
-                PCI9080_DMA1_MODE
+                1
                 );
+        }
 
-        // Check if SGL is enabled & cleanup
-        if (RegValue & (1 << 9))
+        // Outbound post FIFO interrupt
+        if (IntData.Source_Ints & INTR_TYPE_OUTBOUND_POST)
         {
-            PlxSglDmaTransferComplete(
+            // Mask Outbound Post interrupt
+            PLX_9000_REG_WRITE(
                 pdx,
-                1
+                PCI9080_OUTPOST_INT_MASK,
+                (1 << 3)
                 );
         }
-    }
 
-    // Outbound post FIFO interrupt
-    if (IntData.Source_Ints & INTR_TYPE_OUTBOUND_POST)
-    {
-        // Mask Outbound Post interrupt
-        PLX_9000_REG_WRITE(
+        // Signal any objects waiting for notification
+        PlxSignalNotifications(
             pdx,
-            PCI9080_OUTPOST_INT_MASK,
-            (1 << 3)
+            &IntData
             );
     }
 
-    // Signal any objects waiting for notification
-    PlxSignalNotifications(
-        pdx,
-        &IntData
-        );
-
     // Re-enable interrupts
     PlxChipInterruptsEnable(
         pdx
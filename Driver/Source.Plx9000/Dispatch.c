@@ -176,6 +176,12 @@ Dispatch_release(
             fdo->DeviceExtension,
             filp
             );
+
+        // Release any BAR windows locked by process
+        PlxPciBarWindowUnlockAll_ByOwner(
+            fdo->DeviceExtension,
+            filp
+            );
     }
 
     DebugPrintf(("...device closed\n"));
@@ -326,6 +332,29 @@ Dispatch_mmap(
             "Mapped Phys (%08llx) ==> User VA (%08lx)\n",
             AddressToMap, vma->vm_start
             ));
+
+        // Keep the window expected by the mapping of a local space
+        if (bDeviceMem)
+        {
+            PlxPciBarMapTrack(
+                pdx,
+                vma,
+                (U8)offset
+                );
+        }
+
+#if defined(PLX_DMA_SUPPORT)
+        // Prevent release of a DMA completion ring while mapped
+        if (bDeviceMem == FALSE)
+        {
+            PlxDmaCompletionRingMapTrack(
+                pdx,
+                vma,
+                AddressToMap,
+                filp
+                );
+        }
+#endif
     }
 
     DebugPrintf(("...Completed message\n"));
@@ -335,6 +364,86 @@ Dispatch_mmap(
 
 
 
+/******************************************************************************
+ *
+ * Function   :  Dispatch_poll
+ *
+ * Description:  Handle poll()/select()/epoll() on a device handle
+ *
+ * Note       :  The handle is readable while any notification object it owns
+ *               has interrupt sources not yet retrieved with a status request.
+ *
+ ******************************************************************************/
+__poll_t
+Dispatch_poll(
+    struct file *filp,
+    poll_table  *wait
+    )
+{
+    __poll_t          mask;
+    unsigned long     flags;
+    struct list_head *pEntry;
+    PLX_WAIT_OBJECT  *pWaitObject;
+    DEVICE_EXTENSION *pdx;
+
+
+    // Management interface has no notifications
+    if (iminor(filp->f_path.dentry->d_inode) == PLX_MNGMT_INTERFACE)
+    {
+        return POLLERR;
+    }
+
+    // Get device extension
+    pdx = ((DEVICE_OBJECT*)(filp->private_data))->DeviceExtension;
+
+    poll_wait(
+        filp,
+        &(pdx->WaitQueue_Poll),
+        wait
+        );
+
+    mask = 0;
+
+    spin_lock_irqsave(
+        &(pdx->Lock_WaitObjectsList),
+        flags
+        );
+
+    pEntry = pdx->List_WaitObjects.next;
+
+    // Check for any triggered object owned by this handle
+    while (pEntry != &(pdx->List_WaitObjects))
+    {
+        // Get the object
+        pWaitObject =
+            list_entry(
+                pEntry,
+                PLX_WAIT_OBJECT,
+                ListEntry
+                );
+
+        if ((pWaitObject->pOwner == filp) &&
+            (pWaitObject->Source_Ints || pWaitObject->Source_Doorbell))
+        {
+            mask = POLLIN | POLLRDNORM;
+            break;
+        }
+
+        // Jump to next item in the list
+        pEntry = pEntry->next;
+    }
+
+    spin_unlock_irqrestore(
+        &(pdx->Lock_WaitObjectsList),
+        flags
+        );
+
+    return mask;
+}
+
+
+
+
 /******************************************************************************
  *
  * Function   :  Dispatch_IoControl
@@ -350,6 +459,9 @@ Dispatch_IoControl(
     )
 {
     int               status;
+#if defined(PLX_MU_SUPPORT)
+    U32               Count;
+#endif
     VOID             *pOwner;
     PLX_PARAMS        IoBuffer;
     PLX_PARAMS       *pIoBuffer;
@@ -636,6 +748,18 @@ Dispatch_IoControl(
                 ));
             break;
 
+        case PLX_IOCTL_REGISTER_BATCH:
+            DebugPrintf_Cont(("PLX_IOCTL_REGISTER_BATCH\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxRegisterBatch(
+                    pdx,
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (U32)pIoBuffer->value[0],
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[1]) )
+                    );
+            break;
+
         case PLX_IOCTL_MAILBOX_READ:
             DebugPrintf_Cont(("PLX_IOCTL_MAILBOX_READ\n"));
 
@@ -670,6 +794,47 @@ Dispatch_IoControl(
                 ));
             break;
 
+#if defined(PLX_MU_SUPPORT)
+        case PLX_IOCTL_MU_QUEUE_INIT:
+            DebugPrintf_Cont(("PLX_IOCTL_MU_QUEUE_INIT\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxChip_MuQueueInit(
+                    pdx,
+                    (U32)pIoBuffer->value[0],
+                    (U32)pIoBuffer->value[1]
+                    );
+            break;
+
+        case PLX_IOCTL_MU_INBOUND_POST:
+            DebugPrintf_Cont(("PLX_IOCTL_MU_INBOUND_POST\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxChip_MuInboundPost(
+                    pdx,
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (U32)pIoBuffer->value[0],
+                    &Count
+                    );
+
+            pIoBuffer->value[1] = Count;
+            break;
+
+        case PLX_IOCTL_MU_OUTBOUND_DRAIN:
+            DebugPrintf_Cont(("PLX_IOCTL_MU_OUTBOUND_DRAIN\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxChip_MuOutboundDrain(
+                    pdx,
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (U32)pIoBuffer->value[0],
+                    &Count
+                    );
+
+            pIoBuffer->value[1] = Count;
+            break;
+#endif
+
 
         /******************************************
          * PCI Mapping Functions
@@ -983,6 +1148,37 @@ Dispatch_IoControl(
                     );
             break;
 
+        case PLX_IOCTL_NOTIFICATION_EVENTFD_BIND:
+            DebugPrintf_Cont(("PLX_IOCTL_NOTIFICATION_EVENTFD_BIND\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxNotificationEventFdBind(
+                    pdx,
+                    PLX_INT_TO_PTR(pIoBuffer->value[0]),
+                    (int)pIoBuffer->value[1],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_INTR_COALESCE_SET:
+            DebugPrintf_Cont(("PLX_IOCTL_INTR_COALESCE_SET\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxInterruptCoalesceSet(
+                    pdx,
+                    (U32)pIoBuffer->value[0],
+                    (U32)pIoBuffer->value[1]
+                    );
+            break;
+
+        case PLX_IOCTL_INTR_EVENT_DROP_COUNT:
+            DebugPrintf_Cont(("PLX_IOCTL_INTR_EVENT_DROP_COUNT\n"));
+
+            // Interrupt events dropped because the ISR->DPC queue was full
+            pIoBuffer->value[0]   = pdx->IntEventDropCount;
+            pIoBuffer->ReturnCode = PLX_STATUS_OK;
+            break;
+
 
         /******************************************
          *         VPD Functions
@@ -1045,6 +1241,29 @@ Dispatch_IoControl(
                     );
             break;
 
+        case PLX_IOCTL_PCI_BAR_WINDOW_LOCK:
+            DebugPrintf_Cont(("PLX_IOCTL_PCI_BAR_WINDOW_LOCK\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxPciBarWindowLock(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    (U32)pIoBuffer->value[1],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_PCI_BAR_WINDOW_UNLOCK:
+            DebugPrintf_Cont(("PLX_IOCTL_PCI_BAR_WINDOW_UNLOCK\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxPciBarWindowUnlock(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    pOwner
+                    );
+            break;
+
 
         /******************************************
          * DMA Functions
@@ -1104,11 +1323,29 @@ Dispatch_IoControl(
                     (U8)pIoBuffer->value[0],
                     pOwner
                     );
+
+#if defined(PLX_DMA_SUPPORT)
+            // Return number of descriptors in last SGL built for the channel
+            if (pIoBuffer->value[0] < NUM_DMA_CHANNELS)
+            {
+                pIoBuffer->value[1] =
+                    pdx->DmaInfo[pIoBuffer->value[0]].NumDescriptors;
+            }
+#endif
             break;
 
         case PLX_IOCTL_DMA_TRANSFER_BLOCK:
             DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_BLOCK\n"));
 
+#if defined(PLX_DMA_SUPPORT)
+            // Return completion sequence of the transfer for a later wait on it
+            if (pIoBuffer->value[0] < NUM_DMA_CHANNELS)
+            {
+                pIoBuffer->value[1] =
+                    PLX_DMA_NEXT_DONE_SEQ( pdx, pIoBuffer->value[0] );
+            }
+#endif
+
             pIoBuffer->ReturnCode =
                 PlxChip_DmaTransferBlock(
                     pdx,
@@ -1121,6 +1358,21 @@ Dispatch_IoControl(
         case PLX_IOCTL_DMA_TRANSFER_USER_BUFFER:
             DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_USER_BUFFER\n"));
 
+#if defined(PLX_DMA_SUPPORT)
+            // Split transfer across both channels if requested
+            if (pIoBuffer->u.TxParams.bStriped)
+            {
+                pIoBuffer->ReturnCode =
+                    PlxDmaTransferStriped(
+                        pdx,
+                        &(pIoBuffer->u.TxParams),
+                        0,
+                        pOwner
+                        );
+                break;
+            }
+#endif
+
             pIoBuffer->ReturnCode =
                 PlxChip_DmaTransferUserBuffer(
                     pdx,
@@ -1142,6 +1394,171 @@ Dispatch_IoControl(
                     );
             break;
 
+#if defined(PLX_DMA_SUPPORT)
+        case PLX_IOCTL_DMA_BUFFER_REGISTER:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_BUFFER_REGISTER\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaBufferRegister(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    &(pIoBuffer->u.TxParams),
+                    &(pIoBuffer->value[1]),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_BUFFER_UNREGISTER:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_BUFFER_UNREGISTER\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaBufferUnregister(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    pIoBuffer->value[1],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_TRANSFER_REG_BUFFER:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_REG_BUFFER\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaTransferRegBuffer(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    pIoBuffer->value[1],
+                    (U32)pIoBuffer->value[2],
+                    pIoBuffer->u.TxParams.ByteCount,
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_TRANSFER_QUEUE:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_QUEUE\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaTransferQueue(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    &(pIoBuffer->u.TxParams),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_QUEUE_STATUS:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_QUEUE_STATUS\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaQueueStatus(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[1]) ),
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[2]) ),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_TRANSFER_WAIT:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_WAIT\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaTransferWait(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    &(pIoBuffer->u.TxParams),
+                    (BOOLEAN)pIoBuffer->value[2],
+                    (PLX_UINT_PTR)pIoBuffer->value[1],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_WAIT_DONE:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_WAIT_DONE\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaWaitDone(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    (U32)pIoBuffer->value[1],
+                    (PLX_UINT_PTR)pIoBuffer->value[2],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_TRANSFER_VECTOR:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_TRANSFER_VECTOR\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaTransferVector(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    (PLX_UINT_PTR)pIoBuffer->u.ExData[0],
+                    (U32)pIoBuffer->value[1],
+                    (PLX_UINT_PTR)pIoBuffer->value[2],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_RING_START:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_RING_START\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaRingStart(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    &(pIoBuffer->u.TxParams),
+                    (U32)pIoBuffer->value[1],
+                    &(pIoBuffer->value[2]),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_RING_STOP:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_RING_STOP\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaRingStop(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_COMPLETION_RING_CREATE:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_COMPLETION_RING_CREATE\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaCompletionRingCreate(
+                    pdx,
+                    &(pIoBuffer->value[0]),
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_COMPLETION_RING_DESTROY:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_COMPLETION_RING_DESTROY\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaCompletionRingDestroy(
+                    pdx,
+                    pOwner
+                    );
+            break;
+
+        case PLX_IOCTL_DMA_GET_STATISTICS:
+            DebugPrintf_Cont(("PLX_IOCTL_DMA_GET_STATISTICS\n"));
+
+            pIoBuffer->ReturnCode =
+                PlxDmaGetStatistics(
+                    pdx,
+                    (U8)pIoBuffer->value[0],
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (BOOLEAN)pIoBuffer->value[1]
+                    );
+            break;
+#endif
+
 
         /******************************************
          * Unsupported Messages
@@ -1168,3 +1585,57 @@ _Exit_Dispatch_IoControl:
 
     return status;
 }
+
+
+
+
+#if defined(PLX_IO_URING)
+/*******************************************************************************
+ *
+ * Function   :  Dispatch_uring_cmd
+ *
+ * Description:  Handle a PLX message submitted through io_uring
+ *
+ * Note       :  The SQE command opcode is the IOCTL code & the command area
+ *               holds the user address of the PLX_PARAMS message.  Messages
+ *               that may sleep are refused in non-blocking context, so
+ *               io_uring re-issues them from a worker thread & a batch of
+ *               waits completes independently of the submitter.
+ *
+ ******************************************************************************/
+int
+Dispatch_uring_cmd(
+    struct io_uring_cmd *ioucmd,
+    unsigned int         issue_flags
+    )
+{
+    const PLX_URING_CMD *pCmd;
+
+
+    pCmd = io_uring_sqe_cmd( ioucmd->sqe );
+
+    // Only register accesses are processed in the submitter's context
+    if (issue_flags & IO_URING_F_NONBLOCK)
+    {
+        switch (ioucmd->cmd_op)
+        {
+            case PLX_IOCTL_PCI_REGISTER_READ:
+            case PLX_IOCTL_PCI_REGISTER_WRITE:
+            case PLX_IOCTL_REGISTER_READ:
+            case PLX_IOCTL_REGISTER_WRITE:
+            case PLX_IOCTL_MAPPED_REGISTER_READ:
+            case PLX_IOCTL_MAPPED_REGISTER_WRITE:
+                break;
+
+            default:
+                return (-EAGAIN);
+        }
+    }
+
+    return Dispatch_IoControl(
+        ioucmd->file,
+        ioucmd->cmd_op,
+        (unsigned long)READ_ONCE(pCmd->pIoBuffer)
+        );
+}
+#endif
@@ -52,8 +52,13 @@
 
 
 #include <linux/fs.h>
+#include <linux/poll.h>
 #include "Plx_sysdep.h"
 
+#if defined(PLX_IO_URING)
+    #include <linux/io_uring/cmd.h>
+#endif
+
 
 
 
@@ -78,6 +83,12 @@ Dispatch_mmap(
     struct vm_area_struct *vma
     );
 
+__poll_t
+Dispatch_poll(
+    struct file *filp,
+    poll_table  *wait
+    );
+
 long
 Dispatch_IoControl(
     struct file   *filp,
@@ -85,6 +96,14 @@ Dispatch_IoControl(
     unsigned long  args
     );
 
+#if defined(PLX_IO_URING)
+int
+Dispatch_uring_cmd(
+    struct io_uring_cmd *ioucmd,
+    unsigned int         issue_flags
+    );
+#endif
+
 
 
 
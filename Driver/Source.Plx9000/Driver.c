@@ -48,6 +48,7 @@
  *****************************************************************************/
 
 
+#include <linux/debugfs.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/sched.h>
@@ -76,6 +77,10 @@
 #include "Plx_sysdep.h"
 #include "SuppFunc.h"
 
+// Instantiate the driver trace events in this file only
+#define CREATE_TRACE_POINTS
+#include "PlxTrace.h"
+
 
 
 
@@ -140,6 +145,11 @@ static struct pci_device_id PlxPciIdTable[] =
 };
 MODULE_DEVICE_TABLE(pci, PlxPciIdTable);
 
+// CPU to service device interrupts & run the IRQ thread (-1 = any CPU)
+static int PlxIrqCpu = -1;
+module_param(PlxIrqCpu, int, S_IRUGO);
+MODULE_PARM_DESC(PlxIrqCpu, "CPU to service device interrupts (-1 = any)");
+
 // Driver registration functions
 static struct pci_driver PlxPciDriver =
 {
@@ -208,16 +218,46 @@ Plx_init_module(
     pGbl_DriverObject->DispatchTable.mmap    = Dispatch_mmap;
     pGbl_DriverObject->DispatchTable.open    = Dispatch_open;
     pGbl_DriverObject->DispatchTable.release = Dispatch_release;
+    pGbl_DriverObject->DispatchTable.poll    = Dispatch_poll;
 
     // Use newer IOCTL functions
     pGbl_DriverObject->DispatchTable.unlocked_ioctl = Dispatch_IoControl;
     pGbl_DriverObject->DispatchTable.compat_ioctl   = Dispatch_IoControl;
 
+#if defined(PLX_IO_URING)
+    // Accept messages submitted through io_uring
+    pGbl_DriverObject->DispatchTable.uring_cmd = Dispatch_uring_cmd;
+#endif
+
     // Initialize spin locks
     spin_lock_init(
         &(pGbl_DriverObject->Lock_DeviceList)
         );
 
+    // Create cache for notification wait objects
+    pGbl_DriverObject->pCache_WaitObject =
+        Plx_kmem_cache_create(
+            PLX_DRIVER_NAME "_WaitObject",
+            sizeof(PLX_WAIT_OBJECT)
+            );
+
+    if (pGbl_DriverObject->pCache_WaitObject == NULL)
+    {
+        ErrorPrintf(("ERROR - Unable to create wait object cache\n"));
+        kfree( pGbl_DriverObject );
+        pGbl_DriverObject = NULL;
+        return (-ENOMEM);
+    }
+
+#if defined(PLX_DMA_SUPPORT) && defined(PLX_DEBUGFS)
+    // Create debugfs directory for device statistics
+    pGbl_DriverObject->pDebugFsRoot =
+        debugfs_create_dir(
+            PLX_DRIVER_NAME,
+            NULL
+            );
+#endif
+
     /*********************************************************
      * Register the driver with the OS
      *
@@ -342,6 +382,17 @@ Plx_cleanup_module(
         PLX_DRIVER_NAME
         );
 
+    // Release wait object cache
+    if (pGbl_DriverObject->pCache_WaitObject != NULL)
+    {
+        kmem_cache_destroy( pGbl_DriverObject->pCache_WaitObject );
+    }
+
+#if defined(PLX_DMA_SUPPORT) && defined(PLX_DEBUGFS)
+    // Remove debugfs directory
+    debugfs_remove_recursive( pGbl_DriverObject->pDebugFsRoot );
+#endif
+
     DebugPrintf((
         "Release global driver object (%p)\n",
         pGbl_DriverObject
@@ -492,6 +543,7 @@ AddDevice(
     struct pci_dev *pPciDev
     )
 {
+    U8                i;
     int               status;
     U32               RegValue;
     DEVICE_OBJECT    *fdo;
@@ -596,21 +648,74 @@ AddDevice(
     // Initialize interrupt wait list
     INIT_LIST_HEAD( &(pdx->List_WaitObjects) );
     spin_lock_init( &(pdx->Lock_WaitObjectsList) );
+    init_waitqueue_head( &(pdx->WaitQueue_Poll) );
+    idr_init( &(pdx->Idr_WaitObjects) );
+
+    for (i = 0; i < PLX_WAIT_SOURCE_COUNT; i++)
+    {
+        INIT_LIST_HEAD( &(pdx->List_WaitBySource[i]) );
+    }
+
+    // Initialize interrupt moderation, disabled by default
+    spin_lock_init( &(pdx->Lock_Coalesce) );
+
+    Plx_hrtimer_setup(
+        &(pdx->Timer_Coalesce),
+        OnCoalesceTimer,
+        CLOCK_MONOTONIC,
+        HRTIMER_MODE_REL
+        );
+
+    // Initialize BAR space transfer mutex
+    Plx_sema_init( &(pdx->Mutex_BarSpace), 1 );
+
+    // Remap window cache starts out invalid (cleared with device extension)
+    atomic_set( &(pdx->RemapGeneration), 0 );
+    atomic_set( &(pdx->RemapRestorePending), 0 );
+
+    // Initialize register batch mutex
+    Plx_sema_init( &(pdx->Mutex_RegBatch), 1 );
 
     // Initialize physical memories list
     INIT_LIST_HEAD( &(pdx->List_PhysicalMem) );
     spin_lock_init( &(pdx->Lock_PhysicalMemList) );
 
+#if defined(PLX_MU_SUPPORT)
+    // Initialize messaging unit spinlock
+    spin_lock_init( &(pdx->Lock_Mu) );
+#endif
+
 #if defined(PLX_DMA_SUPPORT)
     /****************************************************************
      * Set the DMA mask
      *
-     * Although PLX devices can handle 64-bit DMA addressing through
-     * dual cycles, this driver does not support that feature.  As
-     * a result, the OS is notified to keep this device's DMA mask
-     * to 32-bit, which is the default.
+     * Chips with a DMA dual address cycle (DAC) register can reach
+     * 64-bit PCI addresses through 64-bit SGL descriptors. In that
+     * case the OS is notified the device supports a 64-bit DMA mask
+     * so that user buffers above 4GB are not bounce buffered. SGL
+     * descriptors themselves are always allocated below 4GB.
      ***************************************************************/
+    pdx->bDmaAddr64 = FALSE;
+
+#if defined(DMA_DAC_SUPPORT)
+    if (dma_set_mask( &(pdx->pPciDevice->dev), PLX_DMA_BIT_MASK(64) ) == 0)
+    {
+        DebugPrintf(("Set DMA bit mask to 64-bits\n"));
+
+        // Only use larger descriptors if system memory extends above 4GB
+        if (dma_get_required_mask( &(pdx->pPciDevice->dev) ) > PLX_DMA_BIT_MASK(32))
+        {
+            pdx->bDmaAddr64 = TRUE;
+        }
+    }
+    else
+    {
+        DebugPrintf(("ERROR - Unable to set DMA mask to 64-bits, revert to 32-bit\n"));
+        dma_set_mask( &(pdx->pPciDevice->dev), PLX_DMA_BIT_MASK(32) );
+    }
+#else
     dma_set_mask( &(pdx->pPciDevice->dev), PLX_DMA_BIT_MASK(32) );
+#endif
 
     // Set buffer allocation mask
     if (Plx_dma_set_coherent_mask( pdx, PLX_DMA_BIT_MASK(32) ) != 0)
@@ -618,13 +723,30 @@ AddDevice(
         ErrorPrintf(("WARNING - Set DMA coherent mask failed\n"));
     }
 
-    // Initialize DMA spinlocks
+    // Initialize DMA completion rings list
+    INIT_LIST_HEAD( &(pdx->List_CompletionRings) );
+    spin_lock_init( &(pdx->Lock_CompletionRingList) );
+
+    // Initialize DMA statistics spinlock
+    spin_lock_init( &(pdx->Lock_DmaStats) );
+
+#if defined(PLX_DEBUGFS)
+    // Export DMA statistics in debugfs
+    PlxDmaStatsDebugFsCreate(
+        pdx,
+        pDriverObject->pDebugFsRoot
+        );
+#endif
+
+    // Initialize DMA spinlocks & completion wait queues
     {
         U8 channel;
 
         for (channel = 0; channel < NUM_DMA_CHANNELS; channel++)
         {
             spin_lock_init( &(pdx->Lock_Dma[channel]) );
+            init_waitqueue_head( &(pdx->DmaInfo[channel].WaitDone) );
+            atomic_set( &(pdx->DmaInfo[channel].DoneCount), 0 );
         }
     }
 #endif  // PLX_DMA_SUPPORT
@@ -749,6 +871,20 @@ RemoveDevice(
     // Release Device List lock
     spin_unlock( &(fdo->DriverObject->Lock_DeviceList) );
 
+    // Release notification handle table
+    idr_destroy( &(pdx->Idr_WaitObjects) );
+
+#if defined(PLX_DMA_SUPPORT) && defined(PLX_DEBUGFS)
+    // Remove DMA statistics from debugfs
+    PlxDmaStatsDebugFsRemove( pdx );
+#endif
+
+    // Release BAR space transfer bounce page
+    if (pdx->pBarBounce != NULL)
+    {
+        free_page( (unsigned long)pdx->pBarBounce );
+    }
+
     // Disable the device
     DebugPrintf(("Disable device\n"));
     pci_disable_device( pdx->pPciDevice );
@@ -951,6 +1087,17 @@ StartDevice(
         pdx->IrqType = PLX_IRQ_TYPE_INTX;
 
         // Install the ISR
+#if defined(PLX_THREADED_IRQ)
+        rc =
+            request_threaded_irq(
+                pdx->pPciDevice->irq,    // The device IRQ
+                OnInterrupt,             // Interrupt handler
+                OnInterruptThread,       // IRQ thread to run the DPC
+                IRQF_SHARED,             // Flags, support interrupt sharing
+                PLX_DRIVER_NAME,         // The driver name
+                pdx                      // Parameter to the ISR
+                );
+#else
         rc =
             request_irq(
                 pdx->pPciDevice->irq,    // The device IRQ
@@ -959,6 +1106,7 @@ StartDevice(
                 PLX_DRIVER_NAME,         // The driver name
                 pdx                      // Parameter to the ISR
                 );
+#endif
 
         if (rc != 0)
         {
@@ -969,6 +1117,24 @@ StartDevice(
         {
             DebugPrintf(("Installed ISR for interrupt\n"));
 
+            // Pin interrupt & its IRQ thread to a CPU if requested
+            if (PlxIrqCpu >= 0)
+            {
+                if (((unsigned int)PlxIrqCpu < nr_cpu_ids) && cpu_online(PlxIrqCpu))
+                {
+                    DebugPrintf(("Set interrupt affinity to CPU %d\n", PlxIrqCpu));
+
+                    Plx_irq_set_affinity_hint(
+                        pdx->pPciDevice->irq,
+                        cpumask_of(PlxIrqCpu)
+                        );
+                }
+                else
+                {
+                    ErrorPrintf(("WARNING - CPU %d not available for interrupt affinity\n", PlxIrqCpu));
+                }
+            }
+
             // Enable interrupts on success
             PlxChipInterruptsEnable( pdx );
         }
@@ -1044,6 +1210,9 @@ StopDevice(
         schedule_timeout( Plx_ms_to_jiffies( 100 ) );
     }
 
+    // Stop interrupt moderation timer
+    hrtimer_cancel( &(pdx->Timer_Coalesce) );
+
     // Release interrupt resources
     if (pdx->IrqType != PLX_IRQ_TYPE_NONE)
     {
@@ -1051,6 +1220,9 @@ StopDevice(
             "Remove ISR (IRQ = %02d [%02Xh])\n",
             pdx->pPciDevice->irq, pdx->pPciDevice->irq
             ));
+        // Affinity hint must be removed before the IRQ is released
+        Plx_irq_set_affinity_hint( pdx->pPciDevice->irq, NULL );
+
         free_irq( pdx->pPciDevice->irq, pdx );
 
         // Mark the interrupt resource released
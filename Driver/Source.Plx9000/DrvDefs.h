@@ -53,8 +53,11 @@
 
 #include <asm/io.h>
 #include <linux/fs.h>
+#include <linux/hrtimer.h>
+#include <linux/idr.h>
 #include <linux/list.h>
 #include <linux/mm.h>
+#include <linux/slab.h>
 #include <linux/version.h>
 #include <linux/workqueue.h>
 #include "Plx.h"
@@ -63,6 +66,10 @@
 #include "PlxTypes.h"
 #include "Plx_sysdep.h"
 
+#if defined(PLX_EVENTFD_SUPPORT)
+    #include <linux/eventfd.h>
+#endif
+
 
 
 
@@ -72,6 +79,7 @@
 #define PLX_MNGMT_INTERFACE                 0xff          // Minor number of Management interface
 #define PLX_MAX_NAME_LENGTH                 0x20          // Max length of registered device name
 #define MIN_WORKING_POWER_STATE             PowerDeviceD2 // Minimum state required for local register access
+#define PLX_MU_FRAMES_PER_COPY              32            // Message frames staged per user copy for MU queue access
 
 // Used for build of SGL descriptors
 #define SGL_DESC_IDX_PCI_LOW                0
@@ -79,6 +87,25 @@
 #define SGL_DESC_IDX_COUNT                  2
 #define SGL_DESC_IDX_NEXT_DESC              3
 #define SGL_DESC_IDX_PCI_HIGH               4
+#define SGL_DESC_MAX_U32                    8             // Largest descriptor size (in 32-bit words)
+#define DMA_MAX_REG_BUFFERS                 8             // Max registered user buffers per DMA channel
+#define DMA_MAX_QUEUE_ENTRIES               16            // Max queued SGL transfers per DMA channel
+#define DMA_MAX_VECTOR_ENTRIES              256           // Max user buffers in a vectored SGL transfer
+#define PLX_INT_EVENT_QUEUE_SIZE            64            // ISR->DPC interrupt event queue entries (power of 2)
+#define PLX_WAIT_SOURCE_DOORBELL            8             // Waiter list index for doorbells (0-7 are INTR_TYPE_Xxx bits)
+#define PLX_WAIT_SOURCE_COUNT               9             // Number of per-source waiter lists
+#define PLX_COALESCE_MAX_DELAY_US           1000000       // Largest interrupt moderation delay limit
+
+// Local configuration & space 1 registers, which may move a local space window
+#define PLX_REG_AFFECTS_REMAP(offset)       (((offset) < 0x40) || ((offset) >= 0xE8))
+
+// Completion sequence number of the next transfer started on a DMA channel
+#define PLX_DMA_NEXT_DONE_SEQ(pdx, channel) \
+    ((U32)atomic_read( &((pdx)->DmaInfo[(channel)].DoneCount) ) + 1)
+
+// Verifies a DMA channel has signaled the completion with a sequence number
+#define PLX_DMA_DONE_SEQ_REACHED(pdx, channel, seq) \
+    ((S32)((U32)atomic_read( &((pdx)->DmaInfo[(channel)].DoneCount) ) - (seq)) >= 0)
 
 // Used to dump SGL descriptors in debug mode  (0 = Do Not Display   1 = Display SGL Descriptors)
 #if defined(PLX_DISPLAY_SGL)
@@ -143,16 +170,6 @@
 
 
 
-// Macros for Memory access to/from user-space addresses
-#define DEV_MEM_TO_USER_8( VaUser, VaDev, count)    Plx_dev_mem_to_user_8(  (U8*)(VaUser),  (U8*)(VaDev), (count))
-#define DEV_MEM_TO_USER_16(VaUser, VaDev, count)    Plx_dev_mem_to_user_16((U16*)(VaUser), (U16*)(VaDev), (count))
-#define DEV_MEM_TO_USER_32(VaUser, VaDev, count)    Plx_dev_mem_to_user_32((U32*)(VaUser), (U32*)(VaDev), (count))
-#define USER_TO_DEV_MEM_8( VaDev, VaUser, count)    Plx_user_to_dev_mem_8(  (U8*)(VaDev),   (U8*)(VaUser), (count))
-#define USER_TO_DEV_MEM_16(VaDev, VaUser, count)    Plx_user_to_dev_mem_16((U16*)(VaDev),  (U16*)(VaUser), (count))
-#define USER_TO_DEV_MEM_32(VaDev, VaUser, count)    Plx_user_to_dev_mem_32((U32*)(VaDev),  (U32*)(VaUser), (count))
-
-
-
 // Macros for I/O port access
 #define IO_PORT_READ_8(port)                        inb( (U16)(port) )
 #define IO_PORT_READ_16(port)                       inw( (U16)(port) )
@@ -185,6 +202,12 @@
     #define PHYS_MEM_WRITE_32(addr, data)           writel( (data), (addr) )
 #endif
 
+// 64-bit accesses are not provided by all ioreadX() implementations
+#if defined(PLX_MMIO_64)
+    #define PHYS_MEM_READ_64                        readq
+    #define PHYS_MEM_WRITE_64(addr, data)           writeq( (data), (addr) )
+#endif
+
 
 
 // Macros for PLX chip register access
@@ -201,18 +224,30 @@
 
 
 
+// Entry of a wait object in a per-source waiter list
+typedef struct _PLX_WAIT_SOURCE_NODE
+{
+    struct list_head         ListEntry;
+    struct _PLX_WAIT_OBJECT *pWaitObject;       // Wait object the entry belongs to
+} PLX_WAIT_SOURCE_NODE;
+
+
 // PCI Interrupt wait object
 typedef struct _PLX_WAIT_OBJECT
 {
-    struct list_head   ListEntry;
-    VOID              *pOwner;
-    U32                Notify_Flags;            // Registered interrupt(s) for notification
-    U32                Notify_Doorbell;         // Registered doorbell interrupt(s) for notification
-    U32                Source_Ints;             // Interrupt(s) that caused notification
-    U32                Source_Doorbell;         // Doorbells that caused notification
-    PLX_STATE          state;                   // Current state of the object
-    atomic_t           SleepCount;              // Number of currently sleeping threads for this object
-    wait_queue_head_t  WaitQueue;
+    struct list_head     ListEntry;
+    PLX_WAIT_SOURCE_NODE SourceNode[PLX_WAIT_SOURCE_COUNT]; // Entries in per-source waiter lists
+    int                  Handle;                // ID provided to user as the object handle
+    U32                  SignalSeq;             // Last DPC pass that signaled the object
+    VOID                *pOwner;
+    U32                  Notify_Flags;          // Registered interrupt(s) for notification
+    U32                  Notify_Doorbell;       // Registered doorbell interrupt(s) for notification
+    U32                  Source_Ints;           // Interrupt(s) that caused notification
+    U32                  Source_Doorbell;       // Doorbells that caused notification
+    PLX_STATE            state;                 // Current state of the object
+    struct eventfd_ctx  *pEventFd;              // Optional user eventfd signaled on notification
+    atomic_t             SleepCount;            // Number of currently sleeping threads for this object
+    wait_queue_head_t    WaitQueue;
 } PLX_WAIT_OBJECT;
 
 
@@ -222,9 +257,19 @@ typedef struct _PLX_INTERRUPT_DATA
     struct _DEVICE_EXTENSION *pdx;
     U32                       Source_Ints;
     U32                       Source_Doorbell;
+    U64                       Timestamp_ns;             // Time the ISR detected the interrupt
 } PLX_INTERRUPT_DATA;
 
 
+// Interrupt event queued by the ISR for the DPC
+typedef struct _PLX_INT_EVENT
+{
+    U32 Source_Ints;                                    // Interrupts detected by ISR
+    U32 Source_Doorbell;                                // Doorbell value read & cleared by ISR
+    U64 Timestamp_ns;                                   // Time the ISR detected the interrupt
+} PLX_INT_EVENT;
+
+
 // Information about contiguous, page-locked buffers
 typedef struct _PLX_PHYS_MEM_OBJECT
 {
@@ -234,6 +279,7 @@ typedef struct _PLX_PHYS_MEM_OBJECT
     U64               CpuPhysical;              // CPU Physical Address
     U64               BusPhysical;              // Bus Physical Address
     U32               Size;                     // Buffer size
+    atomic_t          MapCount;                 // Number of user mappings (DMA completion rings only)
 } PLX_PHYS_MEM_OBJECT;
 
 
@@ -246,6 +292,57 @@ typedef struct _PLX_PCI_BAR_INFO
 } PLX_PCI_BAR_INFO;
 
 
+// Page-locked user buffer & the SGL describing it
+typedef struct _PLX_DMA_SGL
+{
+    PLX_UINT_PTR          UserVa;               // User virtual address of buffer start
+    U32                   LocalAddr;            // Local address of buffer start
+    BOOLEAN               bConstAddrLocal;      // Flag whether local address remains constant
+    U8                    SizeDescr;            // Size of each SGL descriptor in bytes
+    U32                   NumPages;             // Number of pages mapped for user buffer
+    U32                   NumDescriptors;       // Number of SGL descriptors after merging contiguous pages
+    U32                   InitialOffset;        // Initial offset of user buffer
+    U32                   BufferSize;           // Total size of the user buffer
+    int                   direction;            // The direction of the transfer
+    struct page         **PageList;             // List of locked user pages
+    PLX_PHYS_MEM_OBJECT   SglBuffer;            // SGL descriptor list buffer
+} PLX_DMA_SGL;
+
+
+// User buffer kept page-locked with a pre-built SGL for repeated transfers
+typedef struct _PLX_DMA_REG_BUFFER
+{
+    BOOLEAN               bInUse;               // Flag whether entry is allocated
+    BOOLEAN               bReady;               // Flag whether SGL is built & buffer may be used
+    BOOLEAN               bBusy;                // Flag whether a transfer of the buffer is being started
+    PLX_DMA_SGL           Sgl;                  // Locked buffer & its SGL
+} PLX_DMA_REG_BUFFER;
+
+
+// User buffer transfer submitted to a DMA channel queue
+typedef struct _PLX_DMA_QUEUE_ENTRY
+{
+    BOOLEAN               bInUse;               // Flag whether entry is allocated
+    BOOLEAN               bBits64;              // Flag whether SGL requires 64-bit DMA
+    U32                   SglAddress;           // Bus address of first SGL descriptor
+    PLX_DMA_SGL           Sgl;                  // Locked buffer & its SGL
+} PLX_DMA_QUEUE_ENTRY;
+
+
+// Continuous streaming DMA over a circular SGL
+typedef struct _PLX_DMA_RING
+{
+    BOOLEAN               bActive;              // Flag whether ring streaming is in progress
+    U32                   SglAddress;           // Bus address of first SGL descriptor
+    U32                   NumSegments;          // Number of segments in the ring
+    U32                   SegmentSize;          // Size of each segment in bytes
+    U32                   SegmentActive;        // Segment currently being filled by DMA
+    U32                  *pDescrSegment;        // Ring segment of each SGL descriptor
+    PLX_DMA_SGL           Sgl;                  // Locked ring buffer & its circular SGL
+    PLX_PHYS_MEM_OBJECT   CtrlPage;             // Control page shared with user space
+} PLX_DMA_RING;
+
+
 // DMA channel information 
 typedef struct _PLX_DMA_INFO
 {
@@ -253,12 +350,33 @@ typedef struct _PLX_DMA_INFO
     BOOLEAN               bOpen;                // Flag to note if DMA channel is open
     BOOLEAN               bSglPending;          // Flag to note if an SGL DMA is pending
     BOOLEAN               bConstAddrLocal;      // Flag to keep track if local address remains constant
-    U32                   NumPages;             // Number of pages mapped for user buffer
-    U32                   InitialOffset;        // Initial offset of user buffer
-    U32                   BufferSize;           // Total size of the user buffer
-    int                   direction;            // The direction of the transfer
-    struct page         **PageList;             // List of locked user pages
-    PLX_PHYS_MEM_OBJECT   SglBuffer;            // Current SGL descriptor list buffer
+    U32                   NumDescriptors;       // Number of descriptors in last SGL started
+    PLX_DMA_SGL           Sgl;                  // SGL of current user buffer transfer
+    PLX_DMA_REG_BUFFER    RegBuffer[DMA_MAX_REG_BUFFERS];  // Registered user buffers
+    PLX_DMA_REG_BUFFER   *pRegBufferActive;     // Registered buffer used by pending transfer
+    U32                   RegOffset;            // Offset into registered buffer of pending transfer
+    U32                   RegByteCount;         // Size of pending registered buffer transfer
+    U32                  *pDescrPatched[2];     // First & last descriptors modified for partial transfer
+    U32                   DescrSave[2][SGL_DESC_MAX_U32];  // Original contents of modified descriptors
+    PLX_DMA_QUEUE_ENTRY   Queue[DMA_MAX_QUEUE_ENTRIES];       // Queued user buffer transfers
+    PLX_DMA_QUEUE_ENTRY  *pQueueFifo[DMA_MAX_QUEUE_ENTRIES];  // Queued transfers in order of submission
+    U8                    QueueHead;            // Index of next transfer to start in FIFO
+    U8                    QueueCount;           // Number of transfers waiting in FIFO
+    PLX_DMA_QUEUE_ENTRY  *pQueueActive;         // Queued transfer currently in progress
+    U32                   QueueCompleted;       // Number of queued transfers completed
+    wait_queue_head_t     WaitDone;             // Threads waiting for DMA completion
+    atomic_t              DoneCount;            // Number of DMA completions serviced
+    U32                   BlockByteCount;       // Size of block transfer in progress
+    PLX_DMA_RING          Ring;                 // Continuous streaming ring
+    PLX_DMA_SGL          *pVector;              // SGLs of pending vectored transfer
+    U32                   VectorCount;          // Number of user buffers in vectored transfer
+    U32                   VectorByteCount;      // Total size of vectored transfer
+    PLX_PHYS_MEM_OBJECT   VectorSglBuffer;      // Descriptor memory shared by vectored transfer SGLs
+    BOOLEAN               bStriped;             // Flag to note channel carries half of a striped transfer
+    U32                   StripeByteCount;      // Size reported when striped transfer completes
+    PLX_DMA_STATS         Stats;                // Transfer counters & latency histograms
+    U64                   StartTime_ns;         // Time the last transfer was started
+    U64                   DoneTime_ns;          // Time of the last DMA done interrupt
 } PLX_DMA_INFO;
 
 
@@ -272,6 +390,19 @@ typedef struct _PLX_REG_DATA
 } PLX_REG_DATA;
 
 
+// Cached remap register state of a local space
+typedef struct _PLX_REMAP_WINDOW
+{
+    BOOLEAN  bValid;                // Flag whether cached state is valid
+    U16      Offset_RegRemap;       // Offset of the space remap register
+    U32      RegValue;              // Current value of the remap register
+    U32      RegHome;               // Window expected by BAR mappings & offset accesses
+    int      Generation;            // RemapGeneration when state was cached
+    VOID    *pOwnerLock;            // Owner of a locked window (NULL = unlocked)
+    atomic_t MapCount;              // Number of user mappings of the BAR
+} PLX_REMAP_WINDOW;
+
+
 // All relevant information about the device
 typedef struct _DEVICE_EXTENSION
 {
@@ -288,19 +419,54 @@ typedef struct _DEVICE_EXTENSION
     BOOLEAN                bDpcPending;                   // Flag whether a DPC task is scheduled
     PLX_IRQ_TYPE           IrqType;                       // Type of interrupt used
     U8                     IrqPci;                        // Original PCI IRQ Line assigned to device
-    U32                    Source_Ints;                   // Interrupts detected by ISR
-    U32                    Source_Doorbell;               // Doorbell interrupts detected by ISR
+    PLX_INT_EVENT          IntEvent[PLX_INT_EVENT_QUEUE_SIZE]; // Interrupt events from ISR to DPC
+    U32                    IntEventHead;                  // Next event to write (ISR only, release to DPC)
+    U32                    IntEventTail;                  // Next event to read (DPC only, release to ISR)
+    PLX_INT_EVENT          IntEventOverflow;              // Sources of events dropped when queue is full (Lock_Isr)
+    U32                    IntEventDropCount;             // Number of events dropped due to a full queue (Lock_Isr)
     U8                    *pRegVa;                        // Virtual address to registers
 
     struct list_head       List_WaitObjects;              // List of registered notification objects
     spinlock_t             Lock_WaitObjectsList;          // Spinlock for notification objects list
+    wait_queue_head_t      WaitQueue_Poll;                // Wakes poll() callers on any notification
+    struct idr             Idr_WaitObjects;               // Notification objects indexed by handle
+    struct list_head       List_WaitBySource[PLX_WAIT_SOURCE_COUNT]; // Notification objects per interrupt source
+    U32                    WaitSignalSeq;                 // Number of DPC notification passes
+
+    spinlock_t             Lock_Coalesce;                 // Spinlock for interrupt moderation state
+    struct hrtimer         Timer_Coalesce;                // Releases batched notifications after delay limit
+    U32                    Coalesce_MaxEvents;            // Events per batch (0/1 = moderation disabled)
+    U32                    Coalesce_MaxDelay_us;          // Max delay before a batch is released
+    U32                    Coalesce_Count;                // Events in the current batch
+    PLX_INTERRUPT_DATA     Coalesce_Pending;              // Sources batched for notification
+
+    struct semaphore       Mutex_BarSpace;                // Serializes BAR space transfers
+    U8                    *pBarBounce;                    // Bounce page for BAR space transfers
+    PLX_REMAP_WINDOW       RemapWindow[PCI_NUM_BARS_TYPE_00]; // Cached remap state (Mutex_BarSpace)
+    atomic_t               RemapGeneration;               // Changes when remap registers may be modified
+    atomic_t               RemapRestorePending;           // BAR mapping waits for its home window
+
+    struct semaphore       Mutex_RegBatch;                // Serializes register batch sequences
 
     struct list_head       List_PhysicalMem;              // List of user-allocated physical memory
     spinlock_t             Lock_PhysicalMemList;          // Spinlock for physical memory list
 
+#if defined(PLX_MU_SUPPORT)
+    spinlock_t             Lock_Mu;                       // Serializes messaging unit queue access
+#endif
+
 #if defined(PLX_DMA_SUPPORT)
     PLX_DMA_INFO           DmaInfo[NUM_DMA_CHANNELS];     // DMA properties and lock
     spinlock_t             Lock_Dma[NUM_DMA_CHANNELS];
+    BOOLEAN                bDmaAddr64;                    // Flag whether SGL descriptors use 64-bit addresses
+
+    struct list_head       List_CompletionRings;          // List of DMA completion rings shared with user space
+    spinlock_t             Lock_CompletionRingList;       // Spinlock for completion ring list
+    spinlock_t             Lock_DmaStats;                 // Spinlock for DMA channel statistics
+#endif
+
+#if defined(PLX_DEBUGFS)
+    struct dentry         *pDebugFsDir;                   // Device directory in debugfs
 #endif
 
 } DEVICE_EXTENSION; 
@@ -315,6 +481,10 @@ typedef struct _DRIVER_OBJECT
     U8                      DeviceCount;      // Number of devices in list
     U8                      bPciDriverReg;    // Flag whether the driver was registered as PCI
     PLX_PHYS_MEM_OBJECT     CommonBuffer;     // Contiguous memory to be shared by all processes
+    struct kmem_cache      *pCache_WaitObject; // Slab cache for notification wait objects
+#if defined(PLX_DEBUGFS)
+    struct dentry          *pDebugFsRoot;     // Driver directory in debugfs
+#endif
     struct file_operations  DispatchTable;    // Driver dispatch table
 } DRIVER_OBJECT;
 
@@ -93,6 +93,7 @@
     #define PLX_DRIVER_NAME_UNICODE             L"Plx9080"
     #define DEFAULT_SIZE_COMMON_BUFFER          (64 * 1024)                  // Default size of Common Buffer
     #define NUM_DMA_CHANNELS                    2                            // Total number of DMA Channels
+    #define DMA_MAX_BYTE_COUNT                  0x007FFFFF                   // Max byte count per DMA descriptor (23-bit)
 
     // Referenced register definitions
     #define PCI9080_SPACE0_REMAP                0x04
@@ -115,6 +116,9 @@
     #define PLX_DRIVER_NAME_UNICODE             L"Plx9054"
     #define DEFAULT_SIZE_COMMON_BUFFER          (64 * 1024)                  // Default size of Common Buffer
     #define NUM_DMA_CHANNELS                    2                            // Total number of DMA Channels
+    #define DMA_MAX_BYTE_COUNT                  0x007FFFFF                   // Max byte count per DMA descriptor (23-bit)
+    #define DMA_DAC_SUPPORT                                                  // DMA supports 64-bit PCI addresses (dual address cycle)
+    #define PLX_MU_SUPPORT                                                   // I2O messaging unit queues supported
 
     // Referenced register definitions
     #define PCI9054_PM_CSR                      0x44
@@ -133,6 +137,18 @@
     #define PCI9054_OUTPOST_INT_STAT            0x30
     #define PCI9054_OUTPOST_INT_MASK            0x34
     #define PCI9054_FIFO_CTRL_STAT              0xE8
+    #define PCI9054_MU_INBOUND_PORT             0x40                         // Replaces mailbox 0 when I2O decode enabled
+    #define PCI9054_MU_OUTBOUND_PORT            0x44                         // Replaces mailbox 1 when I2O decode enabled
+    #define PCI9054_MU_QUEUE_CONFIG             0xC0
+    #define PCI9054_MU_QUEUE_BASE               0xC4
+    #define PCI9054_MU_IN_FREE_HEAD             0xC8
+    #define PCI9054_MU_IN_FREE_TAIL             0xCC
+    #define PCI9054_MU_IN_POST_HEAD             0xD0
+    #define PCI9054_MU_IN_POST_TAIL             0xD4
+    #define PCI9054_MU_OUT_FREE_HEAD            0xD8
+    #define PCI9054_MU_OUT_FREE_TAIL            0xDC
+    #define PCI9054_MU_OUT_POST_HEAD            0xE0
+    #define PCI9054_MU_OUT_POST_TAIL            0xE4
 
 #elif (PLX_CHIP == 9056)
 
@@ -141,6 +157,8 @@
     #define PLX_DRIVER_NAME_UNICODE             L"Plx9056"
     #define DEFAULT_SIZE_COMMON_BUFFER          (64 * 1024)                  // Default size of Common Buffer
     #define NUM_DMA_CHANNELS                    2                            // Total number of DMA Channels
+    #define DMA_MAX_BYTE_COUNT                  0x007FFFFF                   // Max byte count per DMA descriptor (23-bit)
+    #define DMA_DAC_SUPPORT                                                  // DMA supports 64-bit PCI addresses (dual address cycle)
 
     // Referenced register definitions
     #define PCI9056_PM_CSR                      0x44
@@ -166,6 +184,8 @@
     #define PLX_DRIVER_NAME_UNICODE             L"Plx9656"
     #define DEFAULT_SIZE_COMMON_BUFFER          (64 * 1024)                  // Default size of Common Buffer
     #define NUM_DMA_CHANNELS                    2                            // Total number of DMA Channels
+    #define DMA_MAX_BYTE_COUNT                  0x007FFFFF                   // Max byte count per DMA descriptor (23-bit)
+    #define DMA_DAC_SUPPORT                                                  // DMA supports 64-bit PCI addresses (dual address cycle)
 
     // Referenced register definitions
     #define PCI9656_PM_CSR                      0x44
@@ -191,6 +211,8 @@
     #define PLX_DRIVER_NAME_UNICODE             L"Plx8311"
     #define DEFAULT_SIZE_COMMON_BUFFER          (64 * 1024)                  // Default size of Common Buffer
     #define NUM_DMA_CHANNELS                    2                            // Total number of DMA Channels
+    #define DMA_MAX_BYTE_COUNT                  0x007FFFFF                   // Max byte count per DMA descriptor (23-bit)
+    #define DMA_DAC_SUPPORT                                                  // DMA supports 64-bit PCI addresses (dual address cycle)
 
     // Referenced register definitions
     #define PCI8311_PM_CSR                      0x44
@@ -165,6 +165,31 @@ PlxChip_DmaChannelClose(
     VOID             *pOwner
     );
 
+#if defined(PLX_MU_SUPPORT)
+PLX_STATUS
+PlxChip_MuQueueInit(
+    DEVICE_EXTENSION *pdx,
+    U32               LocalQueueBase,
+    U32               EntriesPerQueue
+    );
+
+PLX_STATUS
+PlxChip_MuInboundPost(
+    DEVICE_EXTENSION *pdx,
+    U32              *pUserFrames,
+    U32               Count,
+    U32              *pCountPosted
+    );
+
+PLX_STATUS
+PlxChip_MuOutboundDrain(
+    DEVICE_EXTENSION *pdx,
+    U32              *pUserFrames,
+    U32               MaxCount,
+    U32              *pCountDrained
+    );
+#endif
+
 
 
 
@@ -93,6 +93,22 @@ PlxChipGetRemapOffset(
     U16              *Offset_RegRemap
     );
 
+#if defined(PLX_DMA_SUPPORT)
+VOID
+PlxChipDmaSglStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               SglPciAddress,
+    BOOLEAN           bBits64
+    );
+
+U32
+PlxChipDmaSglNextDescriptor(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+#endif
+
 
 
 
@@ -69,6 +69,10 @@
 #define INTR_TYPE_DMA_0                 (1 << 5)
 #define INTR_TYPE_DMA_1                 (1 << 6)
 #define INTR_TYPE_SOFTWARE              (1 << 7)
+#define INTR_TYPE_DMA_0_DONE_ISR        (1 << 8)       // Block DMA completion handled by ISR (driver internal)
+#define INTR_TYPE_DMA_1_DONE_ISR        (1 << 9)
+
+#define PLX_COALESCE_INTR_TYPES         (INTR_TYPE_DMA_0 | INTR_TYPE_DMA_1)  // Sources subject to interrupt moderation
 
 
 
@@ -87,6 +91,14 @@ OnInterrupt(
   #endif
     );
 
+#if defined(PLX_THREADED_IRQ)
+irqreturn_t
+OnInterruptThread(
+    int   irq,
+    void *dev_id
+    );
+#endif
+
 VOID
 DpcForIsr(
     PLX_DPC_PARAM *pArg1
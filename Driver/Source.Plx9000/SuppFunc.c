@@ -50,14 +50,19 @@
 
 #include <linux/uaccess.h>   // For user page access
 #include <linux/ctype.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
 #include <linux/ioport.h>
 #include <linux/mm.h>
 #include <linux/sched.h>
+#include <linux/seq_file.h>
 #include "ApiFunc.h"
 #include "PciFunc.h"
 #include "PciRegs.h"
 #include "PlxChipApi.h"
+#include "PlxChipFn.h"
+#include "PlxInterrupt.h"
+#include "PlxTrace.h"
 #include "SuppFunc.h"
 
 
@@ -144,7 +149,9 @@ PlxSynchronizedRegisterModify(
  *
  * Description:  Called by the DPC to signal any notification events
  *
- * Note       :  This is expected to be called at DPC level
+ * Note       :  If interrupt moderation is enabled, DMA done & doorbell sources
+ *               are batched until either the event count or the delay limit is
+ *               reached. All other sources are signaled immediately.
  *
  ******************************************************************************/
 VOID
@@ -153,37 +160,223 @@ PlxSignalNotifications(
     PLX_INTERRUPT_DATA *pIntData
     )
 {
+    unsigned long      flags;
+    PLX_INTERRUPT_DATA IntData;
+    PLX_INTERRUPT_DATA IntFlush;
+
+
+    IntData = *pIntData;
+
+    IntFlush.Source_Ints     = INTR_TYPE_NONE;
+    IntFlush.Source_Doorbell = 0;
+
+    spin_lock_irqsave( &(pdx->Lock_Coalesce), flags );
+
+    if ((pdx->Coalesce_MaxEvents > 1) &&
+        ((IntData.Source_Ints & PLX_COALESCE_INTR_TYPES) || IntData.Source_Doorbell))
+    {
+        // Add moderated sources to pending batch
+        pdx->Coalesce_Pending.Source_Ints     |= IntData.Source_Ints & PLX_COALESCE_INTR_TYPES;
+        pdx->Coalesce_Pending.Source_Doorbell |= IntData.Source_Doorbell;
+        pdx->Coalesce_Count++;
+
+        // Remove moderated sources from immediate notification
+        IntData.Source_Ints     &= ~PLX_COALESCE_INTR_TYPES;
+        IntData.Source_Doorbell  = 0;
+
+        if (pdx->Coalesce_Count >= pdx->Coalesce_MaxEvents)
+        {
+            // Event limit reached, release batch now
+            IntFlush = pdx->Coalesce_Pending;
+
+            pdx->Coalesce_Pending.Source_Ints     = INTR_TYPE_NONE;
+            pdx->Coalesce_Pending.Source_Doorbell = 0;
+            pdx->Coalesce_Count                   = 0;
+
+            hrtimer_try_to_cancel( &(pdx->Timer_Coalesce) );
+        }
+        else if (pdx->Coalesce_Count == 1)
+        {
+            // First event of a batch starts the delay limit
+            hrtimer_start(
+                &(pdx->Timer_Coalesce),
+                ns_to_ktime( (U64)pdx->Coalesce_MaxDelay_us * 1000 ),
+                HRTIMER_MODE_REL
+                );
+        }
+    }
+
+    spin_unlock_irqrestore( &(pdx->Lock_Coalesce), flags );
+
+    if (IntFlush.Source_Ints || IntFlush.Source_Doorbell)
+    {
+        PlxSignalWaitObjects(
+            pdx,
+            &IntFlush
+            );
+    }
+
+    if (IntData.Source_Ints || IntData.Source_Doorbell)
+    {
+        PlxSignalWaitObjects(
+            pdx,
+            &IntData
+            );
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxCoalesceFlush
+ *
+ * Description:  Signals any batched notifications & resets the batch
+ *
+ ******************************************************************************/
+VOID
+PlxCoalesceFlush(
+    DEVICE_EXTENSION *pdx
+    )
+{
+    unsigned long      flags;
+    PLX_INTERRUPT_DATA IntFlush;
+
+
+    spin_lock_irqsave( &(pdx->Lock_Coalesce), flags );
+
+    IntFlush = pdx->Coalesce_Pending;
+
+    pdx->Coalesce_Pending.Source_Ints     = INTR_TYPE_NONE;
+    pdx->Coalesce_Pending.Source_Doorbell = 0;
+    pdx->Coalesce_Count                   = 0;
+
+    spin_unlock_irqrestore( &(pdx->Lock_Coalesce), flags );
+
+    if (IntFlush.Source_Ints || IntFlush.Source_Doorbell)
+    {
+        PlxSignalWaitObjects(
+            pdx,
+            &IntFlush
+            );
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  OnCoalesceTimer
+ *
+ * Description:  Interrupt moderation delay limit reached, release the batch
+ *
+ ******************************************************************************/
+enum hrtimer_restart
+OnCoalesceTimer(
+    struct hrtimer *pTimer
+    )
+{
+    DEVICE_EXTENSION *pdx;
+
+
+    pdx =
+        container_of(
+            pTimer,
+            DEVICE_EXTENSION,
+            Timer_Coalesce
+            );
+
+    PlxCoalesceFlush(
+        pdx
+        );
+
+    return HRTIMER_NORESTART;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSignalWaitObjects
+ *
+ * Description:  Signals wait objects registered for the active interrupt sources
+ *
+ * Note       :  May be called from the DPC or the interrupt moderation timer
+ *
+ ******************************************************************************/
+VOID
+PlxSignalWaitObjects(
+    DEVICE_EXTENSION   *pdx,
+    PLX_INTERRUPT_DATA *pIntData
+    )
+{
+    U8                source;
     U32               SourceDB;
     U32               SourceInt;
+    BOOLEAN           bSignaled;
+    unsigned long     flags;
     struct list_head *pEntry;
+    struct list_head *pList;
     PLX_WAIT_OBJECT  *pWaitObject;
 
 
-    spin_lock(
-        &(pdx->Lock_WaitObjectsList)
+    bSignaled = FALSE;
+
+    spin_lock_irqsave(
+        &(pdx->Lock_WaitObjectsList),
+        flags
         );
 
-    // Get the interrupt wait list
-    pEntry = pdx->List_WaitObjects.next;
+    // Start a new pass so objects on several source lists are signaled once
+    pdx->WaitSignalSeq++;
 
-    // Traverse wait objects and wake-up processes
-    while (pEntry != &(pdx->List_WaitObjects))
+    // Only visit the waiters registered for each active source
+    for (source = 0; source < PLX_WAIT_SOURCE_COUNT; source++)
     {
-        // Get the wait object
-        pWaitObject =
-            list_entry(
-                pEntry,
-                PLX_WAIT_OBJECT,
-                ListEntry
-                );
+        if (source == PLX_WAIT_SOURCE_DOORBELL)
+        {
+            if (pIntData->Source_Doorbell == 0)
+            {
+                continue;
+            }
+        }
+        else if ((pIntData->Source_Ints & (1 << source)) == 0)
+        {
+            continue;
+        }
 
-        // Set active notifications
-        SourceInt = pWaitObject->Notify_Flags & pIntData->Source_Ints;
-        SourceDB  = pWaitObject->Notify_Doorbell & pIntData->Source_Doorbell;
+        pList  = &(pdx->List_WaitBySource[source]);
+        pEntry = pList->next;
 
-        // Check if waiting for active interrupt
-        if (SourceInt || SourceDB)
+        // Traverse wait objects and wake-up processes
+        while (pEntry != pList)
         {
+            // Get the wait object from its entry for this source
+            pWaitObject =
+                list_entry(
+                    pEntry,
+                    PLX_WAIT_SOURCE_NODE,
+                    ListEntry
+                    )->pWaitObject;
+
+            // Jump to next item in the list
+            pEntry = pEntry->next;
+
+            // Skip object if already signaled for another source
+            if (pWaitObject->SignalSeq == pdx->WaitSignalSeq)
+            {
+                continue;
+            }
+
+            pWaitObject->SignalSeq = pdx->WaitSignalSeq;
+
+            // Set active notifications
+            SourceInt = pWaitObject->Notify_Flags & pIntData->Source_Ints;
+            SourceDB  = pWaitObject->Notify_Doorbell & pIntData->Source_Doorbell;
+
             DebugPrintf((
                 "DPC signal wait object (%p)\n",
                 pWaitObject
@@ -200,15 +393,31 @@ PlxSignalNotifications(
             wake_up_interruptible(
                 &(pWaitObject->WaitQueue)
                 );
-        }
 
-        // Jump to next item in the list
-        pEntry = pEntry->next;
+#if defined(PLX_EVENTFD_SUPPORT)
+            // Signal the bound eventfd, if any
+            if (pWaitObject->pEventFd != NULL)
+            {
+                Plx_eventfd_signal( pWaitObject->pEventFd );
+            }
+#endif
+
+            bSignaled = TRUE;
+        }
     }
 
-    spin_unlock(
-        &(pdx->Lock_WaitObjectsList)
+    spin_unlock_irqrestore(
+        &(pdx->Lock_WaitObjectsList),
+        flags
         );
+
+    // Wake any poll() callers so they re-check their notifications
+    if (bSignaled)
+    {
+        wake_up_interruptible(
+            &(pdx->WaitQueue_Poll)
+            );
+    }
 }
 
 
@@ -216,109 +425,435 @@ PlxSignalNotifications(
 
 /*******************************************************************************
  *
- * Function   :  PlxPciFindCapability
+ * Function   :  PlxWaitObjectFind
  *
- * Description:  Scans a device's capability list to find the base offset of the
- *               specified PCI or PCIe extended capability. If the capability ID
- *               is PCI or PCIe vendor-specific (VSEC), an optional instance
- *               number can be provided since a device could have multiple VSEC
- *               capabilities. A value of 0 returns the 1st matching instance but
- *               the parameter is ignored for non-VSEC capability search.
+ * Description:  Returns the wait object for a user handle or NULL if not found
+ *
+ * Note       :  Caller must hold Lock_WaitObjectsList
  *
  ******************************************************************************/
-U16
-PlxPciFindCapability(
+PLX_WAIT_OBJECT*
+PlxWaitObjectFind(
     DEVICE_EXTENSION *pdx,
-    U16               CapID,
-    U8                bPCIeCap,
-    U8                InstanceNum
+    VOID             *pUserWaitObject
     )
 {
-    U8  matchCount;
-    U16 offset;
-    U16 currID;
-    U16 probeLimit;
-    U32 regVal;
+    // Handles are positive IDs assigned at registration
+    if (((PLX_UINT_PTR)pUserWaitObject == 0) ||
+        ((PLX_UINT_PTR)pUserWaitObject > INT_MAX))
+    {
+        return NULL;
+    }
 
+    return idr_find(
+        &(pdx->Idr_WaitObjects),
+        (int)(PLX_UINT_PTR)pUserWaitObject
+        );
+}
 
-    // Get PCI command register (04h)
-    PLX_PCI_REG_READ( pdx, PCI_REG_CMD_STAT, &regVal );
 
-    // Verify device responds to PCI accesses (in case link down)
-    if (regVal == (U32)-1)
-    {
-        return 0;
-    }
 
-    // Verify device supports extended capabilities (04h[20])
-    if ((regVal & ((U32)1 << 20)) == 0)
-    {
-        return 0;
-    }
 
-    // Set capability pointer offset
-    if (bPCIeCap)
+/*******************************************************************************
+ *
+ * Function   :  PlxWaitObjectLink
+ *
+ * Description:  Adds a wait object to the device list & to the waiter list of
+ *               each interrupt source it is registered for
+ *
+ * Note       :  Caller must hold Lock_WaitObjectsList
+ *
+ ******************************************************************************/
+VOID
+PlxWaitObjectLink(
+    DEVICE_EXTENSION *pdx,
+    PLX_WAIT_OBJECT  *pWaitObject
+    )
+{
+    U8 source;
+
+
+    list_add_tail(
+        &(pWaitObject->ListEntry),
+        &(pdx->List_WaitObjects)
+        );
+
+    for (source = 0; source < PLX_WAIT_SOURCE_COUNT; source++)
     {
-        // PCIe capabilities must start at 100h
-        offset = PCIE_REG_CAP_PTR;
+        // Initialize entry so it may be safely removed even if not linked
+        INIT_LIST_HEAD( &(pWaitObject->SourceNode[source].ListEntry) );
 
-        // Ignore instance number for non-VSEC capabilities
-        if (CapID != PCIE_CAP_ID_VENDOR_SPECIFIC)
+        pWaitObject->SourceNode[source].pWaitObject = pWaitObject;
+
+        if (source == PLX_WAIT_SOURCE_DOORBELL)
         {
-            InstanceNum = 0;
+            if (pWaitObject->Notify_Doorbell == 0)
+            {
+                continue;
+            }
+        }
+        else if ((pWaitObject->Notify_Flags & (1 << source)) == 0)
+        {
+            continue;
         }
+
+        list_add_tail(
+            &(pWaitObject->SourceNode[source].ListEntry),
+            &(pdx->List_WaitBySource[source])
+            );
     }
-    else
-    {
-        // Get offset of first capability from capability pointer (34h[7:0])
-        PLX_PCI_REG_READ( pdx, PCI_REG_CAP_PTR, &regVal );
+}
 
-        // Set first capability offset
-        offset = (U8)regVal;
 
-        // Ignore instance number for non-VSEC capabilities
-        if (CapID != PCI_CAP_ID_VENDOR_SPECIFIC)
-        {
-            InstanceNum = 0;
-        }
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxWaitObjectUnlink
+ *
+ * Description:  Removes a wait object from its handle & all lists
+ *
+ * Note       :  Caller must hold Lock_WaitObjectsList
+ *
+ ******************************************************************************/
+VOID
+PlxWaitObjectUnlink(
+    DEVICE_EXTENSION *pdx,
+    PLX_WAIT_OBJECT  *pWaitObject
+    )
+{
+    U8 source;
+
+
+    DebugPrintf((
+        "Remove interrupt wait object (%p)...\n",
+        pWaitObject
+        ));
+
+    idr_remove(
+        &(pdx->Idr_WaitObjects),
+        pWaitObject->Handle
+        );
+
+    list_del( &(pWaitObject->ListEntry) );
+
+    for (source = 0; source < PLX_WAIT_SOURCE_COUNT; source++)
+    {
+        list_del_init( &(pWaitObject->SourceNode[source].ListEntry) );
     }
+}
 
-    // Start with 1st match
-    matchCount = 0;
 
-    // Set max probe limit
-    probeLimit = 100;
 
-    // Traverse capability list searching for desired ID
-    while ((offset != 0) && (regVal != (U32)-1))
+
+/*******************************************************************************
+ *
+ * Function   :  PlxWaitObjectRelease
+ *
+ * Description:  Wakes any threads still waiting on an unlinked wait object and
+ *               releases it
+ *
+ ******************************************************************************/
+VOID
+PlxWaitObjectRelease(
+    PLX_WAIT_OBJECT *pWaitObject
+    )
+{
+    U32 LoopCount;
+
+
+    // Set loop count
+    LoopCount = 20;
+
+    // Wake-up processes if wait object is pending
+    if (atomic_read(&pWaitObject->SleepCount) != 0)
     {
-        // Get next capability
-        PLX_PCI_REG_READ( pdx, offset, &regVal );
+        DebugPrintf(("Wait object is pending in another thread, forcing wake up\n"));
 
-        // Verify capability is valid
-        if ((regVal == 0) || (regVal == (U32)-1))
-        {
-            return 0;
-        }
+        // Mark object for deletion
+        pWaitObject->state = PLX_STATE_MARKED_FOR_DELETE;
 
-        // Some chipset pass 100h+ to PCI devices which decode
-        // back to 0-FFh, so check if 100h matches Dev/Ven ID(0)
-        if ((offset == PCIE_REG_CAP_PTR) &&
-            (regVal == (((U32)pdx->Key.DeviceId << 16) |
-                              pdx->Key.VendorId)))
-        {
-            return 0;
-        }
+        // Wake-up any process waiting on the object
+        wake_up_interruptible(
+            &(pWaitObject->WaitQueue)
+            );
 
-        // Extract the capability ID
-        if (bPCIeCap)
+        do
         {
-            // PCIe ID in [15:0]
-            currID = (U16)((regVal >> 0) & 0xFFFF);
+            // Set current task as uninterruptible
+            set_current_state(TASK_UNINTERRUPTIBLE);
+
+            // Relieve timeslice to allow pending thread to wake up
+            schedule_timeout( Plx_ms_to_jiffies( 10 ) );
+
+            // Decrement counter
+            LoopCount--;
         }
-        else
-        {
-            // PCI ID in [7:0]
+        while (LoopCount && (atomic_read(&pWaitObject->SleepCount) != 0));
+    }
+
+#if defined(PLX_EVENTFD_SUPPORT)
+    // Release any bound eventfd
+    if (pWaitObject->pEventFd != NULL)
+    {
+        eventfd_ctx_put( pWaitObject->pEventFd );
+        pWaitObject->pEventFd = NULL;
+    }
+#endif
+
+    if (LoopCount == 0)
+    {
+        DebugPrintf(("ERROR: Timeout waiting for pending thread, unable to free wait object\n"));
+    }
+    else
+    {
+        // Release the object
+        kmem_cache_free(
+            pGbl_DriverObject->pCache_WaitObject,
+            pWaitObject
+            );
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxIntEventPush
+ *
+ * Description:  Queues an interrupt event detected by the ISR for the DPC
+ *
+ * Note       :  Called only by the ISR, which is the single producer, so no lock
+ *               is needed unless the queue is full.  In that case, the event is
+ *               dropped & counted.  Only its interrupt source types are kept,
+ *               so the DPC still services them, while its doorbell value is
+ *               lost rather than combined with other values.
+ *
+ ******************************************************************************/
+VOID
+PlxIntEventPush(
+    DEVICE_EXTENSION *pdx,
+    U32               Source_Ints,
+    U32               Source_Doorbell
+    )
+{
+    U32            head;
+    U32            tail;
+    PLX_INT_EVENT *pEvent;
+
+
+    head = pdx->IntEventHead;
+
+    // Entry is only reused after the DPC has finished reading it
+    tail = smp_load_acquire( &(pdx->IntEventTail) );
+
+    // If queue is full, drop the event
+    if ((head - tail) >= PLX_INT_EVENT_QUEUE_SIZE)
+    {
+        spin_lock( &(pdx->Lock_Isr) );
+
+        if (pdx->IntEventOverflow.Source_Ints == INTR_TYPE_NONE)
+        {
+            pdx->IntEventOverflow.Timestamp_ns = ktime_to_ns( ktime_get() );
+        }
+
+        pdx->IntEventOverflow.Source_Ints |= Source_Ints;
+        pdx->IntEventDropCount++;
+
+        spin_unlock( &(pdx->Lock_Isr) );
+        return;
+    }
+
+    pEvent = &(pdx->IntEvent[head & (PLX_INT_EVENT_QUEUE_SIZE - 1)]);
+
+    pEvent->Source_Ints     = Source_Ints;
+    pEvent->Source_Doorbell = Source_Doorbell;
+    pEvent->Timestamp_ns    = ktime_to_ns( ktime_get() );
+
+    // Entry must be visible before the DPC sees the new head
+    smp_store_release( &(pdx->IntEventHead), head + 1 );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxIntEventPop
+ *
+ * Description:  Removes the oldest interrupt event queued by the ISR
+ *
+ * Note       :  Called only by the DPC, which is the single consumer.  Once the
+ *               queue is empty, the interrupt sources of any dropped events are
+ *               returned last, without a doorbell value.
+ *
+ ******************************************************************************/
+BOOLEAN
+PlxIntEventPop(
+    DEVICE_EXTENSION   *pdx,
+    PLX_INTERRUPT_DATA *pIntData
+    )
+{
+    U32            tail;
+    U32            head;
+    U32            DropCount;
+    unsigned long  flags;
+    PLX_INT_EVENT *pEvent;
+
+
+    tail = pdx->IntEventTail;
+
+    // Entry is only read after the ISR has finished writing it
+    head = smp_load_acquire( &(pdx->IntEventHead) );
+
+    if (tail != head)
+    {
+        pEvent = &(pdx->IntEvent[tail & (PLX_INT_EVENT_QUEUE_SIZE - 1)]);
+
+        pIntData->Source_Ints     = pEvent->Source_Ints;
+        pIntData->Source_Doorbell = pEvent->Source_Doorbell;
+        pIntData->Timestamp_ns    = pEvent->Timestamp_ns;
+
+        // Entry must be consumed before the ISR may reuse it
+        smp_store_release( &(pdx->IntEventTail), tail + 1 );
+
+        return TRUE;
+    }
+
+    // Queue is empty, so take sources of any events dropped due to overflow
+    spin_lock_irqsave( &(pdx->Lock_Isr), flags );
+
+    pIntData->Source_Ints     = pdx->IntEventOverflow.Source_Ints;
+    pIntData->Source_Doorbell = 0;
+    pIntData->Timestamp_ns    = pdx->IntEventOverflow.Timestamp_ns;
+    DropCount                 = pdx->IntEventDropCount;
+
+    pdx->IntEventOverflow.Source_Ints = INTR_TYPE_NONE;
+
+    spin_unlock_irqrestore( &(pdx->Lock_Isr), flags );
+
+    if (pIntData->Source_Ints == INTR_TYPE_NONE)
+    {
+        return FALSE;
+    }
+
+    ErrorPrintf((
+        "WARNING - Interrupt event queue overflow, %d events dropped in total\n",
+        DropCount
+        ));
+
+    return TRUE;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciFindCapability
+ *
+ * Description:  Scans a device's capability list to find the base offset of the
+ *               specified PCI or PCIe extended capability. If the capability ID
+ *               is PCI or PCIe vendor-specific (VSEC), an optional instance
+ *               number can be provided since a device could have multiple VSEC
+ *               capabilities. A value of 0 returns the 1st matching instance but
+ *               the parameter is ignored for non-VSEC capability search.
+ *
+ ******************************************************************************/
+U16
+PlxPciFindCapability(
+    DEVICE_EXTENSION *pdx,
+    U16               CapID,
+    U8                bPCIeCap,
+    U8                InstanceNum
+    )
+{
+    U8  matchCount;
+    U16 offset;
+    U16 currID;
+    U16 probeLimit;
+    U32 regVal;
+
+
+    // Get PCI command register (04h)
+    PLX_PCI_REG_READ( pdx, PCI_REG_CMD_STAT, &regVal );
+
+    // Verify device responds to PCI accesses (in case link down)
+    if (regVal == (U32)-1)
+    {
+        return 0;
+    }
+
+    // Verify device supports extended capabilities (04h[20])
+    if ((regVal & ((U32)1 << 20)) == 0)
+    {
+        return 0;
+    }
+
+    // Set capability pointer offset
+    if (bPCIeCap)
+    {
+        // PCIe capabilities must start at 100h
+        offset = PCIE_REG_CAP_PTR;
+
+        // Ignore instance number for non-VSEC capabilities
+        if (CapID != PCIE_CAP_ID_VENDOR_SPECIFIC)
+        {
+            InstanceNum = 0;
+        }
+    }
+    else
+    {
+        // Get offset of first capability from capability pointer (34h[7:0])
+        PLX_PCI_REG_READ( pdx, PCI_REG_CAP_PTR, &regVal );
+
+        // Set first capability offset
+        offset = (U8)regVal;
+
+        // Ignore instance number for non-VSEC capabilities
+        if (CapID != PCI_CAP_ID_VENDOR_SPECIFIC)
+        {
+            InstanceNum = 0;
+        }
+    }
+
+    // Start with 1st match
+    matchCount = 0;
+
+    // Set max probe limit
+    probeLimit = 100;
+
+    // Traverse capability list searching for desired ID
+    while ((offset != 0) && (regVal != (U32)-1))
+    {
+        // Get next capability
+        PLX_PCI_REG_READ( pdx, offset, &regVal );
+
+        // Verify capability is valid
+        if ((regVal == 0) || (regVal == (U32)-1))
+        {
+            return 0;
+        }
+
+        // Some chipset pass 100h+ to PCI devices which decode
+        // back to 0-FFh, so check if 100h matches Dev/Ven ID(0)
+        if ((offset == PCIE_REG_CAP_PTR) &&
+            (regVal == (((U32)pdx->Key.DeviceId << 16) |
+                              pdx->Key.VendorId)))
+        {
+            return 0;
+        }
+
+        // Extract the capability ID
+        if (bPCIeCap)
+        {
+            // PCIe ID in [15:0]
+            currID = (U16)((regVal >> 0) & 0xFFFF);
+        }
+        else
+        {
+            // PCI ID in [7:0]
             currID = (U16)((regVal >> 0) & 0xFF);
         }
 
@@ -336,28 +871,2308 @@ PlxPciFindCapability(
             matchCount++;
         }
 
-        // Enforce an upper bound on probe in case device has issues
-        probeLimit--;
-        if (probeLimit == 0)
-        {
-            return 0;
-        }
+        // Enforce an upper bound on probe in case device has issues
+        probeLimit--;
+        if (probeLimit == 0)
+        {
+            return 0;
+        }
+
+        // Jump to next capability
+        if (bPCIeCap)
+        {
+            // PCIe next cap offset in [31:20]
+            offset = (U16)((regVal >> 20) & 0xFFF);
+        }
+        else
+        {
+            // PCI next cap offset in [15:8]
+            offset = (U8)((regVal >> 8) & 0xFF);
+        }
+    }
+
+    // Capability not found
+    return 0;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarResourceMap
+ *
+ * Description:  Maps a PCI BAR resource into kernel space
+ *
+ ******************************************************************************/
+int
+PlxPciBarResourceMap(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex
+    )
+{
+    // Default resource to not claimed
+    pdx->PciBar[BarIndex].bResourceClaimed = FALSE;
+
+    // Default to NULL kernel VA
+    pdx->PciBar[BarIndex].pVa = NULL;
+
+    // Request and Map space
+    if (pdx->PciBar[BarIndex].Properties.Flags & PLX_BAR_FLAG_IO)
+    {
+        // Request I/O port region
+        if (request_region(
+                pdx->PciBar[BarIndex].Properties.Physical,
+                pdx->PciBar[BarIndex].Properties.Size,
+                PLX_DRIVER_NAME
+                ) != NULL)
+        {
+            // Note that resource was claimed
+            pdx->PciBar[BarIndex].bResourceClaimed = TRUE;
+        }
+    }
+    else
+    {
+        // Request memory region
+        if (request_mem_region(
+                pdx->PciBar[BarIndex].Properties.Physical,
+                pdx->PciBar[BarIndex].Properties.Size,
+                PLX_DRIVER_NAME
+                ) == NULL)
+        {
+            return (-ENOMEM);
+        }
+        else
+        {
+            // Note that resource was claimed
+            pdx->PciBar[BarIndex].bResourceClaimed = TRUE;
+
+            // Get a kernel-mapped virtual address
+            pdx->PciBar[BarIndex].pVa =
+                ioremap(
+                    pdx->PciBar[BarIndex].Properties.Physical,
+                    pdx->PciBar[BarIndex].Properties.Size
+                    );
+
+            if (pdx->PciBar[BarIndex].pVa == NULL)
+            {
+                return (-ENOMEM);
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarResourcesUnmap
+ *
+ * Description:  Unmap all mapped PCI BAR memory for a device
+ *
+ ******************************************************************************/
+VOID
+PlxPciBarResourcesUnmap(
+    DEVICE_EXTENSION *pdx
+    )
+{
+    U8 i;
+
+
+    // Go through all the BARS
+    for (i = 0; i < PCI_NUM_BARS_TYPE_00; i++)
+    {
+        // Unmap the space from Kernel space if previously mapped
+        if (pdx->PciBar[i].Properties.Physical != 0)
+        {
+            if (pdx->PciBar[i].Properties.Flags & PLX_BAR_FLAG_IO)
+            {
+                // Release I/O port region if it was claimed
+                if (pdx->PciBar[i].bResourceClaimed)
+                {
+                    release_region(
+                        pdx->PciBar[i].Properties.Physical,
+                        pdx->PciBar[i].Properties.Size
+                        );
+                }
+            }
+            else
+            {
+                // Unmap from kernel space
+                if (pdx->PciBar[i].pVa != NULL)
+                {
+                    DebugPrintf((
+                        "Unmap BAR %d (VA=%p)\n",
+                        i, pdx->PciBar[i].pVa
+                        ));
+                    iounmap( pdx->PciBar[i].pVa );
+                    pdx->PciBar[i].pVa = NULL;
+                }
+
+                // Release memory region if it was claimed
+                if (pdx->PciBar[i].bResourceClaimed)
+                {
+                    release_mem_region(
+                        pdx->PciBar[i].Properties.Physical,
+                        pdx->PciBar[i].Properties.Size
+                        );
+                }
+            }
+        }
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciPhysicalMemoryFreeAll_ByOwner
+ *
+ * Description:  Unmap & release all physical memory assigned to the specified owner
+ *
+ ******************************************************************************/
+VOID
+PlxPciPhysicalMemoryFreeAll_ByOwner(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    )
+{
+    PLX_PHYSICAL_MEM     PciMem;
+    struct list_head    *pEntry;
+    PLX_PHYS_MEM_OBJECT *pMemObject;
+
+
+    spin_lock(
+        &(pdx->Lock_PhysicalMemList)
+        );
+
+    pEntry = pdx->List_PhysicalMem.next;
+
+    // Traverse list to find the desired list objects
+    while (pEntry != &(pdx->List_PhysicalMem))
+    {
+        // Get the object
+        pMemObject =
+            list_entry(
+                pEntry,
+                PLX_PHYS_MEM_OBJECT,
+                ListEntry
+                );
+
+        // Check if owner matches
+        if (pMemObject->pOwner == pOwner)
+        {
+            // Copy memory information
+            PciMem.PhysicalAddr = pMemObject->BusPhysical;
+            PciMem.Size         = pMemObject->Size;
+
+            // Release list lock
+            spin_unlock(
+                &(pdx->Lock_PhysicalMemList)
+                );
+
+            // Release the memory & remove from list
+            PlxPciPhysicalMemoryFree(
+                pdx,
+                &PciMem
+                );
+
+            spin_lock(
+                &(pdx->Lock_PhysicalMemList)
+                );
+
+            // Restart parsing the list from the beginning
+            pEntry = pdx->List_PhysicalMem.next;
+        }
+        else
+        {
+            // Jump to next item
+            pEntry = pEntry->next;
+        }
+    }
+
+    spin_unlock(
+        &(pdx->Lock_PhysicalMemList)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRemapWindowGet
+ *
+ * Description:  Returns the remap window state of a local space, refreshing
+ *               it from the device if registers may have changed
+ *
+ * Note       :  Must be called with Mutex_BarSpace held.  NULL is returned if
+ *               the BAR does not decode a local space.
+ *
+ ******************************************************************************/
+PLX_REMAP_WINDOW*
+PlxRemapWindowGet(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex
+    )
+{
+    U32               RegValue;
+    int               Generation;
+    BOOLEAN           bCached;
+    PLX_REMAP_WINDOW *pWindow;
+
+
+    pWindow = &(pdx->RemapWindow[BarIndex]);
+
+    // Get generation before reading registers so later changes are detected
+    Generation = atomic_read( &(pdx->RemapGeneration) );
+
+    if (pWindow->bValid && (pWindow->Generation == Generation))
+    {
+        return pWindow;
+    }
+
+    bCached = pWindow->bValid;
+
+    pWindow->bValid = FALSE;
+
+    // Get offset of remap register
+    PlxChipGetRemapOffset(
+        pdx,
+        BarIndex,
+        &(pWindow->Offset_RegRemap)
+        );
+
+    if (pWindow->Offset_RegRemap == (U16)-1)
+    {
+        return NULL;
+    }
+
+    RegValue =
+        PLX_9000_REG_READ(
+            pdx,
+            pWindow->Offset_RegRemap
+            );
+
+    // Keep the home window unless the remap register itself was changed
+    if ((bCached == FALSE) || (RegValue != pWindow->RegValue))
+    {
+        pWindow->RegHome = RegValue;
+    }
+
+    pWindow->RegValue   = RegValue;
+    pWindow->Generation = Generation;
+    pWindow->bValid     = TRUE;
+
+    return pWindow;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRemapWindowRestore
+ *
+ * Description:  Moves a local space window back to its home window if the
+ *               BAR is mapped to user space
+ *
+ * Note       :  Must be called with Mutex_BarSpace held.  Windows left moved
+ *               by transfers are otherwise kept to avoid remap writes.
+ *
+ ******************************************************************************/
+static VOID
+PlxRemapWindowRestore(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex
+    )
+{
+    PLX_REMAP_WINDOW *pWindow;
+
+
+    pWindow = &(pdx->RemapWindow[BarIndex]);
+
+    // Skip if state is stale, since registers may have been changed directly
+    if ((pWindow->bValid == FALSE) ||
+        (pWindow->Generation != atomic_read( &(pdx->RemapGeneration) )))
+    {
+        return;
+    }
+
+    if ((pWindow->RegValue != pWindow->RegHome) &&
+        (atomic_read( &(pWindow->MapCount) ) != 0))
+    {
+        PLX_9000_REG_WRITE(
+            pdx,
+            pWindow->Offset_RegRemap,
+            pWindow->RegHome
+            );
+
+        pWindow->RegValue = pWindow->RegHome;
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxBarSpaceRelease
+ *
+ * Description:  Releases Mutex_BarSpace, first restoring the home window of
+ *               any mapped local space
+ *
+ * Note       :  A BAR mapping created while the mutex is held can't wait for
+ *               it, so the restore is left to the holder through
+ *               RemapRestorePending.
+ *
+ ******************************************************************************/
+VOID
+PlxBarSpaceRelease(
+    DEVICE_EXTENSION *pdx
+    )
+{
+    U8 i;
+
+
+    for (i = 0; i < PCI_NUM_BARS_TYPE_00; i++)
+    {
+        PlxRemapWindowRestore( pdx, i );
+    }
+
+    up( &(pdx->Mutex_BarSpace) );
+
+    // Handle mappings created while the mutex was held
+    if (atomic_read( &(pdx->RemapRestorePending) ) == 0)
+    {
+        return;
+    }
+
+    if (down_trylock( &(pdx->Mutex_BarSpace) ) == 0)
+    {
+        atomic_set( &(pdx->RemapRestorePending), 0 );
+
+        PlxBarSpaceRelease( pdx );
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarVmOpen
+ *
+ * Description:  Count a copy of a PCI BAR user mapping, created when the
+ *               mapping is split or inherited by a child process
+ *
+ ******************************************************************************/
+static void
+PlxPciBarVmOpen(
+    struct vm_area_struct *vma
+    )
+{
+    PLX_REMAP_WINDOW *pWindow;
+
+
+    pWindow = vma->vm_private_data;
+
+    atomic_inc( &(pWindow->MapCount) );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarVmClose
+ *
+ * Description:  Release a PCI BAR user mapping
+ *
+ ******************************************************************************/
+static void
+PlxPciBarVmClose(
+    struct vm_area_struct *vma
+    )
+{
+    PLX_REMAP_WINDOW *pWindow;
+
+
+    pWindow = vma->vm_private_data;
+
+    atomic_dec( &(pWindow->MapCount) );
+}
+
+
+static const struct vm_operations_struct PlxPciBarVmOps =
+{
+    .open  = PlxPciBarVmOpen,
+    .close = PlxPciBarVmClose,
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarMapTrack
+ *
+ * Description:  Track a new user mapping of a PCI BAR & move a local space
+ *               window left elsewhere by transfers back to its home window
+ *
+ * Note       :  Called with the mmap lock held, so Mutex_BarSpace may not be
+ *               waited on since transfers fault in user pages while holding it.
+ *
+ ******************************************************************************/
+VOID
+PlxPciBarMapTrack(
+    DEVICE_EXTENSION      *pdx,
+    struct vm_area_struct *vma,
+    U8                     BarIndex
+    )
+{
+    PLX_REMAP_WINDOW *pWindow;
+
+
+    pWindow = &(pdx->RemapWindow[BarIndex]);
+
+    atomic_inc( &(pWindow->MapCount) );
+
+    vma->vm_private_data = pWindow;
+    vma->vm_ops          = &PlxPciBarVmOps;
+
+    // Flag restore for the current holder in case the mutex is busy
+    atomic_set( &(pdx->RemapRestorePending), 1 );
+
+    if (down_trylock( &(pdx->Mutex_BarSpace) ) == 0)
+    {
+        atomic_set( &(pdx->RemapRestorePending), 0 );
+
+        PlxBarSpaceRelease( pdx );
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPciBarWindowUnlockAll_ByOwner
+ *
+ * Description:  Releases all local space windows locked by the specified owner
+ *
+ ******************************************************************************/
+VOID
+PlxPciBarWindowUnlockAll_ByOwner(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    )
+{
+    U8 i;
+
+
+    // Wait for any transfer in progress
+    down( &(pdx->Mutex_BarSpace) );
+
+    for (i = 0; i < PCI_NUM_BARS_TYPE_00; i++)
+    {
+        if (pdx->RemapWindow[i].pOwnerLock == pOwner)
+        {
+            DebugPrintf(("Release lock on BAR %d window\n", i));
+            pdx->RemapWindow[i].pOwnerLock = NULL;
+        }
+    }
+
+    PlxBarSpaceRelease( pdx );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  Plx_dma_buffer_alloc
+ *
+ * Description:  Allocates physically contiguous non-paged memory
+ *
+ * Note       :  The function allocates a contiguous block of system memory and
+ *               marks it as reserved. Marking the memory as reserved is required
+ *               in case the memory is later mapped to user virtual space.
+ *
+ ******************************************************************************/
+VOID*
+Plx_dma_buffer_alloc(
+    DEVICE_EXTENSION    *pdx,
+    PLX_PHYS_MEM_OBJECT *pMemObject
+    )
+{
+    dma_addr_t   BusAddress;
+    PLX_UINT_PTR virt_addr;
+
+
+    // Verify size
+    if (pMemObject->Size == 0)
+    {
+        ErrorPrintf(("ERROR: Unable to allocate buffer, requested size = 0\n"));
+        RtlZeroMemory( pMemObject, sizeof(PLX_PHYS_MEM_OBJECT) );
+        return NULL;
+    }
+
+    /*********************************************************
+     * Attempt to allocate contiguous memory
+     *
+     * Additional flags are specified as follows:
+     *
+     * __GFP_NOWARN : Prevents the kernel from dumping warnings
+     *                about a failed allocation attempt.  The
+     *                PLX driver already handles failures.
+     *
+     * __GFP_REPEAT : Not enabled by default, but may be added
+     *                manually.  It asks the kernel to "try a
+     *                little harder" in the allocation effort.
+     ********************************************************/
+    pMemObject->pKernelVa =
+        dma_alloc_coherent(
+            &(pdx->pPciDevice->dev),
+            pMemObject->Size,
+            &BusAddress,
+            GFP_KERNEL | __GFP_NOWARN
+            );
+
+    if (pMemObject->pKernelVa == NULL)
+    {
+        return NULL;
+    }
+
+    // Store the bus address
+    pMemObject->BusPhysical = (U64)BusAddress;
+
+    // Tag all pages as reserved
+    for (virt_addr = (PLX_UINT_PTR)pMemObject->pKernelVa;
+         virt_addr < ((PLX_UINT_PTR)pMemObject->pKernelVa + pMemObject->Size);
+         virt_addr += PAGE_SIZE)
+    {
+        SetPageReserved(
+            virt_to_page( PLX_INT_TO_PTR(virt_addr) )
+            );
+    }
+
+    // Get CPU physical address of buffer
+    pMemObject->CpuPhysical =
+        virt_to_phys(
+            pMemObject->pKernelVa
+            );
+
+    // Clear the buffer
+    RtlZeroMemory( pMemObject->pKernelVa, pMemObject->Size );
+
+    DebugPrintf(("Allocated physical memory...\n"));
+
+    DebugPrintf((
+        "    CPU Phys Addr: %08llx\n",
+        pMemObject->CpuPhysical
+        ));
+
+    DebugPrintf((
+        "    Bus Phys Addr: %08llx\n",
+        pMemObject->BusPhysical
+        ));
+
+    DebugPrintf((
+        "    Kernel VA    : %p\n",
+        pMemObject->pKernelVa
+        ));
+
+    DebugPrintf((
+        "    Size         : %Xh (%d%s)\n",
+        pMemObject->Size,
+        (pMemObject->Size > (1 << 30)) ? (pMemObject->Size >> 30) :
+          (pMemObject->Size > (1 << 20)) ? (pMemObject->Size >> 20) :
+          (pMemObject->Size > (1 << 10)) ? (pMemObject->Size >> 10) :
+          pMemObject->Size,
+        (pMemObject->Size > (1 << 30)) ? "GB" :
+          (pMemObject->Size > (1 << 20)) ? "MB" :
+          (pMemObject->Size > (1 << 10)) ? "KB" : "B"
+        ));
+
+    // Return the kernel virtual address of the allocated block
+    return pMemObject->pKernelVa;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  Plx_dma_buffer_free
+ *
+ * Description:  Frees previously allocated physical memory
+ *
+ ******************************************************************************/
+VOID
+Plx_dma_buffer_free(
+    DEVICE_EXTENSION    *pdx,
+    PLX_PHYS_MEM_OBJECT *pMemObject
+    )
+{
+    PLX_UINT_PTR virt_addr;
+
+
+    // Remove reservation tag for all pages
+    for (virt_addr = (PLX_UINT_PTR)pMemObject->pKernelVa;
+         virt_addr < ((PLX_UINT_PTR)pMemObject->pKernelVa + PAGE_ALIGN(pMemObject->Size));
+         virt_addr += PAGE_SIZE)
+    {
+        ClearPageReserved(
+            virt_to_page( PLX_INT_TO_PTR(virt_addr) )
+            );
+    }
+
+    // Release the buffer
+    dma_free_coherent(
+        &(pdx->pPciDevice->dev),
+        pMemObject->Size,
+        pMemObject->pKernelVa,
+        (dma_addr_t)pMemObject->BusPhysical
+        );
+
+    DebugPrintf((
+        "Released physical memory at %08llxh (%d%s)\n",
+        pMemObject->CpuPhysical,
+        (pMemObject->Size > (1 << 30)) ? (pMemObject->Size >> 30) :
+          (pMemObject->Size > (1 << 20)) ? (pMemObject->Size >> 20) :
+          (pMemObject->Size > (1 << 10)) ? (pMemObject->Size >> 10) :
+          pMemObject->Size,
+        (pMemObject->Size > (1 << 30)) ? "GB" :
+          (pMemObject->Size > (1 << 20)) ? "MB" :
+          (pMemObject->Size > (1 << 10)) ? "KB" : "B"
+        ));
+
+    // Clear memory object properties
+    RtlZeroMemory( pMemObject, sizeof(PLX_PHYS_MEM_OBJECT) );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaChannelCleanup
+ *
+ * Description:  Called by the Cleanup routine to close any open channels
+ *
+ ******************************************************************************/
+VOID
+PlxDmaChannelCleanup(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    )
+{
+#if defined(PLX_DMA_SUPPORT)
+    U8 i;
+
+
+    // Close any DMA channels opened by the owner
+    for (i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (pdx->DmaInfo[i].bOpen)
+        {
+            PlxChip_DmaChannelClose(
+                pdx,
+                i,
+                FALSE,
+                pOwner
+                );
+        }
+    }
+
+    // Release any DMA completion ring of the owner
+    PlxDmaCompletionRingDestroy(
+        pdx,
+        pOwner
+        );
+#endif  // PLX_DMA_SUPPORT
+}
+
+
+
+
+#if defined(PLX_DMA_SUPPORT)
+/*******************************************************************************
+ *
+ * Function   :  PlxSglDmaTransferComplete
+ *
+ * Description:  Perform any necessary cleanup after an SGL DMA transfer
+ *
+ ******************************************************************************/
+VOID
+PlxSglDmaTransferComplete(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U32                  ByteCount;
+    BOOLEAN              bPost;
+    PLX_DMA_QUEUE_ENTRY *pEntry;
+
+
+    if (pdx->DmaInfo[channel].bSglPending == FALSE)
+    {
+        DebugPrintf(("No pending SGL DMA to complete\n"));
+        return;
+    }
+
+    // A streaming ring never completes, so only update ring indices
+    if (pdx->DmaInfo[channel].Ring.bActive)
+    {
+        PlxDmaRingService(
+            pdx,
+            channel
+            );
+        return;
+    }
+
+    pEntry = pdx->DmaInfo[channel].pQueueActive;
+
+    // Record completion of the transfer
+    if (pEntry != NULL)
+    {
+        ByteCount = pEntry->Sgl.BufferSize;
+    }
+    else if (pdx->DmaInfo[channel].pRegBufferActive != NULL)
+    {
+        ByteCount = pdx->DmaInfo[channel].RegByteCount;
+    }
+    else if (pdx->DmaInfo[channel].pVector != NULL)
+    {
+        ByteCount = pdx->DmaInfo[channel].VectorByteCount;
+    }
+    else
+    {
+        ByteCount = pdx->DmaInfo[channel].Sgl.BufferSize;
+    }
+
+    trace_plx_dma_sgl_complete(
+        pdx,
+        channel,
+        ByteCount
+        );
+
+    bPost = TRUE;
+
+    // Report a striped transfer only once both channel halves are done
+    if (pdx->DmaInfo[channel].bStriped)
+    {
+        pdx->DmaInfo[channel].bStriped = FALSE;
+
+        if (pdx->DmaInfo[channel ^ 1].bStriped)
+        {
+            bPost = FALSE;
+        }
+        else
+        {
+            ByteCount = pdx->DmaInfo[channel].StripeByteCount;
+        }
+    }
+
+    if (bPost)
+    {
+        PlxDmaCompletionPost(
+            pdx,
+            channel,
+            ByteCount,
+            PLX_STATUS_OK
+            );
+    }
+
+    if (pEntry != NULL)
+    {
+        DebugPrintf(("Unlock user-mode buffer used for queued SGL DMA transfer...\n"));
+
+        // Unmap and unlock user buffer pages
+        PlxSglRelease(
+            pdx,
+            &pEntry->Sgl
+            );
+    }
+    else if (pdx->DmaInfo[channel].pRegBufferActive != NULL)
+    {
+        // Buffer remains locked, only restore its SGL
+        PlxSglRegBufferDone(
+            pdx,
+            channel
+            );
+    }
+    else if (pdx->DmaInfo[channel].pVector != NULL)
+    {
+        DebugPrintf((
+            "Unlock %d user-mode buffers used for vectored SGL DMA transfer...\n",
+            pdx->DmaInfo[channel].VectorCount
+            ));
+
+        // Unmap and unlock all user buffers & release shared descriptors
+        PlxSglVectorRelease(
+            pdx,
+            pdx->DmaInfo[channel].pVector,
+            pdx->DmaInfo[channel].VectorCount,
+            &pdx->DmaInfo[channel].VectorSglBuffer
+            );
+
+        pdx->DmaInfo[channel].pVector         = NULL;
+        pdx->DmaInfo[channel].VectorCount     = 0;
+        pdx->DmaInfo[channel].VectorByteCount = 0;
+    }
+    else
+    {
+        DebugPrintf(("Unlock user-mode buffer used for SGL DMA transfer...\n"));
+
+        // Unmap and unlock user buffer pages
+        PlxSglRelease(
+            pdx,
+            &pdx->DmaInfo[channel].Sgl
+            );
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Return queue entry to the free pool
+    if (pEntry != NULL)
+    {
+        pEntry->bInUse = FALSE;
+        pdx->DmaInfo[channel].pQueueActive = NULL;
+        pdx->DmaInfo[channel].QueueCompleted++;
+    }
+
+    // Chain the next queued transfer to keep the channel busy
+    if ((pdx->DmaInfo[channel].QueueCount != 0) && pdx->DmaInfo[channel].bOpen)
+    {
+        pEntry =
+            pdx->DmaInfo[channel].pQueueFifo[pdx->DmaInfo[channel].QueueHead];
+
+        pdx->DmaInfo[channel].QueueHead =
+            (pdx->DmaInfo[channel].QueueHead + 1) % DMA_MAX_QUEUE_ENTRIES;
+
+        pdx->DmaInfo[channel].QueueCount--;
+
+        DebugPrintf((
+            "Start next queued DMA transfer (%d remain)\n",
+            pdx->DmaInfo[channel].QueueCount
+            ));
+
+        pdx->DmaInfo[channel].pQueueActive   = pEntry;
+        pdx->DmaInfo[channel].NumDescriptors = pEntry->Sgl.NumDescriptors;
+
+        trace_plx_dma_start(
+            pdx,
+            channel,
+            pEntry->Sgl.BufferSize,
+            pEntry->Sgl.NumDescriptors,
+            (pEntry->Sgl.direction == DMA_FROM_DEVICE) ? PLX_DMA_LOC_TO_PCI : PLX_DMA_PCI_TO_LOC
+            );
+
+        PlxDmaStatsStart(
+            pdx,
+            channel,
+            pEntry->Sgl.BufferSize
+            );
+
+        PlxChipDmaSglStart(
+            pdx,
+            channel,
+            pEntry->SglAddress,
+            pEntry->bBits64
+            );
+    }
+    else
+    {
+        // Clear the DMA pending flag
+        pdx->DmaInfo[channel].bSglPending = FALSE;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxLockBufferAndBuildSgl
+ *
+ * Description:  Lock a user buffer and build an SGL for it
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxLockBufferAndBuildSgl(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_PARAMS   *pDma,
+    U32              *pSglAddress,
+    BOOLEAN          *pbBits64
+    )
+{
+    U8                  i;
+    U32                 offset;
+    U64                 Start_ns;
+    PLX_STATUS          status;
+    PLX_DMA_SGL        *pSgl;
+    PLX_DMA_REG_BUFFER *pRegBuffer;
+
+
+    offset     = 0;
+    pRegBuffer = NULL;
+    Start_ns   = ktime_to_ns( ktime_get() );
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Check if buffer is part of a registered buffer with matching SGL
+    for (i = 0; i < DMA_MAX_REG_BUFFERS; i++)
+    {
+        pSgl = &pdx->DmaInfo[channel].RegBuffer[i].Sgl;
+
+        if ((pdx->DmaInfo[channel].RegBuffer[i].bReady == FALSE) ||
+            (pDma->UserVa < pSgl->UserVa) ||
+            ((pDma->UserVa + pDma->ByteCount) > (pSgl->UserVa + pSgl->BufferSize)) ||
+            (pSgl->bConstAddrLocal != pdx->DmaInfo[channel].bConstAddrLocal) ||
+            (pSgl->direction !=
+                ((pDma->Direction == PLX_DMA_LOC_TO_PCI) ? DMA_FROM_DEVICE : DMA_TO_DEVICE)))
+        {
+            continue;
+        }
+
+        offset = (U32)(pDma->UserVa - pSgl->UserVa);
+
+        // Local address must match the one used when the SGL was built
+        if (pSgl->bConstAddrLocal)
+        {
+            if (pDma->LocalAddr != pSgl->LocalAddr)
+            {
+                continue;
+            }
+        }
+        else if (pDma->LocalAddr != (pSgl->LocalAddr + offset))
+        {
+            continue;
+        }
+
+        pRegBuffer = &pdx->DmaInfo[channel].RegBuffer[i];
+
+        // Flag buffer as in use by the pending transfer
+        pdx->DmaInfo[channel].pRegBufferActive = pRegBuffer;
+        break;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (pRegBuffer != NULL)
+    {
+        DebugPrintf(("Use SGL of registered buffer %d\n", i + 1));
+
+        // Re-use SGL of registered buffer
+        status =
+            PlxSglRegBufferStart(
+                pdx,
+                channel,
+                offset,
+                pDma->ByteCount,
+                pSglAddress,
+                pbBits64
+                );
+
+        if (status != PLX_STATUS_OK)
+        {
+            pdx->DmaInfo[channel].pRegBufferActive = NULL;
+        }
+
+        PlxDmaStatsSetup(
+            pdx,
+            channel,
+            Start_ns,
+            NULL,
+            status
+            );
+
+        return status;
+    }
+
+    // Page-lock user buffer & build a new SGL
+    status =
+        PlxSglBuild(
+            pdx,
+            pDma,
+            pdx->DmaInfo[channel].bConstAddrLocal,
+            0,
+            &pdx->DmaInfo[channel].Sgl,
+            pSglAddress,
+            pbBits64
+            );
+
+    if (status == PLX_STATUS_OK)
+    {
+        // Store final descriptor count
+        pdx->DmaInfo[channel].NumDescriptors =
+                           pdx->DmaInfo[channel].Sgl.NumDescriptors;
+    }
+
+    PlxDmaStatsSetup(
+        pdx,
+        channel,
+        Start_ns,
+        &pdx->DmaInfo[channel].Sgl,
+        status
+        );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglBuild
+ *
+ * Description:  Page-lock & map a user buffer and build the SGL describing it
+ *
+ * Note       :  If SegmentSize is non-zero, descriptors are not merged across
+ *               segment boundaries of the buffer.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxSglBuild(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_PARAMS   *pDma,
+    BOOLEAN           bConstAddrLocal,
+    U32               SegmentSize,
+    PLX_DMA_SGL      *pSgl,
+    U32              *pSglAddress,
+    BOOLEAN          *pbBits64
+    )
+{
+    int          rc;
+    U8           SizeDescr;
+    U32          i;
+    U32          offset;
+    U32          BusSgl;
+    U32          BusSglOriginal;
+    U32          SglSize;
+    U32          BlockSize;
+    U32          LocalAddr;
+    U32          NumDescr;
+    U32          DescrSize;
+    U32          TotalDescr;
+    U32          BytesRemaining;
+    U64          BusAddr;
+    U64          DescrBusAddr;
+    BOOLEAN      bDirLocalToPci;
+    PLX_UINT_PTR VaSgl;
+    PLX_UINT_PTR UserVa;
+
+
+    DebugPrintf(("Build SGL descriptors for buffer...\n"));
+    DebugPrintf(("   User VA   : %08lX\n", (PLX_UINT_PTR)pDma->UserVa));
+    DebugPrintf(("   Local Addr: %08X\n", pDma->LocalAddr));
+    DebugPrintf(("   Size      : %dB\n", pDma->ByteCount));
+    DebugPrintf(("   Direction : %s\n",
+        (pDma->Direction == PLX_DMA_LOC_TO_PCI) ? "Local --> PCI" : "PCI --> Local"
+        ));
+
+    // Set default return address
+    *pSglAddress = 0;
+
+    // Store buffer properties
+    pSgl->UserVa          = (PLX_UINT_PTR)pDma->UserVa;
+    pSgl->LocalAddr       = pDma->LocalAddr;
+    pSgl->bConstAddrLocal = bConstAddrLocal;
+
+    // Store buffer page offset
+    pSgl->InitialOffset = (U32)(pDma->UserVa & ~PAGE_MASK);
+
+    offset         = pSgl->InitialOffset;
+    UserVa         = pDma->UserVa;
+    BytesRemaining = pDma->ByteCount;
+    TotalDescr     = 0;
+
+    // Count number of user pages
+    while (BytesRemaining != 0)
+    {
+        // Add an I/O buffer
+        TotalDescr++;
+
+        if (BytesRemaining <= (PAGE_SIZE - offset))
+        {
+            BytesRemaining = 0;
+        }
+        else
+        {
+            BytesRemaining -= (PAGE_SIZE - offset);
+        }
+
+        // Clear offset
+        offset = 0;
+    }
+
+    DebugPrintf((
+        "Allocate %d bytes for user buffer page list (%d pages)...\n",
+        (U32)(TotalDescr * sizeof(struct page *)), TotalDescr
+        ));
+
+    // Allocate memory to store page list
+    pSgl->PageList =
+        kmalloc(
+            TotalDescr * sizeof(struct page *),
+            GFP_KERNEL
+            );
+
+    if (pSgl->PageList == NULL)
+    {
+        DebugPrintf(("ERROR - Unable to allocate memory for list of pages\n"));
+        return PLX_STATUS_PAGE_GET_ERROR;
+    }
+
+    // Store number of pages
+    pSgl->NumPages = TotalDescr;
+
+    // Determine & store DMA transfer direction
+    if (pDma->Direction == PLX_DMA_LOC_TO_PCI)
+    {
+        bDirLocalToPci  = TRUE;
+        pSgl->direction = DMA_FROM_DEVICE;
+    }
+    else
+    {
+        bDirLocalToPci  = FALSE;
+        pSgl->direction = DMA_TO_DEVICE;
+    }
+
+    // Obtain the mmap reader/writer semaphore
+    Plx_mmap_lock(current->mm);
+
+    // Attempt to lock the user buffer into memory
+    rc =
+        Plx_get_user_pages(
+            UserVa & PAGE_MASK,                // Page-aligned user buffer start address
+            TotalDescr,                        // Length of the buffer in pages
+            (bDirLocalToPci ? FOLL_WRITE : 0), // Flags
+            pSgl->PageList,                    // List of page pointers describing buffer
+            NULL                               // List of associated VMAs
+            );
+
+    // Release mmap semaphore
+    Plx_mmap_unlock(current->mm);
+
+    if (rc != TotalDescr)
+    {
+        if (rc <= 0)
+        {
+            DebugPrintf(("ERROR - Unable to map user buffer (code=%d)\n", rc));
+        }
+        else
+        {
+            DebugPrintf((
+                "ERROR - Only able to map %d of %d total pages\n",
+                rc, TotalDescr
+                ));
+
+            // Unlock user buffer pages that were mapped
+            for (i = 0; i < rc; i++)
+            {
+                put_page( pSgl->PageList[i] );
+            }
+        }
+        kfree( pSgl->PageList );
+        pSgl->PageList = NULL;
+        return PLX_STATUS_PAGE_LOCK_ERROR;
+    }
+
+    DebugPrintf(("Page-locked %d user buffer pages...\n", TotalDescr));
+
+    // Use 64-bit dual-address descriptors if buffers may reside above 4GB
+    *pbBits64 = pdx->bDmaAddr64;
+
+    /*************************************************************
+     * Build SGL descriptors
+     *
+     * The following code will build the SGL descriptors
+     * in PCI memory.  Pages are mapped individually, but
+     * pages which end up contiguous on the bus are merged
+     * into a single descriptor, up to the maximum byte count
+     * supported by the DMA engine per descriptor.
+     ************************************************************/
+
+    /*************************************************************
+     * Calculate memory needed for SGL descriptors
+     *
+     * Mem needed = (#descriptors * descriptor size) + (rounding bytes)
+     *
+     * 16 or 32 bytes are added to support rounding up to the next
+     * 16 or 32-byte boundary, which is a requirement of the hardware.
+     ************************************************************/
+    // Calculate descriptor size
+    if (*pbBits64)
+    {
+        SizeDescr = 8 * sizeof(U32);
+    }
+    else
+    {
+        SizeDescr = 4 * sizeof(U32);
+    }
+
+    pSgl->SizeDescr = SizeDescr;
+
+    // Calculate SGL size
+    SglSize = (TotalDescr * SizeDescr) + SizeDescr;
+
+    // Check if a previously allocated buffer can be re-used
+    if (pSgl->SglBuffer.pKernelVa != NULL)
+    {
+        if (pSgl->SglBuffer.Size >= SglSize)
+        {
+            // Buffer can be re-used, do nothing
+            DebugPrintf(("Re-use previously allocated SGL descriptor buffer\n"));
+        }
+        else
+        {
+            DebugPrintf(("Release previously allocated SGL descriptor buffer\n"));
+
+            // Release memory used for SGL descriptors
+            Plx_dma_buffer_free(
+                pdx,
+                &pSgl->SglBuffer
+                );
+
+            pSgl->SglBuffer.pKernelVa = NULL;
+        }
+    }
+
+    // Allocate memory for SGL descriptors if necessary
+    if (pSgl->SglBuffer.pKernelVa == NULL)
+    {
+        DebugPrintf(("Allocate PCI memory for SGL descriptor buffer...\n"));
+
+        // Setup for transfer
+        pSgl->SglBuffer.Size = SglSize;
+
+        VaSgl =
+            (PLX_UINT_PTR)Plx_dma_buffer_alloc(
+                pdx,
+                &pSgl->SglBuffer
+                );
+
+        if (VaSgl == 0)
+        {
+            DebugPrintf((
+                "ERROR - Unable to allocate %d bytes for %d SGL descriptors\n",
+                pSgl->SglBuffer.Size, TotalDescr
+                ));
+            // Unlock user buffer pages
+            for (i = 0; i < TotalDescr; i++)
+            {
+                put_page( pSgl->PageList[i] );
+            }
+            kfree( pSgl->PageList );
+            pSgl->PageList = NULL;
+            return PLX_STATUS_INSUFFICIENT_RES;
+        }
+    }
+    else
+    {
+        VaSgl = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
+    }
+
+    // Prepare for build of SGL
+    LocalAddr = pDma->LocalAddr;
+
+    // Get bus physical address of SGL descriptors
+    BusSgl = (U32)pSgl->SglBuffer.BusPhysical;
+
+    // Make sure addresses are aligned on next descriptor boundary
+    VaSgl  = (VaSgl + (SizeDescr - 1)) & ~((PLX_UINT_PTR)SizeDescr - 1);
+    BusSgl = (BusSgl + (SizeDescr - 1)) & ~((PLX_UINT_PTR)SizeDescr - 1);
+
+    // Store the starting address of the SGL for later return
+    BusSglOriginal = BusSgl;
+
+    DebugPrintf((
+        "Build SGL at %08xh (%d descriptors)\n",
+        BusSglOriginal, TotalDescr
+        ));
+
+    // Store total buffer size
+    pSgl->BufferSize = pDma->ByteCount;
+
+    // Set offset of first page
+    offset = pSgl->InitialOffset;
+
+    // Initialize bytes remaining
+    BytesRemaining = pDma->ByteCount;
+
+    // Initialize descriptor tracking
+    NumDescr     = 0;
+    DescrSize    = 0;
+    DescrBusAddr = 0;
+
+    // Build the SGL list
+    for (i = 0; i < TotalDescr; i++)
+    {
+        // Calculate transfer size
+        if (BytesRemaining > (PAGE_SIZE - offset))
+        {
+            BlockSize = PAGE_SIZE - offset;
+        }
+        else
+        {
+            BlockSize = BytesRemaining;
+        }
+
+        // Get bus address of buffer
+        BusAddr =
+            dma_map_page(
+                &(pdx->pPciDevice->dev),
+                pSgl->PageList[i],
+                offset,
+                BlockSize,
+                pSgl->direction
+                );
+
+        // Merge into current descriptor if contiguous, within byte count limit
+        // & not at the start of a new segment
+        if ((DescrSize != 0) &&
+            (BusAddr == (DescrBusAddr + DescrSize)) &&
+            ((DescrSize + BlockSize) <= DMA_MAX_BYTE_COUNT) &&
+            ((SegmentSize == 0) ||
+             (((pDma->ByteCount - BytesRemaining) % SegmentSize) != 0)))
+        {
+            DescrSize += BlockSize;
+        }
+        else
+        {
+            if (DescrSize != 0)
+            {
+                // Calculate address of next descriptor
+                BusSgl += SizeDescr;
+
+                // Link current descriptor to the next one
+                *(((U32*)VaSgl) + SGL_DESC_IDX_NEXT_DESC) =
+                    PLX_LE_DATA_32(
+                        BusSgl | (bDirLocalToPci << 3) | (1 << 0)
+                        );
+
+                // Adjust Local address
+                if (bConstAddrLocal == FALSE)
+                {
+                    LocalAddr += DescrSize;
+                }
+
+                // Adjust virtual address to next descriptor
+                VaSgl += SizeDescr;
+            }
+
+            // Start a new descriptor
+            NumDescr++;
+            DescrBusAddr = BusAddr;
+            DescrSize    = BlockSize;
+
+            // Write PCI address in descriptor
+            *(((U32*)VaSgl) + SGL_DESC_IDX_PCI_LOW) = PLX_LE_DATA_32( (U32)BusAddr );
+
+            // Write upper 32-bit of 64-bit PCI address in descriptor
+            if (*pbBits64)
+            {
+                *(((U32*)VaSgl) + SGL_DESC_IDX_PCI_HIGH) =
+                               PLX_LE_DATA_32( (U32)(BusAddr >> 32) );
+            }
+
+            // Write Local address in descriptor
+            *(((U32*)VaSgl) + SGL_DESC_IDX_LOC_ADDR) = PLX_LE_DATA_32( LocalAddr );
+        }
+
+        // Write transfer count in descriptor
+        *(((U32*)VaSgl) + SGL_DESC_IDX_COUNT) = PLX_LE_DATA_32( DescrSize );
+
+        // Enable the following to display the parameters of each SGL descriptor
+        if (PLX_DEBUG_DISPLAY_SGL_DESCR)
+        {
+            DebugPrintf((
+                "SGL Desc %02d: PCI=%08llX  Loc=%08X  Size=%X (%dB)\n",
+                NumDescr - 1, DescrBusAddr, LocalAddr, DescrSize, DescrSize
+                ));
+        }
+
+        // Adjust byte count
+        BytesRemaining -= BlockSize;
+
+        // Clear offset
+        offset = 0;
+    }
+
+    // Write the last descriptor
+    *(((U32*)VaSgl) + SGL_DESC_IDX_NEXT_DESC) =
+        PLX_LE_DATA_32(
+            (bDirLocalToPci << 3) | (1 << 1) | (1 << 0)
+            );
+
+    // Store final descriptor count
+    pSgl->NumDescriptors = NumDescr;
+
+    DebugPrintf((
+        "Merged %d pages into %d SGL descriptors\n",
+        TotalDescr, NumDescr
+        ));
+
+    trace_plx_dma_sgl_build(
+        pdx,
+        pDma->ByteCount,
+        TotalDescr,
+        NumDescr
+        );
+
+    // Return the physical address of the SGL
+    *pSglAddress = BusSglOriginal;
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglRelease
+ *
+ * Description:  Unmap & unlock the user buffer pages described by an SGL
+ *
+ ******************************************************************************/
+VOID
+PlxSglRelease(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_SGL      *pSgl
+    )
+{
+    U32          i;
+    U32          page;
+    U32          offset;
+    U32          BlockSize;
+    U32          BytesRemaining;
+    U64          BusAddr;
+    PLX_UINT_PTR VaSgl;
+
+
+    // Get pointer to SGL list
+    VaSgl = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
+
+    // Jump to next descriptor-aligned boundary
+    VaSgl = (VaSgl + (pSgl->SizeDescr - 1)) & ~((PLX_UINT_PTR)pSgl->SizeDescr - 1);
+
+    // Set offset of first page
+    offset = pSgl->InitialOffset;
+
+    page = 0;
+
+    /*************************************************************
+     * Unmap and unlock user buffer pages
+     *
+     * A descriptor may cover several pages which were merged
+     * because they were contiguous on the bus. Each page was
+     * mapped individually, so the descriptor is split back
+     * into its page-sized pieces for unmapping.
+     ************************************************************/
+    for (i = 0; i < pSgl->NumDescriptors; i++)
+    {
+        // Get PCI bus address from descriptor
+        BusAddr = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_PCI_LOW));
+
+        if (pSgl->SizeDescr > (4 * sizeof(U32)))
+        {
+            BusAddr |= (U64)PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_PCI_HIGH)) << 32;
+        }
+
+        // Get byte count from descriptor
+        BytesRemaining = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_COUNT));
+
+        // Adjust virtual address to next descriptor
+        VaSgl += pSgl->SizeDescr;
+
+        while ((BytesRemaining != 0) && (page < pSgl->NumPages))
+        {
+            // Calculate size of the piece in current page
+            if (BytesRemaining > (PAGE_SIZE - offset))
+            {
+                BlockSize = PAGE_SIZE - offset;
+            }
+            else
+            {
+                BlockSize = BytesRemaining;
+            }
+
+            // Unmap the page
+            dma_unmap_page(
+                &(pdx->pPciDevice->dev),
+                BusAddr,
+                BlockSize,
+                pSgl->direction
+                );
+
+            // Mark page as dirty if Loc->PCI DMA (user app read)
+            if (pSgl->direction == DMA_FROM_DEVICE)
+            {
+                // Mark page as dirty if necessary
+                if (!PageReserved(pSgl->PageList[page]))
+                {
+                    SetPageDirty( pSgl->PageList[page] );
+                }
+            }
+
+            // Unlock the page
+            put_page( pSgl->PageList[page] );
+
+            // Adjust for next page
+            BusAddr        += BlockSize;
+            BytesRemaining -= BlockSize;
+            offset          = 0;
+            page++;
+        }
+    }
+
+    // Release page-list memory
+    kfree( pSgl->PageList );
+
+    pSgl->PageList = NULL;
+    pSgl->NumPages = 0;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglSync
+ *
+ * Description:  Synchronize part of a mapped user buffer for CPU or device access
+ *
+ ******************************************************************************/
+VOID
+PlxSglSync(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_SGL      *pSgl,
+    U32               offset,
+    U32               ByteCount,
+    BOOLEAN           bForDevice
+    )
+{
+    U32          i;
+    U32          pos;
+    U32          end;
+    U32          count;
+    U32          BlockSize;
+    U32          PageEnd;
+    U64          BusAddr;
+    PLX_UINT_PTR VaSgl;
+
+
+    // Get pointer to first descriptor
+    VaSgl = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
+    VaSgl = (VaSgl + (pSgl->SizeDescr - 1)) & ~((PLX_UINT_PTR)pSgl->SizeDescr - 1);
+
+    pos = 0;
+    end = offset + ByteCount;
+
+    for (i = 0; (i < pSgl->NumDescriptors) && (pos < end); i++)
+    {
+        // Get descriptor bus address & byte count
+        BusAddr = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_PCI_LOW));
+
+        if (pSgl->SizeDescr > (4 * sizeof(U32)))
+        {
+            BusAddr |= (U64)PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_PCI_HIGH)) << 32;
+        }
+
+        count = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_COUNT));
+
+        VaSgl += pSgl->SizeDescr;
+
+        // Sync each page piece of the descriptor within the requested range
+        while ((count != 0) && (pos < end))
+        {
+            // Determine end of current page, in buffer offset terms
+            PageEnd = (((pos + pSgl->InitialOffset) & PAGE_MASK) + PAGE_SIZE) -
+                      pSgl->InitialOffset;
+
+            BlockSize = PageEnd - pos;
+            if (BlockSize > count)
+            {
+                BlockSize = count;
+            }
+
+            if ((pos + BlockSize) > offset)
+            {
+                if (bForDevice)
+                {
+                    dma_sync_single_for_device(
+                        &(pdx->pPciDevice->dev),
+                        BusAddr,
+                        BlockSize,
+                        pSgl->direction
+                        );
+                }
+                else
+                {
+                    dma_sync_single_for_cpu(
+                        &(pdx->pPciDevice->dev),
+                        BusAddr,
+                        BlockSize,
+                        pSgl->direction
+                        );
+                }
+            }
+
+            BusAddr += BlockSize;
+            pos     += BlockSize;
+            count   -= BlockSize;
+        }
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglRegBufferStart
+ *
+ * Description:  Prepare the SGL of the active registered buffer for a transfer
+ *               of part or all of the buffer
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxSglRegBufferStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               offset,
+    U32               ByteCount,
+    U32              *pSglAddress,
+    BOOLEAN          *pbBits64
+    )
+{
+    U32          i;
+    U32          pos;
+    U32          end;
+    U32          count;
+    U32          delta;
+    U32          BusSgl;
+    U64          BusAddr;
+    U32         *pDescr;
+    U32         *pDescrFirst;
+    PLX_DMA_SGL *pSgl;
+    PLX_UINT_PTR VaSgl;
+
+
+    pSgl = &pdx->DmaInfo[channel].pRegBufferActive->Sgl;
+
+    if ((ByteCount == 0) || ((offset + ByteCount) > pSgl->BufferSize))
+    {
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    // Store transfer range for completion
+    pdx->DmaInfo[channel].RegOffset        = offset;
+    pdx->DmaInfo[channel].RegByteCount     = ByteCount;
+    pdx->DmaInfo[channel].pDescrPatched[0] = NULL;
+    pdx->DmaInfo[channel].pDescrPatched[1] = NULL;
+    pdx->DmaInfo[channel].NumDescriptors   = pSgl->NumDescriptors;
+
+    // Return buffer to the device, which flushes CPU writes before the
+    // device reads it or discards stale CPU cache lines of a re-used
+    // buffer before the device writes it
+    PlxSglSync(
+        pdx,
+        pSgl,
+        offset,
+        ByteCount,
+        TRUE
+        );
+
+    *pbBits64 = (pSgl->SizeDescr > (4 * sizeof(U32))) ? TRUE : FALSE;
+
+    // Get first descriptor
+    VaSgl  = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
+    VaSgl  = (VaSgl + (pSgl->SizeDescr - 1)) & ~((PLX_UINT_PTR)pSgl->SizeDescr - 1);
+    BusSgl = (U32)pSgl->SglBuffer.BusPhysical;
+    BusSgl = (BusSgl + (pSgl->SizeDescr - 1)) & ~((U32)pSgl->SizeDescr - 1);
+
+    // Entire buffer transfer uses the SGL as-is
+    if ((offset == 0) && (ByteCount == pSgl->BufferSize))
+    {
+        *pSglAddress = BusSgl;
+        return PLX_STATUS_OK;
+    }
+
+    pos         = 0;
+    end         = offset + ByteCount;
+    pDescrFirst = NULL;
+
+    /*************************************************************
+     * Trim the SGL to the requested range
+     *
+     * The descriptor containing the start of the range is
+     * adjusted to begin at the offset and the descriptor
+     * containing the end is marked as the end of the chain.
+     * The original values are restored once the transfer is done.
+     ************************************************************/
+    for (i = 0; i < pSgl->NumDescriptors; i++)
+    {
+        pDescr = (U32*)(VaSgl + (i * pSgl->SizeDescr));
+        count  = PLX_LE_DATA_32( pDescr[SGL_DESC_IDX_COUNT] );
+
+        if ((pDescrFirst == NULL) && (offset < (pos + count)))
+        {
+            pDescrFirst = pDescr;
+
+            // Save original descriptor
+            memcpy(
+                pdx->DmaInfo[channel].DescrSave[0],
+                pDescr,
+                pSgl->SizeDescr
+                );
+            pdx->DmaInfo[channel].pDescrPatched[0] = pDescr;
+
+            delta = offset - pos;
+
+            // Advance PCI address to start of range
+            BusAddr = PLX_LE_DATA_32( pDescr[SGL_DESC_IDX_PCI_LOW] );
+            if (*pbBits64)
+            {
+                BusAddr |= (U64)PLX_LE_DATA_32( pDescr[SGL_DESC_IDX_PCI_HIGH] ) << 32;
+            }
+            BusAddr += delta;
+
+            pDescr[SGL_DESC_IDX_PCI_LOW] = PLX_LE_DATA_32( (U32)BusAddr );
+            if (*pbBits64)
+            {
+                pDescr[SGL_DESC_IDX_PCI_HIGH] = PLX_LE_DATA_32( (U32)(BusAddr >> 32) );
+            }
+
+            // Advance Local address unless it remains constant
+            if (pSgl->bConstAddrLocal == FALSE)
+            {
+                pDescr[SGL_DESC_IDX_LOC_ADDR] =
+                    PLX_LE_DATA_32(
+                        PLX_LE_DATA_32( pDescr[SGL_DESC_IDX_LOC_ADDR] ) + delta
+                        );
+            }
+
+            pDescr[SGL_DESC_IDX_COUNT] = PLX_LE_DATA_32( count - delta );
+
+            // Return address of first descriptor used
+            *pSglAddress = BusSgl + (i * pSgl->SizeDescr);
+        }
+
+        if (end <= (pos + count))
+        {
+            // Save original descriptor unless already saved as first
+            if (pDescr != pDescrFirst)
+            {
+                memcpy(
+                    pdx->DmaInfo[channel].DescrSave[1],
+                    pDescr,
+                    pSgl->SizeDescr
+                    );
+                pdx->DmaInfo[channel].pDescrPatched[1] = pDescr;
+            }
+
+            // Trim byte count to end of range
+            if (pDescr == pDescrFirst)
+            {
+                pDescr[SGL_DESC_IDX_COUNT] = PLX_LE_DATA_32( ByteCount );
+            }
+            else
+            {
+                pDescr[SGL_DESC_IDX_COUNT] = PLX_LE_DATA_32( end - pos );
+            }
+
+            // Mark as end of chain
+            pDescr[SGL_DESC_IDX_NEXT_DESC] |= PLX_LE_DATA_32( 1 << 1 );
+            break;
+        }
+
+        pos += count;
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxSglRegBufferDone
+ *
+ * Description:  Restore the SGL of the active registered buffer after a transfer
+ *
+ ******************************************************************************/
+VOID
+PlxSglRegBufferDone(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U8           i;
+    PLX_DMA_SGL *pSgl;
+
+
+    pSgl = &pdx->DmaInfo[channel].pRegBufferActive->Sgl;
+
+    // Restore any descriptors modified for a partial transfer
+    for (i = 0; i < 2; i++)
+    {
+        if (pdx->DmaInfo[channel].pDescrPatched[i] != NULL)
+        {
+            memcpy(
+                pdx->DmaInfo[channel].pDescrPatched[i],
+                pdx->DmaInfo[channel].DescrSave[i],
+                pSgl->SizeDescr
+                );
+
+            pdx->DmaInfo[channel].pDescrPatched[i] = NULL;
+        }
+    }
+
+    // Make device writes to the buffer visible to the CPU
+    if (pSgl->direction == DMA_FROM_DEVICE)
+    {
+        PlxSglSync(
+            pdx,
+            pSgl,
+            pdx->DmaInfo[channel].RegOffset,
+            pdx->DmaInfo[channel].RegByteCount,
+            FALSE
+            );
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Registered buffer is no longer in use
+    pdx->DmaInfo[channel].pRegBufferActive = NULL;
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaRegBufferRelease
+ *
+ * Description:  Unlock a registered user buffer & release its SGL
+ *
+ ******************************************************************************/
+VOID
+PlxDmaRegBufferRelease(
+    DEVICE_EXTENSION   *pdx,
+    U8                  channel,
+    PLX_DMA_REG_BUFFER *pRegBuffer
+    )
+{
+    // Unmap and unlock user buffer pages
+    PlxSglRelease(
+        pdx,
+        &pRegBuffer->Sgl
+        );
+
+    // Release memory used for SGL descriptors
+    if (pRegBuffer->Sgl.SglBuffer.pKernelVa != NULL)
+    {
+        Plx_dma_buffer_free(
+            pdx,
+            &pRegBuffer->Sgl.SglBuffer
+            );
+    }
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Free the entry
+    RtlZeroMemory( pRegBuffer, sizeof(PLX_DMA_REG_BUFFER) );
+
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaRegBufferReleaseAll
+ *
+ * Description:  Unlock all registered buffers of a DMA channel
+ *
+ ******************************************************************************/
+VOID
+PlxDmaRegBufferReleaseAll(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U8 i;
+
+
+    for (i = 0; i < DMA_MAX_REG_BUFFERS; i++)
+    {
+        if (pdx->DmaInfo[channel].RegBuffer[i].bReady)
+        {
+            DebugPrintf(("Release registered buffer %d\n", i + 1));
+
+            PlxDmaRegBufferRelease(
+                pdx,
+                channel,
+                &pdx->DmaInfo[channel].RegBuffer[i]
+                );
+        }
+    }
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionSignal
+ *
+ * Description:  Wake any threads waiting for a DMA channel to complete
+ *
+ ******************************************************************************/
+VOID
+PlxDmaCompletionSignal(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    )
+{
+    U64           Time_ns;
+    unsigned long flags;
+
+
+    Time_ns = ktime_to_ns( ktime_get() );
+
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+    // Record hardware time of the transfer
+    PlxDmaStatsHistAdd(
+        pdx->DmaInfo[channel].Stats.Hist_Hardware,
+        pdx->DmaInfo[channel].StartTime_ns,
+        Time_ns
+        );
+
+    pdx->DmaInfo[channel].StartTime_ns = 0;
+    pdx->DmaInfo[channel].DoneTime_ns  = Time_ns;
+
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+
+    // Signaled from both the ISR & the DPC
+    atomic_inc( &(pdx->DmaInfo[channel].DoneCount) );
+
+    wake_up_interruptible(
+        &(pdx->DmaInfo[channel].WaitDone)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionPost
+ *
+ * Description:  Append a record to the completion ring of the DMA channel owner
+ *
+ ******************************************************************************/
+VOID
+PlxDmaCompletionPost(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount,
+    PLX_STATUS        status
+    )
+{
+    unsigned long            flags;
+    struct list_head        *pEntry;
+    PLX_DMA_COMPLETION      *pRecord;
+    PLX_PHYS_MEM_OBJECT     *pMemObject;
+    PLX_DMA_COMPLETION_RING *pRing;
+
+
+    if (status != PLX_STATUS_OK)
+    {
+        spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+        pdx->DmaInfo[channel].Stats.Errors++;
+        spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+    }
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Find the ring of the channel owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        pMemObject =
+            list_entry(
+                pEntry,
+                PLX_PHYS_MEM_OBJECT,
+                ListEntry
+                );
+
+        if (pMemObject->pOwner == pdx->DmaInfo[channel].pOwner)
+        {
+            pRing = (PLX_DMA_COMPLETION_RING*)pMemObject->pKernelVa;
+
+            // Drop record if application has not drained the ring
+            if ((pRing->Head - pRing->Tail) >= PLX_DMA_COMPLETION_RING_SIZE)
+            {
+                pRing->DropCount++;
+            }
+            else
+            {
+                pRecord =
+                    &pRing->Entry[pRing->Head & (PLX_DMA_COMPLETION_RING_SIZE - 1)];
+
+                pRecord->Timestamp_ns = ktime_to_ns( ktime_get() );
+                pRecord->ByteCount    = ByteCount;
+                pRecord->Status       = status;
+                pRecord->Channel      = channel;
+
+                // Ensure record is visible before it is published
+                wmb();
+
+                pRing->Head++;
+            }
+            break;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingVmOpen
+ *
+ * Description:  Count a copy of a DMA completion ring user mapping, created
+ *               when the mapping is split or inherited by a child process
+ *
+ ******************************************************************************/
+static void
+PlxDmaCompletionRingVmOpen(
+    struct vm_area_struct *vma
+    )
+{
+    PLX_PHYS_MEM_OBJECT *pMemObject;
+
+
+    pMemObject = vma->vm_private_data;
+
+    atomic_inc( &(pMemObject->MapCount) );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingVmClose
+ *
+ * Description:  Release a DMA completion ring user mapping
+ *
+ ******************************************************************************/
+static void
+PlxDmaCompletionRingVmClose(
+    struct vm_area_struct *vma
+    )
+{
+    PLX_PHYS_MEM_OBJECT *pMemObject;
+
+
+    pMemObject = vma->vm_private_data;
+
+    atomic_dec( &(pMemObject->MapCount) );
+}
+
+
+static const struct vm_operations_struct PlxDmaCompletionRingVmOps =
+{
+    .open  = PlxDmaCompletionRingVmOpen,
+    .close = PlxDmaCompletionRingVmClose,
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionRingMapTrack
+ *
+ * Description:  Track a new user mapping if it maps the DMA completion ring
+ *               of the owner, so the ring is not released while mapped
+ *
+ * Note       :  Mappings hold a reference to the owner's file, so all are
+ *               closed before the ring is released when the owner closes.
+ *
+ ******************************************************************************/
+VOID
+PlxDmaCompletionRingMapTrack(
+    DEVICE_EXTENSION      *pdx,
+    struct vm_area_struct *vma,
+    U64                    CpuPhysical,
+    VOID                  *pOwner
+    )
+{
+    struct list_head    *pEntry;
+    PLX_PHYS_MEM_OBJECT *pMemObject;
+
+
+    spin_lock(
+        &(pdx->Lock_CompletionRingList)
+        );
+
+    pEntry = pdx->List_CompletionRings.next;
+
+    // Find the ring of the owner
+    while (pEntry != &(pdx->List_CompletionRings))
+    {
+        pMemObject =
+            list_entry(
+                pEntry,
+                PLX_PHYS_MEM_OBJECT,
+                ListEntry
+                );
+
+        if ((pMemObject->pOwner == pOwner) &&
+            (pMemObject->CpuPhysical == CpuPhysical))
+        {
+            atomic_inc( &(pMemObject->MapCount) );
+
+            vma->vm_private_data = pMemObject;
+            vma->vm_ops          = &PlxDmaCompletionRingVmOps;
+            break;
+        }
+
+        // Jump to next item
+        pEntry = pEntry->next;
+    }
+
+    spin_unlock(
+        &(pdx->Lock_CompletionRingList)
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaCompletionWait
+ *
+ * Description:  Wait until the DMA completion count of a channel reaches the
+ *               sequence number of the caller's transfer or the timeout expires
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxDmaCompletionWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               DoneSeq,
+    PLX_UINT_PTR      Timeout_ms
+    )
+{
+    U64           Time_ns;
+    long          Wait_rc;
+    unsigned long flags;
+
+
+    // Convert to jiffies in 2 steps to minimize overflow
+    if (Timeout_ms != PLX_TIMEOUT_INFINITE)
+    {
+        Timeout_ms = ((Timeout_ms / 1000) * HZ) + Plx_ms_to_jiffies( Timeout_ms % 1000 );
+    }
+
+    // Timeout parameter is signed and can't be negative
+    if ((signed long)Timeout_ms < 0)
+    {
+        Timeout_ms = Timeout_ms >> 1;
+    }
+
+    do
+    {
+        Wait_rc =
+            wait_event_interruptible_timeout(
+                pdx->DmaInfo[channel].WaitDone,
+                PLX_DMA_DONE_SEQ_REACHED( pdx, channel, DoneSeq ),
+                Timeout_ms
+                );
+    }
+    while ((Wait_rc == 0) && (Timeout_ms == PLX_TIMEOUT_INFINITE));
+
+    if (Wait_rc > 0)
+    {
+        Time_ns = ktime_to_ns( ktime_get() );
+
+        spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+        // Record delay from DMA done interrupt until the waiter runs
+        PlxDmaStatsHistAdd(
+            pdx->DmaInfo[channel].Stats.Hist_Wakeup,
+            pdx->DmaInfo[channel].DoneTime_ns,
+            Time_ns
+            );
+
+        spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+
+        return PLX_STATUS_OK;
+    }
+
+    if (Wait_rc == 0)
+    {
+        DebugPrintf(("Timeout waiting for DMA completion\n"));
 
-        // Jump to next capability
-        if (bPCIeCap)
-        {
-            // PCIe next cap offset in [31:20]
-            offset = (U16)((regVal >> 20) & 0xFFF);
-        }
-        else
-        {
-            // PCI next cap offset in [15:8]
-            offset = (U8)((regVal >> 8) & 0xFF);
-        }
+        spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+        pdx->DmaInfo[channel].Stats.Timeouts++;
+        spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+
+        return PLX_STATUS_TIMEOUT;
     }
 
-    // Capability not found
-    return 0;
+    DebugPrintf(("DMA completion wait interrupted by signal\n"));
+    return PLX_STATUS_CANCELED;
 }
 
 
@@ -365,68 +3180,58 @@ PlxPciFindCapability(
 
 /*******************************************************************************
  *
- * Function   :  PlxPciBarResourceMap
+ * Function   :  PlxDmaQueueFlush
  *
- * Description:  Maps a PCI BAR resource into kernel space
+ * Description:  Remove all transfers waiting in a DMA channel queue & unlock
+ *               their buffers. A transfer already in progress is not affected.
  *
  ******************************************************************************/
-int
-PlxPciBarResourceMap(
+VOID
+PlxDmaQueueFlush(
     DEVICE_EXTENSION *pdx,
-    U8                BarIndex
+    U8                channel
     )
 {
-    // Default resource to not claimed
-    pdx->PciBar[BarIndex].bResourceClaimed = FALSE;
+    U8                   i;
+    U8                   count;
+    PLX_DMA_QUEUE_ENTRY *pFlush[DMA_MAX_QUEUE_ENTRIES];
 
-    // Default to NULL kernel VA
-    pdx->PciBar[BarIndex].pVa = NULL;
 
-    // Request and Map space
-    if (pdx->PciBar[BarIndex].Properties.Flags & PLX_BAR_FLAG_IO)
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Detach waiting entries so the DPC can no longer start them
+    count = pdx->DmaInfo[channel].QueueCount;
+
+    for (i = 0; i < count; i++)
     {
-        // Request I/O port region
-        if (request_region(
-                pdx->PciBar[BarIndex].Properties.Physical,
-                pdx->PciBar[BarIndex].Properties.Size,
-                PLX_DRIVER_NAME
-                ) != NULL)
-        {
-            // Note that resource was claimed
-            pdx->PciBar[BarIndex].bResourceClaimed = TRUE;
-        }
+        pFlush[i] =
+            pdx->DmaInfo[channel].pQueueFifo[
+                (pdx->DmaInfo[channel].QueueHead + i) % DMA_MAX_QUEUE_ENTRIES];
     }
-    else
-    {
-        // Request memory region
-        if (request_mem_region(
-                pdx->PciBar[BarIndex].Properties.Physical,
-                pdx->PciBar[BarIndex].Properties.Size,
-                PLX_DRIVER_NAME
-                ) == NULL)
-        {
-            return (-ENOMEM);
-        }
-        else
-        {
-            // Note that resource was claimed
-            pdx->PciBar[BarIndex].bResourceClaimed = TRUE;
 
-            // Get a kernel-mapped virtual address
-            pdx->PciBar[BarIndex].pVa =
-                ioremap(
-                    pdx->PciBar[BarIndex].Properties.Physical,
-                    pdx->PciBar[BarIndex].Properties.Size
-                    );
+    pdx->DmaInfo[channel].QueueHead  = 0;
+    pdx->DmaInfo[channel].QueueCount = 0;
 
-            if (pdx->PciBar[BarIndex].pVa == NULL)
-            {
-                return (-ENOMEM);
-            }
-        }
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    if (count != 0)
+    {
+        DebugPrintf(("Flush %d queued DMA transfers\n", count));
     }
 
-    return 0;
+    for (i = 0; i < count; i++)
+    {
+        PlxSglRelease(
+            pdx,
+            &pFlush[i]->Sgl
+            );
+
+        pFlush[i]->bInUse = FALSE;
+    }
 }
 
 
@@ -434,60 +3239,43 @@ PlxPciBarResourceMap(
 
 /*******************************************************************************
  *
- * Function   :  PlxPciBarResourcesUnmap
+ * Function   :  PlxDmaQueueReleaseAll
  *
- * Description:  Unmap all mapped PCI BAR memory for a device
+ * Description:  Flush a DMA channel queue & release its SGL descriptor memory
  *
  ******************************************************************************/
 VOID
-PlxPciBarResourcesUnmap(
-    DEVICE_EXTENSION *pdx
+PlxDmaQueueReleaseAll(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
     )
 {
     U8 i;
 
 
-    // Go through all the BARS
-    for (i = 0; i < PCI_NUM_BARS_TYPE_00; i++)
+    PlxDmaQueueFlush(
+        pdx,
+        channel
+        );
+
+    for (i = 0; i < DMA_MAX_QUEUE_ENTRIES; i++)
     {
-        // Unmap the space from Kernel space if previously mapped
-        if (pdx->PciBar[i].Properties.Physical != 0)
+        if (pdx->DmaInfo[channel].Queue[i].Sgl.SglBuffer.pKernelVa != NULL)
         {
-            if (pdx->PciBar[i].Properties.Flags & PLX_BAR_FLAG_IO)
-            {
-                // Release I/O port region if it was claimed
-                if (pdx->PciBar[i].bResourceClaimed)
-                {
-                    release_region(
-                        pdx->PciBar[i].Properties.Physical,
-                        pdx->PciBar[i].Properties.Size
-                        );
-                }
-            }
-            else
-            {
-                // Unmap from kernel space
-                if (pdx->PciBar[i].pVa != NULL)
-                {
-                    DebugPrintf((
-                        "Unmap BAR %d (VA=%p)\n",
-                        i, pdx->PciBar[i].pVa
-                        ));
-                    iounmap( pdx->PciBar[i].pVa );
-                    pdx->PciBar[i].pVa = NULL;
-                }
-
-                // Release memory region if it was claimed
-                if (pdx->PciBar[i].bResourceClaimed)
-                {
-                    release_mem_region(
-                        pdx->PciBar[i].Properties.Physical,
-                        pdx->PciBar[i].Properties.Size
-                        );
-                }
-            }
+            Plx_dma_buffer_free(
+                pdx,
+                &pdx->DmaInfo[channel].Queue[i].Sgl.SglBuffer
+                );
         }
+
+        RtlZeroMemory(
+            &pdx->DmaInfo[channel].Queue[i],
+            sizeof(PLX_DMA_QUEUE_ENTRY)
+            );
     }
+
+    pdx->DmaInfo[channel].pQueueActive   = NULL;
+    pdx->DmaInfo[channel].QueueCompleted = 0;
 }
 
 
@@ -495,74 +3283,57 @@ PlxPciBarResourcesUnmap(
 
 /*******************************************************************************
  *
- * Function   :  PlxPciPhysicalMemoryFreeAll_ByOwner
+ * Function   :  PlxSglRingLink
  *
- * Description:  Unmap & release all physical memory assigned to the specified owner
+ * Description:  Convert an SGL into a circular list which interrupts at the end
+ *               of each ring segment & record the segment of each descriptor
  *
  ******************************************************************************/
 VOID
-PlxPciPhysicalMemoryFreeAll_ByOwner(
-    DEVICE_EXTENSION *pdx,
-    VOID             *pOwner
+PlxSglRingLink(
+    PLX_DMA_SGL *pSgl,
+    U32          SglAddress,
+    U32          SegmentSize,
+    U32         *pDescrSegment
     )
 {
-    PLX_PHYSICAL_MEM     PciMem;
-    struct list_head    *pEntry;
-    PLX_PHYS_MEM_OBJECT *pMemObject;
+    U32          i;
+    U32          offset;
+    U32          NextDescr;
+    PLX_UINT_PTR VaSgl;
 
 
-    spin_lock(
-        &(pdx->Lock_PhysicalMemList)
-        );
+    // Get pointer to first descriptor
+    VaSgl = (PLX_UINT_PTR)pSgl->SglBuffer.pKernelVa;
+    VaSgl = (VaSgl + (pSgl->SizeDescr - 1)) & ~((PLX_UINT_PTR)pSgl->SizeDescr - 1);
 
-    pEntry = pdx->List_PhysicalMem.next;
+    offset = 0;
 
-    // Traverse list to find the desired list objects
-    while (pEntry != &(pdx->List_PhysicalMem))
+    for (i = 0; i < pSgl->NumDescriptors; i++)
     {
-        // Get the object
-        pMemObject =
-            list_entry(
-                pEntry,
-                PLX_PHYS_MEM_OBJECT,
-                ListEntry
-                );
-
-        // Check if owner matches
-        if (pMemObject->pOwner == pOwner)
-        {
-            // Copy memory information
-            PciMem.PhysicalAddr = pMemObject->BusPhysical;
-            PciMem.Size         = pMemObject->Size;
-
-            // Release list lock
-            spin_unlock(
-                &(pdx->Lock_PhysicalMemList)
-                );
+        // Record the segment the descriptor belongs to
+        pDescrSegment[i] = offset / SegmentSize;
 
-            // Release the memory & remove from list
-            PlxPciPhysicalMemoryFree(
-                pdx,
-                &PciMem
-                );
+        offset += PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_COUNT));
 
-            spin_lock(
-                &(pdx->Lock_PhysicalMemList)
-                );
+        NextDescr = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_NEXT_DESC));
 
-            // Restart parsing the list from the beginning
-            pEntry = pdx->List_PhysicalMem.next;
+        // Replace end of chain in last descriptor with link back to the first
+        if (i == (pSgl->NumDescriptors - 1))
+        {
+            NextDescr = (NextDescr & (1 << 3)) | SglAddress | (1 << 0);
         }
-        else
+
+        // Interrupt after terminal count of the last descriptor in a segment
+        if ((offset % SegmentSize) == 0)
         {
-            // Jump to next item
-            pEntry = pEntry->next;
+            NextDescr |= (1 << 2);
         }
-    }
 
-    spin_unlock(
-        &(pdx->Lock_PhysicalMemList)
-        );
+        *(((U32*)VaSgl) + SGL_DESC_IDX_NEXT_DESC) = PLX_LE_DATA_32( NextDescr );
+
+        VaSgl += pSgl->SizeDescr;
+    }
 }
 
 
@@ -570,112 +3341,83 @@ PlxPciPhysicalMemoryFreeAll_ByOwner(
 
 /*******************************************************************************
  *
- * Function   :  Plx_dma_buffer_alloc
- *
- * Description:  Allocates physically contiguous non-paged memory
+ * Function   :  PlxDmaRingService
  *
- * Note       :  The function allocates a contiguous block of system memory and
- *               marks it as reserved. Marking the memory as reserved is required
- *               in case the memory is later mapped to user virtual space.
+ * Description:  Publish ring segments filled by DMA since the last interrupt
  *
  ******************************************************************************/
-VOID*
-Plx_dma_buffer_alloc(
-    DEVICE_EXTENSION    *pdx,
-    PLX_PHYS_MEM_OBJECT *pMemObject
+VOID
+PlxDmaRingService(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
     )
 {
-    dma_addr_t   BusAddress;
-    PLX_UINT_PTR virt_addr;
+    U32                descr;
+    U32                segment;
+    PLX_DMA_RING      *pRing;
+    PLX_DMA_RING_CTRL *pCtrl;
 
 
-    // Verify size
-    if (pMemObject->Size == 0)
-    {
-        ErrorPrintf(("ERROR: Unable to allocate buffer, requested size = 0\n"));
-        RtlZeroMemory( pMemObject, sizeof(PLX_PHYS_MEM_OBJECT) );
-        return NULL;
-    }
+    pRing = &pdx->DmaInfo[channel].Ring;
 
-    /*********************************************************
-     * Attempt to allocate contiguous memory
-     *
-     * Additional flags are specified as follows:
-     *
-     * __GFP_NOWARN : Prevents the kernel from dumping warnings
-     *                about a failed allocation attempt.  The
-     *                PLX driver already handles failures.
-     *
-     * __GFP_REPEAT : Not enabled by default, but may be added
-     *                manually.  It asks the kernel to "try a
-     *                little harder" in the allocation effort.
-     ********************************************************/
-    pMemObject->pKernelVa =
-        dma_alloc_coherent(
-            &(pdx->pPciDevice->dev),
-            pMemObject->Size,
-            &BusAddress,
-            GFP_KERNEL | __GFP_NOWARN
-            );
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
 
-    if (pMemObject->pKernelVa == NULL)
+    // Ring may have been stopped before DPC was run
+    if (pRing->bActive == FALSE)
     {
-        return NULL;
+        spin_unlock( &(pdx->Lock_Dma[channel]) );
+        return;
     }
 
-    // Store the bus address
-    pMemObject->BusPhysical = (U64)BusAddress;
+    pCtrl = (PLX_DMA_RING_CTRL*)pRing->CtrlPage.pKernelVa;
 
-    // Tag all pages as reserved
-    for (virt_addr = (PLX_UINT_PTR)pMemObject->pKernelVa;
-         virt_addr < ((PLX_UINT_PTR)pMemObject->pKernelVa + pMemObject->Size);
-         virt_addr += PAGE_SIZE)
+    // Get index of next descriptor to be fetched
+    descr =
+        (PlxChipDmaSglNextDescriptor(pdx, channel) - pRing->SglAddress) /
+        pRing->Sgl.SizeDescr;
+
+    if (descr >= pRing->Sgl.NumDescriptors)
     {
-        SetPageReserved(
-            virt_to_page( PLX_INT_TO_PTR(virt_addr) )
-            );
+        descr = 0;
     }
 
-    // Get CPU physical address of buffer
-    pMemObject->CpuPhysical =
-        virt_to_phys(
-            pMemObject->pKernelVa
-            );
+    // Determine segment of the descriptor in progress
+    descr =
+        (descr + pRing->Sgl.NumDescriptors - 1) % pRing->Sgl.NumDescriptors;
 
-    // Clear the buffer
-    RtlZeroMemory( pMemObject->pKernelVa, pMemObject->Size );
+    segment = pRing->pDescrSegment[descr];
 
-    DebugPrintf(("Allocated physical memory...\n"));
+    // All segments prior to the one in progress have been filled
+    while (pRing->SegmentActive != segment)
+    {
+        // Make segment data visible to the CPU
+        PlxSglSync(
+            pdx,
+            &pRing->Sgl,
+            pRing->SegmentActive * pRing->SegmentSize,
+            pRing->SegmentSize,
+            FALSE
+            );
 
-    DebugPrintf((
-        "    CPU Phys Addr: %08llx\n",
-        pMemObject->CpuPhysical
-        ));
+        // Check if DMA overwrote a segment not yet released by application
+        if ((pCtrl->ProducerIndex - pCtrl->ConsumerIndex) >= pRing->NumSegments)
+        {
+            pCtrl->OverrunCount++;
+        }
 
-    DebugPrintf((
-        "    Bus Phys Addr: %08llx\n",
-        pMemObject->BusPhysical
-        ));
+        // Ensure segment data is visible before it is published
+        wmb();
 
-    DebugPrintf((
-        "    Kernel VA    : %p\n",
-        pMemObject->pKernelVa
-        ));
+        pCtrl->ProducerIndex++;
 
-    DebugPrintf((
-        "    Size         : %Xh (%d%s)\n",
-        pMemObject->Size,
-        (pMemObject->Size > (1 << 30)) ? (pMemObject->Size >> 30) :
-          (pMemObject->Size > (1 << 20)) ? (pMemObject->Size >> 20) :
-          (pMemObject->Size > (1 << 10)) ? (pMemObject->Size >> 10) :
-          pMemObject->Size,
-        (pMemObject->Size > (1 << 30)) ? "GB" :
-          (pMemObject->Size > (1 << 20)) ? "MB" :
-          (pMemObject->Size > (1 << 10)) ? "KB" : "B"
-        ));
+        pRing->SegmentActive = (pRing->SegmentActive + 1) % pRing->NumSegments;
+    }
 
-    // Return the kernel virtual address of the allocated block
-    return pMemObject->pKernelVa;
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
+        );
 }
 
 
@@ -683,52 +3425,77 @@ Plx_dma_buffer_alloc(
 
 /*******************************************************************************
  *
- * Function   :  Plx_dma_buffer_free
+ * Function   :  PlxDmaRingRelease
  *
- * Description:  Frees previously allocated physical memory
+ * Description:  Stop servicing a DMA streaming ring & release its resources
+ *
+ * Note       :  The DMA channel must already be halted
  *
  ******************************************************************************/
 VOID
-Plx_dma_buffer_free(
-    DEVICE_EXTENSION    *pdx,
-    PLX_PHYS_MEM_OBJECT *pMemObject
+PlxDmaRingRelease(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
     )
 {
-    PLX_UINT_PTR virt_addr;
+    PLX_DMA_RING *pRing;
 
 
-    // Remove reservation tag for all pages
-    for (virt_addr = (PLX_UINT_PTR)pMemObject->pKernelVa;
-         virt_addr < ((PLX_UINT_PTR)pMemObject->pKernelVa + PAGE_ALIGN(pMemObject->Size));
-         virt_addr += PAGE_SIZE)
+    pRing = &pdx->DmaInfo[channel].Ring;
+
+    spin_lock(
+        &(pdx->Lock_Dma[channel])
+        );
+
+    // Prevent DPC from servicing the ring
+    if (pRing->bActive)
     {
-        ClearPageReserved(
-            virt_to_page( PLX_INT_TO_PTR(virt_addr) )
-            );
+        pRing->bActive                    = FALSE;
+        pdx->DmaInfo[channel].bSglPending = FALSE;
     }
 
-    // Release the buffer
-    dma_free_coherent(
-        &(pdx->pPciDevice->dev),
-        pMemObject->Size,
-        pMemObject->pKernelVa,
-        (dma_addr_t)pMemObject->BusPhysical
+    spin_unlock(
+        &(pdx->Lock_Dma[channel])
         );
 
-    DebugPrintf((
-        "Released physical memory at %08llxh (%d%s)\n",
-        pMemObject->CpuPhysical,
-        (pMemObject->Size > (1 << 30)) ? (pMemObject->Size >> 30) :
-          (pMemObject->Size > (1 << 20)) ? (pMemObject->Size >> 20) :
-          (pMemObject->Size > (1 << 10)) ? (pMemObject->Size >> 10) :
-          pMemObject->Size,
-        (pMemObject->Size > (1 << 30)) ? "GB" :
-          (pMemObject->Size > (1 << 20)) ? "MB" :
-          (pMemObject->Size > (1 << 10)) ? "KB" : "B"
-        ));
+    // Unmap and unlock ring buffer pages
+    if (pRing->Sgl.PageList != NULL)
+    {
+        DebugPrintf(("Unlock user-mode buffer used for DMA ring...\n"));
 
-    // Clear memory object properties
-    RtlZeroMemory( pMemObject, sizeof(PLX_PHYS_MEM_OBJECT) );
+        PlxSglRelease(
+            pdx,
+            &pRing->Sgl
+            );
+    }
+
+    // Release memory used for SGL descriptors
+    if (pRing->Sgl.SglBuffer.pKernelVa != NULL)
+    {
+        Plx_dma_buffer_free(
+            pdx,
+            &pRing->Sgl.SglBuffer
+            );
+    }
+
+    // Release the control page
+    if (pRing->CtrlPage.pKernelVa != NULL)
+    {
+        Plx_dma_buffer_free(
+            pdx,
+            &pRing->CtrlPage
+            );
+    }
+
+    if (pRing->pDescrSegment != NULL)
+    {
+        kfree( pRing->pDescrSegment );
+    }
+
+    RtlZeroMemory(
+        pRing,
+        sizeof(PLX_DMA_RING)
+        );
 }
 
 
@@ -736,113 +3503,82 @@ Plx_dma_buffer_free(
 
 /*******************************************************************************
  *
- * Function   :  PlxDmaChannelCleanup
+ * Function   :  PlxSglVectorRelease
  *
- * Description:  Called by the Cleanup routine to close any open channels
+ * Description:  Unlock the user buffers of a vectored SGL transfer & release
+ *               the descriptor memory shared by their SGLs
  *
  ******************************************************************************/
 VOID
-PlxDmaChannelCleanup(
-    DEVICE_EXTENSION *pdx,
-    VOID             *pOwner
+PlxSglVectorRelease(
+    DEVICE_EXTENSION    *pdx,
+    PLX_DMA_SGL         *pVector,
+    U32                  count,
+    PLX_PHYS_MEM_OBJECT *pSglBuffer
     )
 {
-#if defined(PLX_DMA_SUPPORT)
-    U8 i;
+    U32 i;
 
 
-    // Close any DMA channels opened by the owner
-    for (i = 0; i < NUM_DMA_CHANNELS; i++)
+    for (i = 0; i < count; i++)
     {
-        if (pdx->DmaInfo[i].bOpen)
+        // Only buffers that were successfully page-locked need release
+        if (pVector[i].PageList != NULL)
         {
-            PlxChip_DmaChannelClose(
+            PlxSglRelease(
                 pdx,
-                i,
-                FALSE,
-                pOwner
+                &pVector[i]
                 );
         }
     }
-#endif  // PLX_DMA_SUPPORT
-}
 
+    // Descriptors are a view into the shared buffer, so release it only once
+    if (pSglBuffer->pKernelVa != NULL)
+    {
+        Plx_dma_buffer_free(
+            pdx,
+            pSglBuffer
+            );
+    }
+
+    kfree( pVector );
+}
 
 
 
-#if defined(PLX_DMA_SUPPORT)
 /*******************************************************************************
  *
- * Function   :  PlxSglDmaTransferComplete
+ * Function   :  PlxDmaStatsHistAdd
  *
- * Description:  Perform any necessary cleanup after an SGL DMA transfer
+ * Description:  Add a latency sample to a log2 histogram
  *
  ******************************************************************************/
 VOID
-PlxSglDmaTransferComplete(
-    DEVICE_EXTENSION *pdx,
-    U8                channel
+PlxDmaStatsHistAdd(
+    U32 *pHist,
+    U64  Start_ns,
+    U64  End_ns
     )
 {
-    U32          i;
-    U32          BusAddr;
-    U32          BlockSize;
-    PLX_UINT_PTR VaSgl;
+    U32 bucket;
 
 
-    if (pdx->DmaInfo[channel].bSglPending == FALSE)
+    // Ignore samples without a valid start time
+    if ((Start_ns == 0) || (End_ns < Start_ns))
     {
-        DebugPrintf(("No pending SGL DMA to complete\n"));
         return;
     }
 
-    DebugPrintf(("Unlock user-mode buffer used for SGL DMA transfer...\n"));
-
-    // Get pointer to SGL list
-    VaSgl = (PLX_UINT_PTR)pdx->DmaInfo[channel].SglBuffer.pKernelVa;
-
-    // Jump to next 16-byte aligned boundary
-    VaSgl = (VaSgl + 0xF) & ~(0xF);
+    // Bucket N holds samples in the range [2^(N-1), 2^N) ns
+    bucket = fls64( End_ns - Start_ns );
 
-    // Unmap and unlock user buffer pages
-    for (i = 0; i < pdx->DmaInfo[channel].NumPages; i++)
+    // Last bucket also collects any larger samples
+    if (bucket >= PLX_DMA_STATS_HIST_BUCKETS)
     {
-        // Get PCI bus address from descriptor
-        BusAddr = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_PCI_LOW));
-
-        // Get byte count from descriptor
-        BlockSize = PLX_LE_DATA_32(*(((U32*)VaSgl) + SGL_DESC_IDX_COUNT));
-
-        // Adjust virtual address to next descriptor
-        VaSgl += (4 * sizeof(U32));
-
-        // Unmap the page
-        dma_unmap_page(
-            &(pdx->pPciDevice->dev),
-            BusAddr,
-            BlockSize,
-            pdx->DmaInfo[channel].direction
-            );
-
-        // Mark page as dirty if Loc->PCI DMA (user app read)
-        if (pdx->DmaInfo[channel].direction == DMA_FROM_DEVICE)
-        {
-            // Mark page as dirty if necessary
-            if (!PageReserved(pdx->DmaInfo[channel].PageList[i]))
-            {
-                SetPageDirty( pdx->DmaInfo[channel].PageList[i] );
-            }
-        }
-
-        // Unlock the page
-        put_page( pdx->DmaInfo[channel].PageList[i] );
+        bucket = PLX_DMA_STATS_HIST_BUCKETS - 1;
     }
 
-    // Release page-list memory
-    kfree( pdx->DmaInfo[channel].PageList );
-
-    // Clear the DMA pending flag
-    pdx->DmaInfo[channel].bSglPending = FALSE;
+    pHist[bucket]++;
 }
 
 
@@ -850,392 +3586,352 @@ PlxSglDmaTransferComplete(
 
 /*******************************************************************************
  *
- * Function   :  PlxLockBufferAndBuildSgl
+ * Function   :  PlxDmaStatsStart
  *
- * Description:  Lock a user buffer and build an SGL for it
+ * Description:  Account for a DMA transfer started on a channel
  *
  ******************************************************************************/
-PLX_STATUS
-PlxLockBufferAndBuildSgl(
+VOID
+PlxDmaStatsStart(
     DEVICE_EXTENSION *pdx,
     U8                channel,
-    PLX_DMA_PARAMS   *pDma,
-    U32              *pSglAddress,
-    BOOLEAN          *pbBits64
+    U32               ByteCount
     )
 {
-    int          rc;
-    U8           SizeDescr;
-    U32          i;
-    U32          offset;
-    U32          BusSgl;
-    U32          BusSglOriginal;
-    U32          SglSize;
-    U32          BlockSize;
-    U32          LocalAddr;
-    U32          TotalDescr;
-    U32          BytesRemaining;
-    U64          BusAddr;
-    BOOLEAN      bDirLocalToPci;
-    PLX_UINT_PTR VaSgl;
-    PLX_UINT_PTR UserVa;
+    U64           Time_ns;
+    unsigned long flags;
 
 
-    DebugPrintf(("Build SGL descriptors for buffer...\n"));
-    DebugPrintf(("   User VA   : %08lX\n", (PLX_UINT_PTR)pDma->UserVa));
-    DebugPrintf(("   Local Addr: %08X\n", pDma->LocalAddr));
-    DebugPrintf(("   Size      : %dB\n", pDma->ByteCount));
-    DebugPrintf(("   Direction : %s\n",
-        (pDma->Direction == PLX_DMA_LOC_TO_PCI) ? "Local --> PCI" : "PCI --> Local"
-        ));
+    Time_ns = ktime_to_ns( ktime_get() );
 
-    // Set default return address
-    *pSglAddress = 0;
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
 
-    // Store buffer page offset
-    pdx->DmaInfo[channel].InitialOffset = (U32)(pDma->UserVa & ~PAGE_MASK);
+    pdx->DmaInfo[channel].Stats.Transfers++;
+    pdx->DmaInfo[channel].Stats.Bytes  += ByteCount;
+    pdx->DmaInfo[channel].StartTime_ns  = Time_ns;
+    pdx->DmaInfo[channel].DoneTime_ns   = 0;
 
-    offset         = pdx->DmaInfo[channel].InitialOffset;
-    UserVa         = pDma->UserVa;
-    BytesRemaining = pDma->ByteCount;
-    TotalDescr     = 0;
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+}
 
-    // Count number of user pages
-    while (BytesRemaining != 0)
-    {
-        // Add an I/O buffer
-        TotalDescr++;
 
-        if (BytesRemaining <= (PAGE_SIZE - offset))
-        {
-            BytesRemaining = 0;
-        }
-        else
-        {
-            BytesRemaining -= (PAGE_SIZE - offset);
-        }
 
-        // Clear offset
-        offset = 0;
-    }
 
-    DebugPrintf((
-        "Allocate %d bytes for user buffer page list (%d pages)...\n",
-        (U32)(TotalDescr * sizeof(struct page *)), TotalDescr
-        ));
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsSetup
+ *
+ * Description:  Account for the result of locking a user buffer & building
+ *               its SGL
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsSetup(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Start_ns,
+    PLX_DMA_SGL      *pSgl,
+    PLX_STATUS        status
+    )
+{
+    U64           Time_ns;
+    unsigned long flags;
 
-    // Allocate memory to store page list
-    pdx->DmaInfo[channel].PageList =
-        kmalloc(
-            TotalDescr * sizeof(struct page *),
-            GFP_KERNEL
-            );
 
-    if (pdx->DmaInfo[channel].PageList == NULL)
-    {
-        DebugPrintf(("ERROR - Unable to allocate memory for list of pages\n"));
-        return PLX_STATUS_PAGE_GET_ERROR;
-    }
+    Time_ns = ktime_to_ns( ktime_get() );
 
-    // Store number of pages
-    pdx->DmaInfo[channel].NumPages = TotalDescr;
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
 
-    // Determine & store DMA transfer direction
-    if (pDma->Direction == PLX_DMA_LOC_TO_PCI)
+    if (status != PLX_STATUS_OK)
     {
-        bDirLocalToPci                  = TRUE;
-        pdx->DmaInfo[channel].direction = DMA_FROM_DEVICE;
+        pdx->DmaInfo[channel].Stats.Errors++;
     }
     else
     {
-        bDirLocalToPci                  = FALSE;
-        pdx->DmaInfo[channel].direction = DMA_TO_DEVICE;
-    }
-
-    // Obtain the mmap reader/writer semaphore
-    Plx_mmap_lock(current->mm);
-
-    // Attempt to lock the user buffer into memory
-    rc =
-        Plx_get_user_pages(
-            UserVa & PAGE_MASK,                // Page-aligned user buffer start address
-            TotalDescr,                        // Length of the buffer in pages
-            (bDirLocalToPci ? FOLL_WRITE : 0), // Flags
-            pdx->DmaInfo[channel].PageList,    // List of page pointers describing buffer
-            NULL                               // List of associated VMAs
-            );
-
-    // Release mmap semaphore
-    Plx_mmap_unlock(current->mm);
-
-    if (rc != TotalDescr)
-    {
-        if (rc <= 0)
-        {
-            DebugPrintf(("ERROR - Unable to map user buffer (code=%d)\n", rc));
-        }
-        else
+        // Registered buffers re-use an existing SGL
+        if (pSgl != NULL)
         {
-            DebugPrintf((
-                "ERROR - Only able to map %d of %d total pages\n",
-                rc, TotalDescr
-                ));
-
-            // Unlock user buffer pages that were mapped
-            for (i = 0; i < rc; i++)
-            {
-                put_page( pdx->DmaInfo[channel].PageList[i] );
-            }
+            pdx->DmaInfo[channel].Stats.PagesPinned += pSgl->NumPages;
+            pdx->DmaInfo[channel].Stats.Descriptors += pSgl->NumDescriptors;
         }
-        kfree( pdx->DmaInfo[channel].PageList );
-        return PLX_STATUS_PAGE_LOCK_ERROR;
+
+        PlxDmaStatsHistAdd(
+            pdx->DmaInfo[channel].Stats.Hist_Setup,
+            Start_ns,
+            Time_ns
+            );
     }
 
-    DebugPrintf(("Page-locked %d user buffer pages...\n", TotalDescr));
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+}
 
-    // Default to 32-bit transfer
-    *pbBits64 = FALSE;
 
-    /*************************************************************
-     * Build SGL descriptors
-     *
-     * The following code will build the SGL descriptors
-     * in PCI memory.  There will be one descriptor for
-     * each page of memory since the pages are scattered
-     * throughout physical memory.
-     ************************************************************/
 
-    /*************************************************************
-     * Calculate memory needed for SGL descriptors
-     *
-     * Mem needed = (#descriptors * descriptor size) + (rounding bytes)
-     *
-     * 16 or 32 bytes are added to support rounding up to the next
-     * 16 or 32-byte boundary, which is a requirement of the hardware.
-     ************************************************************/
-    // Calculate descriptor size
-    if (*pbBits64)
+
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsGet
+ *
+ * Description:  Return a snapshot of the statistics of a DMA channel
+ *
+ * Note       :  Either parameter may be NULL/FALSE to only read or only reset
+ *
+ ******************************************************************************/
+VOID
+PlxDmaStatsGet(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_STATS    *pStats,
+    BOOLEAN           bReset
+    )
+{
+    unsigned long flags;
+
+
+    spin_lock_irqsave( &(pdx->Lock_DmaStats), flags );
+
+    if (pStats != NULL)
     {
-        SizeDescr = 8 * sizeof(U32);
+        *pStats = pdx->DmaInfo[channel].Stats;
     }
-    else
+
+    if (bReset)
     {
-        SizeDescr = 4 * sizeof(U32);
+        RtlZeroMemory(
+            &(pdx->DmaInfo[channel].Stats),
+            sizeof(PLX_DMA_STATS)
+            );
     }
 
-    // Calculate SGL size
-    SglSize = (TotalDescr * SizeDescr) + SizeDescr;
+    spin_unlock_irqrestore( &(pdx->Lock_DmaStats), flags );
+}
 
-    // Check if a previously allocated buffer can be re-used
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa != NULL)
-    {
-        if (pdx->DmaInfo[channel].SglBuffer.Size >= SglSize)
-        {
-            // Buffer can be re-used, do nothing
-            DebugPrintf(("Re-use previously allocated SGL descriptor buffer\n"));
-        }
-        else
-        {
-            DebugPrintf(("Release previously allocated SGL descriptor buffer\n"));
 
-            // Release memory used for SGL descriptors
-            Plx_dma_buffer_free(
-                pdx,
-                &pdx->DmaInfo[channel].SglBuffer
-                );
 
-            pdx->DmaInfo[channel].SglBuffer.pKernelVa = NULL;
-        }
-    }
+#if defined(PLX_DEBUGFS)
 
-    // Allocate memory for SGL descriptors if necessary
-    if (pdx->DmaInfo[channel].SglBuffer.pKernelVa == NULL)
-    {
-        DebugPrintf(("Allocate PCI memory for SGL descriptor buffer...\n"));
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsShow
+ *
+ * Description:  Print the statistics of all DMA channels to a debugfs file
+ *
+ ******************************************************************************/
+static int
+PlxDmaStatsDebugFsShow(
+    struct seq_file *pSeq,
+    void            *pData
+    )
+{
+    U8                channel;
+    U32               bucket;
+    PLX_DMA_STATS     Stats;
+    DEVICE_EXTENSION *pdx;
 
-        // Setup for transfer
-        pdx->DmaInfo[channel].SglBuffer.Size = SglSize;
 
-        VaSgl =
-            (PLX_UINT_PTR)Plx_dma_buffer_alloc(
-                pdx,
-                &pdx->DmaInfo[channel].SglBuffer
-                );
+    pdx = pSeq->private;
 
-        if (VaSgl == 0)
+    for (channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        PlxDmaStatsGet(
+            pdx,
+            channel,
+            &Stats,
+            FALSE
+            );
+
+        seq_printf(pSeq, "Channel %d\n", channel);
+        seq_printf(pSeq, "  Transfers  : %llu\n", (unsigned long long)Stats.Transfers);
+        seq_printf(pSeq, "  Bytes      : %llu\n", (unsigned long long)Stats.Bytes);
+        seq_printf(pSeq, "  Pages      : %llu\n", (unsigned long long)Stats.PagesPinned);
+        seq_printf(pSeq, "  Descriptors: %llu\n", (unsigned long long)Stats.Descriptors);
+        seq_printf(pSeq, "  Errors     : %llu\n", (unsigned long long)Stats.Errors);
+        seq_printf(pSeq, "  Timeouts   : %llu\n", (unsigned long long)Stats.Timeouts);
+        seq_printf(pSeq, "  Latency (ns)      Setup   Hardware     Wakeup\n");
+
+        // Only list buckets holding samples
+        for (bucket = 0; bucket < PLX_DMA_STATS_HIST_BUCKETS; bucket++)
         {
-            DebugPrintf((
-                "ERROR - Unable to allocate %d bytes for %d SGL descriptors\n",
-                pdx->DmaInfo[channel].SglBuffer.Size, TotalDescr
-                ));
-            // Unlock user buffer pages
-            for (i = 0; i < TotalDescr; i++)
+            if ((Stats.Hist_Setup[bucket] == 0) &&
+                (Stats.Hist_Hardware[bucket] == 0) &&
+                (Stats.Hist_Wakeup[bucket] == 0))
             {
-                put_page( pdx->DmaInfo[channel].PageList[i] );
+                continue;
             }
-            kfree( pdx->DmaInfo[channel].PageList );
-            return PLX_STATUS_INSUFFICIENT_RES;
+
+            seq_printf(
+                pSeq,
+                "  %s %10llu %10u %10u %10u\n",
+                (bucket == (PLX_DMA_STATS_HIST_BUCKETS - 1)) ? ">=" : "< ",
+                (unsigned long long)1 <<
+                    ((bucket == (PLX_DMA_STATS_HIST_BUCKETS - 1)) ? (bucket - 1) : bucket),
+                Stats.Hist_Setup[bucket],
+                Stats.Hist_Hardware[bucket],
+                Stats.Hist_Wakeup[bucket]
+                );
         }
     }
-    else
-    {
-        VaSgl = (PLX_UINT_PTR)pdx->DmaInfo[channel].SglBuffer.pKernelVa;
-    }
-
-    // Prepare for build of SGL
-    LocalAddr = pDma->LocalAddr;
 
-    // Get bus physical address of SGL descriptors
-    BusSgl = (U32)pdx->DmaInfo[channel].SglBuffer.BusPhysical;
-
-    // Make sure addresses are aligned on next descriptor boundary
-    VaSgl  = (VaSgl + (SizeDescr - 1)) & ~((PLX_UINT_PTR)SizeDescr - 1);
-    BusSgl = (BusSgl + (SizeDescr - 1)) & ~((PLX_UINT_PTR)SizeDescr - 1);
+    return 0;
+}
 
-    // Store the starting address of the SGL for later return
-    BusSglOriginal = BusSgl;
 
-    DebugPrintf((
-        "Build SGL at %08xh (%d descriptors)\n",
-        BusSglOriginal, TotalDescr
-        ));
 
-    // Store total buffer size
-    pdx->DmaInfo[channel].BufferSize = pDma->ByteCount;
 
-    // Set offset of first page
-    offset = pdx->DmaInfo[channel].InitialOffset;
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsOpen
+ *
+ * Description:  Open the debugfs statistics file
+ *
+ ******************************************************************************/
+static int
+PlxDmaStatsDebugFsOpen(
+    struct inode *inode,
+    struct file  *filp
+    )
+{
+    return single_open(
+        filp,
+        PlxDmaStatsDebugFsShow,
+        inode->i_private
+        );
+}
 
-    // Initialize bytes remaining
-    BytesRemaining = pDma->ByteCount;
 
-    // Build the SGL list
-    for (i = 0; i < TotalDescr; i++)
-    {
-        // Calculate transfer size
-        if (BytesRemaining > (PAGE_SIZE - offset))
-        {
-            BlockSize = PAGE_SIZE - offset;
-        }
-        else
-        {
-            BlockSize = BytesRemaining;
-        }
 
-        // Get bus address of buffer
-        BusAddr =
-            dma_map_page(
-                &(pdx->pPciDevice->dev),
-                pdx->DmaInfo[channel].PageList[i],
-                offset,
-                BlockSize,
-                pdx->DmaInfo[channel].direction
-                );
 
-        // Enable the following to display the parameters of each SGL descriptor
-        if (PLX_DEBUG_DISPLAY_SGL_DESCR)
-        {
-            DebugPrintf((
-                "SGL Desc %02d: PCI=%08llX  Loc=%08X  Size=%X (%dB)\n",
-                i, BusAddr, LocalAddr, BlockSize, BlockSize
-                ));
-        }
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsResetOpen
+ *
+ * Description:  Open the debugfs statistics reset file
+ *
+ ******************************************************************************/
+static int
+PlxDmaStatsDebugFsResetOpen(
+    struct inode *inode,
+    struct file  *filp
+    )
+{
+    filp->private_data = inode->i_private;
 
-        // Write PCI address in descriptor
-        *(((U32*)VaSgl) + SGL_DESC_IDX_PCI_LOW) = PLX_LE_DATA_32( (U32)BusAddr );
+    return 0;
+}
 
-        // Write upper 32-bit of 64-bit PCI address in descriptor
-        if (*pbBits64)
-        {
-            *(((U32*)VaSgl) + SGL_DESC_IDX_PCI_HIGH) =
-                           PLX_LE_DATA_32( (U32)(BusAddr >> 32) );
-        }
 
-        // Write Local address in descriptor
-        *(((U32*)VaSgl) + SGL_DESC_IDX_LOC_ADDR) = PLX_LE_DATA_32( LocalAddr );
 
-        // Write transfer count in descriptor
-        *(((U32*)VaSgl) + SGL_DESC_IDX_COUNT) = PLX_LE_DATA_32( BlockSize );
 
-        // Adjust byte count
-        BytesRemaining -= BlockSize;
+/*******************************************************************************
+ *
+ * Function   :  PlxDmaStatsDebugFsReset
+ *
+ * Description:  Clear the statistics of all DMA channels on any write
+ *
+ ******************************************************************************/
+static ssize_t
+PlxDmaStatsDebugFsReset(
+    struct file       *filp,
+    const char __user *pBuffer,
+    size_t             count,
+    loff_t            *pOffset
+    )
+{
+    U8                channel;
+    DEVICE_EXTENSION *pdx;
 
-        if (BytesRemaining == 0)
-        {
-            // Write the last descriptor
-            *(((U32*)VaSgl) + SGL_DESC_IDX_NEXT_DESC) =
-                PLX_LE_DATA_32(
-                    (bDirLocalToPci << 3) | (1 << 1) | (1 << 0)
-                    );
-        }
-        else
-        {
-            // Calculate address of next descriptor
-            BusSgl += SizeDescr;
 
-            // Write next descriptor address
-            *(((U32*)VaSgl) + SGL_DESC_IDX_NEXT_DESC) =
-                PLX_LE_DATA_32(
-                    BusSgl | (bDirLocalToPci << 3) | (1 << 0)
-                    );
+    pdx = filp->private_data;
 
-            // Adjust Local address
-            if (pdx->DmaInfo[channel].bConstAddrLocal == FALSE)
-            {
-                LocalAddr += BlockSize;
-            }
+    for (channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        PlxDmaStatsGet(
+            pdx,
+            channel,
+            NULL,
+            TRUE
+            );
+    }
 
-            // Adjust virtual address to next descriptor
-            VaSgl += SizeDescr;
+    return count;
+}
 
-            // Clear offset
-            offset = 0;
-        }
-    }
 
-    // Return the physical address of the SGL
-    *pSglAddress = BusSglOriginal;
+static const struct file_operations PlxDmaStatsFops =
+{
+    .owner   = THIS_MODULE,
+    .open    = PlxDmaStatsDebugFsOpen,
+    .read    = seq_read,
+    .llseek  = seq_lseek,
+    .release = single_release,
+};
 
-    return PLX_STATUS_OK;
-}
 
-#endif  // PLX_DMA_SUPPORT
+static const struct file_operations PlxDmaStatsResetFops =
+{
+    .owner   = THIS_MODULE,
+    .open    = PlxDmaStatsDebugFsResetOpen,
+    .write   = PlxDmaStatsDebugFsReset,
+};
 
 
 
 
 /*******************************************************************************
  *
- * Function   :  Plx_dev_mem_to_user_8
+ * Function   :  PlxDmaStatsDebugFsCreate
  *
- * Description:  Copy data from device to a user-mode buffer, 8-bits at a time
+ * Description:  Create the debugfs directory & statistics files of a device
+ *
+ * Note       :  Failure is not fatal, the device just has no debugfs entries
  *
  ******************************************************************************/
-void
-Plx_dev_mem_to_user_8(
-    U8            *VaUser,
-    U8            *VaDev,
-    unsigned long  count
+VOID
+PlxDmaStatsDebugFsCreate(
+    DEVICE_EXTENSION *pdx,
+    struct dentry    *pRoot
     )
 {
-    U8 value;
+    struct dentry *pDir;
 
 
-    while (count)
-    {
-        // Get next value from device
-        value = PHYS_MEM_READ_8( VaDev );
+    pdx->pDebugFsDir = NULL;
 
-        // Copy value to user-buffer
-        __put_user( value, VaUser );
+    if ((pRoot == NULL) || IS_ERR(pRoot))
+    {
+        return;
+    }
 
-        // Increment pointers
-        VaDev++;
-        VaUser++;
+    // Name directory after the PCI location of the device
+    pDir =
+        debugfs_create_dir(
+            pci_name( pdx->pPciDevice ),
+            pRoot
+            );
 
-        // Decrement count
-        count -= sizeof(U8);
+    if ((pDir == NULL) || IS_ERR(pDir))
+    {
+        DebugPrintf(("ERROR - Unable to create debugfs directory\n"));
+        return;
     }
+
+    debugfs_create_file(
+        "dma_stats",
+        S_IRUGO,
+        pDir,
+        pdx,
+        &PlxDmaStatsFops
+        );
+
+    debugfs_create_file(
+        "dma_stats_reset",
+        S_IWUSR,
+        pDir,
+        pdx,
+        &PlxDmaStatsResetFops
+        );
+
+    pdx->pDebugFsDir = pDir;
 }
 
 
@@ -1243,72 +3939,94 @@ Plx_dev_mem_to_user_8(
 
 /*******************************************************************************
  *
- * Function   :  Plx_dev_mem_to_user_16
+ * Function   :  PlxDmaStatsDebugFsRemove
  *
- * Description:  Copy data from device to a user-mode buffer, 16-bits at a time
+ * Description:  Remove the debugfs directory of a device
  *
  ******************************************************************************/
-void
-Plx_dev_mem_to_user_16(
-    U16           *VaUser,
-    U16           *VaDev,
-    unsigned long  count
+VOID
+PlxDmaStatsDebugFsRemove(
+    DEVICE_EXTENSION *pdx
     )
 {
-    U16 value;
-
-
-    while (count)
+    if (pdx->pDebugFsDir != NULL)
     {
-        // Get next value from device
-        value = PHYS_MEM_READ_16( VaDev );
+        debugfs_remove_recursive( pdx->pDebugFsDir );
+        pdx->pDebugFsDir = NULL;
+    }
+}
 
-        // Copy value to user-buffer
-        __put_user( value, VaUser );
+#endif  // PLX_DEBUGFS
 
-        // Increment pointers
-        VaDev++;
-        VaUser++;
 
-        // Decrement count
-        count -= sizeof(U16);
-    }
-}
+#endif  // PLX_DMA_SUPPORT
 
 
 
 
 /*******************************************************************************
  *
- * Function   :  Plx_dev_mem_to_user_32
+ * Function   :  Plx_dev_mem_read_block
  *
- * Description:  Copy data from device to a user-mode buffer, 32-bits at a time
+ * Description:  Read a block of device memory into a kernel buffer
+ *
+ * Note       :  Burst mode lets the CPU pick the access size & may combine
+ *               accesses, so it is only used for prefetchable spaces
  *
  ******************************************************************************/
-void
-Plx_dev_mem_to_user_32(
-    U32           *VaUser,
-    U32           *VaDev,
-    unsigned long  count
+static void
+Plx_dev_mem_read_block(
+    U8              *pBuffer,
+    U8              *VaDev,
+    unsigned long    count,
+    PLX_ACCESS_TYPE  AccessType,
+    BOOLEAN          bBurst
     )
 {
-    U32 value;
+    unsigned long i;
 
 
-    while (count)
+    if (bBurst && ((AccessType == BitSize32) || (AccessType == BitSize64)))
+    {
+        memcpy_fromio( pBuffer, VaDev, count );
+        return;
+    }
+
+    switch (AccessType)
     {
-        // Get next value from device
-        value = PHYS_MEM_READ_32( VaDev );
+        case BitSize8:
+            for (i = 0; i < count; i += sizeof(U8))
+            {
+                *(U8*)(pBuffer + i) = PHYS_MEM_READ_8( VaDev + i );
+            }
+            break;
 
-        // Copy value to user-buffer
-        __put_user( value, VaUser );
+        case BitSize16:
+            for (i = 0; i < count; i += sizeof(U16))
+            {
+                *(U16*)(pBuffer + i) = PHYS_MEM_READ_16( (U16*)(VaDev + i) );
+            }
+            break;
+
+        case BitSize32:
+            for (i = 0; i < count; i += sizeof(U32))
+            {
+                *(U32*)(pBuffer + i) = PHYS_MEM_READ_32( (U32*)(VaDev + i) );
+            }
+            break;
 
-        // Increment pointers
-        VaDev++;
-        VaUser++;
+#if defined(PLX_MMIO_64)
+        case BitSize64:
+            for (i = 0; i < count; i += sizeof(U64))
+            {
+                *(U64*)(pBuffer + i) = PHYS_MEM_READ_64( (U64*)(VaDev + i) );
+            }
+            break;
+#endif
 
-        // Decrement count
-        count -= sizeof(U32);
+        default:
+            // Unsupported sizes are rejected by the caller
+            break;
     }
 }
 
@@ -1317,35 +4035,64 @@ Plx_dev_mem_to_user_32(
 
 /*******************************************************************************
  *
- * Function   :  Plx_user_to_dev_mem_8
+ * Function   :  Plx_dev_mem_write_block
  *
- * Description:  Copy data from a user-mode buffer to device, 16-bits at a time
+ * Description:  Write a kernel buffer to a block of device memory
  *
  ******************************************************************************/
-void
-Plx_user_to_dev_mem_8(
-    U8            *VaDev,
-    U8            *VaUser,
-    unsigned long  count
+static void
+Plx_dev_mem_write_block(
+    U8              *VaDev,
+    U8              *pBuffer,
+    unsigned long    count,
+    PLX_ACCESS_TYPE  AccessType,
+    BOOLEAN          bBurst
     )
 {
-    U8 value;
+    unsigned long i;
 
 
-    while (count)
+    if (bBurst && ((AccessType == BitSize32) || (AccessType == BitSize64)))
+    {
+        memcpy_toio( VaDev, pBuffer, count );
+        return;
+    }
+
+    switch (AccessType)
     {
-        // Get next data from user-buffer
-        __get_user( value, VaUser );
+        case BitSize8:
+            for (i = 0; i < count; i += sizeof(U8))
+            {
+                PHYS_MEM_WRITE_8( VaDev + i, *(U8*)(pBuffer + i) );
+            }
+            break;
+
+        case BitSize16:
+            for (i = 0; i < count; i += sizeof(U16))
+            {
+                PHYS_MEM_WRITE_16( (U16*)(VaDev + i), *(U16*)(pBuffer + i) );
+            }
+            break;
 
-        // Write value to device
-        PHYS_MEM_WRITE_8( VaDev, value );
+        case BitSize32:
+            for (i = 0; i < count; i += sizeof(U32))
+            {
+                PHYS_MEM_WRITE_32( (U32*)(VaDev + i), *(U32*)(pBuffer + i) );
+            }
+            break;
 
-        // Increment pointers
-        VaDev++;
-        VaUser++;
+#if defined(PLX_MMIO_64)
+        case BitSize64:
+            for (i = 0; i < count; i += sizeof(U64))
+            {
+                PHYS_MEM_WRITE_64( (U64*)(VaDev + i), *(U64*)(pBuffer + i) );
+            }
+            break;
+#endif
 
-        // Decrement count
-        count -= sizeof(U8);
+        default:
+            // Unsupported sizes are rejected by the caller
+            break;
     }
 }
 
@@ -1354,36 +4101,55 @@ Plx_user_to_dev_mem_8(
 
 /*******************************************************************************
  *
- * Function   :  Plx_user_to_dev_mem_16
+ * Function   :  Plx_dev_mem_to_user
+ *
+ * Description:  Copy data from device to a user-mode buffer
  *
- * Description:  Copy data from a user-mode buffer to device, 16-bits at a time
+ * Note       :  Data is read a page at a time into a bounce buffer, which is
+ *               then copied to the user buffer with a single user access.
+ *               The caller must own the bounce page.
  *
  ******************************************************************************/
-void
-Plx_user_to_dev_mem_16(
-    U16           *VaDev,
-    U16           *VaUser,
-    unsigned long  count
+PLX_STATUS
+Plx_dev_mem_to_user(
+    U8              *VaUser,
+    U8              *VaDev,
+    unsigned long    count,
+    PLX_ACCESS_TYPE  AccessType,
+    BOOLEAN          bBurst,
+    U8              *pBounce
     )
 {
-    U16 value;
+    unsigned long BytesToCopy;
 
 
     while (count)
     {
-        // Get next data from user-buffer
-        __get_user( value, VaUser );
-
-        // Write value to device
-        PHYS_MEM_WRITE_16( VaDev, value );
+        BytesToCopy = min( count, (unsigned long)PAGE_SIZE );
+
+        // Get next block from device
+        Plx_dev_mem_read_block(
+            pBounce,
+            VaDev,
+            BytesToCopy,
+            AccessType,
+            bBurst
+            );
 
-        // Increment pointers
-        VaDev++;
-        VaUser++;
+        // Copy block to user-buffer
+        if (copy_to_user( VaUser, pBounce, BytesToCopy ) != 0)
+        {
+            DebugPrintf(("ERROR - Unable to copy to user buffer (%p)\n", VaUser));
+            return PLX_STATUS_INVALID_ADDR;
+        }
 
-        // Decrement count
-        count -= sizeof(U16);
+        // Adjust for next block
+        VaDev  += BytesToCopy;
+        VaUser += BytesToCopy;
+        count  -= BytesToCopy;
     }
+
+    return PLX_STATUS_OK;
 }
 
 
@@ -1391,34 +4157,51 @@ Plx_user_to_dev_mem_16(
 
 /*******************************************************************************
  *
- * Function   :  Plx_user_to_dev_mem_32
+ * Function   :  Plx_user_to_dev_mem
+ *
+ * Description:  Copy data from a user-mode buffer to device
  *
- * Description:  Copy data from a user-mode buffer to device, 32-bits at a time
+ * Note       :  The caller must own the bounce page
  *
  ******************************************************************************/
-void
-Plx_user_to_dev_mem_32(
-    U32           *VaDev,
-    U32           *VaUser,
-    unsigned long  count
+PLX_STATUS
+Plx_user_to_dev_mem(
+    U8              *VaDev,
+    U8              *VaUser,
+    unsigned long    count,
+    PLX_ACCESS_TYPE  AccessType,
+    BOOLEAN          bBurst,
+    U8              *pBounce
     )
 {
-    U32 value;
+    unsigned long BytesToCopy;
 
 
     while (count)
     {
-        // Get next data from user-buffer
-        __get_user( value, VaUser );
+        BytesToCopy = min( count, (unsigned long)PAGE_SIZE );
 
-        // Write value to device
-        PHYS_MEM_WRITE_32( VaDev, value );
+        // Get next block from user-buffer
+        if (copy_from_user( pBounce, VaUser, BytesToCopy ) != 0)
+        {
+            DebugPrintf(("ERROR - Unable to copy from user buffer (%p)\n", VaUser));
+            return PLX_STATUS_INVALID_ADDR;
+        }
 
-        // Increment pointers
-        VaDev++;
-        VaUser++;
+        // Write block to device
+        Plx_dev_mem_write_block(
+            VaDev,
+            pBounce,
+            BytesToCopy,
+            AccessType,
+            bBurst
+            );
 
-        // Decrement count
-        count -= sizeof(U32);
+        // Adjust for next block
+        VaDev  += BytesToCopy;
+        VaUser += BytesToCopy;
+        count  -= BytesToCopy;
     }
+
+    return PLX_STATUS_OK;
 }
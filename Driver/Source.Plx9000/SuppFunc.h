@@ -75,6 +75,58 @@ PlxSignalNotifications(
     PLX_INTERRUPT_DATA *pIntData
     );
 
+VOID
+PlxCoalesceFlush(
+    DEVICE_EXTENSION *pdx
+    );
+
+enum hrtimer_restart
+OnCoalesceTimer(
+    struct hrtimer *pTimer
+    );
+
+VOID
+PlxSignalWaitObjects(
+    DEVICE_EXTENSION   *pdx,
+    PLX_INTERRUPT_DATA *pIntData
+    );
+
+PLX_WAIT_OBJECT*
+PlxWaitObjectFind(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pUserWaitObject
+    );
+
+VOID
+PlxWaitObjectLink(
+    DEVICE_EXTENSION *pdx,
+    PLX_WAIT_OBJECT  *pWaitObject
+    );
+
+VOID
+PlxWaitObjectUnlink(
+    DEVICE_EXTENSION *pdx,
+    PLX_WAIT_OBJECT  *pWaitObject
+    );
+
+VOID
+PlxWaitObjectRelease(
+    PLX_WAIT_OBJECT *pWaitObject
+    );
+
+VOID
+PlxIntEventPush(
+    DEVICE_EXTENSION *pdx,
+    U32               Source_Ints,
+    U32               Source_Doorbell
+    );
+
+BOOLEAN
+PlxIntEventPop(
+    DEVICE_EXTENSION   *pdx,
+    PLX_INTERRUPT_DATA *pIntData
+    );
+
 U16
 PlxPciFindCapability(
     DEVICE_EXTENSION *pdx,
@@ -100,6 +152,30 @@ PlxPciPhysicalMemoryFreeAll_ByOwner(
     VOID             *pOwner
     );
 
+PLX_REMAP_WINDOW*
+PlxRemapWindowGet(
+    DEVICE_EXTENSION *pdx,
+    U8                BarIndex
+    );
+
+VOID
+PlxBarSpaceRelease(
+    DEVICE_EXTENSION *pdx
+    );
+
+VOID
+PlxPciBarMapTrack(
+    DEVICE_EXTENSION      *pdx,
+    struct vm_area_struct *vma,
+    U8                     BarIndex
+    );
+
+VOID
+PlxPciBarWindowUnlockAll_ByOwner(
+    DEVICE_EXTENSION *pdx,
+    VOID             *pOwner
+    );
+
 VOID*
 Plx_dma_buffer_alloc(
     DEVICE_EXTENSION    *pdx,
@@ -133,46 +209,193 @@ PlxLockBufferAndBuildSgl(
     BOOLEAN          *pbBits64
     );
 
-void
-Plx_dev_mem_to_user_8(
-    U8            *VaUser,
-    U8            *VaDev,
-    unsigned long  count
+PLX_STATUS
+PlxSglBuild(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_PARAMS   *pDma,
+    BOOLEAN           bConstAddrLocal,
+    U32               SegmentSize,
+    PLX_DMA_SGL      *pSgl,
+    U32              *pSglAddress,
+    BOOLEAN          *pbBits64
+    );
+
+VOID
+PlxSglRelease(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_SGL      *pSgl
+    );
+
+VOID
+PlxSglSync(
+    DEVICE_EXTENSION *pdx,
+    PLX_DMA_SGL      *pSgl,
+    U32               offset,
+    U32               ByteCount,
+    BOOLEAN           bForDevice
+    );
+
+PLX_STATUS
+PlxSglRegBufferStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               offset,
+    U32               ByteCount,
+    U32              *pSglAddress,
+    BOOLEAN          *pbBits64
+    );
+
+VOID
+PlxSglRegBufferDone(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaRegBufferRelease(
+    DEVICE_EXTENSION   *pdx,
+    U8                  channel,
+    PLX_DMA_REG_BUFFER *pRegBuffer
+    );
+
+VOID
+PlxDmaRegBufferReleaseAll(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaQueueFlush(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaQueueReleaseAll(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxSglRingLink(
+    PLX_DMA_SGL *pSgl,
+    U32          SglAddress,
+    U32          SegmentSize,
+    U32         *pDescrSegment
+    );
+
+VOID
+PlxDmaRingService(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaRingRelease(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxSglVectorRelease(
+    DEVICE_EXTENSION    *pdx,
+    PLX_DMA_SGL         *pVector,
+    U32                  count,
+    PLX_PHYS_MEM_OBJECT *pSglBuffer
+    );
+
+VOID
+PlxDmaCompletionSignal(
+    DEVICE_EXTENSION *pdx,
+    U8                channel
+    );
+
+VOID
+PlxDmaCompletionPost(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount,
+    PLX_STATUS        status
+    );
+
+VOID
+PlxDmaCompletionRingMapTrack(
+    DEVICE_EXTENSION      *pdx,
+    struct vm_area_struct *vma,
+    U64                    CpuPhysical,
+    VOID                  *pOwner
+    );
+
+PLX_STATUS
+PlxDmaCompletionWait(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               DoneSeq,
+    PLX_UINT_PTR      Timeout_ms
+    );
+
+VOID
+PlxDmaStatsHistAdd(
+    U32 *pHist,
+    U64  Start_ns,
+    U64  End_ns
+    );
+
+VOID
+PlxDmaStatsStart(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U32               ByteCount
     );
 
-void
-Plx_dev_mem_to_user_16(
-    U16           *VaUser,
-    U16           *VaDev,
-    unsigned long  count
+VOID
+PlxDmaStatsSetup(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    U64               Start_ns,
+    PLX_DMA_SGL      *pSgl,
+    PLX_STATUS        status
     );
 
-void
-Plx_dev_mem_to_user_32(
-    U32           *VaUser,
-    U32           *VaDev,
-    unsigned long  count
+VOID
+PlxDmaStatsGet(
+    DEVICE_EXTENSION *pdx,
+    U8                channel,
+    PLX_DMA_STATS    *pStats,
+    BOOLEAN           bReset
     );
 
-void
-Plx_user_to_dev_mem_8(
-    U8            *VaDev,
-    U8            *VaUser,
-    unsigned long  count
+#if defined(PLX_DEBUGFS)
+VOID
+PlxDmaStatsDebugFsCreate(
+    DEVICE_EXTENSION *pdx,
+    struct dentry    *pRoot
     );
 
-void
-Plx_user_to_dev_mem_16(
-    U16           *VaDev,
-    U16           *VaUser,
-    unsigned long  count
+VOID
+PlxDmaStatsDebugFsRemove(
+    DEVICE_EXTENSION *pdx
     );
+#endif
 
-void
-Plx_user_to_dev_mem_32(
-    U32           *VaDev,
-    U32           *VaUser,
-    unsigned long  count
+PLX_STATUS
+Plx_dev_mem_to_user(
+    U8              *VaUser,
+    U8              *VaDev,
+    unsigned long    count,
+    PLX_ACCESS_TYPE  AccessType,
+    BOOLEAN          bBurst,
+    U8              *pBounce
+    );
+
+PLX_STATUS
+Plx_user_to_dev_mem(
+    U8              *VaDev,
+    U8              *VaUser,
+    unsigned long    count,
+    PLX_ACCESS_TYPE  AccessType,
+    BOOLEAN          bBurst,
+    U8              *pBounce
     );
 
 
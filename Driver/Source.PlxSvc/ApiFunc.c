@@ -51,6 +51,7 @@
 
 #include <linux/types.h>
 #include <linux/slab.h>     // For kmalloc()
+#include <linux/delay.h>    // For udelay()
 #include <linux/uaccess.h>  // For copy_to/from_user()
 #include "ApiFunc.h"
 #include "ChipFunc.h"
@@ -59,6 +60,7 @@
 #include "Eep_8111.h"
 #include "PciFunc.h"
 #include "PciRegs.h"
+#include "PlxRegBatch.h"
 #include "SuppFunc.h"
 
 
@@ -693,6 +695,126 @@ PlxRegisterWrite(
 
 
 
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchRead
+ *
+ * Description:  Register batch accessor to read a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchRead(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32  *pValue
+    )
+{
+    PLX_STATUS       status;
+    PLX_DEVICE_NODE *pdx;
+
+
+    pdx = (PLX_DEVICE_NODE*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterRead_UseOS( &(pdx->Key), (U16)offset, pValue );
+    }
+
+    *pValue =
+        PlxRegisterRead(
+            pdx,
+            offset,
+            &status,
+            (Space == PLX_REG_BATCH_SPACE_PLX)
+            );
+
+    return status;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegBatchWrite
+ *
+ * Description:  Register batch accessor to write a register
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxRegBatchWrite(
+    VOID *pContext,
+    U8    Space,
+    U32   offset,
+    U32   value
+    )
+{
+    PLX_DEVICE_NODE *pdx;
+
+
+    pdx = (PLX_DEVICE_NODE*)pContext;
+
+    if (Space == PLX_REG_BATCH_SPACE_PCI)
+    {
+        return PlxPciRegisterWrite_UseOS( &(pdx->Key), (U16)offset, value );
+    }
+
+    return PlxRegisterWrite(
+        pdx,
+        offset,
+        value,
+        (Space == PLX_REG_BATCH_SPACE_PLX)
+        );
+}
+
+
+
+
+// Register accessors for batch operations
+static const PLX_REG_BATCH_OPS PlxRegBatchOps =
+{
+    .RegRead   = PlxRegBatchRead,
+    .RegWrite  = PlxRegBatchWrite,
+    .RegModify = NULL,              // No ISR to synchronize with
+};
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxRegisterBatch
+ *
+ * Description:  Executes a sequence of register accesses from a user array,
+ *               returning read values in the array
+ *
+ * Note       :  Processing stops at the first failed entry. Batches are
+ *               serialized so that a sequence is not interleaved with
+ *               another batch.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxRegisterBatch(
+    PLX_DEVICE_NODE     *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    )
+{
+    return PlxRegBatchExecute(
+        &PlxRegBatchOps,
+        pdx,
+        &(pdx->pdo->Mutex_RegBatch),
+        pUserEntries,
+        Count,
+        pCountDone
+        );
+}
+
+
+
+
 /*******************************************************************************
  *
  * Function   :  PlxPciBarProperties
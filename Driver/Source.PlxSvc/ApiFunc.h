@@ -108,6 +108,14 @@ PlxRegisterWrite(
     BOOLEAN          bAdjustForPort
     );
 
+PLX_STATUS
+PlxRegisterBatch(
+    PLX_DEVICE_NODE     *pdx,
+    PLX_REG_BATCH_ENTRY *pUserEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    );
+
 PLX_STATUS
 PlxPciBarProperties(
     PLX_DEVICE_NODE  *pdx,
@@ -661,6 +661,24 @@ pIoBuffer->ReturnCode = PLX_STATUS_UNSUPPORTED;
                 ));
             break;
 
+        case PLX_IOCTL_REGISTER_BATCH:
+            DebugPrintf_Cont(("PLX_IOCTL_REGISTER_BATCH\n"));
+
+            if (pdx == NULL)
+            {
+                pIoBuffer->ReturnCode = PLX_STATUS_INVALID_OBJECT;
+                break;
+            }
+
+            pIoBuffer->ReturnCode =
+                PlxRegisterBatch(
+                    pdx,
+                    PLX_INT_TO_PTR(pIoBuffer->u.TxParams.UserVa),
+                    (U32)pIoBuffer->value[0],
+                    PLX_CAST_64_TO_32_PTR( &(pIoBuffer->value[1]) )
+                    );
+            break;
+
 
         /******************************************
          * PCI Mapping Functions
@@ -1013,3 +1031,57 @@ pIoBuffer->ReturnCode = PLX_STATUS_UNSUPPORTED;
 
     return status;
 }
+
+
+
+
+#if defined(PLX_IO_URING)
+/*******************************************************************************
+ *
+ * Function   :  Dispatch_uring_cmd
+ *
+ * Description:  Handle a PLX message submitted through io_uring
+ *
+ * Note       :  The SQE command opcode is the IOCTL code & the command area
+ *               holds the user address of the PLX_PARAMS message.  Messages
+ *               that may sleep are refused in non-blocking context, so
+ *               io_uring re-issues them from a worker thread & a batch of
+ *               waits completes independently of the submitter.
+ *
+ ******************************************************************************/
+int
+Dispatch_uring_cmd(
+    struct io_uring_cmd *ioucmd,
+    unsigned int         issue_flags
+    )
+{
+    const PLX_URING_CMD *pCmd;
+
+
+    pCmd = io_uring_sqe_cmd( ioucmd->sqe );
+
+    // Only register accesses are processed in the submitter's context
+    if (issue_flags & IO_URING_F_NONBLOCK)
+    {
+        switch (ioucmd->cmd_op)
+        {
+            case PLX_IOCTL_PCI_REGISTER_READ:
+            case PLX_IOCTL_PCI_REGISTER_WRITE:
+            case PLX_IOCTL_REGISTER_READ:
+            case PLX_IOCTL_REGISTER_WRITE:
+            case PLX_IOCTL_MAPPED_REGISTER_READ:
+            case PLX_IOCTL_MAPPED_REGISTER_WRITE:
+                break;
+
+            default:
+                return (-EAGAIN);
+        }
+    }
+
+    return Dispatch_IoControl(
+        ioucmd->file,
+        ioucmd->cmd_op,
+        (unsigned long)READ_ONCE(pCmd->pIoBuffer)
+        );
+}
+#endif
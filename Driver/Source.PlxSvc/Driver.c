@@ -139,6 +139,11 @@ Plx_init_module(
     pGbl_DriverObject->DispatchTable.unlocked_ioctl = Dispatch_IoControl;
     pGbl_DriverObject->DispatchTable.compat_ioctl   = Dispatch_IoControl;
 
+#if defined(PLX_IO_URING)
+    // Accept messages submitted through io_uring
+    pGbl_DriverObject->DispatchTable.uring_cmd = Dispatch_uring_cmd;
+#endif
+
     // Initialize spin locks
     spin_lock_init( &(pGbl_DriverObject->Lock_DeviceList) );
 
@@ -317,6 +322,9 @@ AddDevice(
     // Initialize device open mutex
     Plx_sema_init( &(pdx->Mutex_DeviceOpen), 1 );
 
+    // Initialize register batch mutex
+    Plx_sema_init( &(pdx->Mutex_RegBatch), 1 );
+
     // Initialize device list
     INIT_LIST_HEAD(
         &(pdx->List_Devices)
@@ -197,6 +197,7 @@ typedef struct _DEVICE_EXTENSION
     struct _DEVICE_OBJECT *pDeviceObject;          // Device object this extension belongs to
     U8                     OpenCount;              // Count of open connections to the device
     struct semaphore       Mutex_DeviceOpen;       // Mutex for opening/closing the device
+    struct semaphore       Mutex_RegBatch;         // Serializes register batch sequences
     struct list_head       List_Devices;           // List of detected devices
     struct list_head       List_MapParams;         // Stores information about an upcoming mapping request
     spinlock_t             Lock_MapParamsList;     // Spinlock for map parameters list
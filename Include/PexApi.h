@@ -83,6 +83,13 @@ PlxPci_DeviceOpen(
     PLX_DEVICE_OBJECT *pDevice
     );
 
+PLX_STATUS EXPORT
+PlxPci_DeviceOpenEx(
+    PLX_DEVICE_KEY    *pKey,
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                Flags
+    );
+
 PLX_STATUS EXPORT
 PlxPci_DeviceClose(
     PLX_DEVICE_OBJECT *pDevice
@@ -266,6 +273,14 @@ PlxPci_PlxMappedRegisterWrite(
     U32                value
     );
 
+PLX_STATUS EXPORT
+PlxPci_RegisterBatch(
+    PLX_DEVICE_OBJECT   *pDevice,
+    PLX_REG_BATCH_ENTRY *pEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    );
+
 U32 EXPORT
 PlxPci_PlxMailboxRead(
     PLX_DEVICE_OBJECT *pDevice,
@@ -280,6 +295,29 @@ PlxPci_PlxMailboxWrite(
     U32                value
     );
 
+PLX_STATUS EXPORT
+PlxPci_MuQueueInit(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                LocalQueueBase,
+    U32                EntriesPerQueue
+    );
+
+PLX_STATUS EXPORT
+PlxPci_MuInboundPost(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32               *pFrames,
+    U32                Count,
+    U32               *pCountPosted
+    );
+
+PLX_STATUS EXPORT
+PlxPci_MuOutboundDrain(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32               *pFrames,
+    U32                MaxCount,
+    U32               *pCountDrained
+    );
+
 
 /******************************************
  *         PCI Mapping Functions
@@ -348,6 +386,39 @@ PlxPci_PciBarSpaceWrite(
     BOOLEAN            bOffsetAsLocalAddr
     );
 
+PLX_STATUS EXPORT
+PlxPci_PciBarWindowLock(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    U32                LocalAddress
+    );
+
+PLX_STATUS EXPORT
+PlxPci_PciBarWindowUnlock(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex
+    );
+
+PLX_STATUS EXPORT
+PlxPci_BarCopyFromDevice(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    U32                offset,
+    VOID              *pBuffer,
+    U32                ByteCount,
+    PLX_ACCESS_TYPE    AccessType
+    );
+
+PLX_STATUS EXPORT
+PlxPci_BarCopyToDevice(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    U32                offset,
+    VOID              *pBuffer,
+    U32                ByteCount,
+    PLX_ACCESS_TYPE    AccessType
+    );
+
 
 /******************************************
  *       Physical Memory Functions
@@ -438,6 +509,26 @@ PlxPci_NotificationCancel(
     PLX_NOTIFY_OBJECT *pEvent
     );
 
+PLX_STATUS EXPORT
+PlxPci_NotificationBindEventFd(
+    PLX_DEVICE_OBJECT *pDevice,
+    PLX_NOTIFY_OBJECT *pEvent,
+    int                EventFd
+    );
+
+PLX_STATUS EXPORT
+PlxPci_InterruptCoalesceSet(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                MaxEvents,
+    U32                MaxDelay_us
+    );
+
+PLX_STATUS EXPORT
+PlxPci_InterruptEventDropCount(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32               *pDropCount
+    );
+
 
 /******************************************
  *     Serial EEPROM Access Functions
@@ -639,12 +730,167 @@ PlxPci_DmaTransferUserBuffer(
     U64                Timeout_ms
     );
 
+PLX_STATUS EXPORT
+PlxPci_DmaTransferUserBufferV(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U32                count,
+    U64                Timeout_ms
+    );
+
 PLX_STATUS EXPORT
 PlxPci_DmaChannelClose(
     PLX_DEVICE_OBJECT *pDevice,
     U8                 channel
     );
 
+PLX_STATUS EXPORT
+PlxPci_DmaBufferRegister(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U64               *pHandle
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaBufferUnregister(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    U64                Handle
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaTransferRegisteredBuffer(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    U64                Handle,
+    U32                offset,
+    U32                ByteCount,
+    U64                Timeout_ms
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaTransferQueue(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaQueueStatus(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    U32               *pNumPending,
+    U32               *pNumCompleted
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaRingStart(
+    PLX_DEVICE_OBJECT  *pDevice,
+    U8                  channel,
+    PLX_DMA_PARAMS     *pDmaParams,
+    U32                 SegmentSize,
+    PLX_DMA_RING_CTRL **ppRingCtrl
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaRingStop(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_RING_CTRL *pRingCtrl
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaCompletionRingCreate(
+    PLX_DEVICE_OBJECT        *pDevice,
+    PLX_DMA_COMPLETION_RING **ppRing
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaCompletionRingDestroy(
+    PLX_DEVICE_OBJECT       *pDevice,
+    PLX_DMA_COMPLETION_RING *pRing
+    );
+
+U32 EXPORT
+PlxPci_DmaCompletionRingDrain(
+    PLX_DMA_COMPLETION_RING *pRing,
+    PLX_DMA_COMPLETION      *pRecords,
+    U32                      MaxRecords
+    );
+
+PLX_STATUS EXPORT
+PlxPci_DmaGetStatistics(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_STATS     *pStats,
+    BOOLEAN            bReset
+    );
+
+
+/******************************************
+ *   Asynchronous Request Functions
+ *****************************************/
+PLX_STATUS EXPORT
+PlxPci_AsyncQueueCreate(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                Depth,
+    PLX_ASYNC_QUEUE   *pQueue
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncQueueDestroy(
+    PLX_ASYNC_QUEUE *pQueue
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncPlxRegisterRead(
+    PLX_ASYNC_QUEUE   *pQueue,
+    U32                offset,
+    PLX_ASYNC_REQUEST *pRequest
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncPlxRegisterWrite(
+    PLX_ASYNC_QUEUE   *pQueue,
+    U32                offset,
+    U32                value,
+    PLX_ASYNC_REQUEST *pRequest
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncDmaTransferUserBuffer(
+    PLX_ASYNC_QUEUE   *pQueue,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U64                Timeout_ms,
+    PLX_ASYNC_REQUEST *pRequest
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncNotificationWait(
+    PLX_ASYNC_QUEUE   *pQueue,
+    PLX_NOTIFY_OBJECT *pEvent,
+    U64                Timeout_ms,
+    PLX_ASYNC_REQUEST *pRequest
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncSubmit(
+    PLX_ASYNC_QUEUE *pQueue,
+    U32             *pCountSubmitted
+    );
+
+PLX_STATUS EXPORT
+PlxPci_AsyncComplete(
+    PLX_ASYNC_QUEUE    *pQueue,
+    PLX_ASYNC_REQUEST **ppCompleted,
+    U32                 MaxCount,
+    BOOLEAN             bWait,
+    U32                *pCountCompleted
+    );
+
 
 /******************************************
  *   Performance Monitoring Functions
@@ -96,6 +96,14 @@ typedef struct _PLX_PARAMS
 } PLX_PARAMS;
 
 
+// Command area of an io_uring SQE carrying a PLX message (Linux only)
+typedef struct _PLX_URING_CMD
+{
+    U64 pIoBuffer;                  // User address of the PLX_PARAMS message
+    U64 Reserved;
+} PLX_URING_CMD;
+
+
 #if defined(PLX_MSWINDOWS)
     /**********************************************************
      * Note: Codes 0-2047 (0-7FFh) are reserved by Microsoft
@@ -195,7 +203,29 @@ typedef enum _DRIVER_MSGS
     MSG_NT_PROBE_REQ_ID,
     MSG_NT_LUT_PROPERTIES,
     MSG_NT_LUT_ADD,
-    MSG_NT_LUT_DISABLE
+    MSG_NT_LUT_DISABLE,
+    MSG_DMA_BUFFER_REGISTER,
+    MSG_DMA_BUFFER_UNREGISTER,
+    MSG_DMA_TRANSFER_REG_BUFFER,
+    MSG_DMA_TRANSFER_QUEUE,
+    MSG_DMA_QUEUE_STATUS,
+    MSG_DMA_TRANSFER_WAIT,
+    MSG_DMA_RING_START,
+    MSG_DMA_RING_STOP,
+    MSG_DMA_COMPLETION_RING_CREATE,
+    MSG_DMA_COMPLETION_RING_DESTROY,
+    MSG_DMA_TRANSFER_VECTOR,
+    MSG_DMA_WAIT_DONE,
+    MSG_INTR_EVENT_DROP_COUNT,
+    MSG_NOTIFICATION_EVENTFD_BIND,
+    MSG_INTR_COALESCE_SET,
+    MSG_MU_QUEUE_INIT,
+    MSG_MU_INBOUND_POST,
+    MSG_MU_OUTBOUND_DRAIN,
+    MSG_DMA_GET_STATISTICS,
+    MSG_REGISTER_BATCH,
+    MSG_PCI_BAR_WINDOW_LOCK,
+    MSG_PCI_BAR_WINDOW_UNLOCK
 } DRIVER_MSGS;
 
 
@@ -223,6 +253,7 @@ typedef enum _DRIVER_MSGS
 #define PLX_IOCTL_REGISTER_WRITE                IOCTL_MSG( MSG_REGISTER_WRITE )
 #define PLX_IOCTL_MAPPED_REGISTER_READ          IOCTL_MSG( MSG_MAPPED_REGISTER_READ )
 #define PLX_IOCTL_MAPPED_REGISTER_WRITE         IOCTL_MSG( MSG_MAPPED_REGISTER_WRITE )
+#define PLX_IOCTL_REGISTER_BATCH                IOCTL_MSG( MSG_REGISTER_BATCH )
 #define PLX_IOCTL_MAILBOX_READ                  IOCTL_MSG( MSG_MAILBOX_READ )
 #define PLX_IOCTL_MAILBOX_WRITE                 IOCTL_MSG( MSG_MAILBOX_WRITE )
 
@@ -236,6 +267,8 @@ typedef enum _DRIVER_MSGS
 #define PLX_IOCTL_IO_PORT_WRITE                 IOCTL_MSG( MSG_IO_PORT_WRITE )
 #define PLX_IOCTL_PCI_BAR_SPACE_READ            IOCTL_MSG( MSG_PCI_BAR_SPACE_READ )
 #define PLX_IOCTL_PCI_BAR_SPACE_WRITE           IOCTL_MSG( MSG_PCI_BAR_SPACE_WRITE )
+#define PLX_IOCTL_PCI_BAR_WINDOW_LOCK           IOCTL_MSG( MSG_PCI_BAR_WINDOW_LOCK )
+#define PLX_IOCTL_PCI_BAR_WINDOW_UNLOCK         IOCTL_MSG( MSG_PCI_BAR_WINDOW_UNLOCK )
 
 #define PLX_IOCTL_VPD_READ                      IOCTL_MSG( MSG_VPD_READ )
 #define PLX_IOCTL_VPD_WRITE                     IOCTL_MSG( MSG_VPD_WRITE )
@@ -258,6 +291,12 @@ typedef enum _DRIVER_MSGS
 #define PLX_IOCTL_NOTIFICATION_CANCEL           IOCTL_MSG( MSG_NOTIFICATION_CANCEL )
 #define PLX_IOCTL_NOTIFICATION_WAIT             IOCTL_MSG( MSG_NOTIFICATION_WAIT )
 #define PLX_IOCTL_NOTIFICATION_STATUS           IOCTL_MSG( MSG_NOTIFICATION_STATUS )
+#define PLX_IOCTL_INTR_EVENT_DROP_COUNT         IOCTL_MSG( MSG_INTR_EVENT_DROP_COUNT )
+#define PLX_IOCTL_NOTIFICATION_EVENTFD_BIND     IOCTL_MSG( MSG_NOTIFICATION_EVENTFD_BIND )
+#define PLX_IOCTL_INTR_COALESCE_SET             IOCTL_MSG( MSG_INTR_COALESCE_SET )
+#define PLX_IOCTL_MU_QUEUE_INIT                 IOCTL_MSG( MSG_MU_QUEUE_INIT )
+#define PLX_IOCTL_MU_INBOUND_POST               IOCTL_MSG( MSG_MU_INBOUND_POST )
+#define PLX_IOCTL_MU_OUTBOUND_DRAIN             IOCTL_MSG( MSG_MU_OUTBOUND_DRAIN )
 
 #define PLX_IOCTL_DMA_CHANNEL_OPEN              IOCTL_MSG( MSG_DMA_CHANNEL_OPEN )
 #define PLX_IOCTL_DMA_GET_PROPERTIES            IOCTL_MSG( MSG_DMA_GET_PROPERTIES )
@@ -267,6 +306,19 @@ typedef enum _DRIVER_MSGS
 #define PLX_IOCTL_DMA_TRANSFER_BLOCK            IOCTL_MSG( MSG_DMA_TRANSFER_BLOCK )
 #define PLX_IOCTL_DMA_TRANSFER_USER_BUFFER      IOCTL_MSG( MSG_DMA_TRANSFER_USER_BUFFER )
 #define PLX_IOCTL_DMA_CHANNEL_CLOSE             IOCTL_MSG( MSG_DMA_CHANNEL_CLOSE )
+#define PLX_IOCTL_DMA_BUFFER_REGISTER           IOCTL_MSG( MSG_DMA_BUFFER_REGISTER )
+#define PLX_IOCTL_DMA_BUFFER_UNREGISTER         IOCTL_MSG( MSG_DMA_BUFFER_UNREGISTER )
+#define PLX_IOCTL_DMA_TRANSFER_REG_BUFFER       IOCTL_MSG( MSG_DMA_TRANSFER_REG_BUFFER )
+#define PLX_IOCTL_DMA_TRANSFER_QUEUE            IOCTL_MSG( MSG_DMA_TRANSFER_QUEUE )
+#define PLX_IOCTL_DMA_QUEUE_STATUS              IOCTL_MSG( MSG_DMA_QUEUE_STATUS )
+#define PLX_IOCTL_DMA_TRANSFER_WAIT             IOCTL_MSG( MSG_DMA_TRANSFER_WAIT )
+#define PLX_IOCTL_DMA_RING_START                IOCTL_MSG( MSG_DMA_RING_START )
+#define PLX_IOCTL_DMA_RING_STOP                 IOCTL_MSG( MSG_DMA_RING_STOP )
+#define PLX_IOCTL_DMA_COMPLETION_RING_CREATE    IOCTL_MSG( MSG_DMA_COMPLETION_RING_CREATE )
+#define PLX_IOCTL_DMA_COMPLETION_RING_DESTROY   IOCTL_MSG( MSG_DMA_COMPLETION_RING_DESTROY )
+#define PLX_IOCTL_DMA_TRANSFER_VECTOR           IOCTL_MSG( MSG_DMA_TRANSFER_VECTOR )
+#define PLX_IOCTL_DMA_WAIT_DONE                 IOCTL_MSG( MSG_DMA_WAIT_DONE )
+#define PLX_IOCTL_DMA_GET_STATISTICS            IOCTL_MSG( MSG_DMA_GET_STATISTICS )
 
 #define PLX_IOCTL_PERFORMANCE_INIT_PROPERTIES   IOCTL_MSG( MSG_PERFORMANCE_INIT_PROPERTIES )
 #define PLX_IOCTL_PERFORMANCE_MONITOR_CTRL      IOCTL_MSG( MSG_PERFORMANCE_MONITOR_CTRL )
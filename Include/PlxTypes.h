@@ -896,9 +896,15 @@ typedef struct _PLX_DEVICE_OBJECT
     U8                BarMapRef[6];  // BAR map count used by API
     PLX_PHYSICAL_MEM  CommonBuffer;  // Used to store common buffer information
     U64               PrivateData[4];// Private storage for user application
+    U32               OpenFlags;     // -- INTERNAL -- Options selected when device opened
+    U64               DmaPollVa;     // -- INTERNAL -- Read-only DMA status mapping for polled transfers
 } PLX_DEVICE_OBJECT;
 
 
+// Options for PlxPci_DeviceOpenEx()
+#define PLX_OPEN_FLAG_FAST_REGISTER       (1 << 0)  // Access registers through a BAR 0 mapping
+
+
 // PLX Notification Object
 typedef struct _PLX_NOTIFY_OBJECT
 {
@@ -999,9 +1005,124 @@ typedef struct _PLX_DMA_PARAMS
     U8  bConstAddrDest  :1;         // Constant destination PCI address? (8000 DMA)
     U8  bForceFlush     :1;         // Force DMA to flush write on final descriptor (8000 DMA)
     U8  bIgnoreBlockInt :1;         // For block mode only, do not enable DMA done interrupt
+    U8  bStriped        :1;         // For user buffers, split transfer across both DMA channels (9000 DMA)
+    U8  bPolled         :1;         // For block mode only, API polls DMA done bit before waiting on interrupt (9000 DMA)
 } PLX_DMA_PARAMS;
 
 
+// DMA streaming ring control page, shared between driver & application (9000 DMA)
+typedef struct _PLX_DMA_RING_CTRL
+{
+    volatile U32 ProducerIndex;     // Total segments filled by DMA (updated by driver)
+    volatile U32 ConsumerIndex;     // Total segments released by application
+    volatile U32 OverrunCount;      // Number of segments overwritten before release
+    U32          NumSegments;       // Number of segments in the ring
+    U32          SegmentSize;       // Size of each segment in bytes
+} PLX_DMA_RING_CTRL;
+
+
+// Number of records in a DMA completion ring (must be a power of 2)
+#define PLX_DMA_COMPLETION_RING_SIZE    128
+
+// DMA completion record
+typedef struct _PLX_DMA_COMPLETION
+{
+    U64 Timestamp_ns;               // Time of completion in ns (monotonic clock)
+    U32 ByteCount;                  // Number of bytes transferred
+    U32 Status;                     // Completion status (PLX_STATUS code)
+    U8  Channel;                    // DMA channel
+    U8  Reserved[7];
+} PLX_DMA_COMPLETION;
+
+
+// DMA completion ring, shared between driver & application
+typedef struct _PLX_DMA_COMPLETION_RING
+{
+    volatile U32       Head;        // Total records posted (updated by driver)
+    volatile U32       Tail;        // Total records drained by application
+    volatile U32       DropCount;   // Records dropped because ring was full
+    U32                NumEntries;  // Number of records in ring
+    PLX_DMA_COMPLETION Entry[PLX_DMA_COMPLETION_RING_SIZE];
+} PLX_DMA_COMPLETION_RING;
+
+
+// Number of log2 latency histogram buckets (bucket N counts [2^(N-1), 2^N) ns)
+#define PLX_DMA_STATS_HIST_BUCKETS      32
+
+// DMA channel statistics
+typedef struct _PLX_DMA_STATS
+{
+    U64 Transfers;                  // Number of DMA transfers started
+    U64 Bytes;                      // Number of bytes in transfers started
+    U64 PagesPinned;                // Number of user pages locked for SGLs
+    U64 Descriptors;                // Number of SGL descriptors built
+    U64 Errors;                     // Number of failed SGL builds & transfers
+    U64 Timeouts;                   // Number of completion waits that timed out
+    U32 Hist_Setup[PLX_DMA_STATS_HIST_BUCKETS];      // Buffer lock & SGL build time
+    U32 Hist_Hardware[PLX_DMA_STATS_HIST_BUCKETS];   // DMA start to DMA done interrupt
+    U32 Hist_Wakeup[PLX_DMA_STATS_HIST_BUCKETS];     // DMA done interrupt to waiter wakeup
+} PLX_DMA_STATS;
+
+
+// Asynchronous API request
+typedef struct _PLX_ASYNC_REQUEST
+{
+    U64        UserTag;             // Caller-defined value, returned unchanged
+    PLX_STATUS Status;              // Completion status of the request
+    U32        Value;               // Value returned by read requests
+    U32        Slot;                // -- INTERNAL -- Message slot used in queue
+    U32        Type;                // -- INTERNAL -- Type of request
+} PLX_ASYNC_REQUEST;
+
+
+// Asynchronous API request queue (Linux io_uring)
+typedef struct _PLX_ASYNC_QUEUE
+{
+    U32                IsValidTag;  // Magic number to determine validity
+    PLX_DEVICE_OBJECT *pDevice;     // Device the requests are sent to
+    U32                Depth;       // Max requests prepared or in flight
+    U32                Prepared;    // Requests prepared but not yet submitted
+    U32                InFlight;    // Requests submitted but not yet completed
+    VOID              *pPrivate;    // -- INTERNAL -- Ring mappings & message slots
+} PLX_ASYNC_QUEUE;
+
+
+// Register batch limits
+#define PLX_REG_BATCH_MAX_ENTRIES       4096        // Max entries in a single batch
+#define PLX_REG_BATCH_MAX_DELAY_US      1000000     // Max total of entry delays in a single batch
+
+
+// Register batch operations
+typedef enum _PLX_REG_BATCH_OP
+{
+    PLX_REG_BATCH_READ,
+    PLX_REG_BATCH_WRITE,
+    PLX_REG_BATCH_DELAY             // Only delay, no register access
+} PLX_REG_BATCH_OP;
+
+
+// Register spaces for batch operations
+typedef enum _PLX_REG_BATCH_SPACE
+{
+    PLX_REG_BATCH_SPACE_PCI,        // PCI configuration register
+    PLX_REG_BATCH_SPACE_PLX,        // PLX-specific register
+    PLX_REG_BATCH_SPACE_MAPPED      // PLX register mapped from upstream port BAR 0
+} PLX_REG_BATCH_SPACE;
+
+
+// Register batch entry
+typedef struct _PLX_REG_BATCH_ENTRY
+{
+    U8  Op;                         // Operation (PLX_REG_BATCH_OP)
+    U8  Space;                      // Register space (PLX_REG_BATCH_SPACE)
+    U16 Reserved;
+    U32 offset;                     // Register offset
+    U32 value;                      // Value to write or value read
+    U32 mask;                       // Bits to write or return (0 = all bits)
+    U32 Delay_us;                   // Delay after the operation
+} PLX_REG_BATCH_ENTRY;
+
+
 // Performance properties
 typedef struct _PLX_PERF_PROP
 {
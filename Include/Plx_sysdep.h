@@ -131,6 +131,180 @@
 
 
 
+/***********************************************************
+ * TRACE_EVENT
+ *
+ * Static trace events, used by PLX drivers for low-cost
+ * tracing of the interrupt & DMA paths, were added in
+ * 2.6.31 & stabilized in 2.6.32.  On older kernels, the
+ * driver trace calls compile to nothing.
+ **********************************************************/
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,32))
+    #define PLX_TRACEPOINTS
+#endif
+
+
+
+
+/***********************************************************
+ * debugfs_remove_recursive
+ *
+ * PLX drivers export per-device statistics through debugfs
+ * when the kernel is built with it.  Recursive removal of a
+ * device directory was added in 2.6.27.  Later kernels
+ * return an error pointer instead of NULL on failure, which
+ * the recursive removal accepts in either form.
+ **********************************************************/
+#if defined(CONFIG_DEBUG_FS) && (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,27))
+    #define PLX_DEBUGFS
+#endif
+
+
+
+
+/***********************************************************
+ * file_operations.uring_cmd
+ *
+ * Driver-specific io_uring commands were added in 5.19.
+ * The SQE command accessor was added in 6.4 & the command
+ * definitions moved to io_uring/cmd.h in 6.7.  PLX drivers
+ * accept io_uring commands on 6.7 & later kernels only.
+ **********************************************************/
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6,7,0))
+    #define PLX_IO_URING
+#endif
+
+
+
+
+/***********************************************************
+ * request_threaded_irq & irq_set_affinity_hint
+ *
+ * Threaded interrupt handlers were added in 2.6.30. When
+ * available, PLX drivers run the DPC in a dedicated real-time
+ * IRQ thread instead of the shared system work queue.  The
+ * affinity hint, used to pin the IRQ & its thread to a CPU,
+ * was added in 2.6.35.
+ **********************************************************/
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,30))
+    #define PLX_THREADED_IRQ
+#endif
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(2,6,35))
+    #define Plx_irq_set_affinity_hint(irq, mask)     (0)
+#else
+    #define Plx_irq_set_affinity_hint                irq_set_affinity_hint
+#endif
+
+
+
+
+/***********************************************************
+ * smp_load_acquire & smp_store_release
+ *
+ * Used to publish indices of lockless single producer/consumer
+ * queues.  The functions were added in 3.14, so older kernels
+ * use a full memory barrier instead.
+ **********************************************************/
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(3,14,0))
+    #define smp_load_acquire(p)                                         \
+        ({                                                              \
+            typeof(*(p)) ___v = ACCESS_ONCE( *(p) );                    \
+            smp_mb();                                                   \
+            ___v;                                                       \
+        })
+
+    #define smp_store_release(p, v)                                     \
+        do                                                              \
+        {                                                               \
+            smp_mb();                                                   \
+            ACCESS_ONCE( *(p) ) = (v);                                  \
+        }                                                               \
+        while (0)
+#endif
+
+
+
+
+/***********************************************************
+ * eventfd_signal & __poll_t
+ *
+ * Notification objects may be bound to a user eventfd, which
+ * drivers can signal starting with 2.6.31.  In 6.8, the count
+ * parameter of eventfd_signal() was removed.  The __poll_t
+ * type returned by the poll() handler was added in 4.16.
+ **********************************************************/
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,31))
+    #define PLX_EVENTFD_SUPPORT
+#endif
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6,8,0))
+    #define Plx_eventfd_signal(ctx)                  eventfd_signal( (ctx), 1 )
+#else
+    #define Plx_eventfd_signal(ctx)                  eventfd_signal( (ctx) )
+#endif
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4,16,0))
+    #define __poll_t                                 unsigned int
+#endif
+
+
+
+
+/***********************************************************
+ * idr_alloc & kmem_cache_create
+ *
+ * idr_preload/idr_alloc replaced idr_pre_get/idr_get_new_above
+ * in 3.9.  Plx_idr_alloc() must be called between preload &
+ * preload_end, and returns the new ID or a negative error.
+ * The destructor parameter of kmem_cache_create() was removed
+ * in 2.6.23.
+ **********************************************************/
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(3,9,0))
+    #define Plx_idr_preload(idr, gfp)                idr_pre_get( (idr), (gfp) )
+    #define Plx_idr_preload_end()
+    #define Plx_idr_alloc(idr, ptr, start)                              \
+        ({                                                              \
+            int _id;                                                    \
+            (idr_get_new_above( (idr), (ptr), (start), &_id ) == 0) ?   \
+                _id : -ENOMEM;                                          \
+        })
+#else
+    #define Plx_idr_preload(idr, gfp)                idr_preload( (gfp) )
+    #define Plx_idr_preload_end()                    idr_preload_end()
+    #define Plx_idr_alloc(idr, ptr, start)           idr_alloc( (idr), (ptr), (start), 0, GFP_NOWAIT )
+#endif
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(2,6,23))
+    #define Plx_kmem_cache_create(name, size)        kmem_cache_create( (name), (size), 0, 0, NULL, NULL )
+#else
+    #define Plx_kmem_cache_create(name, size)        kmem_cache_create( (name), (size), 0, 0, NULL )
+#endif
+
+
+
+
+/***********************************************************
+ * hrtimer_setup
+ *
+ * Starting with 6.13, hrtimer_setup() initializes a timer &
+ * its callback together, replacing hrtimer_init().
+ **********************************************************/
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6,13,0))
+    #define Plx_hrtimer_setup(timer, fn, clock, mode)              \
+        do                                                         \
+        {                                                          \
+            hrtimer_init( (timer), (clock), (mode) );              \
+            (timer)->function = (fn);                              \
+        }                                                          \
+        while (0)
+#else
+    #define Plx_hrtimer_setup                        hrtimer_setup
+#endif
+
+
+
+
 /***********************************************************
  * ioremap_prot
  *
@@ -288,6 +462,70 @@
 
 
 
+/***********************************************************
+ * Multiple-message MSI
+ *
+ * Allocating a block of MSI vectors was added in 2.6.30 with
+ * pci_enable_msi_block, replaced by pci_enable_msi_range in
+ * 3.14, then by pci_alloc_irq_vectors in 4.8.  PLX drivers
+ * only use a vector block with threaded IRQs, which were
+ * also added in 2.6.30.  Plx_pci_enable_msi_block returns 0
+ * only if exactly 'nvec' vectors were allocated.
+ **********************************************************/
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(2,6,30))
+    #define PLX_MULTI_MSI
+#endif
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(2,6,30))
+
+    #define Plx_pci_enable_msi_block(pdev,nvec)    (-EINVAL)
+    #define Plx_pci_irq_vector(pdev,idx)           ((pdev)->irq)
+
+#elif (LINUX_VERSION_CODE < KERNEL_VERSION(3,14,0))
+
+    #define Plx_pci_enable_msi_block               pci_enable_msi_block
+    #define Plx_pci_irq_vector(pdev,idx)           ((pdev)->irq + (idx))
+
+#elif (LINUX_VERSION_CODE < KERNEL_VERSION(4,8,0))
+
+    #define Plx_pci_enable_msi_block(pdev,nvec)                          \
+        ({                                                               \
+            int _rc;                                                     \
+                                                                         \
+            _rc = pci_enable_msi_range( (pdev), (nvec), (nvec) );        \
+            if (_rc == (nvec))                                           \
+                _rc = 0;                                                 \
+            else if (_rc >= 0)                                           \
+                _rc = -ENOSPC;                                           \
+                                                                         \
+            _rc;                                                         \
+        })
+
+    #define Plx_pci_irq_vector(pdev,idx)           ((pdev)->irq + (idx))
+
+#else
+
+    #define Plx_pci_enable_msi_block(pdev,nvec)                          \
+        ({                                                               \
+            int _rc;                                                     \
+                                                                         \
+            _rc = pci_alloc_irq_vectors(                                 \
+                      (pdev), (nvec), (nvec), PCI_IRQ_MSI );             \
+            if (_rc == (nvec))                                           \
+                _rc = 0;                                                 \
+            else if (_rc >= 0)                                           \
+                _rc = -ENOSPC;                                           \
+                                                                         \
+            _rc;                                                         \
+        })
+
+    #define Plx_pci_irq_vector                     pci_irq_vector
+
+#endif
+
+
+
+
 /***********************************************************
  * kmap_atomic/kunmap_atomic - 2nd parameter removed in 2.6.37
  **********************************************************/
@@ -392,8 +630,9 @@
  * I/O memory.  They are not defined for all architectures.
  * For x86 32-bit, they were added in 2.6.29.
  *
- * NOTE: This is still incomplete for non-x86 32-bit architectures
- *       where readq/writeq are not yet defined.
+ * PLX_MMIO_64 is defined where 64-bit I/O memory accesses
+ * are available.  Otherwise, 64-bit accesses are rejected
+ * rather than split or truncated to 32 bits.
  **********************************************************/
 #if ((LINUX_VERSION_CODE < KERNEL_VERSION(2,6,29)) && defined(CONFIG_X86_32))
     // x86 64-bit I/O access functions
@@ -414,10 +653,9 @@
         writel(val >> 32, addr+4);
     }
 
-#elif !defined(CONFIG_64BIT) && !defined(CONFIG_X86_32)
-    // Revert to 32-bit accesses for non-x86/x64 platforms
-    #define readq                   readl
-    #define writeq                  writel
+    #define PLX_MMIO_64
+#elif defined(CONFIG_64BIT) || defined(CONFIG_X86_32) || defined(readq)
+    #define PLX_MMIO_64
 #endif
 
 
@@ -73,6 +73,7 @@
 
 #if defined(PLX_LINUX)
     #include <sys/mman.h>
+    #include <time.h>
 #endif
 
 #if defined(PLX_DOS)
@@ -101,6 +102,13 @@
  *               Definitions
  *********************************************/
 #define PLX_SVC_DRIVER_NAME             "PlxSvc"            // PLX PCI Service driver name
+#define PLX_9000_DMA_CMD_STAT           0xA8                // 9000 DMA command/status register offset
+#define PLX_9000_MAILBOX_0              0x78                // 9000 mailbox 0 & 1 register offset
+#define PLX_9000_MAILBOX_2              0x48                // 9000 mailbox 2-7 register offset
+#define PLX_9000_MAILBOX_ALIAS          0x40                // 9000 mailbox 0 & 1 alias register offset
+#define PLX_9000_DOORBELL_TO_LOCAL      0x60                // 9000 PCI-to-local doorbell register offset
+#define PLX_9000_DOORBELL_TO_PCI        0x64                // 9000 local-to-PCI doorbell register offset
+#define PLX_DMA_POLL_SPIN_NS            50000               // Max time to poll for DMA done before waiting on interrupt
 
 
 #if defined(PLX_MSWINDOWS)
@@ -233,6 +241,45 @@ PlxIoMessage(
     VOID              *pBuffer
     );
 
+static PLX_STATUS
+PlxDmaTransferAndWait(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    BOOLEAN            bUserBuffer,
+    U64                Timeout_ms
+    );
+
+static PLX_STATUS
+PlxDmaTransferPolled(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U64                Timeout_ms
+    );
+
+static U32
+PlxMailboxOffset(
+    PLX_DEVICE_OBJECT *pDevice,
+    U16                mailbox
+    );
+
+static volatile U32*
+PlxRegisterDirectVa(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                offset,
+    BOOLEAN            bWrite
+    );
+
+#if defined(PLX_LINUX)
+static BOOLEAN
+PlxDmaPollDone(
+    volatile U32 *pDmaStat,
+    U32           DoneMask,
+    U64           Limit_ns
+    );
+#endif
+
 
 
 
@@ -314,7 +361,38 @@ PlxPci_DeviceOpen(
     PLX_DEVICE_OBJECT *pDevice
     )
 {
-    PLX_STATUS status;
+    return PlxPci_DeviceOpenEx(
+        pKey,
+        pDevice,
+        0           // No options
+        );
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DeviceOpenEx
+ *
+ * Description:  Selects a device with additional options
+ *
+ * Note       :  With PLX_OPEN_FLAG_FAST_REGISTER, register reads and
+ *               mailbox & doorbell writes of 9000 & 8311 devices go through
+ *               a user mapping of BAR 0 instead of a driver request.  If the
+ *               mapping is not possible, the device is opened with driver
+ *               access.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DeviceOpenEx(
+    PLX_DEVICE_KEY    *pKey,
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                Flags
+    )
+{
+    VOID       *pRegVa;
+    PLX_STATUS  status;
 
 
     if ((pDevice == NULL) || (pKey == NULL))
@@ -386,6 +464,28 @@ PlxPci_DeviceOpen(
     // Mark object as valid
     ObjectValidate( pDevice );
 
+    // Map registers for direct access if requested
+    if ((Flags & PLX_OPEN_FLAG_FAST_REGISTER) &&
+        (pDevice->Key.PlxFamily == PLX_FAMILY_BRIDGE_P2L) &&
+        (strcmp(
+            PlxDrivers[pDevice->Key.ApiIndex],
+            PLX_SVC_DRIVER_NAME
+            ) != 0))
+    {
+        if (PlxPci_PciBarMap(
+                pDevice,
+                0,
+                &pRegVa
+                ) == PLX_STATUS_OK)
+        {
+            pDevice->OpenFlags |= PLX_OPEN_FLAG_FAST_REGISTER;
+        }
+        else
+        {
+            DebugPrintf(("Unable to map registers, fast register access disabled\n"));
+        }
+    }
+
     return PLX_STATUS_OK;
 }
 
@@ -404,6 +504,9 @@ PlxPci_DeviceClose(
     PLX_DEVICE_OBJECT *pDevice
     )
 {
+    VOID *pRegVa;
+
+
     if (pDevice == NULL)
     {
         return PLX_STATUS_NULL_PARAM;
@@ -430,6 +533,28 @@ PlxPci_DeviceClose(
     }
     else
     {
+        // Release register mapping
+        if (pDevice->OpenFlags & PLX_OPEN_FLAG_FAST_REGISTER)
+        {
+            pRegVa = PLX_INT_TO_PTR(pDevice->PciBarVa[0]);
+
+            PlxPci_PciBarUnmap(
+                pDevice,
+                &pRegVa
+                );
+        }
+
+        // Release DMA status mapping created by polled transfers
+        if (pDevice->DmaPollVa != 0)
+        {
+            munmap(
+                PLX_INT_TO_PTR(pDevice->DmaPollVa & PAGE_MASK),
+                getpagesize()
+                );
+
+            pDevice->DmaPollVa = 0;
+        }
+
         // Close the handle
         Driver_Disconnect( pDevice->hDevice );
     }
@@ -2465,7 +2590,8 @@ PlxPci_PlxRegisterRead(
     PLX_STATUS        *pStatus
     )
 {
-    PLX_PARAMS IoBuffer;
+    PLX_PARAMS    IoBuffer;
+    volatile U32 *pRegister;
 
 
     // Verify device object
@@ -2488,6 +2614,17 @@ PlxPci_PlxRegisterRead(
         return PCI_CFG_RD_ERR_VAL_32;
     }
 
+    // Read directly from register mapping if possible
+    pRegister = PlxRegisterDirectVa( pDevice, offset, FALSE );
+    if (pRegister != NULL)
+    {
+        if (pStatus != NULL)
+        {
+            *pStatus = PLX_STATUS_OK;
+        }
+        return *pRegister;
+    }
+
     RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
 
     IoBuffer.Key      = pDevice->Key;
@@ -2524,7 +2661,8 @@ PlxPci_PlxRegisterWrite(
     U32                value
     )
 {
-    PLX_PARAMS IoBuffer;
+    PLX_PARAMS    IoBuffer;
+    volatile U32 *pRegister;
 
 
     // Verify device object
@@ -2539,6 +2677,14 @@ PlxPci_PlxRegisterWrite(
         return PLX_STATUS_INVALID_OFFSET;
     }
 
+    // Write directly to register mapping if possible
+    pRegister = PlxRegisterDirectVa( pDevice, offset, TRUE );
+    if (pRegister != NULL)
+    {
+        *pRegister = value;
+        return PLX_STATUS_OK;
+    }
+
     RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
 
     IoBuffer.Key      = pDevice->Key;
@@ -2643,6 +2789,173 @@ PlxPci_PlxMappedRegisterWrite(
 
 
 
+/******************************************************************************
+ *
+ * Function   :  PlxPci_RegisterBatch
+ *
+ * Description:  Executes a sequence of register reads, writes & delays
+ *
+ * Note       :  For PCI connections, the whole sequence is handled by the
+ *               driver in a single call.  Values read are returned in the
+ *               entries.  Processing stops at the first failing entry and the
+ *               number of entries completed is returned in pCountDone.
+ *               Batches are limited to PLX_REG_BATCH_MAX_ENTRIES entries and
+ *               a total delay of PLX_REG_BATCH_MAX_DELAY_US.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_RegisterBatch(
+    PLX_DEVICE_OBJECT   *pDevice,
+    PLX_REG_BATCH_ENTRY *pEntries,
+    U32                  Count,
+    U32                 *pCountDone
+    )
+{
+    U32        i;
+    U32        value;
+    U32        DelayTotal_us;
+    PLX_STATUS status;
+    PLX_PARAMS IoBuffer;
+
+
+    if ((pEntries == NULL) || (pCountDone == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    *pCountDone   = 0;
+    DelayTotal_us = 0;
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    if (Count > PLX_REG_BATCH_MAX_ENTRIES)
+    {
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    if (pDevice->Key.ApiMode == PLX_API_MODE_PCI)
+    {
+        RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+        IoBuffer.Key               = pDevice->Key;
+        IoBuffer.value[0]          = Count;
+        IoBuffer.u.TxParams.UserVa = (PLX_UINT_PTR)pEntries;
+
+        // Older drivers do not handle this message
+        IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+        PlxIoMessage(
+            pDevice,
+            PLX_IOCTL_REGISTER_BATCH,
+            &IoBuffer
+            );
+
+        *pCountDone = (U32)IoBuffer.value[1];
+
+        return IoBuffer.ReturnCode;
+    }
+
+    // Other connection types execute each entry individually
+    for (i = 0; i < Count; i++)
+    {
+        if ((pEntries[i].Op > PLX_REG_BATCH_DELAY) ||
+            (pEntries[i].Space > PLX_REG_BATCH_SPACE_MAPPED))
+        {
+            return PLX_STATUS_INVALID_DATA;
+        }
+
+        // Limit the total delay of the batch
+        if (pEntries[i].Delay_us > (PLX_REG_BATCH_MAX_DELAY_US - DelayTotal_us))
+        {
+            return PLX_STATUS_INVALID_SIZE;
+        }
+
+        DelayTotal_us += pEntries[i].Delay_us;
+
+        status = PLX_STATUS_OK;
+
+        // Read current value for reads & partial writes
+        if ((pEntries[i].Op == PLX_REG_BATCH_READ) ||
+            ((pEntries[i].Op == PLX_REG_BATCH_WRITE) && (pEntries[i].mask != 0)))
+        {
+            if (pEntries[i].Space == PLX_REG_BATCH_SPACE_PCI)
+            {
+                value = PlxPci_PciRegisterReadFast( pDevice, pEntries[i].offset, &status );
+            }
+            else if (pEntries[i].Space == PLX_REG_BATCH_SPACE_PLX)
+            {
+                value = PlxPci_PlxRegisterRead( pDevice, pEntries[i].offset, &status );
+            }
+            else
+            {
+                value = PlxPci_PlxMappedRegisterRead( pDevice, pEntries[i].offset, &status );
+            }
+
+            if (status != PLX_STATUS_OK)
+            {
+                return status;
+            }
+
+            if (pEntries[i].Op == PLX_REG_BATCH_READ)
+            {
+                if (pEntries[i].mask != 0)
+                {
+                    value &= pEntries[i].mask;
+                }
+                pEntries[i].value = value;
+            }
+        }
+
+        if (pEntries[i].Op == PLX_REG_BATCH_WRITE)
+        {
+            if (pEntries[i].mask == 0)
+            {
+                value = pEntries[i].value;
+            }
+            else
+            {
+                value = (value & ~pEntries[i].mask) |
+                        (pEntries[i].value & pEntries[i].mask);
+            }
+
+            if (pEntries[i].Space == PLX_REG_BATCH_SPACE_PCI)
+            {
+                status = PlxPci_PciRegisterWriteFast( pDevice, pEntries[i].offset, value );
+            }
+            else if (pEntries[i].Space == PLX_REG_BATCH_SPACE_PLX)
+            {
+                status = PlxPci_PlxRegisterWrite( pDevice, pEntries[i].offset, value );
+            }
+            else
+            {
+                status = PlxPci_PlxMappedRegisterWrite( pDevice, pEntries[i].offset, value );
+            }
+
+            if (status != PLX_STATUS_OK)
+            {
+                return status;
+            }
+        }
+
+        // Delay is rounded up to the next millisecond
+        if (pEntries[i].Delay_us != 0)
+        {
+            Plx_sleep( (pEntries[i].Delay_us + 999) / 1000 );
+        }
+
+        (*pCountDone)++;
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
 /******************************************************************************
  *
  * Function   :  PlxPci_PlxMailboxRead
@@ -2657,7 +2970,8 @@ PlxPci_PlxMailboxRead(
     PLX_STATUS        *pStatus
     )
 {
-    PLX_PARAMS IoBuffer;
+    PLX_PARAMS    IoBuffer;
+    volatile U32 *pRegister;
 
 
     // Verify device object
@@ -2670,6 +2984,23 @@ PlxPci_PlxMailboxRead(
         return PCI_CFG_RD_ERR_VAL_32;
     }
 
+    // Read directly from register mapping if possible
+    pRegister =
+        PlxRegisterDirectVa(
+            pDevice,
+            PlxMailboxOffset( pDevice, mailbox ),
+            FALSE
+            );
+
+    if (pRegister != NULL)
+    {
+        if (pStatus != NULL)
+        {
+            *pStatus = PLX_STATUS_OK;
+        }
+        return *pRegister;
+    }
+
     RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
 
     IoBuffer.Key      = pDevice->Key;
@@ -2706,7 +3037,8 @@ PlxPci_PlxMailboxWrite(
     U32                value
     )
 {
-    PLX_PARAMS IoBuffer;
+    PLX_PARAMS    IoBuffer;
+    volatile U32 *pRegister;
 
 
     // Verify device object
@@ -2715,6 +3047,20 @@ PlxPci_PlxMailboxWrite(
         return PLX_STATUS_INVALID_OBJECT;
     }
 
+    // Write directly to register mapping if possible
+    pRegister =
+        PlxRegisterDirectVa(
+            pDevice,
+            PlxMailboxOffset( pDevice, mailbox ),
+            TRUE
+            );
+
+    if (pRegister != NULL)
+    {
+        *pRegister = value;
+        return PLX_STATUS_OK;
+    }
+
     RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
 
     IoBuffer.Key      = pDevice->Key;
@@ -2735,67 +3081,46 @@ PlxPci_PlxMailboxWrite(
 
 /******************************************************************************
  *
- * Function   :  PlxPci_PciBarProperties
+ * Function   :  PlxPci_MuQueueInit
  *
- * Description:  Returns the properties of a PCI BAR space
+ * Description:  Sets up the I2O messaging unit circular queues in local memory
+ *
+ * Note       :  Queues occupy 4 * EntriesPerQueue * 4 bytes from the 1MB-aligned
+ *               LocalQueueBase.  Valid sizes are 4K, 8K, 16K, 32K or 64K
+ *               entries.  Enabling the queues maps the queue ports over
+ *               mailbox 0 & 1 and remaps local space 1 to BAR 0.
  *
  *****************************************************************************/
 PLX_STATUS
-PlxPci_PciBarProperties(
+PlxPci_MuQueueInit(
     PLX_DEVICE_OBJECT *pDevice,
-    U8                 BarIndex,
-    PLX_PCI_BAR_PROP  *pBarProp
+    U32                LocalQueueBase,
+    U32                EntriesPerQueue
     )
 {
     PLX_PARAMS IoBuffer;
 
 
-    if (pBarProp == NULL)
-    {
-        return PLX_STATUS_NULL_PARAM;
-    }
-
-    // Set default value
-    RtlZeroMemory( pBarProp, sizeof(PLX_PCI_BAR_PROP) );
-
     // Verify device object
     if (!IsObjectValid(pDevice))
     {
         return PLX_STATUS_INVALID_OBJECT;
     }
 
-    // Verify BAR number
-    switch (BarIndex)
-    {
-        case 0:
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-            break;
-
-        default:
-            return PLX_STATUS_INVALID_ACCESS;
-    }
-
     RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
 
-    IoBuffer.Key      = pDevice->Key;
-    IoBuffer.value[0] = BarIndex;
+    IoBuffer.value[0] = LocalQueueBase;
+    IoBuffer.value[1] = EntriesPerQueue;
+
+    // Drivers for chips without a messaging unit do not handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
 
     PlxIoMessage(
         pDevice,
-        PLX_IOCTL_PCI_BAR_PROPERTIES,
+        PLX_IOCTL_MU_QUEUE_INIT,
         &IoBuffer
         );
 
-    if (IoBuffer.ReturnCode == PLX_STATUS_OK)
-    {
-        // Copy properties
-        *pBarProp = IoBuffer.u.BarProp;
-    }
-
     return IoBuffer.ReturnCode;
 }
 
@@ -2804,31 +3129,31 @@ PlxPci_PciBarProperties(
 
 /******************************************************************************
  *
- * Function   :  PlxPci_PciBarMap
+ * Function   :  PlxPci_MuInboundPost
  *
- * Description:  Maps a PCI BAR space into user virtual space.
+ * Description:  Posts 32-bit message frames to the messaging unit inbound queue
+ *
+ * Note       :  If the queue fills, fewer than Count frames are posted.  The
+ *               number posted is returned in pCountPosted.
  *
  *****************************************************************************/
 PLX_STATUS
-PlxPci_PciBarMap(
-    PLX_DEVICE_OBJECT  *pDevice,
-    U8                  BarIndex,
-    VOID              **pVa
+PlxPci_MuInboundPost(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32               *pFrames,
+    U32                Count,
+    U32               *pCountPosted
     )
 {
-    U32              BarOffset;
-    PLX_PARAMS       IoBuffer;
-    PLX_STATUS       status;
-    PLX_PCI_BAR_PROP BarProp;
+    PLX_PARAMS IoBuffer;
 
 
-    if (pVa == NULL)
+    if ((pFrames == NULL) || (pCountPosted == NULL))
     {
         return PLX_STATUS_NULL_PARAM;
     }
 
-    // Set default value
-    *(PLX_UINT_PTR*)pVa = 0;
+    *pCountPosted = 0;
 
     // Verify device object
     if (!IsObjectValid(pDevice))
@@ -2836,10 +3161,193 @@ PlxPci_PciBarMap(
         return PLX_STATUS_INVALID_OBJECT;
     }
 
-    // Verify BAR number
-    switch (BarIndex)
-    {
-        case 0:
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]          = Count;
+    IoBuffer.u.TxParams.UserVa = (PLX_UINT_PTR)pFrames;
+
+    // Drivers for chips without a messaging unit do not handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_MU_INBOUND_POST,
+        &IoBuffer
+        );
+
+    *pCountPosted = (U32)IoBuffer.value[1];
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_MuOutboundDrain
+ *
+ * Description:  Reaps 32-bit message frames from the messaging unit outbound
+ *               queue, up to MaxCount or until the queue is empty
+ *
+ * Note       :  The outbound post interrupt is masked once it is signaled.
+ *               Re-enable it with PlxPci_InterruptEnable after draining to be
+ *               notified of new frames.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_MuOutboundDrain(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32               *pFrames,
+    U32                MaxCount,
+    U32               *pCountDrained
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if ((pFrames == NULL) || (pCountDrained == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    *pCountDrained = 0;
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]          = MaxCount;
+    IoBuffer.u.TxParams.UserVa = (PLX_UINT_PTR)pFrames;
+
+    // Drivers for chips without a messaging unit do not handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_MU_OUTBOUND_DRAIN,
+        &IoBuffer
+        );
+
+    *pCountDrained = (U32)IoBuffer.value[1];
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_PciBarProperties
+ *
+ * Description:  Returns the properties of a PCI BAR space
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_PciBarProperties(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    PLX_PCI_BAR_PROP  *pBarProp
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pBarProp == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Set default value
+    RtlZeroMemory( pBarProp, sizeof(PLX_PCI_BAR_PROP) );
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Verify BAR number
+    switch (BarIndex)
+    {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+            break;
+
+        default:
+            return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.Key      = pDevice->Key;
+    IoBuffer.value[0] = BarIndex;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_PCI_BAR_PROPERTIES,
+        &IoBuffer
+        );
+
+    if (IoBuffer.ReturnCode == PLX_STATUS_OK)
+    {
+        // Copy properties
+        *pBarProp = IoBuffer.u.BarProp;
+    }
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_PciBarMap
+ *
+ * Description:  Maps a PCI BAR space into user virtual space.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_PciBarMap(
+    PLX_DEVICE_OBJECT  *pDevice,
+    U8                  BarIndex,
+    VOID              **pVa
+    )
+{
+    U32              BarOffset;
+    PLX_PARAMS       IoBuffer;
+    PLX_STATUS       status;
+    PLX_PCI_BAR_PROP BarProp;
+
+
+    if (pVa == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Set default value
+    *(PLX_UINT_PTR*)pVa = 0;
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Verify BAR number
+    switch (BarIndex)
+    {
+        case 0:
         case 1:
         case 2:
         case 3:
@@ -3920,6 +4428,107 @@ PlxPci_PciBarSpaceWrite(
 
 
 
+/******************************************************************************
+ *
+ * Function   :  PlxPci_PciBarWindowLock
+ *
+ * Description:  Moves a local space window to a local address & locks it there
+ *
+ * Note       :  While locked, local address accesses outside the window fail
+ *               rather than moving it, so a sequence of accesses within the
+ *               window needs no remap register updates.  Locks are released
+ *               with PlxPci_PciBarWindowUnlock or when the device is closed.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_PciBarWindowLock(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    U32                LocalAddress
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify BAR number
+    if (BarIndex >= PCI_NUM_BARS_TYPE_00)
+    {
+        return PLX_STATUS_INVALID_DATA;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = BarIndex;
+    IoBuffer.value[1] = LocalAddress;
+
+    // Only drivers for chips with local space remap handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_PCI_BAR_WINDOW_LOCK,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_PciBarWindowUnlock
+ *
+ * Description:  Releases a local space window locked by PlxPci_PciBarWindowLock
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_PciBarWindowUnlock(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify BAR number
+    if (BarIndex >= PCI_NUM_BARS_TYPE_00)
+    {
+        return PLX_STATUS_INVALID_DATA;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = BarIndex;
+
+    // Only drivers for chips with local space remap handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_PCI_BAR_WINDOW_UNLOCK,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
 /******************************************************************************
  *
  * Function   :  PlxPci_PhysicalMemoryAllocate
@@ -4676,25 +5285,181 @@ PlxPci_NotificationCancel(
 
 /******************************************************************************
  *
- * Function   :  PlxPci_VpdRead
+ * Function   :  PlxPci_NotificationBindEventFd
  *
- * Description:  Read VPD data at the specified offset
+ * Description:  Binds an eventfd to a notification event, which the driver
+ *               signals each time the event is triggered.  This allows many
+ *               events & devices to be serviced from one epoll() loop.  The
+ *               device handle (pDevice->hDevice) may also be polled directly.
+ *               Passing a negative descriptor removes the binding.
  *
  *****************************************************************************/
-U32
-PlxPci_VpdRead(
+PLX_STATUS
+PlxPci_NotificationBindEventFd(
     PLX_DEVICE_OBJECT *pDevice,
-    U16                offset,
-    PLX_STATUS        *pStatus
+    PLX_NOTIFY_OBJECT *pEvent,
+    int                EventFd
     )
 {
     PLX_PARAMS IoBuffer;
 
 
-    // Verify device object
-    if (!IsObjectValid(pDevice))
+    // Verify notify object
+    if (pEvent == NULL)
     {
-        if (pStatus != NULL)
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Verify event object
+    if (!IsObjectValid(pEvent))
+    {
+        return PLX_STATUS_FAILED;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = pEvent->pWaitObject;
+    IoBuffer.value[1] = (S64)EventFd;
+
+    // Drivers without eventfd support do not handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_NOTIFICATION_EVENTFD_BIND,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_InterruptCoalesceSet
+ *
+ * Description:  Configures interrupt moderation for DMA done & doorbell
+ *               notifications.  Notifications are batched until MaxEvents
+ *               interrupts occur or MaxDelay_us elapses, whichever is first.
+ *               A MaxEvents of 0 or 1 disables moderation.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_InterruptCoalesceSet(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                MaxEvents,
+    U32                MaxDelay_us
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = MaxEvents;
+    IoBuffer.value[1] = MaxDelay_us;
+
+    // Drivers without interrupt moderation do not handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_INTR_COALESCE_SET,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_InterruptEventDropCount
+ *
+ * Description:  Returns the number of interrupt events the driver had to drop
+ *               because its ISR to DPC event queue was full.  Doorbell values
+ *               of dropped events are lost.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_InterruptEventDropCount(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32               *pDropCount
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pDropCount == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    // Drivers without an event queue do not handle this message
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_INTR_EVENT_DROP_COUNT,
+        &IoBuffer
+        );
+
+    if (IoBuffer.ReturnCode == PLX_STATUS_OK)
+    {
+        *pDropCount = (U32)IoBuffer.value[0];
+    }
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_VpdRead
+ *
+ * Description:  Read VPD data at the specified offset
+ *
+ *****************************************************************************/
+U32
+PlxPci_VpdRead(
+    PLX_DEVICE_OBJECT *pDevice,
+    U16                offset,
+    PLX_STATUS        *pStatus
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        if (pStatus != NULL)
         {
             *pStatus = PLX_STATUS_INVALID_OBJECT;
         }
@@ -5029,6 +5794,38 @@ PlxPci_DmaTransferBlock(
     // Setup to wait for interrupt if requested
     if (Timeout_ms != 0)
     {
+        // Poll for completion to avoid interrupt latency if requested
+        if (pDmaParams->bPolled)
+        {
+            status =
+                PlxDmaTransferPolled(
+                    pDevice,
+                    channel,
+                    pDmaParams,
+                    Timeout_ms
+                    );
+
+            if (status != PLX_STATUS_UNSUPPORTED)
+            {
+                return status;
+            }
+        }
+
+        // Transfer & wait with a single request if supported by driver
+        status =
+            PlxDmaTransferAndWait(
+                pDevice,
+                channel,
+                pDmaParams,
+                FALSE,
+                Timeout_ms
+                );
+
+        if (status != PLX_STATUS_UNSUPPORTED)
+        {
+            return status;
+        }
+
         // Clear interrupt fields
         RtlZeroMemory( &PlxIntr, sizeof(PLX_INTERRUPT) );
 
@@ -5155,6 +5952,22 @@ PlxPci_DmaTransferUserBuffer(
     // Setup to wait for interrupt if requested
     if (Timeout_ms != 0)
     {
+        // Transfer & wait with a single request if supported by driver
+        status =
+            PlxDmaTransferAndWait(
+                pDevice,
+                channel,
+                pDmaParams,
+                TRUE,
+                Timeout_ms
+                );
+
+        // Striped transfer requires a driver wait on both channels
+        if ((status != PLX_STATUS_UNSUPPORTED) || pDmaParams->bStriped)
+        {
+            return status;
+        }
+
         // Clear interrupt fields
         RtlZeroMemory( &PlxIntr, sizeof(PLX_INTERRUPT) );
 
@@ -5234,6 +6047,67 @@ PlxPci_DmaTransferUserBuffer(
 
 
 
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaTransferUserBufferV
+ *
+ * Description:  Transfers an array of user-mode buffers as a single chained
+ *               SGL DMA transfer, which completes only once
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaTransferUserBufferV(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U32                count,
+    U64                Timeout_ms
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pDmaParams == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    if (count == 0)
+    {
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]    = channel;
+    IoBuffer.value[1]    = count;
+    IoBuffer.value[2]    = Timeout_ms;
+    IoBuffer.u.ExData[0] = PLX_PTR_TO_INT( pDmaParams );
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_TRANSFER_VECTOR,
+        &IoBuffer
+        );
+
+    // Report a wait aborted by channel close as a failed transfer
+    if (IoBuffer.ReturnCode == PLX_STATUS_CANCELED)
+    {
+        return PLX_STATUS_FAILED;
+    }
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
 /******************************************************************************
  *
  * Function   :  PlxPci_DmaChannelClose
@@ -5272,6 +6146,661 @@ PlxPci_DmaChannelClose(
 
 
 
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaBufferRegister
+ *
+ * Description:  Page-locks a user buffer & builds its SGL once so that it can
+ *               be transferred repeatedly without per-transfer setup
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaBufferRegister(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U64               *pHandle
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if ((pDmaParams == NULL) || (pHandle == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]   = channel;
+    IoBuffer.u.TxParams = *pDmaParams;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_BUFFER_REGISTER,
+        &IoBuffer
+        );
+
+    // Return buffer handle
+    *pHandle = IoBuffer.value[1];
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaBufferUnregister
+ *
+ * Description:  Unlocks a previously registered DMA user buffer
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaBufferUnregister(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    U64                Handle
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = channel;
+    IoBuffer.value[1] = Handle;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_BUFFER_UNREGISTER,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaTransferRegisteredBuffer
+ *
+ * Description:  Transfers part or all of a registered user buffer using DMA.
+ *               A ByteCount of 0 transfers the remainder of the buffer.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaTransferRegisteredBuffer(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    U64                Handle,
+    U32                offset,
+    U32                ByteCount,
+    U64                Timeout_ms
+    )
+{
+    PLX_PARAMS        IoBuffer;
+    PLX_STATUS        status;
+    PLX_INTERRUPT     PlxIntr;
+    PLX_NOTIFY_OBJECT Event;
+
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Setup to wait for interrupt if requested
+    if (Timeout_ms != 0)
+    {
+        // Clear interrupt fields
+        RtlZeroMemory( &PlxIntr, sizeof(PLX_INTERRUPT) );
+
+        // Setup for DMA done interrupt
+        if (((S8)channel >= 0) && ((S8)channel < 4))
+        {
+            PlxIntr.DmaDone = (1 << channel);
+        }
+        else
+        {
+            return PLX_STATUS_INVALID_ADDR;
+        }
+
+        // Register to wait for DMA interrupt
+        PlxPci_NotificationRegisterFor(
+            pDevice,
+            &PlxIntr,
+            &Event
+            );
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]             = channel;
+    IoBuffer.value[1]             = Handle;
+    IoBuffer.value[2]             = offset;
+    IoBuffer.u.TxParams.ByteCount = ByteCount;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_TRANSFER_REG_BUFFER,
+        &IoBuffer
+        );
+
+    status = IoBuffer.ReturnCode;
+
+    // Don't wait for completion if requested not to
+    if (Timeout_ms == 0)
+    {
+        return status;
+    }
+
+    // Wait for completion if requested
+    if (status == PLX_STATUS_OK)
+    {
+        status =
+            PlxPci_NotificationWait(
+                pDevice,
+                &Event,
+                Timeout_ms
+                );
+
+        if (status == PLX_STATUS_CANCELED)
+        {
+            status = PLX_STATUS_FAILED;
+        }
+    }
+
+    // Cancel event notification
+    PlxPci_NotificationCancel( pDevice, &Event );
+
+    return status;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaTransferQueue
+ *
+ * Description:  Submits a user buffer transfer to the DMA channel queue and
+ *               returns without waiting. Queued transfers are started by the
+ *               driver back-to-back in order of submission.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaTransferQueue(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pDmaParams == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]   = channel;
+    IoBuffer.u.TxParams = *pDmaParams;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_TRANSFER_QUEUE,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaQueueStatus
+ *
+ * Description:  Returns the number of queued DMA transfers not yet completed
+ *               & the total number completed since the channel was opened
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaQueueStatus(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    U32               *pNumPending,
+    U32               *pNumCompleted
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if ((pNumPending == NULL) || (pNumCompleted == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = channel;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_QUEUE_STATUS,
+        &IoBuffer
+        );
+
+    *pNumPending   = (U32)IoBuffer.value[1];
+    *pNumCompleted = (U32)IoBuffer.value[2];
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaRingStart
+ *
+ * Description:  Starts continuous Local-to-PCI DMA into a page-aligned user
+ *               ring buffer & maps the ring control page. The application
+ *               consumes segments up to ProducerIndex & releases them by
+ *               advancing ConsumerIndex, without any further driver calls.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaRingStart(
+    PLX_DEVICE_OBJECT  *pDevice,
+    U8                  channel,
+    PLX_DMA_PARAMS     *pDmaParams,
+    U32                 SegmentSize,
+    PLX_DMA_RING_CTRL **ppRingCtrl
+    )
+{
+    VOID       *pCtrl;
+    PLX_PARAMS  IoBuffer;
+
+
+    if ((pDmaParams == NULL) || (ppRingCtrl == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Set default return value
+    *ppRingCtrl = NULL;
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]   = channel;
+    IoBuffer.value[1]   = SegmentSize;
+    IoBuffer.u.TxParams = *pDmaParams;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_RING_START,
+        &IoBuffer
+        );
+
+    if (IoBuffer.ReturnCode != PLX_STATUS_OK)
+    {
+        return IoBuffer.ReturnCode;
+    }
+
+    // Map the ring control page to user space
+    pCtrl =
+        mmap(
+            0,
+            sizeof(PLX_DMA_RING_CTRL),
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            pDevice->hDevice,
+            IoBuffer.value[2]            // CPU Physical address of control page
+            );
+
+    if (pCtrl == MAP_FAILED)
+    {
+        // Stop the ring since it can't be accessed
+        RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+        IoBuffer.value[0] = channel;
+
+        PlxIoMessage(
+            pDevice,
+            PLX_IOCTL_DMA_RING_STOP,
+            &IoBuffer
+            );
+
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    *ppRingCtrl = (PLX_DMA_RING_CTRL*)pCtrl;
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaRingStop
+ *
+ * Description:  Unmaps the ring control page & stops continuous DMA
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaRingStop(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_RING_CTRL *pRingCtrl
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pRingCtrl == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Control page must be unmapped before the driver releases it
+    munmap(
+        pRingCtrl,
+        sizeof(PLX_DMA_RING_CTRL)
+        );
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = channel;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_RING_STOP,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaCompletionRingCreate
+ *
+ * Description:  Creates a ring of DMA completion records for this device
+ *               handle & maps it to user space. The driver posts a record
+ *               each time a DMA transfer on a channel owned by the handle
+ *               completes, which may then be drained without driver calls.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaCompletionRingCreate(
+    PLX_DEVICE_OBJECT        *pDevice,
+    PLX_DMA_COMPLETION_RING **ppRing
+    )
+{
+    VOID       *pRing;
+    PLX_PARAMS  IoBuffer;
+
+
+    if (ppRing == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Set default return value
+    *ppRing = NULL;
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_COMPLETION_RING_CREATE,
+        &IoBuffer
+        );
+
+    if (IoBuffer.ReturnCode != PLX_STATUS_OK)
+    {
+        return IoBuffer.ReturnCode;
+    }
+
+    // Map the ring to user space
+    pRing =
+        mmap(
+            0,
+            sizeof(PLX_DMA_COMPLETION_RING),
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            pDevice->hDevice,
+            IoBuffer.value[0]            // CPU Physical address of ring
+            );
+
+    if (pRing == MAP_FAILED)
+    {
+        // Release the ring since it can't be accessed
+        RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+        PlxIoMessage(
+            pDevice,
+            PLX_IOCTL_DMA_COMPLETION_RING_DESTROY,
+            &IoBuffer
+            );
+
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    *ppRing = (PLX_DMA_COMPLETION_RING*)pRing;
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaCompletionRingDestroy
+ *
+ * Description:  Unmaps & releases the DMA completion ring
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaCompletionRingDestroy(
+    PLX_DEVICE_OBJECT       *pDevice,
+    PLX_DMA_COMPLETION_RING *pRing
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pRing == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Ring must be unmapped before the driver releases it
+    munmap(
+        pRing,
+        sizeof(PLX_DMA_COMPLETION_RING)
+        );
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_COMPLETION_RING_DESTROY,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaCompletionRingDrain
+ *
+ * Description:  Copies up to MaxRecords pending completion records from the
+ *               ring & releases them to the driver. Returns number copied.
+ *
+ *****************************************************************************/
+U32
+PlxPci_DmaCompletionRingDrain(
+    PLX_DMA_COMPLETION_RING *pRing,
+    PLX_DMA_COMPLETION      *pRecords,
+    U32                      MaxRecords
+    )
+{
+    U32 head;
+    U32 tail;
+    U32 count;
+
+
+    if ((pRing == NULL) || (pRecords == NULL))
+    {
+        return 0;
+    }
+
+    head = pRing->Head;
+    tail = pRing->Tail;
+
+    // Ensure records are read after the driver published them
+    __sync_synchronize();
+
+    count = 0;
+
+    while ((tail != head) && (count < MaxRecords))
+    {
+        pRecords[count] = pRing->Entry[tail & (PLX_DMA_COMPLETION_RING_SIZE - 1)];
+        tail++;
+        count++;
+    }
+
+    // Ensure records are copied before entries are released
+    __sync_synchronize();
+
+    pRing->Tail = tail;
+
+    return count;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_DmaGetStatistics
+ *
+ * Description:  Returns the transfer counters & latency histograms of a DMA
+ *               channel, optionally clearing them afterward
+ *
+ * Note       :  pStats may be NULL to only reset the statistics
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_DmaGetStatistics(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_STATS     *pStats,
+    BOOLEAN            bReset
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if ((pStats == NULL) && (bReset == FALSE))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    // Drivers without DMA statistics do not update the return code
+    IoBuffer.ReturnCode        = PLX_STATUS_UNSUPPORTED;
+    IoBuffer.value[0]          = channel;
+    IoBuffer.value[1]          = bReset;
+    IoBuffer.u.TxParams.UserVa = (PLX_UINT_PTR)pStats;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_GET_STATISTICS,
+        &IoBuffer
+        );
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+
 /******************************************************************************
  *
  * Function   :  PlxPci_PerformanceInitializeProperties
@@ -6296,6 +7825,414 @@ Driver_Connect(
 
 
 
+/******************************************************************************
+ *
+ * Function   :  PlxDmaTransferAndWait
+ *
+ * Description:  Starts a DMA transfer & waits for completion in the driver
+ *               with a single request.  Returns PLX_STATUS_UNSUPPORTED if
+ *               the driver does not implement the combined request, in
+ *               which case the caller must fall back to notifications.
+ *
+ *****************************************************************************/
+static PLX_STATUS
+PlxDmaTransferAndWait(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    BOOLEAN            bUserBuffer,
+    U64                Timeout_ms
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    // Default to unsupported in case the request is not processed
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    IoBuffer.value[0]   = channel;
+    IoBuffer.value[1]   = Timeout_ms;
+    IoBuffer.value[2]   = bUserBuffer;
+    IoBuffer.u.TxParams = *pDmaParams;
+
+    // Since the driver waits for completion, interrupt can't be ignored
+    if (bUserBuffer == FALSE)
+    {
+        IoBuffer.u.TxParams.bIgnoreBlockInt = FALSE;
+    }
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_TRANSFER_WAIT,
+        &IoBuffer
+        );
+
+    // Report an interrupted wait as a failed transfer
+    if (IoBuffer.ReturnCode == PLX_STATUS_CANCELED)
+    {
+        return PLX_STATUS_FAILED;
+    }
+
+    return IoBuffer.ReturnCode;
+}
+
+
+
+
+#if defined(PLX_LINUX)
+/******************************************************************************
+ *
+ * Function   :  PlxDmaPollDone
+ *
+ * Description:  Polls a DMA status register until the done bit is set or
+ *               the time limit expires
+ *
+ *****************************************************************************/
+static BOOLEAN
+PlxDmaPollDone(
+    volatile U32 *pDmaStat,
+    U32           DoneMask,
+    U64           Limit_ns
+    )
+{
+    U64             Elapsed_ns;
+    struct timespec TimeStart;
+    struct timespec TimeNow;
+
+
+    clock_gettime( CLOCK_MONOTONIC, &TimeStart );
+
+    do
+    {
+        if (*pDmaStat & DoneMask)
+        {
+            return TRUE;
+        }
+
+        clock_gettime( CLOCK_MONOTONIC, &TimeNow );
+
+        Elapsed_ns =
+            ((U64)(TimeNow.tv_sec - TimeStart.tv_sec) * 1000000000) +
+            TimeNow.tv_nsec - TimeStart.tv_nsec;
+    }
+    while (Elapsed_ns < Limit_ns);
+
+    // Check once more in case of preemption during the last interval
+    return (*pDmaStat & DoneMask) ? TRUE : FALSE;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxDmaPollMap
+ *
+ * Description:  Maps the register page holding the DMA status for polling
+ *
+ * Note       :  The page is mapped read-only since polling never writes
+ *               registers.  The mapping is kept for later polled transfers
+ *               & released by PlxPci_DeviceClose().
+ *
+ *****************************************************************************/
+static PLX_STATUS
+PlxDmaPollMap(
+    PLX_DEVICE_OBJECT *pDevice
+    )
+{
+    U32              BarOffset;
+    PLX_UINT_PTR     Va;
+    PLX_STATUS       status;
+    PLX_PCI_BAR_PROP BarProp;
+
+
+    // Check if mapping has already been performed
+    if (pDevice->DmaPollVa != 0)
+    {
+        return PLX_STATUS_OK;
+    }
+
+    status =
+        PlxPci_PciBarProperties(
+            pDevice,
+            0,
+            &BarProp
+            );
+
+    if (status != PLX_STATUS_OK)
+    {
+        return status;
+    }
+
+    // Verify BAR exists and is memory type
+    if ((BarProp.Physical == 0) || (BarProp.Flags & PLX_BAR_FLAG_IO))
+    {
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    // Calculate starting offset from page boundary
+    BarOffset = BarProp.Physical & ~PAGE_MASK;
+
+    // Status register must be within the mapped page
+    if ((BarOffset + PLX_9000_DMA_CMD_STAT + sizeof(U32)) > (U32)getpagesize())
+    {
+        return PLX_STATUS_UNSUPPORTED;
+    }
+
+    // Map only the first page of the register BAR
+    Va =
+        (PLX_UINT_PTR)mmap(
+            0,
+            getpagesize(),
+            PROT_READ,
+            MAP_SHARED,
+            pDevice->hDevice,
+            0                   // BAR 0
+            );
+
+    if (Va == (PLX_UINT_PTR)MAP_FAILED)
+    {
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    pDevice->DmaPollVa = Va + BarOffset;
+
+    return PLX_STATUS_OK;
+}
+#endif
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxDmaTransferPolled
+ *
+ * Description:  Starts a block DMA transfer & polls the channel done bit
+ *               through a read-only register mapping for a bounded time, then
+ *               falls back to waiting on the DMA done interrupt.  Returns
+ *               PLX_STATUS_UNSUPPORTED if polling is not possible for the
+ *               device, before any transfer is started.
+ *
+ *****************************************************************************/
+static PLX_STATUS
+PlxDmaTransferPolled(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U64                Timeout_ms
+    )
+{
+#if defined(PLX_LINUX)
+    U32           DoneSeq;
+    U32           DoneMask;
+    PLX_PARAMS    IoBuffer;
+    volatile U32 *pDmaStat;
+
+
+    // Only 9000 DMA devices report channel done in the register BAR
+    switch (pDevice->Key.PlxChip)
+    {
+        case 0x9080:
+        case 0x9054:
+        case 0x9056:
+        case 0x9656:
+        case 0x8311:
+            break;
+
+        default:
+            return PLX_STATUS_UNSUPPORTED;
+    }
+
+    if (channel >= 2)
+    {
+        return PLX_STATUS_UNSUPPORTED;
+    }
+
+    // Map DMA status on first use
+    if (PlxDmaPollMap( pDevice ) != PLX_STATUS_OK)
+    {
+        return PLX_STATUS_UNSUPPORTED;
+    }
+
+    pDmaStat =
+        (volatile U32*)PLX_INT_TO_PTR(pDevice->DmaPollVa + PLX_9000_DMA_CMD_STAT);
+
+    // Channel done bit in DMA command/status register
+    DoneMask = (1 << 4) << (channel * 8);
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]   = channel;
+    IoBuffer.u.TxParams = *pDmaParams;
+
+    // Interrupt is required in case polling times out
+    IoBuffer.u.TxParams.bIgnoreBlockInt = FALSE;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_TRANSFER_BLOCK,
+        &IoBuffer
+        );
+
+    if (IoBuffer.ReturnCode != PLX_STATUS_OK)
+    {
+        return IoBuffer.ReturnCode;
+    }
+
+    // Driver returns completion sequence number of the transfer
+    DoneSeq = (U32)IoBuffer.value[1];
+
+    // Poll for a bounded time before falling back to interrupt
+    if (PlxDmaPollDone(
+            pDmaStat,
+            DoneMask,
+            PLX_DMA_POLL_SPIN_NS
+            ))
+    {
+        return PLX_STATUS_OK;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    // Default to unsupported in case the request is not processed
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+
+    IoBuffer.value[0] = channel;
+    IoBuffer.value[1] = DoneSeq;
+    IoBuffer.value[2] = Timeout_ms;
+
+    PlxIoMessage(
+        pDevice,
+        PLX_IOCTL_DMA_WAIT_DONE,
+        &IoBuffer
+        );
+
+    // If driver can't wait on the interrupt, keep polling until timeout
+    if (IoBuffer.ReturnCode == PLX_STATUS_UNSUPPORTED)
+    {
+        if (PlxDmaPollDone(
+                pDmaStat,
+                DoneMask,
+                (Timeout_ms == PLX_TIMEOUT_INFINITE) ?
+                    (U64)-1 : (Timeout_ms * 1000000)
+                ))
+        {
+            return PLX_STATUS_OK;
+        }
+
+        return PLX_STATUS_TIMEOUT;
+    }
+
+    // Report an interrupted wait as a failed transfer
+    if (IoBuffer.ReturnCode == PLX_STATUS_CANCELED)
+    {
+        return PLX_STATUS_FAILED;
+    }
+
+    return IoBuffer.ReturnCode;
+#else
+    return PLX_STATUS_UNSUPPORTED;
+#endif
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxMailboxOffset
+ *
+ * Description:  Returns the register offset of a 9000 mailbox, or an invalid
+ *               offset if the device has no such mailbox
+ *
+ *****************************************************************************/
+static U32
+PlxMailboxOffset(
+    PLX_DEVICE_OBJECT *pDevice,
+    U16                mailbox
+    )
+{
+    // 9050/9030 do not provide mailboxes
+    if ((pDevice->Key.PlxChip == 0x9050) ||
+        (pDevice->Key.PlxChip == 0x9052) ||
+        (pDevice->Key.PlxChip == 0x9030) ||
+        (mailbox > 7))
+    {
+        return (U32)-1;
+    }
+
+    // Mailbox 0 & 1 are located after the doorbells
+    if (mailbox <= 1)
+    {
+        return PLX_9000_MAILBOX_0 + (mailbox * sizeof(U32));
+    }
+
+    return PLX_9000_MAILBOX_2 + ((mailbox - 2) * sizeof(U32));
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxRegisterDirectVa
+ *
+ * Description:  Returns the user address of a register in the BAR 0 mapping,
+ *               or NULL if the access must be sent to the driver
+ *
+ * Note       :  Only mailbox & doorbell registers are written directly.
+ *               All other registers are shared with driver state, such as
+ *               the ISR, DMA channel locks & cached remap windows, so writes
+ *               to them are always sent to the driver to be synchronized.
+ *
+ *****************************************************************************/
+static volatile U32*
+PlxRegisterDirectVa(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                offset,
+    BOOLEAN            bWrite
+    )
+{
+    if (((pDevice->OpenFlags & PLX_OPEN_FLAG_FAST_REGISTER) == 0) ||
+        (pDevice->PciBarVa[0] == 0))
+    {
+        return NULL;
+    }
+
+    // Invalid offsets are reported by the driver
+    if ((offset & 0x3) || (offset >= pDevice->PciBar[0].Size))
+    {
+        return NULL;
+    }
+
+    if (bWrite)
+    {
+        // 9050 & 9030 provide no mailbox or doorbell registers
+        if ((pDevice->Key.PlxChip == 0x9050) ||
+            (pDevice->Key.PlxChip == 0x9052) ||
+            (pDevice->Key.PlxChip == 0x9030))
+        {
+            return NULL;
+        }
+
+        if (((offset < PLX_9000_MAILBOX_ALIAS) ||
+             (offset > PLX_9000_DOORBELL_TO_PCI)) &&
+            (offset != PLX_9000_MAILBOX_0) &&
+            (offset != PLX_9000_MAILBOX_0 + sizeof(U32)))
+        {
+            return NULL;
+        }
+    }
+
+    return (volatile U32*)PLX_INT_TO_PTR(pDevice->PciBarVa[0] + offset);
+}
+
+
+
+
 /******************************************************************************
  *
  * Function   :  PlxIoMessage
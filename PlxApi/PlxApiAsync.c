@@ -0,0 +1,927 @@
+/*******************************************************************************
+ * Copyright 2013-2022 Broadcom Inc
+ * Copyright (c) 2009 to 2012 PLX Technology Inc.  All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directorY of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *
+ * File Name:
+ *
+ *     PlxApiAsync.c
+ *
+ * Description:
+ *
+ *     PLX API functions to batch driver messages through io_uring. Requests
+ *     are prepared into a queue, submitted together with a single system
+ *     call & reaped as they complete.
+ *
+ * Revision History:
+ *
+ *     11-01-19: PCI/PCIe SDK v8.10
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>     // For malloc()/free()
+#include <string.h>     // For memset()/memcpy()
+#include "PexApi.h"
+#include "PciRegs.h"
+#include "PlxApiDebug.h"
+#include "PlxIoctl.h"
+
+#if defined(PLX_LINUX)
+    #include <errno.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <linux/io_uring.h>
+
+    // Driver commands through io_uring were added to the headers in 5.19
+    #if defined(IORING_SETUP_SQE128) && defined(__NR_io_uring_setup)
+        #define PLX_ASYNC_IO_URING
+    #endif
+#endif
+
+
+
+
+/**********************************************
+ *               Definitions
+ *********************************************/
+// Request types, used to decode the completed message
+#define PLX_ASYNC_TYPE_REG_READ            1
+#define PLX_ASYNC_TYPE_REG_WRITE           2
+#define PLX_ASYNC_TYPE_DMA_TRANSFER        3
+#define PLX_ASYNC_TYPE_NOTIFICATION_WAIT   4
+
+
+#if defined(PLX_ASYNC_IO_URING)
+// Ring mappings & message slots of a queue
+typedef struct _PLX_ASYNC_RING
+{
+    int                   RingFd;       // io_uring file descriptor
+    U32                   Entries;      // Number of submission entries & message slots
+    U32                   SqTail;       // Local submission tail, published on submit
+    U32                  *pSqHead;
+    U32                  *pSqTail;
+    U32                  *pSqMask;
+    U32                  *pSqArray;
+    U32                  *pCqHead;
+    U32                  *pCqTail;
+    U32                  *pCqMask;
+    struct io_uring_sqe  *pSqes;
+    struct io_uring_cqe  *pCqes;
+    VOID                 *pSqRing;      // Submission ring mapping
+    size_t                SqRingSize;
+    VOID                 *pCqRing;      // Completion ring mapping (may equal SQ ring)
+    size_t                CqRingSize;
+    size_t                SqesSize;
+    PLX_PARAMS           *pIoBuffer;    // Message buffer of each slot
+    PLX_ASYNC_REQUEST   **ppRequest;    // Request owning each slot (NULL = free)
+} PLX_ASYNC_RING;
+#endif
+
+
+
+
+/**********************************************
+ *       Private Function Prototypes
+ *********************************************/
+static PLX_STATUS
+PlxAsyncPrepare(
+    PLX_ASYNC_QUEUE   *pQueue,
+    PLX_ASYNC_REQUEST *pRequest,
+    U32                Type,
+    U32                IoControlCode,
+    PLX_PARAMS        *pIoBuffer
+    );
+
+#if defined(PLX_ASYNC_IO_URING)
+static VOID
+PlxAsyncRingRelease(
+    PLX_ASYNC_RING *pRing
+    );
+#endif
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncQueueCreate
+ *
+ * Description:  Create a queue to batch asynchronous requests to a device
+ *
+ * Note       :  Returns PLX_STATUS_UNSUPPORTED if the OS does not provide
+ *               io_uring, in which case the synchronous API must be used
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncQueueCreate(
+    PLX_DEVICE_OBJECT *pDevice,
+    U32                Depth,
+    PLX_ASYNC_QUEUE   *pQueue
+    )
+{
+#if defined(PLX_ASYNC_IO_URING)
+
+    PLX_ASYNC_RING         *pRing;
+    struct io_uring_params  Params;
+
+
+    if ((pDevice == NULL) || (pQueue == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Requests are only passed to the PLX PCI driver
+    if (pDevice->Key.ApiMode != PLX_API_MODE_PCI)
+    {
+        return PLX_STATUS_UNSUPPORTED;
+    }
+
+    if (Depth == 0)
+    {
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    RtlZeroMemory( pQueue, sizeof(PLX_ASYNC_QUEUE) );
+
+    pRing = malloc( sizeof(PLX_ASYNC_RING) );
+    if (pRing == NULL)
+    {
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    RtlZeroMemory( pRing, sizeof(PLX_ASYNC_RING) );
+    RtlZeroMemory( &Params, sizeof(struct io_uring_params) );
+
+    pRing->RingFd =
+        (int)syscall(
+            __NR_io_uring_setup,
+            Depth,
+            &Params
+            );
+
+    if (pRing->RingFd < 0)
+    {
+        ErrorPrintf(("ERROR - io_uring setup failed (errno=%d)\n", errno));
+        free( pRing );
+        return PLX_STATUS_UNSUPPORTED;
+    }
+
+    // Kernel rounds up the number of entries to a power of 2
+    pRing->Entries    = Params.sq_entries;
+    pRing->SqRingSize = Params.sq_off.array + (Params.sq_entries * sizeof(U32));
+    pRing->CqRingSize = Params.cq_off.cqes + (Params.cq_entries * sizeof(struct io_uring_cqe));
+    pRing->SqesSize   = Params.sq_entries * sizeof(struct io_uring_sqe);
+
+    // Newer kernels map both rings with a single mapping
+    if (Params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        pRing->SqRingSize = PEX_MAX( pRing->SqRingSize, pRing->CqRingSize );
+        pRing->CqRingSize = pRing->SqRingSize;
+    }
+
+    pRing->pSqRing =
+        mmap(
+            NULL,
+            pRing->SqRingSize,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            pRing->RingFd,
+            IORING_OFF_SQ_RING
+            );
+
+    if (pRing->pSqRing == MAP_FAILED)
+    {
+        pRing->pSqRing = NULL;
+        goto _Exit_PlxPci_AsyncQueueCreate;
+    }
+
+    if (Params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        pRing->pCqRing = pRing->pSqRing;
+    }
+    else
+    {
+        pRing->pCqRing =
+            mmap(
+                NULL,
+                pRing->CqRingSize,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE,
+                pRing->RingFd,
+                IORING_OFF_CQ_RING
+                );
+
+        if (pRing->pCqRing == MAP_FAILED)
+        {
+            pRing->pCqRing = NULL;
+            goto _Exit_PlxPci_AsyncQueueCreate;
+        }
+    }
+
+    pRing->pSqes =
+        mmap(
+            NULL,
+            pRing->SqesSize,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            pRing->RingFd,
+            IORING_OFF_SQES
+            );
+
+    if (pRing->pSqes == MAP_FAILED)
+    {
+        pRing->pSqes = NULL;
+        goto _Exit_PlxPci_AsyncQueueCreate;
+    }
+
+    pRing->pSqHead  = (U32*)((U8*)pRing->pSqRing + Params.sq_off.head);
+    pRing->pSqTail  = (U32*)((U8*)pRing->pSqRing + Params.sq_off.tail);
+    pRing->pSqMask  = (U32*)((U8*)pRing->pSqRing + Params.sq_off.ring_mask);
+    pRing->pSqArray = (U32*)((U8*)pRing->pSqRing + Params.sq_off.array);
+    pRing->pCqHead  = (U32*)((U8*)pRing->pCqRing + Params.cq_off.head);
+    pRing->pCqTail  = (U32*)((U8*)pRing->pCqRing + Params.cq_off.tail);
+    pRing->pCqMask  = (U32*)((U8*)pRing->pCqRing + Params.cq_off.ring_mask);
+    pRing->pCqes    = (struct io_uring_cqe*)((U8*)pRing->pCqRing + Params.cq_off.cqes);
+    pRing->SqTail   = *pRing->pSqTail;
+
+    // Allocate a message slot per submission entry
+    pRing->pIoBuffer = calloc( pRing->Entries, sizeof(PLX_PARAMS) );
+    pRing->ppRequest = calloc( pRing->Entries, sizeof(PLX_ASYNC_REQUEST*) );
+
+    if ((pRing->pIoBuffer == NULL) || (pRing->ppRequest == NULL))
+    {
+        goto _Exit_PlxPci_AsyncQueueCreate;
+    }
+
+    pQueue->pDevice  = pDevice;
+    pQueue->Depth    = pRing->Entries;
+    pQueue->pPrivate = pRing;
+
+    ObjectValidate( pQueue );
+
+    DebugPrintf(("Created async queue (%d entries)\n", pRing->Entries));
+
+    return PLX_STATUS_OK;
+
+_Exit_PlxPci_AsyncQueueCreate:
+    ErrorPrintf(("ERROR - Unable to map io_uring (errno=%d)\n", errno));
+    PlxAsyncRingRelease( pRing );
+    return PLX_STATUS_INSUFFICIENT_RES;
+
+#else
+
+    return PLX_STATUS_UNSUPPORTED;
+
+#endif
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncQueueDestroy
+ *
+ * Description:  Release an asynchronous request queue
+ *
+ * Note       :  Any requests still in flight are abandoned, so the caller
+ *               should reap them first
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncQueueDestroy(
+    PLX_ASYNC_QUEUE *pQueue
+    )
+{
+    if (pQueue == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    if (!IsObjectValid(pQueue))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    if (pQueue->InFlight != 0)
+    {
+        DebugPrintf(("WARNING - Destroy async queue with %d requests in flight\n", pQueue->InFlight));
+    }
+
+#if defined(PLX_ASYNC_IO_URING)
+    PlxAsyncRingRelease( pQueue->pPrivate );
+#endif
+
+    ObjectInvalidate( pQueue );
+
+    pQueue->pPrivate = NULL;
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncPlxRegisterRead
+ *
+ * Description:  Prepare a request to read a PLX-specific register. The value
+ *               is returned in the Value field of the request.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncPlxRegisterRead(
+    PLX_ASYNC_QUEUE   *pQueue,
+    U32                offset,
+    PLX_ASYNC_REQUEST *pRequest
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify offset
+    if (offset >= PCIE_CONFIG_SPACE_SIZE)
+    {
+        return PLX_STATUS_INVALID_OFFSET;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = offset;
+
+    return PlxAsyncPrepare(
+        pQueue,
+        pRequest,
+        PLX_ASYNC_TYPE_REG_READ,
+        PLX_IOCTL_REGISTER_READ,
+        &IoBuffer
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncPlxRegisterWrite
+ *
+ * Description:  Prepare a request to write a PLX-specific register
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncPlxRegisterWrite(
+    PLX_ASYNC_QUEUE   *pQueue,
+    U32                offset,
+    U32                value,
+    PLX_ASYNC_REQUEST *pRequest
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    // Verify offset
+    if (offset >= PCIE_CONFIG_SPACE_SIZE)
+    {
+        return PLX_STATUS_INVALID_OFFSET;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = offset;
+    IoBuffer.value[1] = value;
+
+    return PlxAsyncPrepare(
+        pQueue,
+        pRequest,
+        PLX_ASYNC_TYPE_REG_WRITE,
+        PLX_IOCTL_REGISTER_WRITE,
+        &IoBuffer
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncDmaTransferUserBuffer
+ *
+ * Description:  Prepare a request to transfer a user buffer with DMA
+ *
+ * Note       :  With a timeout, the request completes only once the DMA
+ *               transfer completes, which requires driver support for
+ *               combined transfer & wait.  Otherwise, the request completes
+ *               once the transfer is started.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncDmaTransferUserBuffer(
+    PLX_ASYNC_QUEUE   *pQueue,
+    U8                 channel,
+    PLX_DMA_PARAMS    *pDmaParams,
+    U64                Timeout_ms,
+    PLX_ASYNC_REQUEST *pRequest
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pDmaParams == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0]   = channel;
+    IoBuffer.u.TxParams = *pDmaParams;
+
+    if (Timeout_ms == 0)
+    {
+        return PlxAsyncPrepare(
+            pQueue,
+            pRequest,
+            PLX_ASYNC_TYPE_DMA_TRANSFER,
+            PLX_IOCTL_DMA_TRANSFER_USER_BUFFER,
+            &IoBuffer
+            );
+    }
+
+    // Default to unsupported in case the request is not processed
+    IoBuffer.ReturnCode = PLX_STATUS_UNSUPPORTED;
+    IoBuffer.value[1]   = Timeout_ms;
+    IoBuffer.value[2]   = TRUE;         // User buffer transfer
+
+    return PlxAsyncPrepare(
+        pQueue,
+        pRequest,
+        PLX_ASYNC_TYPE_DMA_TRANSFER,
+        PLX_IOCTL_DMA_TRANSFER_WAIT,
+        &IoBuffer
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncNotificationWait
+ *
+ * Description:  Prepare a request which completes when a notification event
+ *               occurs or the timeout expires
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncNotificationWait(
+    PLX_ASYNC_QUEUE   *pQueue,
+    PLX_NOTIFY_OBJECT *pEvent,
+    U64                Timeout_ms,
+    PLX_ASYNC_REQUEST *pRequest
+    )
+{
+    PLX_PARAMS IoBuffer;
+
+
+    if (pEvent == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify event object
+    if (!IsObjectValid(pEvent))
+    {
+        return PLX_STATUS_FAILED;
+    }
+
+    RtlZeroMemory( &IoBuffer, sizeof(PLX_PARAMS) );
+
+    IoBuffer.value[0] = pEvent->pWaitObject;
+    IoBuffer.value[1] = Timeout_ms;
+
+    return PlxAsyncPrepare(
+        pQueue,
+        pRequest,
+        PLX_ASYNC_TYPE_NOTIFICATION_WAIT,
+        PLX_IOCTL_NOTIFICATION_WAIT,
+        &IoBuffer
+        );
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncSubmit
+ *
+ * Description:  Submit all prepared requests to the driver with a single
+ *               system call
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncSubmit(
+    PLX_ASYNC_QUEUE *pQueue,
+    U32             *pCountSubmitted
+    )
+{
+#if defined(PLX_ASYNC_IO_URING)
+
+    int             rc;
+    PLX_ASYNC_RING *pRing;
+
+
+    if (pCountSubmitted != NULL)
+    {
+        *pCountSubmitted = 0;
+    }
+
+    if (pQueue == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    if (!IsObjectValid(pQueue))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    if (pQueue->Prepared == 0)
+    {
+        return PLX_STATUS_OK;
+    }
+
+    pRing = pQueue->pPrivate;
+
+    // Ensure entries are written before they are published to the kernel
+    __sync_synchronize();
+
+    *pRing->pSqTail = pRing->SqTail;
+
+    rc =
+        (int)syscall(
+            __NR_io_uring_enter,
+            pRing->RingFd,
+            pQueue->Prepared,
+            0,
+            0,
+            NULL,
+            0
+            );
+
+    if (rc < 0)
+    {
+        ErrorPrintf(("ERROR - io_uring submit failed (errno=%d)\n", errno));
+        return PLX_STATUS_FAILED;
+    }
+
+    pQueue->Prepared -= rc;
+    pQueue->InFlight += rc;
+
+    if (pCountSubmitted != NULL)
+    {
+        *pCountSubmitted = rc;
+    }
+
+    return PLX_STATUS_OK;
+
+#else
+
+    if (pCountSubmitted != NULL)
+    {
+        *pCountSubmitted = 0;
+    }
+
+    return PLX_STATUS_UNSUPPORTED;
+
+#endif
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxPci_AsyncComplete
+ *
+ * Description:  Reap up to MaxCount completed requests & return them in the
+ *               provided list. If requested, waits for at least one request
+ *               to complete.
+ *
+ ******************************************************************************/
+PLX_STATUS
+PlxPci_AsyncComplete(
+    PLX_ASYNC_QUEUE    *pQueue,
+    PLX_ASYNC_REQUEST **ppCompleted,
+    U32                 MaxCount,
+    BOOLEAN             bWait,
+    U32                *pCountCompleted
+    )
+{
+#if defined(PLX_ASYNC_IO_URING)
+
+    int                  rc;
+    U32                  slot;
+    U32                  head;
+    U32                  tail;
+    U32                  count;
+    PLX_PARAMS          *pIoBuffer;
+    PLX_ASYNC_RING      *pRing;
+    PLX_ASYNC_REQUEST   *pRequest;
+    struct io_uring_cqe *pCqe;
+
+
+    if (pCountCompleted != NULL)
+    {
+        *pCountCompleted = 0;
+    }
+
+    if ((pQueue == NULL) || (ppCompleted == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    if (!IsObjectValid(pQueue))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    pRing = pQueue->pPrivate;
+    count = 0;
+
+    do
+    {
+        head = *pRing->pCqHead;
+        tail = *pRing->pCqTail;
+
+        // Ensure completions are read after the kernel published them
+        __sync_synchronize();
+
+        while ((head != tail) && (count < MaxCount))
+        {
+            pCqe = &pRing->pCqes[head & *pRing->pCqMask];
+            slot = (U32)pCqe->user_data;
+
+            pRequest  = pRing->ppRequest[slot];
+            pIoBuffer = &pRing->pIoBuffer[slot];
+
+            if (pCqe->res < 0)
+            {
+                // Driver without io_uring support rejects the command
+                if (pCqe->res == -EOPNOTSUPP)
+                {
+                    pRequest->Status = PLX_STATUS_UNSUPPORTED;
+                }
+                else
+                {
+                    pRequest->Status = PLX_STATUS_FAILED;
+                }
+            }
+            else
+            {
+                pRequest->Status = pIoBuffer->ReturnCode;
+
+                if (pRequest->Type == PLX_ASYNC_TYPE_REG_READ)
+                {
+                    pRequest->Value = (U32)pIoBuffer->value[1];
+                }
+            }
+
+            // Release the slot
+            pRing->ppRequest[slot] = NULL;
+            pQueue->InFlight--;
+
+            ppCompleted[count] = pRequest;
+            count++;
+            head++;
+        }
+
+        // Ensure completions are consumed before entries are released
+        __sync_synchronize();
+
+        *pRing->pCqHead = head;
+
+        if ((count != 0) || (bWait == FALSE) || (pQueue->InFlight == 0))
+        {
+            break;
+        }
+
+        // Wait for at least one completion
+        rc =
+            (int)syscall(
+                __NR_io_uring_enter,
+                pRing->RingFd,
+                0,
+                1,
+                IORING_ENTER_GETEVENTS,
+                NULL,
+                0
+                );
+
+        if ((rc < 0) && (errno != EINTR))
+        {
+            ErrorPrintf(("ERROR - io_uring wait failed (errno=%d)\n", errno));
+            return PLX_STATUS_FAILED;
+        }
+    }
+    while (MaxCount != 0);
+
+    if (pCountCompleted != NULL)
+    {
+        *pCountCompleted = count;
+    }
+
+    return PLX_STATUS_OK;
+
+#else
+
+    if (pCountCompleted != NULL)
+    {
+        *pCountCompleted = 0;
+    }
+
+    return PLX_STATUS_UNSUPPORTED;
+
+#endif
+}
+
+
+
+
+/*******************************************************************************
+ *
+ * Function   :  PlxAsyncPrepare
+ *
+ * Description:  Copy a message to a free slot of the queue & fill the
+ *               next submission entry to send it to the driver
+ *
+ ******************************************************************************/
+static PLX_STATUS
+PlxAsyncPrepare(
+    PLX_ASYNC_QUEUE   *pQueue,
+    PLX_ASYNC_REQUEST *pRequest,
+    U32                Type,
+    U32                IoControlCode,
+    PLX_PARAMS        *pIoBuffer
+    )
+{
+#if defined(PLX_ASYNC_IO_URING)
+
+    U32                  slot;
+    U32                  index;
+    PLX_URING_CMD        Cmd;
+    PLX_ASYNC_RING      *pRing;
+    struct io_uring_sqe *pSqe;
+
+
+    if ((pQueue == NULL) || (pRequest == NULL))
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    if (!IsObjectValid(pQueue))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    pRing = pQueue->pPrivate;
+
+    // Find a free slot
+    for (slot = 0; slot < pRing->Entries; slot++)
+    {
+        if (pRing->ppRequest[slot] == NULL)
+        {
+            break;
+        }
+    }
+
+    if (slot == pRing->Entries)
+    {
+        return PLX_STATUS_INSUFFICIENT_RES;
+    }
+
+    pRequest->Status = PLX_STATUS_IN_PROGRESS;
+    pRequest->Value  = 0;
+    pRequest->Slot   = slot;
+    pRequest->Type   = Type;
+
+    pRing->ppRequest[slot] = pRequest;
+    pRing->pIoBuffer[slot] = *pIoBuffer;
+
+    // Messages are sent on behalf of the queue device
+    pRing->pIoBuffer[slot].Key = pQueue->pDevice->Key;
+
+    RtlZeroMemory( &Cmd, sizeof(PLX_URING_CMD) );
+
+    Cmd.pIoBuffer = PLX_PTR_TO_INT( &pRing->pIoBuffer[slot] );
+
+    // Fill next submission entry
+    index = pRing->SqTail & *pRing->pSqMask;
+    pSqe  = &pRing->pSqes[index];
+
+    RtlZeroMemory( pSqe, sizeof(struct io_uring_sqe) );
+
+    pSqe->opcode    = IORING_OP_URING_CMD;
+    pSqe->fd        = (int)pQueue->pDevice->hDevice;
+    pSqe->cmd_op    = IoControlCode;
+    pSqe->user_data = slot;
+
+    RtlCopyMemory( pSqe->cmd, &Cmd, sizeof(PLX_URING_CMD) );
+
+    pRing->pSqArray[index] = index;
+    pRing->SqTail++;
+
+    pQueue->Prepared++;
+
+    return PLX_STATUS_OK;
+
+#else
+
+    return PLX_STATUS_UNSUPPORTED;
+
+#endif
+}
+
+
+
+
+#if defined(PLX_ASYNC_IO_URING)
+/*******************************************************************************
+ *
+ * Function   :  PlxAsyncRingRelease
+ *
+ * Description:  Unmap the rings of a queue & release its resources
+ *
+ ******************************************************************************/
+static VOID
+PlxAsyncRingRelease(
+    PLX_ASYNC_RING *pRing
+    )
+{
+    if (pRing == NULL)
+    {
+        return;
+    }
+
+    if (pRing->pSqes != NULL)
+    {
+        munmap( pRing->pSqes, pRing->SqesSize );
+    }
+
+    if ((pRing->pCqRing != NULL) && (pRing->pCqRing != pRing->pSqRing))
+    {
+        munmap( pRing->pCqRing, pRing->CqRingSize );
+    }
+
+    if (pRing->pSqRing != NULL)
+    {
+        munmap( pRing->pSqRing, pRing->SqRingSize );
+    }
+
+    close( pRing->RingFd );
+
+    free( pRing->pIoBuffer );
+    free( pRing->ppRequest );
+    free( pRing );
+}
+#endif
@@ -0,0 +1,690 @@
+/*******************************************************************************
+ * Copyright 2013-2022 Broadcom Inc
+ * Copyright (c) 2009 to 2012 PLX Technology Inc.  All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directorY of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *
+ * File Name:
+ *
+ *     PlxApiBarCopy.c
+ *
+ * Description:
+ *
+ *     PLX API functions to copy data to & from a PCI BAR space through its
+ *     user-mode mapping.  Prefetchable spaces are mapped write-combined, so
+ *     the copy uses streaming SIMD loads & non-temporal stores when the CPU
+ *     supports them, selected at run-time.
+ *
+ * Revision History:
+ *
+ *     11-01-19: PCI/PCIe SDK v8.10
+ *
+ ******************************************************************************/
+
+
+#include <string.h>     // For memcpy()
+#include "PexApi.h"
+#include "PciRegs.h"
+#include "PlxApiDebug.h"
+
+// SIMD copies need per-function target support to build without global flags
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define PLX_BAR_COPY_SIMD
+#endif
+
+
+
+
+/**********************************************
+ *               Definitions
+ *********************************************/
+// Copy routine for an aligned block
+typedef VOID (*PLX_BAR_COPY_FN)(
+    U8              *pDest,
+    U8              *pSrc,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    );
+
+
+
+
+/**********************************************
+ *       Private Function Prototypes
+ *********************************************/
+static VOID
+PlxBarReadScalar(
+    U8              *pUser,
+    U8              *pDev,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    );
+
+static VOID
+PlxBarWriteScalar(
+    U8              *pDev,
+    U8              *pUser,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    );
+
+static PLX_STATUS
+PlxBarCopyPrepare(
+    PLX_DEVICE_OBJECT  *pDevice,
+    U8                  BarIndex,
+    U32                 offset,
+    VOID               *pBuffer,
+    U32                 ByteCount,
+    PLX_ACCESS_TYPE     AccessType,
+    U8                **ppVaDev,
+    BOOLEAN            *pbBurst
+    );
+
+static VOID
+PlxBarCopySelect(
+    VOID
+    );
+
+
+
+
+/**********************************************
+ *                 Globals
+ *********************************************/
+static PLX_BAR_COPY_FN Gbl_pFnBarRead  = NULL;  // Block read from device for burst-capable spaces
+static PLX_BAR_COPY_FN Gbl_pFnBarWrite = NULL;  // Block write to device for burst-capable spaces
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_BarCopyFromDevice
+ *
+ * Description:  Copies data from a PCI BAR space through its user mapping
+ *
+ * Note       :  The BAR must first be mapped with PlxPci_PciBarMap.  Offset
+ *               & size must be aligned to the access width.  Prefetchable
+ *               spaces accessed 32 or 64 bits at a time are copied in wide
+ *               streaming loads; others are read at exactly the access width.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_BarCopyFromDevice(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    U32                offset,
+    VOID              *pBuffer,
+    U32                ByteCount,
+    PLX_ACCESS_TYPE    AccessType
+    )
+{
+    U8         *pVaDev;
+    BOOLEAN     bBurst;
+    PLX_STATUS  status;
+
+
+    status =
+        PlxBarCopyPrepare(
+            pDevice,
+            BarIndex,
+            offset,
+            pBuffer,
+            ByteCount,
+            AccessType,
+            &pVaDev,
+            &bBurst
+            );
+
+    if (status != PLX_STATUS_OK)
+    {
+        return status;
+    }
+
+    if (bBurst)
+    {
+        Gbl_pFnBarRead( pBuffer, pVaDev, ByteCount, AccessType );
+    }
+    else
+    {
+        PlxBarReadScalar( pBuffer, pVaDev, ByteCount, AccessType );
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxPci_BarCopyToDevice
+ *
+ * Description:  Copies data to a PCI BAR space through its user mapping
+ *
+ * Note       :  The same requirements as PlxPci_BarCopyFromDevice apply.
+ *               Wide non-temporal stores are complete when the call returns.
+ *
+ *****************************************************************************/
+PLX_STATUS
+PlxPci_BarCopyToDevice(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    U32                offset,
+    VOID              *pBuffer,
+    U32                ByteCount,
+    PLX_ACCESS_TYPE    AccessType
+    )
+{
+    U8         *pVaDev;
+    BOOLEAN     bBurst;
+    PLX_STATUS  status;
+
+
+    status =
+        PlxBarCopyPrepare(
+            pDevice,
+            BarIndex,
+            offset,
+            pBuffer,
+            ByteCount,
+            AccessType,
+            &pVaDev,
+            &bBurst
+            );
+
+    if (status != PLX_STATUS_OK)
+    {
+        return status;
+    }
+
+    if (bBurst)
+    {
+        Gbl_pFnBarWrite( pVaDev, pBuffer, ByteCount, AccessType );
+    }
+    else
+    {
+        PlxBarWriteScalar( pVaDev, pBuffer, ByteCount, AccessType );
+    }
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/***********************************************************
+ *
+ *                  PRIVATE SUPPORT FUNCTIONS
+ *
+ **********************************************************/
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxBarCopyPrepare
+ *
+ * Description:  Verifies a BAR copy request & returns the device address
+ *
+ *****************************************************************************/
+static PLX_STATUS
+PlxBarCopyPrepare(
+    PLX_DEVICE_OBJECT  *pDevice,
+    U8                  BarIndex,
+    U32                 offset,
+    VOID               *pBuffer,
+    U32                 ByteCount,
+    PLX_ACCESS_TYPE     AccessType,
+    U8                **ppVaDev,
+    BOOLEAN            *pbBurst
+    )
+{
+    U32 AlignMask;
+
+
+    if (pBuffer == NULL)
+    {
+        return PLX_STATUS_NULL_PARAM;
+    }
+
+    // Verify BAR number
+    if (BarIndex >= PCI_NUM_BARS_TYPE_00)
+    {
+        return PLX_STATUS_INVALID_DATA;
+    }
+
+    // Verify device object
+    if (!IsObjectValid(pDevice))
+    {
+        return PLX_STATUS_INVALID_OBJECT;
+    }
+
+    // Verify data alignment
+    switch (AccessType)
+    {
+        case BitSize8:
+            AlignMask = 0x0;
+            break;
+
+        case BitSize16:
+            AlignMask = 0x1;
+            break;
+
+        case BitSize32:
+            AlignMask = 0x3;
+            break;
+
+        case BitSize64:
+            AlignMask = 0x7;
+            break;
+
+        default:
+            return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    if (offset & AlignMask)
+    {
+        ErrorPrintf(("ERROR - Offset not aligned\n"));
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    if (ByteCount & AlignMask)
+    {
+        ErrorPrintf(("ERROR - Byte count not aligned\n"));
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    // Space must already be mapped
+    if (pDevice->PciBarVa[BarIndex] == 0)
+    {
+        ErrorPrintf(("ERROR - BAR %d not mapped\n", BarIndex));
+        return PLX_STATUS_INVALID_ADDR;
+    }
+
+    // Only memory spaces are mapped, but make sure
+    if (pDevice->PciBar[BarIndex].Flags & PLX_BAR_FLAG_IO)
+    {
+        return PLX_STATUS_INVALID_ACCESS;
+    }
+
+    // Make sure requested area doesn't exceed the space
+    if (((U64)offset + ByteCount) > pDevice->PciBar[BarIndex].Size)
+    {
+        ErrorPrintf(("ERROR - Requested area exceeds space range\n"));
+        return PLX_STATUS_INVALID_SIZE;
+    }
+
+    // Prefetchable spaces allow the CPU to combine accesses into bursts
+    if ((pDevice->PciBar[BarIndex].Flags & PLX_BAR_FLAG_PREFETCHABLE) &&
+        ((AccessType == BitSize32) || (AccessType == BitSize64)))
+    {
+        *pbBurst = TRUE;
+
+        if ((Gbl_pFnBarRead == NULL) || (Gbl_pFnBarWrite == NULL))
+        {
+            PlxBarCopySelect();
+        }
+    }
+    else
+    {
+        *pbBurst = FALSE;
+    }
+
+    *ppVaDev = (U8*)PLX_INT_TO_PTR(pDevice->PciBarVa[BarIndex] + offset);
+
+    return PLX_STATUS_OK;
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxBarReadScalar
+ *
+ * Description:  Reads from a device space exactly at the access width
+ *
+ *****************************************************************************/
+static VOID
+PlxBarReadScalar(
+    U8              *pUser,
+    U8              *pDev,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    )
+{
+    U16 Value16;
+    U32 Value32;
+    U64 Value64;
+
+
+    // User buffer may be unaligned, so store values through memcpy
+    switch (AccessType)
+    {
+        case BitSize8:
+            for (; ByteCount != 0; ByteCount -= sizeof(U8))
+            {
+                *pUser++ = *(volatile U8*)pDev++;
+            }
+            break;
+
+        case BitSize16:
+            for (; ByteCount != 0; ByteCount -= sizeof(U16))
+            {
+                Value16 = *(volatile U16*)pDev;
+                memcpy( pUser, &Value16, sizeof(U16) );
+                pUser += sizeof(U16);
+                pDev  += sizeof(U16);
+            }
+            break;
+
+        case BitSize32:
+            for (; ByteCount != 0; ByteCount -= sizeof(U32))
+            {
+                Value32 = *(volatile U32*)pDev;
+                memcpy( pUser, &Value32, sizeof(U32) );
+                pUser += sizeof(U32);
+                pDev  += sizeof(U32);
+            }
+            break;
+
+        case BitSize64:
+            for (; ByteCount != 0; ByteCount -= sizeof(U64))
+            {
+                Value64 = *(volatile U64*)pDev;
+                memcpy( pUser, &Value64, sizeof(U64) );
+                pUser += sizeof(U64);
+                pDev  += sizeof(U64);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxBarWriteScalar
+ *
+ * Description:  Writes to a device space exactly at the access width
+ *
+ *****************************************************************************/
+static VOID
+PlxBarWriteScalar(
+    U8              *pDev,
+    U8              *pUser,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    )
+{
+    U16 Value16;
+    U32 Value32;
+    U64 Value64;
+
+
+    // User buffer may be unaligned, so load values through memcpy
+    switch (AccessType)
+    {
+        case BitSize8:
+            for (; ByteCount != 0; ByteCount -= sizeof(U8))
+            {
+                *(volatile U8*)pDev++ = *pUser++;
+            }
+            break;
+
+        case BitSize16:
+            for (; ByteCount != 0; ByteCount -= sizeof(U16))
+            {
+                memcpy( &Value16, pUser, sizeof(U16) );
+                *(volatile U16*)pDev = Value16;
+                pUser += sizeof(U16);
+                pDev  += sizeof(U16);
+            }
+            break;
+
+        case BitSize32:
+            for (; ByteCount != 0; ByteCount -= sizeof(U32))
+            {
+                memcpy( &Value32, pUser, sizeof(U32) );
+                *(volatile U32*)pDev = Value32;
+                pUser += sizeof(U32);
+                pDev  += sizeof(U32);
+            }
+            break;
+
+        case BitSize64:
+            for (; ByteCount != 0; ByteCount -= sizeof(U64))
+            {
+                memcpy( &Value64, pUser, sizeof(U64) );
+                *(volatile U64*)pDev = Value64;
+                pUser += sizeof(U64);
+                pDev  += sizeof(U64);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+
+
+#if defined(PLX_BAR_COPY_SIMD)
+/******************************************************************************
+ *
+ * Function   :  PlxBarRead_Sse41
+ *
+ * Description:  Reads from a device space with SSE4.1 streaming loads
+ *
+ * Note       :  MOVNTDQA reads a full write-combining line into a streaming
+ *               buffer, so loads are issued in groups of 4 per 64B line.
+ *
+ *****************************************************************************/
+__attribute__((target("sse4.1")))
+static VOID
+PlxBarRead_Sse41(
+    U8              *pUser,
+    U8              *pDev,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    )
+{
+    U32     count;
+    __m128i Data0;
+    __m128i Data1;
+    __m128i Data2;
+    __m128i Data3;
+
+
+    // Read up to a 16B aligned device address at the access width
+    count = (U32)((16 - ((PLX_UINT_PTR)pDev & 0xF)) & 0xF);
+    if (count > ByteCount)
+    {
+        count = ByteCount;
+    }
+
+    PlxBarReadScalar( pUser, pDev, count, AccessType );
+    pUser     += count;
+    pDev      += count;
+    ByteCount -= count;
+
+    while (ByteCount >= 64)
+    {
+        Data0 = _mm_stream_load_si128( (__m128i*)(pDev +  0) );
+        Data1 = _mm_stream_load_si128( (__m128i*)(pDev + 16) );
+        Data2 = _mm_stream_load_si128( (__m128i*)(pDev + 32) );
+        Data3 = _mm_stream_load_si128( (__m128i*)(pDev + 48) );
+
+        _mm_storeu_si128( (__m128i*)(pUser +  0), Data0 );
+        _mm_storeu_si128( (__m128i*)(pUser + 16), Data1 );
+        _mm_storeu_si128( (__m128i*)(pUser + 32), Data2 );
+        _mm_storeu_si128( (__m128i*)(pUser + 48), Data3 );
+
+        pUser     += 64;
+        pDev      += 64;
+        ByteCount -= 64;
+    }
+
+    while (ByteCount >= 16)
+    {
+        Data0 = _mm_stream_load_si128( (__m128i*)pDev );
+        _mm_storeu_si128( (__m128i*)pUser, Data0 );
+
+        pUser     += 16;
+        pDev      += 16;
+        ByteCount -= 16;
+    }
+
+    // Read remainder at the access width
+    PlxBarReadScalar( pUser, pDev, ByteCount, AccessType );
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxBarWrite_Avx2
+ *
+ * Description:  Writes to a device space with AVX2 non-temporal stores
+ *
+ *****************************************************************************/
+__attribute__((target("avx2")))
+static VOID
+PlxBarWrite_Avx2(
+    U8              *pDev,
+    U8              *pUser,
+    U32              ByteCount,
+    PLX_ACCESS_TYPE  AccessType
+    )
+{
+    U32     count;
+    __m256i Data0;
+    __m256i Data1;
+
+
+    // Write up to a 32B aligned device address at the access width
+    count = (U32)((32 - ((PLX_UINT_PTR)pDev & 0x1F)) & 0x1F);
+    if (count > ByteCount)
+    {
+        count = ByteCount;
+    }
+
+    PlxBarWriteScalar( pDev, pUser, count, AccessType );
+    pUser     += count;
+    pDev      += count;
+    ByteCount -= count;
+
+    while (ByteCount >= 64)
+    {
+        Data0 = _mm256_loadu_si256( (__m256i*)(pUser +  0) );
+        Data1 = _mm256_loadu_si256( (__m256i*)(pUser + 32) );
+
+        _mm256_stream_si256( (__m256i*)(pDev +  0), Data0 );
+        _mm256_stream_si256( (__m256i*)(pDev + 32), Data1 );
+
+        pUser     += 64;
+        pDev      += 64;
+        ByteCount -= 64;
+    }
+
+    if (ByteCount >= 32)
+    {
+        Data0 = _mm256_loadu_si256( (__m256i*)pUser );
+        _mm256_stream_si256( (__m256i*)pDev, Data0 );
+
+        pUser     += 32;
+        pDev      += 32;
+        ByteCount -= 32;
+    }
+
+    // Write remainder at the access width
+    PlxBarWriteScalar( pDev, pUser, ByteCount, AccessType );
+
+    // Non-temporal stores are weakly ordered, so drain them before returning
+    _mm_sfence();
+}
+#endif  // PLX_BAR_COPY_SIMD
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PlxBarCopySelect
+ *
+ * Description:  Selects the burst copy routines supported by the CPU
+ *
+ *****************************************************************************/
+static VOID
+PlxBarCopySelect(
+    VOID
+    )
+{
+    PLX_BAR_COPY_FN pFnRead;
+    PLX_BAR_COPY_FN pFnWrite;
+
+
+    pFnRead  = PlxBarReadScalar;
+    pFnWrite = PlxBarWriteScalar;
+
+#if defined(PLX_BAR_COPY_SIMD)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports( "sse4.1" ))
+    {
+        pFnRead = PlxBarRead_Sse41;
+    }
+
+    if (__builtin_cpu_supports( "avx2" ))
+    {
+        pFnWrite = PlxBarWrite_Avx2;
+    }
+#endif
+
+    DebugPrintf((
+        "BAR copy using %s reads & %s writes\n",
+        (pFnRead  == PlxBarReadScalar)  ? "scalar" : "SSE4.1",
+        (pFnWrite == PlxBarWriteScalar) ? "scalar" : "AVX2"
+        ));
+
+    // Selection is the same on every call, so a race between threads is harmless
+    Gbl_pFnBarRead  = pFnRead;
+    Gbl_pFnBarWrite = pFnWrite;
+}
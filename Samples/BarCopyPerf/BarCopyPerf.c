@@ -0,0 +1,446 @@
+/*******************************************************************************
+ * Copyright 2013-2022 Avago Technologies
+ * Copyright (c) 2009 to 2012 PLX Technology Inc.  All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directorY of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ * File Name:
+ *
+ *      BarCopyPerf.c
+ *
+ * Description:
+ *
+ *      Measures PCI BAR space read & write performance of the driver-based
+ *      PlxPci_PciBarSpaceRead/Write against the user-mapped copy functions
+ *      PlxPci_BarCopyFromDevice/ToDevice.
+ *
+ * Revision History:
+ *
+ *      11-01-19 : PCI/PCIe SDK v8.10
+ *
+ ******************************************************************************/
+
+
+#include <sys/timeb.h>
+#include "PlxApi.h"
+
+#if defined(PLX_MSWINDOWS)
+    #include "..\\Shared\\ConsFunc.h"
+    #include "..\\Shared\\PlxInit.h"
+#endif
+
+#if defined(PLX_LINUX)
+    #include "ConsFunc.h"
+    #include "PlxInit.h"
+#endif
+
+
+
+
+/**********************************************
+*               Definitions
+**********************************************/
+#define MIN_TEST_TIME_MS            500             // Minimum time to run each measurement
+#define CALLS_PER_TIME_CHECK        64              // Calls made between checks of elapsed time
+
+// Transfer methods measured
+typedef enum _TEST_METHOD
+{
+    METHOD_IOCTL_READ,
+    METHOD_COPY_READ,
+    METHOD_IOCTL_WRITE,
+    METHOD_COPY_WRITE,
+    METHOD_COUNT
+} TEST_METHOD;
+
+
+
+
+/**********************************************
+*               Functions
+**********************************************/
+void
+PerformBarCopyPerf(
+    PLX_DEVICE_OBJECT *pDevice
+    );
+
+PLX_STATUS
+MeasureMethod(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    TEST_METHOD        Method,
+    U8                *pBuffer,
+    U32                ByteCount,
+    double            *pRate_MBps,
+    double            *pCallTime_us
+    );
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  main
+ *
+ * Description:  The main entry point
+ *
+ *****************************************************************************/
+int
+main(
+    void
+    )
+{
+    S16               DeviceSelected;
+    PLX_STATUS        rc;
+    PLX_DEVICE_KEY    DeviceKey;
+    PLX_DEVICE_OBJECT Device;
+
+
+    ConsoleInitialize();
+
+    Cons_clear();
+
+    Cons_printf(
+        "\n\n"
+        "\t\t   PLX BAR Copy Performance Sample Application\n"
+        "\t\t                November 2019\n\n"
+        );
+
+
+    /************************************
+    *         Select Device
+    ************************************/
+    DeviceSelected =
+        SelectDevice(
+            &DeviceKey
+            );
+
+    if (DeviceSelected == -1)
+    {
+        ConsoleEnd();
+        exit(0);
+    }
+
+    rc =
+        PlxPci_DeviceOpen(
+            &DeviceKey,
+            &Device
+            );
+
+    if (rc != PLX_STATUS_OK)
+    {
+        Cons_printf("\n   ERROR: Unable to find or select a PLX device\n");
+        PlxSdkErrorDisplay(rc);
+        _Pause;
+        ConsoleEnd();
+        exit(-1);
+    }
+
+    Cons_printf(
+        "\nSelected: %04x %04x [b:%02x  s:%02x  f:%x]\n\n",
+        DeviceKey.DeviceId, DeviceKey.VendorId,
+        DeviceKey.bus, DeviceKey.slot, DeviceKey.function
+        );
+
+
+
+    /************************************
+    *        Perform the Test
+    ************************************/
+    PerformBarCopyPerf(
+        &Device
+        );
+
+
+
+    /************************************
+    *        Close the Device
+    ************************************/
+    PlxPci_DeviceClose(
+        &Device
+        );
+
+    _Pause;
+
+    Cons_printf("\n\n");
+
+    ConsoleEnd();
+
+    exit(0);
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  PerformBarCopyPerf
+ *
+ * Description:  Measures each transfer method over a range of sizes
+ *
+ * Note       :  The test writes to the start of the first local space found,
+ *               so the space must not contain data that needs preserving.
+ *
+ *****************************************************************************/
+void
+PerformBarCopyPerf(
+    PLX_DEVICE_OBJECT *pDevice
+    )
+{
+    U8                i;
+    U8                BarIndex;
+    U8               *pBuffer;
+    U32               ByteCount;
+    VOID             *pVa;
+    double            Rate_MBps[METHOD_COUNT];
+    double            CallTime_us[METHOD_COUNT];
+    TEST_METHOD       Method;
+    PLX_STATUS        rc;
+    PLX_PCI_BAR_PROP  BarProp;
+
+
+    // Find the first memory space after the PLX registers
+    for (BarIndex = 2; BarIndex < 6; BarIndex++)
+    {
+        rc =
+            PlxPci_PciBarProperties(
+                pDevice,
+                BarIndex,
+                &BarProp
+                );
+
+        if ((rc == PLX_STATUS_OK) && (BarProp.Size >= 4) &&
+            !(BarProp.Flags & PLX_BAR_FLAG_IO))
+        {
+            break;
+        }
+    }
+
+    if (BarIndex == 6)
+    {
+        Cons_printf("  ERROR - Device has no local memory space to test\n");
+        return;
+    }
+
+    Cons_printf(
+        "  Testing BAR %d: %lld KB, %s, 32-bit accesses\n",
+        BarIndex, (long long)(BarProp.Size >> 10),
+        (BarProp.Flags & PLX_BAR_FLAG_PREFETCHABLE) ?
+            "prefetchable (SIMD copies if supported by CPU)" :
+            "non-prefetchable (copies at access width)"
+        );
+
+    // Map the space for the copy functions
+    rc =
+        PlxPci_PciBarMap(
+            pDevice,
+            BarIndex,
+            &pVa
+            );
+
+    if (rc != PLX_STATUS_OK)
+    {
+        Cons_printf("  ERROR - Unable to map BAR %d\n", BarIndex);
+        PlxSdkErrorDisplay(rc);
+        return;
+    }
+
+    pBuffer = malloc( (size_t)PEX_MIN(BarProp.Size, 0x10000) );
+    if (pBuffer == NULL)
+    {
+        Cons_printf("  ERROR - Buffer allocation failed\n");
+        PlxPci_PciBarUnmap( pDevice, &pVa );
+        return;
+    }
+
+    Cons_printf(
+        "\n"
+        "                 ioctl read      copy read       ioctl write     copy write\n"
+        "     Size       MB/s    us/call  MB/s    us/call  MB/s    us/call  MB/s    us/call\n"
+        "  ----------------------------------------------------------------------------------\n"
+        );
+
+    // Increase the size 4x each pass, up to 64KB or the size of the space
+    for (ByteCount = 4; ByteCount <= PEX_MIN(BarProp.Size, 0x10000); ByteCount <<= 2)
+    {
+        for (i = 0; i < METHOD_COUNT; i++)
+        {
+            Method = (TEST_METHOD)i;
+
+            rc =
+                MeasureMethod(
+                    pDevice,
+                    BarIndex,
+                    Method,
+                    pBuffer,
+                    ByteCount,
+                    &Rate_MBps[Method],
+                    &CallTime_us[Method]
+                    );
+
+            if (rc != PLX_STATUS_OK)
+            {
+                Cons_printf("\n  ERROR - Transfer failed\n");
+                PlxSdkErrorDisplay(rc);
+                goto _Exit_PerformBarCopyPerf;
+            }
+        }
+
+        Cons_printf("  %6d B", ByteCount);
+
+        for (i = 0; i < METHOD_COUNT; i++)
+        {
+            Cons_printf("  %6.1lf %8.2lf", Rate_MBps[i], CallTime_us[i]);
+        }
+
+        Cons_printf("\n");
+    }
+
+_Exit_PerformBarCopyPerf:
+    free( pBuffer );
+
+    PlxPci_PciBarUnmap(
+        pDevice,
+        &pVa
+        );
+}
+
+
+
+
+/******************************************************************************
+ *
+ * Function   :  MeasureMethod
+ *
+ * Description:  Repeats a transfer at offset 0 of a BAR for a minimum time &
+ *               returns the transfer rate & average time per call
+ *
+ *****************************************************************************/
+PLX_STATUS
+MeasureMethod(
+    PLX_DEVICE_OBJECT *pDevice,
+    U8                 BarIndex,
+    TEST_METHOD        Method,
+    U8                *pBuffer,
+    U32                ByteCount,
+    double            *pRate_MBps,
+    double            *pCallTime_us
+    )
+{
+    U32          i;
+    double       Calls;
+    double       Elapsed_sec;
+    PLX_STATUS   rc;
+    struct timeb StartTime;
+    struct timeb EndTime;
+
+
+    Calls = 0;
+    rc    = PLX_STATUS_OK;
+
+    Plx_ftime_get( &StartTime );
+
+    do
+    {
+        for (i = 0; (i < CALLS_PER_TIME_CHECK) && (rc == PLX_STATUS_OK); i++)
+        {
+            switch (Method)
+            {
+                case METHOD_IOCTL_READ:
+                    rc =
+                        PlxPci_PciBarSpaceRead(
+                            pDevice,
+                            BarIndex,
+                            0,              // Offset from start of BAR
+                            pBuffer,
+                            ByteCount,
+                            BitSize32,
+                            FALSE           // Treat address as an offset from BAR
+                            );
+                    break;
+
+                case METHOD_COPY_READ:
+                    rc =
+                        PlxPci_BarCopyFromDevice(
+                            pDevice,
+                            BarIndex,
+                            0,              // Offset from start of BAR
+                            pBuffer,
+                            ByteCount,
+                            BitSize32
+                            );
+                    break;
+
+                case METHOD_IOCTL_WRITE:
+                    rc =
+                        PlxPci_PciBarSpaceWrite(
+                            pDevice,
+                            BarIndex,
+                            0,              // Offset from start of BAR
+                            pBuffer,
+                            ByteCount,
+                            BitSize32,
+                            FALSE           // Treat address as an offset from BAR
+                            );
+                    break;
+
+                case METHOD_COPY_WRITE:
+                    rc =
+                        PlxPci_BarCopyToDevice(
+                            pDevice,
+                            BarIndex,
+                            0,              // Offset from start of BAR
+                            pBuffer,
+                            ByteCount,
+                            BitSize32
+                            );
+                    break;
+
+                default:
+                    rc = PLX_STATUS_UNSUPPORTED;
+                    break;
+            }
+        }
+
+        Calls += i;
+
+        Plx_ftime_get( &EndTime );
+
+        Elapsed_sec = PLX_DIFF_TIMEB( EndTime, StartTime );
+    }
+    while ((rc == PLX_STATUS_OK) && (Elapsed_sec < (MIN_TEST_TIME_MS / 1000.0)));
+
+    *pRate_MBps   = ((Calls * ByteCount) / Elapsed_sec) / (double)(1 << 20);
+    *pCallTime_us = (Elapsed_sec * 1000000) / Calls;
+
+    return rc;
+}
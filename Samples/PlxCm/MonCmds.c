@@ -234,6 +234,7 @@ BOOLEAN Cmd_Help( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND
     Cons_printf(" rtr       Access Run-Time registers\n");
     Cons_printf(" dma       Access DMA Registers\n");
     Cons_printf(" mqr       Access Message Queue Registers\n");
+    Cons_printf(" regbatch  Execute a file of register accesses as a batch\n");
 
     Cons_printf("\n");
     Cons_printf("       ------------  EEPROM Access  -------------\n");
@@ -3860,6 +3861,241 @@ BOOLEAN Cmd_RegDump( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMA
 
 
 
+/**********************************************************
+ *
+ * Function   :  Cmd_RegBatch
+ *
+ * Description:  Executes a file of register accesses as a single batch
+ *
+ * Note       :  Each line of the file is one of the following.  Offsets,
+ *               values & masks are hex and delays are in microseconds.
+ *
+ *                 r {pci|plx|map} offset [mask [delay_us]]
+ *                 w {pci|plx|map} offset value [mask [delay_us]]
+ *                 d delay_us
+ *
+ *               Blank lines & lines starting with '#' or ';' are ignored.
+ *
+ *********************************************************/
+BOOLEAN Cmd_RegBatch( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd )
+{
+    int                  NumTok;
+    char                 line[200];
+    char                *pTok[7];
+    U32                  i;
+    U32                  LineNum;
+    U32                  Count;
+    U32                  CountDone;
+    FILE                *pFile;
+    BOOLEAN              bOk;
+    PLXCM_ARG           *pArg;
+    PLX_STATUS           status;
+    PLX_REG_BATCH_ENTRY *pEntries;
+    PLX_REG_BATCH_ENTRY *pEntry;
+
+
+    if ( (pDevice == NULL) || (pNode == NULL) )
+    {
+        Cons_printf("Error: No device selected\n");
+        return FALSE;
+    }
+
+    if (pCmd->NumArgs != 1)
+    {
+        Cons_printf("Usage: regbatch <file>\n");
+        Cons_printf(
+            "  File line format:\n"
+            "    r {pci|plx|map} offset [mask [delay_us]]\n"
+            "    w {pci|plx|map} offset value [mask [delay_us]]\n"
+            "    d delay_us\n"
+            );
+        return TRUE;
+    }
+
+    pArg = CmdLine_ArgGet( pCmd, 0 );
+
+    pFile = fopen( pArg->ArgString, "rt" );
+    if (pFile == NULL)
+    {
+        Cons_printf("Error: Unable to open '%s'\n", pArg->ArgString);
+        return FALSE;
+    }
+
+    // Count entries to allocate table
+    Count = 0;
+    while (fgets( line, sizeof(line), pFile ) != NULL)
+    {
+        if (strtok( line, " \t\r\n" ) != NULL)
+        {
+            Count++;
+        }
+    }
+
+    if (Count == 0)
+    {
+        Cons_printf("Error: No entries in file\n");
+        fclose( pFile );
+        return FALSE;
+    }
+
+    pEntries = malloc( Count * sizeof(PLX_REG_BATCH_ENTRY) );
+    if (pEntries == NULL)
+    {
+        Cons_printf("Error: Unable to allocate %d entries\n", Count);
+        fclose( pFile );
+        return FALSE;
+    }
+
+    // Parse entries
+    rewind( pFile );
+    bOk     = TRUE;
+    Count   = 0;
+    LineNum = 0;
+    while (bOk && (fgets( line, sizeof(line), pFile ) != NULL))
+    {
+        LineNum++;
+
+        NumTok = 0;
+        pTok[0] = strtok( line, " \t\r\n" );
+        while ((pTok[NumTok] != NULL) && (NumTok < 6))
+        {
+            NumTok++;
+            pTok[NumTok] = strtok( NULL, " \t\r\n" );
+        }
+
+        // Skip blank lines & comments
+        if ((NumTok == 0) || (pTok[0][0] == '#') || (pTok[0][0] == ';'))
+        {
+            continue;
+        }
+
+        pEntry = &pEntries[Count];
+        RtlZeroMemory( pEntry, sizeof(PLX_REG_BATCH_ENTRY) );
+
+        if (Plx_strcasecmp( pTok[0], "d" ) == 0)
+        {
+            pEntry->Op = PLX_REG_BATCH_DELAY;
+            if (NumTok != 2)
+            {
+                bOk = FALSE;
+            }
+            else
+            {
+                pEntry->Delay_us = (U32)strtoul( pTok[1], NULL, 10 );
+            }
+        }
+        else if ((Plx_strcasecmp( pTok[0], "r" ) == 0) ||
+                 (Plx_strcasecmp( pTok[0], "w" ) == 0))
+        {
+            if (tolower( pTok[0][0] ) == 'r')
+            {
+                pEntry->Op = PLX_REG_BATCH_READ;
+                i          = 3;
+            }
+            else
+            {
+                pEntry->Op = PLX_REG_BATCH_WRITE;
+                i          = 4;
+            }
+
+            if ((NumTok < (int)i) || (NumTok > (int)i + 2))
+            {
+                bOk = FALSE;
+            }
+            else if (Plx_strcasecmp( pTok[1], "pci" ) == 0)
+            {
+                pEntry->Space = PLX_REG_BATCH_SPACE_PCI;
+            }
+            else if (Plx_strcasecmp( pTok[1], "plx" ) == 0)
+            {
+                pEntry->Space = PLX_REG_BATCH_SPACE_PLX;
+            }
+            else if (Plx_strcasecmp( pTok[1], "map" ) == 0)
+            {
+                pEntry->Space = PLX_REG_BATCH_SPACE_MAPPED;
+            }
+            else
+            {
+                bOk = FALSE;
+            }
+
+            if (bOk)
+            {
+                pEntry->offset = (U32)strtoul( pTok[2], NULL, 16 );
+                if (pEntry->Op == PLX_REG_BATCH_WRITE)
+                {
+                    pEntry->value = (U32)strtoul( pTok[3], NULL, 16 );
+                }
+                if (NumTok > (int)i)
+                {
+                    pEntry->mask = (U32)strtoul( pTok[i], NULL, 16 );
+                }
+                if (NumTok > (int)i + 1)
+                {
+                    pEntry->Delay_us = (U32)strtoul( pTok[i + 1], NULL, 10 );
+                }
+            }
+        }
+        else
+        {
+            bOk = FALSE;
+        }
+
+        if (bOk == FALSE)
+        {
+            Cons_printf("Error: Invalid entry on line %d\n", LineNum);
+        }
+
+        Count++;
+    }
+
+    fclose( pFile );
+
+    if (bOk == FALSE)
+    {
+        free( pEntries );
+        return FALSE;
+    }
+
+    // Execute the batch
+    status = PlxPci_RegisterBatch( pDevice, pEntries, Count, &CountDone );
+
+    // Display values read
+    for (i = 0; i < CountDone; i++)
+    {
+        if (pEntries[i].Op == PLX_REG_BATCH_READ)
+        {
+            Cons_printf(
+                " %4d: %s %03X = %08X\n",
+                i,
+                (pEntries[i].Space == PLX_REG_BATCH_SPACE_PCI) ? "PCI" :
+                  (pEntries[i].Space == PLX_REG_BATCH_SPACE_PLX) ? "PLX" : "MAP",
+                pEntries[i].offset,
+                pEntries[i].value
+                );
+        }
+    }
+
+    if (status != PLX_STATUS_OK)
+    {
+        Cons_printf(
+            "Error: Batch stopped at entry %d of %d (status=%02Xh)\n",
+            CountDone, Count, status
+            );
+    }
+    else
+    {
+        Cons_printf("Executed %d entries\n", Count);
+    }
+
+    free( pEntries );
+
+    return (status == PLX_STATUS_OK);
+}
+
+
+
+
 /**********************************************************
  *
  * Function   :  Cmd_Eep
@@ -87,6 +87,7 @@ typedef enum
     CMD_REG_PCI,
     CMD_REG_PLX,
     CMD_REG_DUMP,
+    CMD_REG_BATCH,
     CMD_EEP,
     CMD_EEP_FILE,
     CMD_SPI_RW,
@@ -127,6 +128,7 @@ BOOLEAN Cmd_IoWrite    ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_C
 BOOLEAN Cmd_RegPci     ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
 BOOLEAN Cmd_RegPlx     ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
 BOOLEAN Cmd_RegDump    ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
+BOOLEAN Cmd_RegBatch   ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
 BOOLEAN Cmd_Eep        ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
 BOOLEAN Cmd_Eep8000    ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
 BOOLEAN Cmd_EepFile    ( DEVICE_NODE *pNode, PLX_DEVICE_OBJECT *pDevice, PLXCM_COMMAND *pCmd );
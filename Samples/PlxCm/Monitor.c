@@ -102,6 +102,7 @@ static FN_TABLE Gbl_FnTable[] =
     { CMD_REG_PCI   ,  TRUE, "pcr/pci"                 , Cmd_RegPci      },
     { CMD_REG_PLX   ,  TRUE, "reg/mmr/lcr/rtr/dma/mqr" , Cmd_RegPlx      },
     { CMD_REG_DUMP  ,  TRUE, "dp/dr"                   , Cmd_RegDump     },
+    { CMD_REG_BATCH , FALSE, "regbatch"                , Cmd_RegBatch    },
     { CMD_EEP       ,  TRUE, "eep"                     , Cmd_Eep         },
     { CMD_EEP_FILE  , FALSE, "eepload/eepsave"         , Cmd_EepFile     },
     { CMD_SPI_RW    ,  TRUE, "spirw"                   , Cmd_SpiRW       },